@@ -0,0 +1,10 @@
+#///////////////////////////////////////////////////////////////////////////////
+#// Reaper
+#//
+#// Copyright (c) 2015-2022 Thibault Schueller
+#// This file is distributed under the MIT License
+#///////////////////////////////////////////////////////////////////////////////
+
+set(MESHOPT_BUILD_SHARED_LIBS ${REAPER_BUILD_SHARED_LIBS})
+add_subdirectory(${CMAKE_SOURCE_DIR}/external/meshoptimizer ${CMAKE_BINARY_DIR}/external/meshoptimizer)
+set_target_properties(meshoptimizer PROPERTIES FOLDER External)
@@ -65,7 +65,8 @@ namespace
 {
 #if ENABLE_GAME_SCENE
     Track create_game_track(const GenerationInfo& gen_info, Reaper::VulkanBackend& backend, PhysicsSim& sim,
-                            Reaper::SceneGraph& scene, Reaper::SceneMaterialHandle material_handle)
+                            Reaper::SceneGraph& scene, Reaper::SceneMaterialHandle material_handle,
+                            Reaper::JobSystem* job_system)
     {
         const std::string track_mesh_path("res/model/track_chunk_simple.obj");
         const float       track_mesh_length = 10.0f;
@@ -101,7 +102,7 @@ namespace
         sim_create_static_collision_meshes(track.sim_handles, sim, track_meshes, chunk_transforms);
 
         std::vector<Reaper::MeshHandle> chunk_mesh_handles(track_meshes.size());
-        load_meshes(backend, backend.resources->mesh_cache, track_meshes, chunk_mesh_handles);
+        load_meshes(backend, backend.resources->mesh_cache, track_meshes, chunk_mesh_handles, job_system);
 
         // Place static track in the scene
         for (u32 chunk_index = 0; chunk_index < gen_info.chunk_count; chunk_index++)
@@ -119,14 +120,17 @@ namespace
     {
         sim_destroy_static_collision_meshes(track.sim_handles, sim);
 
+        std::vector<Reaper::MeshHandle> chunk_mesh_handles;
+
         for (auto scene_mesh : track.scene_meshes)
         {
             destroy_scene_node(scene, scene_mesh.scene_node);
+            chunk_mesh_handles.push_back(scene_mesh.mesh_handle);
         }
 
+        unload_meshes(backend, backend.resources->mesh_cache, chunk_mesh_handles);
+
         // FIXME Unload texture data (cpu/gpu)
-        // FIXME Unload mesh data (cpu/render)
-        static_cast<void>(backend);
     }
 #endif
 } // namespace
@@ -325,7 +329,7 @@ void execute_game_loop(ReaperRoot& root)
         backend.resources->material_resources, static_cast<u32>(default_texture_filesnames.size()));
 
     load_png_textures_to_staging(backend, backend.resources->material_resources, default_texture_filesnames,
-                                 default_material_handle_span, default_texture_srgb);
+                                 default_material_handle_span, default_texture_srgb, root.job_system);
 
 #if GLTF_TEST
     std::string   gltf_path = "res/model/sci_fi_helmet/";
@@ -462,12 +466,13 @@ void execute_game_loop(ReaperRoot& root)
     }
 
     std::vector<MeshHandle> gltf_mesh_handles(data->meshes_count);
-    load_meshes(backend, backend.resources->mesh_cache, meshes, gltf_mesh_handles);
+    load_meshes(backend, backend.resources->mesh_cache, meshes, gltf_mesh_handles, root.job_system);
 
     cgltf_free(data);
 #endif
 
-    load_dds_textures_to_staging(backend, backend.resources->material_resources, dds_filenames, dds_handle_span);
+    load_dds_textures_to_staging(backend, backend.resources->material_resources, dds_filenames, dds_handle_span,
+                                 root.job_system);
 
 #if ENABLE_TEST_SCENE
     // scene = create_test_scene_tiled_lighting(backend);
@@ -490,14 +495,14 @@ void execute_game_loop(ReaperRoot& root)
     };
 
     Neptune::Track game_track =
-        Neptune::create_game_track(track_gen_info, backend, sim, scene, default_material_handle);
+        Neptune::create_game_track(track_gen_info, backend, sim, scene, default_material_handle, root.job_system);
 
     const glm::fmat4x3 player_initial_transform = glm::translate(glm::mat4(1.0f), glm::vec3(1.1f, 0.8f, 0.f));
     Neptune::sim_create_player_rigid_body(sim, player_initial_transform);
 
     // Build scene
-    SceneNode* player_scene_node = nullptr;
-    SceneMesh  player_scene_mesh;
+    SceneNodeHandle player_scene_node = InvalidSceneNodeHandle;
+    SceneMesh       player_scene_mesh;
 
     {
         const glm::vec3 up_ws = glm::vec3(0.f, 1.f, 0.f);
@@ -510,11 +515,11 @@ void execute_game_loop(ReaperRoot& root)
 #    if ENABLE_FREE_CAM
             const glm::fvec3 camera_position = glm::vec3(-5.f, 0.f, 0.f);
             const glm::fvec3 camera_local_target = glm::vec3(0.f, 0.f, 0.f);
-            SceneNode*       camera_parent_node = nullptr;
+            SceneNodeHandle  camera_parent_node = InvalidSceneNodeHandle;
 #    else
             const glm::fvec3 camera_position = glm::vec3(-2.0f, 0.8f, 0.f);
             const glm::fvec3 camera_local_target = glm::vec3(1.f, 0.4f, 0.f);
-            SceneNode*       camera_parent_node = player_scene_node;
+            SceneNodeHandle  camera_parent_node = player_scene_node;
 #    endif
 
             const glm::fmat4x3 camera_local_transform =
@@ -585,7 +590,7 @@ void execute_game_loop(ReaperRoot& root)
 #if ENABLE_FREE_CAM
     // Try to match the camera state with the initial transform of the scene node
     CameraState camera_state = {};
-    camera_state.position = scene.camera_node->transform_matrix[3];
+    camera_state.position = get_scene_node_local_transform(scene, scene.camera_node)[3];
 #endif
 
     const auto startTime = std::chrono::system_clock::now();
@@ -747,7 +752,7 @@ void execute_game_loop(ReaperRoot& root)
         const glm::fmat4x3 player_transform = Neptune::get_player_transform(sim);
         glm::fvec3         player_translation = player_transform[3];
 
-        player_scene_node->transform_matrix = player_transform;
+        set_scene_node_transform(scene, player_scene_node, player_transform);
 
         {
             constexpr u32 length_min = 1;
@@ -774,12 +779,8 @@ void execute_game_loop(ReaperRoot& root)
                 {
                     Neptune::destroy_game_track(game_track, backend, sim, scene);
 
-                    // We don't handle fragmentation yet, so we recreate ALL renderer meshes
-                    // FIXME since GLTF was added we don't do this properly anymore
-                    clear_meshes(backend.resources->mesh_cache);
-
-                    game_track =
-                        Neptune::create_game_track(track_gen_info, backend, sim, scene, default_material_handle);
+                    game_track = Neptune::create_game_track(track_gen_info, backend, sim, scene,
+                                                            default_material_handle, root.job_system);
                 }
 
                 ImGui::Separator();
@@ -800,7 +801,7 @@ void execute_game_loop(ReaperRoot& root)
 
         update_camera_state(camera_state, yaw_pitch_delta, forward_side_delta);
 
-        scene.camera_node->transform_matrix = glm::inverse(compute_camera_view_matrix(camera_state));
+        set_scene_node_transform(scene, scene.camera_node, glm::inverse(compute_camera_view_matrix(camera_state)));
 #endif
 
         ImGui::Render();
@@ -842,6 +843,8 @@ void execute_game_loop(ReaperRoot& root)
                 0x0000FFFF));
         }
 
+        update_scene_transforms(scene);
+
         renderer_execute_frame(root, scene, audio_backend.audio_buffer, debug_draw_commands);
 
         audio_execute_frame(root, audio_backend);
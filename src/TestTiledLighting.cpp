@@ -10,6 +10,7 @@
 #include "Geometry.h"
 
 #include "mesh/ModelLoader.h"
+#include "renderer/CookedMesh.h"
 #include "renderer/Mesh2.h"
 #include "renderer/vulkan/Backend.h"
 #include "renderer/vulkan/BackendResources.h"
@@ -33,6 +34,18 @@ namespace
         {
             ReaperMesh& mesh = geometry.mesh;
             Assert(mesh.source != EmptySource);
+
+            // Skip parsing and meshlet building when the mesh cooker already did it
+            std::vector<MeshHandle> cooked_mesh_handles;
+
+            if (load_cooked_meshes(backend, backend.resources->mesh_cache, get_cooked_mesh_path(mesh.source),
+                                   hash_cooked_mesh_source(mesh.source), cooked_mesh_handles))
+            {
+                Assert(cooked_mesh_handles.size() == 1);
+                mesh.handle = cooked_mesh_handles[0];
+                continue;
+            }
+
             meshes.push_back(load_obj(mesh.source));
             mesh_indirections.push_back(&mesh.handle);
         }
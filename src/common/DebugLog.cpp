@@ -23,6 +23,8 @@ void DebugLog::log(LogLevel level, const std::string& message)
     if (to_underlying(level) > to_underlying(m_logLevel))
         return;
 
+    std::lock_guard<std::mutex> lock(m_mutex);
+
     switch (level)
     {
     case LogLevel::Error:
@@ -9,6 +9,7 @@
 
 #include "Log.h"
 
+#include <mutex>
 #include <string>
 
 namespace Reaper
@@ -24,6 +25,7 @@ public:
     void         setLogLevel(LogLevel level);
 
 private:
-    LogLevel m_logLevel;
+    LogLevel   m_logLevel;
+    std::mutex m_mutex; // Messages can come from job threads
 };
 } // namespace Reaper
@@ -12,11 +12,13 @@ namespace Reaper
 struct Renderer;
 class ILog;
 struct AudioBackend;
+struct JobSystem;
 
 struct ReaperRoot
 {
     Renderer*     renderer;
     ILog*         log;
     AudioBackend* audio;
+    JobSystem*    job_system;
 };
 } // namespace Reaper
@@ -0,0 +1,40 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "core/Types.h"
+
+#include <cstddef>
+
+namespace Reaper
+{
+// 64-bit FNV-1a
+// Good enough for hashing small keys, don't use this for anything security related.
+constexpr u64 HashSeed = 0xcbf29ce484222325;
+
+inline u64 hash_bytes(u64 seed, const void* data, std::size_t size_bytes)
+{
+    const u8* bytes = static_cast<const u8*>(data);
+    u64       hash = seed;
+
+    for (std::size_t i = 0; i < size_bytes; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3;
+    }
+
+    return hash;
+}
+
+// NOTE: Hash fields one by one instead of whole structs so padding bytes never end up in the key.
+template <typename T>
+inline u64 hash_value(u64 seed, T value)
+{
+    return hash_bytes(seed, &value, sizeof(T));
+}
+} // namespace Reaper
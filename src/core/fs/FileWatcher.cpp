@@ -0,0 +1,126 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include "FileWatcher.h"
+
+#include "core/Assert.h"
+#include "core/Platform.h"
+
+#if defined(REAPER_PLATFORM_LINUX)
+
+#    include <sys/inotify.h>
+#    include <unistd.h>
+
+#    include <cerrno>
+#    include <unordered_map>
+
+namespace Reaper
+{
+struct FileWatcher
+{
+    int                                  inotify_fd;
+    std::unordered_map<int, std::string> directory_paths; // Indexed by watch descriptor
+};
+
+FileWatcher* create_file_watcher()
+{
+    const int inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    Assert(inotify_fd >= 0, "could not create inotify instance");
+
+    return new FileWatcher{
+        .inotify_fd = inotify_fd,
+        .directory_paths = {},
+    };
+}
+
+void destroy_file_watcher(FileWatcher* file_watcher)
+{
+    // Watches go away with the descriptor
+    close(file_watcher->inotify_fd);
+
+    delete file_watcher;
+}
+
+bool add_file_watch_directory(FileWatcher& file_watcher, const std::string& directory_path)
+{
+    // Compilers usually write the output in place, some write a temporary file and rename it
+    const int watch_descriptor =
+        inotify_add_watch(file_watcher.inotify_fd, directory_path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+
+    if (watch_descriptor < 0)
+        return false;
+
+    file_watcher.directory_paths[watch_descriptor] = directory_path;
+
+    return true;
+}
+
+void poll_file_watcher(FileWatcher& file_watcher, std::vector<std::string>& output_file_paths)
+{
+    alignas(inotify_event) char buffer[4096];
+
+    while (true)
+    {
+        const ssize_t read_size_bytes = read(file_watcher.inotify_fd, buffer, sizeof(buffer));
+
+        if (read_size_bytes <= 0)
+        {
+            Assert(read_size_bytes == 0 || errno == EAGAIN, "could not read inotify events");
+            return;
+        }
+
+        for (ssize_t offset_bytes = 0; offset_bytes < read_size_bytes;)
+        {
+            const inotify_event& event = *reinterpret_cast<const inotify_event*>(buffer + offset_bytes);
+
+            offset_bytes += sizeof(inotify_event) + event.len;
+
+            const auto directory_it = file_watcher.directory_paths.find(event.wd);
+
+            if (event.len == 0 || (event.mask & IN_ISDIR) || directory_it == file_watcher.directory_paths.end())
+                continue;
+
+            output_file_paths.push_back(directory_it->second + "/" + event.name);
+        }
+    }
+}
+} // namespace Reaper
+
+#else
+
+namespace Reaper
+{
+struct FileWatcher
+{
+};
+
+FileWatcher* create_file_watcher()
+{
+    return new FileWatcher;
+}
+
+void destroy_file_watcher(FileWatcher* file_watcher)
+{
+    delete file_watcher;
+}
+
+bool add_file_watch_directory(FileWatcher& file_watcher, const std::string& directory_path)
+{
+    static_cast<void>(file_watcher);
+    static_cast<void>(directory_path);
+
+    return false;
+}
+
+void poll_file_watcher(FileWatcher& file_watcher, std::vector<std::string>& output_file_paths)
+{
+    static_cast<void>(file_watcher);
+    static_cast<void>(output_file_paths);
+}
+} // namespace Reaper
+
+#endif
@@ -0,0 +1,30 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "core/CoreExport.h"
+
+#include <string>
+#include <vector>
+
+namespace Reaper
+{
+// Reports files that were written to or moved into a set of directories, subdirectories are not watched.
+// Backed by inotify on Linux, other platforms never report anything.
+struct FileWatcher;
+
+REAPER_CORE_API FileWatcher* create_file_watcher();
+REAPER_CORE_API void         destroy_file_watcher(FileWatcher* file_watcher);
+
+// Returns false when the directory can't be watched.
+REAPER_CORE_API bool add_file_watch_directory(FileWatcher& file_watcher, const std::string& directory_path);
+
+// Never blocks. Appends the path of every file that changed since the last call, as directory_path/file_name.
+// A file written several times is reported several times.
+REAPER_CORE_API void poll_file_watcher(FileWatcher& file_watcher, std::vector<std::string>& output_file_paths);
+} // namespace Reaper
@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include "MappedFile.h"
+
+#include "core/Assert.h"
+
+#if defined(REAPER_PLATFORM_LINUX) || defined(REAPER_PLATFORM_MACOSX)
+
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+
+namespace Reaper
+{
+bool map_file(const std::string& file_path, MappedFile& output)
+{
+    const int fd = open(file_path.c_str(), O_RDONLY);
+
+    if (fd < 0)
+        return false;
+
+    struct stat file_stat;
+    void*       data = MAP_FAILED;
+
+    if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0)
+        data = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping keeps its own reference to the file
+    close(fd);
+
+    if (data == MAP_FAILED)
+        return false;
+
+    output.data = static_cast<const u8*>(data);
+    output.size_bytes = static_cast<u64>(file_stat.st_size);
+
+    return true;
+}
+
+void unmap_file(MappedFile& mapped_file)
+{
+    const int ret = munmap(const_cast<u8*>(mapped_file.data), mapped_file.size_bytes);
+    Assert(ret == 0);
+
+    mapped_file.data = nullptr;
+    mapped_file.size_bytes = 0;
+}
+} // namespace Reaper
+
+#elif defined(REAPER_PLATFORM_WINDOWS)
+
+namespace Reaper
+{
+bool map_file(const std::string& file_path, MappedFile& output)
+{
+    HANDLE file_handle = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                     FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file_handle == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER file_size;
+
+    if (!GetFileSizeEx(file_handle, &file_size) || file_size.QuadPart == 0)
+    {
+        CloseHandle(file_handle);
+        return false;
+    }
+
+    HANDLE mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (mapping_handle == nullptr)
+    {
+        CloseHandle(file_handle);
+        return false;
+    }
+
+    const void* data = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+
+    if (data == nullptr)
+    {
+        CloseHandle(mapping_handle);
+        CloseHandle(file_handle);
+        return false;
+    }
+
+    output.data = static_cast<const u8*>(data);
+    output.size_bytes = static_cast<u64>(file_size.QuadPart);
+    output.file_handle = file_handle;
+    output.mapping_handle = mapping_handle;
+
+    return true;
+}
+
+void unmap_file(MappedFile& mapped_file)
+{
+    UnmapViewOfFile(mapped_file.data);
+    CloseHandle(mapped_file.mapping_handle);
+    CloseHandle(mapped_file.file_handle);
+
+    mapped_file.data = nullptr;
+    mapped_file.size_bytes = 0;
+}
+} // namespace Reaper
+
+#else
+#    error
+#endif
@@ -0,0 +1,34 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "core/CoreExport.h"
+#include "core/Platform.h"
+#include "core/Types.h"
+
+#include <string>
+
+namespace Reaper
+{
+// Read-only mapping of a whole file, the OS pages the data in on first access.
+// The base address is page-aligned, so data with a known layout can be read in place.
+struct MappedFile
+{
+    const u8* data;
+    u64       size_bytes;
+
+#if defined(REAPER_PLATFORM_WINDOWS)
+    HANDLE file_handle;
+    HANDLE mapping_handle;
+#endif
+};
+
+// Returns false when the file can't be opened or is empty.
+REAPER_CORE_API bool map_file(const std::string& file_path, MappedFile& output);
+REAPER_CORE_API void unmap_file(MappedFile& mapped_file);
+} // namespace Reaper
@@ -0,0 +1,620 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include "JobSystem.h"
+
+#include "core/Assert.h"
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// reaper_profiling pulls in Vulkan for GPU zones, so core talks to Tracy directly
+#if defined(REAPER_USE_TRACY)
+#    include "tracy/Tracy.hpp"
+
+#    define REAPER_JOB_PROFILE_SCOPE(name) ZoneScopedN(name)
+#    define REAPER_JOB_SET_THREAD_NAME(name) tracy::SetThreadName(name)
+#else
+#    define REAPER_JOB_PROFILE_SCOPE(name) \
+        do                                 \
+        {                                  \
+        } while (0)
+#    define REAPER_JOB_SET_THREAD_NAME(name) \
+        do                                   \
+        {                                    \
+        } while (0)
+#endif
+
+namespace Reaper
+{
+namespace
+{
+    constexpr u32 JobQueueCapacity = 4096; // Power of two
+    constexpr u32 ParallelForMaxChunkCount = 1024;
+
+    // Chase-Lev deque, see "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al. 2013).
+    // The seq_cst fences of the paper are folded into the accesses to top and bottom.
+    // Only the owning thread pushes and pops at the bottom, any thread can steal from the top.
+    // It doesn't grow, a full queue makes the owner run the job inline instead.
+    struct JobQueue
+    {
+        alignas(64) std::atomic<i64> top;
+        alignas(64) std::atomic<i64> bottom;
+
+        std::array<std::atomic<Job*>, JobQueueCapacity> jobs;
+    };
+
+    bool job_queue_push(JobQueue& queue, Job* job)
+    {
+        const i64 bottom = queue.bottom.load(std::memory_order_relaxed);
+        const i64 top = queue.top.load(std::memory_order_acquire);
+
+        if (bottom - top >= static_cast<i64>(JobQueueCapacity))
+            return false;
+
+        queue.jobs[bottom & (JobQueueCapacity - 1)].store(job, std::memory_order_relaxed);
+        queue.bottom.store(bottom + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    Job* job_queue_pop(JobQueue& queue)
+    {
+        const i64 bottom = queue.bottom.load(std::memory_order_relaxed) - 1;
+        queue.bottom.store(bottom, std::memory_order_seq_cst);
+        i64 top = queue.top.load(std::memory_order_seq_cst);
+
+        if (top > bottom)
+        {
+            // Empty
+            queue.bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Job* job = queue.jobs[bottom & (JobQueueCapacity - 1)].load(std::memory_order_relaxed);
+
+        if (top == bottom)
+        {
+            // Last job, race against thieves for it
+            if (!queue.top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                                   std::memory_order_relaxed))
+            {
+                job = nullptr;
+            }
+
+            queue.bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        return job;
+    }
+
+    Job* job_queue_steal(JobQueue& queue)
+    {
+        i64       top = queue.top.load(std::memory_order_seq_cst);
+        const i64 bottom = queue.bottom.load(std::memory_order_seq_cst);
+
+        if (top >= bottom)
+            return nullptr;
+
+        Job* job = queue.jobs[top & (JobQueueCapacity - 1)].load(std::memory_order_relaxed);
+
+        // Lost the race to the owner or another thief
+        if (!queue.top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
+
+        return job;
+    }
+
+    // Which job system queue the current thread owns, if any
+    struct ThreadContext
+    {
+        JobSystem* job_system;
+        u32        queue_index;
+        u32        steal_seed;
+    };
+
+    thread_local ThreadContext tls_thread_context = {};
+} // namespace
+
+struct JobSystem
+{
+    std::vector<std::thread> worker_threads;
+
+    // Index 0 belongs to the thread that created the job system, worker N owns queue N + 1
+    std::unique_ptr<JobQueue[]> queues;
+    u32                         queue_count;
+
+    // For threads without a queue of their own
+    std::mutex        shared_queue_mutex;
+    std::deque<Job*>  shared_queue;
+    std::atomic<bool> shared_queue_empty;
+
+    // Can briefly go negative when a job gets taken before the push is accounted for
+    std::atomic<i32> queued_job_count;
+
+    // Only workers take from it, and only when they have nothing else to do
+    std::mutex        background_queue_mutex;
+    std::deque<Job*>  background_queue;               // Protected by background_queue_mutex
+    std::atomic<u32>  running_background_job_count;   // Written with background_queue_mutex held
+    std::atomic<bool> has_runnable_background_job;    // Written with background_queue_mutex held
+    u32               max_running_background_job_count;
+
+    // Sleeping threads wait for queued jobs, counters reaching zero, or shutdown
+    std::mutex              mutex;
+    std::condition_variable wake_up;
+    bool                    stop_requested; // Protected by the mutex
+};
+
+namespace
+{
+    JobQueue* get_thread_queue(JobSystem& job_system)
+    {
+        if (tls_thread_context.job_system != &job_system)
+            return nullptr;
+
+        return &job_system.queues[tls_thread_context.queue_index];
+    }
+
+    void wake_up_threads(JobSystem& job_system)
+    {
+        // Sleepers check their condition while holding the mutex, taking it here means none of them can miss the
+        // notification.
+        {
+            std::lock_guard<std::mutex> lock(job_system.mutex);
+        }
+
+        job_system.wake_up.notify_all();
+    }
+
+    Job* steal_job(JobSystem& job_system)
+    {
+        if (!job_system.shared_queue_empty.load(std::memory_order_acquire))
+        {
+            std::lock_guard<std::mutex> lock(job_system.shared_queue_mutex);
+
+            if (!job_system.shared_queue.empty())
+            {
+                Job* job = job_system.shared_queue.front();
+                job_system.shared_queue.pop_front();
+
+                job_system.shared_queue_empty.store(job_system.shared_queue.empty(), std::memory_order_release);
+
+                return job;
+            }
+        }
+
+        // Start at a different victim every time so thieves spread out
+        ThreadContext& context = tls_thread_context;
+        context.steal_seed = context.steal_seed * 1664525u + 1013904223u;
+
+        const u32  first_queue_index = (context.steal_seed >> 16) % job_system.queue_count;
+        const bool has_own_queue = context.job_system == &job_system;
+
+        for (u32 i = 0; i < job_system.queue_count; i++)
+        {
+            const u32 queue_index = (first_queue_index + i) % job_system.queue_count;
+
+            if (has_own_queue && queue_index == context.queue_index)
+                continue;
+
+            if (Job* job = job_queue_steal(job_system.queues[queue_index]))
+                return job;
+        }
+
+        return nullptr;
+    }
+
+    void update_runnable_background_job(JobSystem& job_system)
+    {
+        const bool has_runnable_background_job =
+            !job_system.background_queue.empty()
+            && job_system.running_background_job_count.load(std::memory_order_relaxed)
+                   < job_system.max_running_background_job_count;
+
+        job_system.has_runnable_background_job.store(has_runnable_background_job, std::memory_order_release);
+    }
+
+    Job* find_background_job(JobSystem& job_system)
+    {
+        if (!job_system.has_runnable_background_job.load(std::memory_order_acquire))
+            return nullptr;
+
+        std::lock_guard<std::mutex> lock(job_system.background_queue_mutex);
+
+        if (job_system.background_queue.empty()
+            || job_system.running_background_job_count.load(std::memory_order_relaxed)
+                   >= job_system.max_running_background_job_count)
+        {
+            return nullptr;
+        }
+
+        Job* job = job_system.background_queue.front();
+        job_system.background_queue.pop_front();
+
+        job_system.running_background_job_count.fetch_add(1, std::memory_order_relaxed);
+
+        update_runnable_background_job(job_system);
+
+        return job;
+    }
+
+    Job* find_job(JobSystem& job_system)
+    {
+        Job* job = nullptr;
+
+        if (JobQueue* queue = get_thread_queue(job_system))
+            job = job_queue_pop(*queue);
+
+        if (job == nullptr)
+            job = steal_job(job_system);
+
+        if (job != nullptr)
+            job_system.queued_job_count.fetch_sub(1, std::memory_order_relaxed);
+
+        return job;
+    }
+
+    void execute_job(JobSystem& job_system, Job& job);
+
+    // Returns false when the job had to run inline instead
+    bool push_job(JobSystem& job_system, Job& job)
+    {
+        if (job_system.worker_threads.empty())
+        {
+            execute_job(job_system, job);
+            return false;
+        }
+
+        if (JobQueue* queue = get_thread_queue(job_system))
+        {
+            if (!job_queue_push(*queue, &job))
+            {
+                execute_job(job_system, job);
+                return false;
+            }
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(job_system.shared_queue_mutex);
+
+            job_system.shared_queue.push_back(&job);
+            job_system.shared_queue_empty.store(false, std::memory_order_release);
+        }
+
+        job_system.queued_job_count.fetch_add(1, std::memory_order_relaxed);
+
+        return true;
+    }
+
+    void run_job_function(Job& job)
+    {
+        REAPER_JOB_PROFILE_SCOPE("Job");
+
+        job.function(job.user_data, job.job_index);
+    }
+
+    // Has to come last, whoever waits on the counter can tear everything down right after
+    void release_job_counter(JobSystem& job_system, Job& job)
+    {
+        JobCounter& counter = *job.counter;
+
+        // Read before the decrement, the counter can go out of scope right after
+        Job* continuation = counter.continuation;
+
+        if (counter.pending_job_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            if (continuation != nullptr)
+                push_job(job_system, *continuation);
+
+            // Waiters on the counter, and threads that could pick up the continuation
+            wake_up_threads(job_system);
+        }
+    }
+
+    void execute_job(JobSystem& job_system, Job& job)
+    {
+        run_job_function(job);
+        release_job_counter(job_system, job);
+    }
+
+    void worker_thread_main(JobSystem& job_system, u32 queue_index)
+    {
+        tls_thread_context = ThreadContext{
+            .job_system = &job_system,
+            .queue_index = queue_index,
+            .steal_seed = queue_index,
+        };
+
+        std::array<char, 32> thread_name;
+        std::snprintf(thread_name.data(), thread_name.size(), "Job worker %u", queue_index - 1);
+        REAPER_JOB_SET_THREAD_NAME(thread_name.data());
+
+        const auto has_work = [&] {
+            return job_system.queued_job_count.load(std::memory_order_relaxed) > 0
+                   || job_system.has_runnable_background_job.load(std::memory_order_acquire);
+        };
+
+        while (true)
+        {
+            if (Job* job = find_job(job_system))
+            {
+                execute_job(job_system, *job);
+                continue;
+            }
+
+            if (Job* job = find_background_job(job_system))
+            {
+                run_job_function(*job);
+
+                // Before the counter gets released, so the job system looks idle to its waiters
+                {
+                    std::lock_guard<std::mutex> lock(job_system.background_queue_mutex);
+
+                    job_system.running_background_job_count.fetch_sub(1, std::memory_order_relaxed);
+
+                    update_runnable_background_job(job_system);
+                }
+
+                release_job_counter(job_system, *job);
+
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(job_system.mutex);
+
+            if (job_system.stop_requested)
+                break;
+
+            if (has_work())
+            {
+                // Lost a race for the job, it's not worth sleeping
+                lock.unlock();
+                std::this_thread::yield();
+                continue;
+            }
+
+            job_system.wake_up.wait(lock, [&] { return job_system.stop_requested || has_work(); });
+        }
+
+        tls_thread_context = {};
+    }
+
+    struct ParallelForRange
+    {
+        JobFunction job_function;
+        void*       user_data;
+        u32         job_count;
+        u32         grain_size;
+    };
+
+    void execute_parallel_for_chunk(void* user_data, u32 chunk_index)
+    {
+        const ParallelForRange& range = *static_cast<const ParallelForRange*>(user_data);
+
+        const u32 first_job_index = chunk_index * range.grain_size;
+        const u32 end_job_index = std::min(first_job_index + range.grain_size, range.job_count);
+
+        for (u32 job_index = first_job_index; job_index < end_job_index; job_index++)
+            range.job_function(range.user_data, job_index);
+    }
+} // namespace
+
+JobSystem* create_job_system(u32 worker_thread_count)
+{
+    JobSystem* job_system = new JobSystem();
+
+    job_system->queue_count = worker_thread_count + 1;
+    job_system->queues = std::make_unique<JobQueue[]>(job_system->queue_count);
+    job_system->shared_queue_empty = true;
+    job_system->queued_job_count = 0;
+    job_system->running_background_job_count = 0;
+    job_system->has_runnable_background_job = false;
+    job_system->max_running_background_job_count = std::max(worker_thread_count / 2, 1u);
+    job_system->stop_requested = false;
+
+    // The creating thread owns the first queue
+    tls_thread_context = ThreadContext{
+        .job_system = job_system,
+        .queue_index = 0,
+        .steal_seed = 0,
+    };
+
+    job_system->worker_threads.reserve(worker_thread_count);
+
+    for (u32 i = 0; i < worker_thread_count; i++)
+        job_system->worker_threads.emplace_back(worker_thread_main, std::ref(*job_system), i + 1);
+
+    return job_system;
+}
+
+void destroy_job_system(JobSystem* job_system)
+{
+    Assert(job_system->queued_job_count == 0, "Destroying the job system while jobs are running");
+    Assert(job_system->background_queue.empty() && job_system->running_background_job_count == 0,
+           "Destroying the job system while background jobs are running");
+
+    {
+        std::lock_guard<std::mutex> lock(job_system->mutex);
+        job_system->stop_requested = true;
+    }
+
+    job_system->wake_up.notify_all();
+
+    for (std::thread& worker_thread : job_system->worker_threads)
+        worker_thread.join();
+
+    if (tls_thread_context.job_system == job_system)
+        tls_thread_context = {};
+
+    delete job_system;
+}
+
+u32 get_worker_thread_count(const JobSystem& job_system)
+{
+    return static_cast<u32>(job_system.worker_threads.size());
+}
+
+u32 get_current_thread_index(const JobSystem& job_system)
+{
+    Assert(tls_thread_context.job_system == &job_system, "Thread doesn't belong to the job system");
+
+    return tls_thread_context.queue_index;
+}
+
+void submit_jobs(JobSystem& job_system, std::span<Job> jobs, JobCounter& counter)
+{
+    if (jobs.empty())
+        return;
+
+    // Account for every job upfront, the first ones might be done before we're through the list
+    counter.pending_job_count.fetch_add(static_cast<u32>(jobs.size()), std::memory_order_relaxed);
+
+    bool has_pushed_jobs = false;
+
+    for (Job& job : jobs)
+    {
+        job.counter = &counter;
+
+        has_pushed_jobs |= push_job(job_system, job);
+    }
+
+    if (has_pushed_jobs)
+        wake_up_threads(job_system);
+}
+
+void submit_background_jobs(JobSystem& job_system, std::span<Job> jobs, JobCounter& counter)
+{
+    if (jobs.empty())
+        return;
+
+    Assert(counter.continuation == nullptr, "Background jobs can't have a continuation");
+
+    counter.pending_job_count.fetch_add(static_cast<u32>(jobs.size()), std::memory_order_relaxed);
+
+    // Nobody else would ever pick them up
+    if (job_system.worker_threads.empty())
+    {
+        for (Job& job : jobs)
+        {
+            job.counter = &counter;
+
+            execute_job(job_system, job);
+        }
+
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(job_system.background_queue_mutex);
+
+        for (Job& job : jobs)
+        {
+            job.counter = &counter;
+
+            job_system.background_queue.push_back(&job);
+        }
+
+        update_runnable_background_job(job_system);
+    }
+
+    wake_up_threads(job_system);
+}
+
+void set_job_continuation(JobCounter& counter, Job& continuation, JobCounter& continuation_counter)
+{
+    Assert(counter.pending_job_count.load(std::memory_order_relaxed) == 0, "Jobs were already submitted");
+    Assert(counter.continuation == nullptr);
+
+    continuation.counter = &continuation_counter;
+    continuation_counter.pending_job_count.fetch_add(1, std::memory_order_relaxed);
+
+    counter.continuation = &continuation;
+}
+
+void wait_for_counter(JobSystem& job_system, JobCounter& counter)
+{
+    REAPER_JOB_PROFILE_SCOPE("Wait for jobs");
+
+    while (counter.pending_job_count.load(std::memory_order_acquire) != 0)
+    {
+        // Help out instead of sleeping
+        if (Job* job = find_job(job_system))
+        {
+            execute_job(job_system, *job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(job_system.mutex);
+
+        if (job_system.queued_job_count.load(std::memory_order_relaxed) > 0)
+        {
+            lock.unlock();
+            std::this_thread::yield();
+            continue;
+        }
+
+        job_system.wake_up.wait(lock, [&] {
+            return job_system.queued_job_count.load(std::memory_order_relaxed) > 0
+                   || counter.pending_job_count.load(std::memory_order_acquire) == 0;
+        });
+    }
+}
+
+void parallel_for(JobSystem& job_system, u32 job_count, JobFunction job_function, void* user_data, u32 grain_size)
+{
+    Assert(grain_size > 0);
+
+    if (job_count == 0)
+        return;
+
+    REAPER_JOB_PROFILE_SCOPE("parallel_for");
+
+    // Not worth going through the scheduler
+    if (job_count <= grain_size || job_system.worker_threads.empty())
+    {
+        for (u32 job_index = 0; job_index < job_count; job_index++)
+            job_function(user_data, job_index);
+
+        return;
+    }
+
+    // Coarser chunks for large ranges, that way they always fit in a queue
+    grain_size = std::max(grain_size, (job_count + ParallelForMaxChunkCount - 1) / ParallelForMaxChunkCount);
+
+    ParallelForRange range = {
+        .job_function = job_function,
+        .user_data = user_data,
+        .job_count = job_count,
+        .grain_size = grain_size,
+    };
+
+    const u32        chunk_count = (job_count + grain_size - 1) / grain_size;
+    std::vector<Job> jobs(chunk_count);
+
+    for (u32 chunk_index = 0; chunk_index < chunk_count; chunk_index++)
+    {
+        jobs[chunk_index] = Job{
+            .function = execute_parallel_for_chunk,
+            .user_data = &range,
+            .job_index = chunk_index,
+            .counter = nullptr,
+        };
+    }
+
+    JobCounter counter;
+
+    submit_jobs(job_system, jobs, counter);
+    wait_for_counter(job_system, counter);
+}
+} // namespace Reaper
@@ -0,0 +1,103 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "core/CoreExport.h"
+#include "core/Types.h"
+
+#include <atomic>
+#include <span>
+#include <type_traits>
+
+namespace Reaper
+{
+// Work-stealing scheduler over a fixed pool of worker threads.
+// Every worker owns a deque of jobs, it pushes and pops at one end while idle threads steal from the other end.
+// The thread that creates the job system gets a deque too, jobs submitted from any other thread go through a shared
+// queue.
+// Waiting never blocks a thread that could run jobs: waiters execute pending jobs until their counter reaches zero,
+// so jobs are free to submit and wait on more jobs.
+// A job system without workers runs every job inline in submission order, which makes it deterministic.
+struct JobSystem;
+
+using JobFunction = void (*)(void* user_data, u32 job_index);
+
+struct JobCounter;
+
+// The storage is owned by the caller and has to stay valid until the counter it was submitted with reaches zero.
+struct Job
+{
+    JobFunction function;
+    void*       user_data;
+    u32         job_index;
+    JobCounter* counter; // Filled in on submission
+};
+
+// Number of jobs submitted against it that haven't finished yet.
+// The continuation, if any, gets submitted by whichever thread finishes the last job.
+struct JobCounter
+{
+    std::atomic<u32> pending_job_count = 0;
+    Job*             continuation = nullptr;
+};
+
+REAPER_CORE_API JobSystem* create_job_system(u32 worker_thread_count);
+REAPER_CORE_API void       destroy_job_system(JobSystem* job_system);
+
+REAPER_CORE_API u32 get_worker_thread_count(const JobSystem& job_system);
+
+// Index of the calling thread in [0, worker_thread_count], 0 being the thread that created the job system.
+// Jobs can use it to pick resources that can't be shared between threads.
+REAPER_CORE_API u32 get_current_thread_index(const JobSystem& job_system);
+
+REAPER_CORE_API void submit_jobs(JobSystem& job_system, std::span<Job> jobs, JobCounter& counter);
+
+// Low priority jobs for work that can take several frames, like compiling pipelines.
+// They only run on idle workers, never on a thread waiting for a counter, and at most on half the workers at once, so
+// the rest of the pool stays available to the frame.
+// A job system without workers runs them inline before returning.
+// The counter can't have a continuation.
+REAPER_CORE_API void submit_background_jobs(JobSystem& job_system, std::span<Job> jobs, JobCounter& counter);
+
+// Schedules continuation once every job submitted against counter is done, continuation_counter tracks it.
+// This has to happen before the first job gets submitted against counter.
+REAPER_CORE_API void set_job_continuation(JobCounter& counter, Job& continuation, JobCounter& continuation_counter);
+
+// Executes pending jobs until the counter reaches zero, and only sleeps when there's nothing left to run.
+REAPER_CORE_API void wait_for_counter(JobSystem& job_system, JobCounter& counter);
+
+// Calls job_function once for every index in [0, job_count) and returns once they are all done.
+// Jobs can run in any order and on any thread, they should only write to memory they own.
+// Indices are scheduled in chunks of at least grain_size, raise it when a single index is too cheap to be worth a
+// trip through the scheduler.
+REAPER_CORE_API void parallel_for(JobSystem& job_system, u32 job_count, JobFunction job_function, void* user_data,
+                                  u32 grain_size = 1);
+
+// Convenience overload for lambdas, function is called as function(job_index).
+template <typename Function>
+void parallel_for(JobSystem& job_system, u32 job_count, Function function, u32 grain_size = 1)
+{
+    static_assert(std::is_invocable_v<Function&, u32>);
+
+    parallel_for(
+        job_system, job_count,
+        [](void* user_data, u32 job_index) { (*static_cast<Function*>(user_data))(job_index); }, &function,
+        grain_size);
+}
+
+// Calls function(item) for every element of items.
+template <typename T, typename Function>
+void parallel_for_each(JobSystem& job_system, std::span<T> items, Function function, u32 grain_size = 1)
+{
+    static_assert(std::is_invocable_v<Function&, T&>);
+
+    parallel_for(
+        job_system, static_cast<u32>(items.size()), [items, &function](u32 index) { function(items[index]); },
+        grain_size);
+}
+} // namespace Reaper
@@ -0,0 +1,133 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include "RangeAllocator.h"
+
+#include "core/Assert.h"
+
+namespace Reaper
+{
+namespace
+{
+    void insert_free_range(RangeAllocator& allocator, u32 offset, u32 size)
+    {
+        allocator.free_ranges_by_offset.emplace(offset, size);
+        allocator.free_ranges_by_size.emplace(size, offset);
+    }
+
+    void erase_free_range(RangeAllocator& allocator, std::map<u32, u32>::iterator it)
+    {
+        allocator.free_ranges_by_size.erase({it->second, it->first});
+        allocator.free_ranges_by_offset.erase(it);
+    }
+
+    // Carves size units at the start of the free range, the remainder stays free.
+    u32 allocate_from_free_range(RangeAllocator& allocator, std::map<u32, u32>::iterator it, u32 size)
+    {
+        const u32 offset = it->first;
+        const u32 free_size = it->second;
+
+        Assert(free_size >= size);
+
+        erase_free_range(allocator, it);
+
+        if (free_size > size)
+            insert_free_range(allocator, offset + size, free_size - size);
+
+        allocator.used += size;
+
+        return offset;
+    }
+} // namespace
+
+RangeAllocator create_range_allocator(u32 capacity)
+{
+    Assert(capacity > 0);
+
+    RangeAllocator allocator = {
+        .capacity = capacity,
+        .used = 0,
+        .free_ranges_by_offset = {},
+        .free_ranges_by_size = {},
+    };
+
+    insert_free_range(allocator, 0, capacity);
+
+    return allocator;
+}
+
+u32 range_allocate(RangeAllocator& allocator, u32 size)
+{
+    Assert(size > 0);
+
+    // Smallest free range that fits, ties go to the lowest offset
+    const auto best_fit = allocator.free_ranges_by_size.lower_bound({size, 0});
+
+    if (best_fit == allocator.free_ranges_by_size.end())
+        return InvalidRangeOffset;
+
+    return allocate_from_free_range(allocator, allocator.free_ranges_by_offset.find(best_fit->second), size);
+}
+
+u32 range_allocate_lowest(RangeAllocator& allocator, u32 size, u32 max_offset)
+{
+    Assert(size > 0);
+
+    for (auto it = allocator.free_ranges_by_offset.begin();
+         it != allocator.free_ranges_by_offset.end() && it->first < max_offset; ++it)
+    {
+        if (it->second >= size)
+            return allocate_from_free_range(allocator, it, size);
+    }
+
+    return InvalidRangeOffset;
+}
+
+void range_free(RangeAllocator& allocator, u32 offset, u32 size)
+{
+    Assert(size > 0);
+    Assert(offset + size <= allocator.capacity);
+    Assert(allocator.used >= size);
+
+    allocator.used -= size;
+
+    auto next = allocator.free_ranges_by_offset.lower_bound(offset);
+
+    Assert(next == allocator.free_ranges_by_offset.end() || offset + size <= next->first, "double free");
+
+    // Merge with the free neighbours
+    if (next != allocator.free_ranges_by_offset.end() && offset + size == next->first)
+    {
+        size += next->second;
+        erase_free_range(allocator, next++);
+    }
+
+    if (next != allocator.free_ranges_by_offset.begin())
+    {
+        auto previous = std::prev(next);
+
+        Assert(previous->first + previous->second <= offset, "double free");
+
+        if (previous->first + previous->second == offset)
+        {
+            offset = previous->first;
+            size += previous->second;
+            erase_free_range(allocator, previous);
+        }
+    }
+
+    insert_free_range(allocator, offset, size);
+}
+
+u32 range_largest_free_size(const RangeAllocator& allocator)
+{
+    if (allocator.free_ranges_by_size.empty())
+        return 0;
+
+    return allocator.free_ranges_by_size.rbegin()->first;
+}
+} // namespace Reaper
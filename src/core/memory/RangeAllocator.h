@@ -0,0 +1,45 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "core/CoreExport.h"
+#include "core/Types.h"
+
+#include <map>
+#include <set>
+#include <utility>
+
+namespace Reaper
+{
+// Free-list allocator handing out ranges of [0, capacity), units are up to the user (bytes, elements...).
+// It doesn't own any memory, which makes it useful to sub-allocate GPU buffers.
+// Allocation is best-fit and freed ranges are merged with their free neighbours.
+struct RangeAllocator
+{
+    u32 capacity;
+    u32 used;
+
+    std::map<u32, u32>            free_ranges_by_offset; // offset -> size
+    std::set<std::pair<u32, u32>> free_ranges_by_size;   // (size, offset)
+};
+
+static constexpr u32 InvalidRangeOffset = static_cast<u32>(-1);
+
+REAPER_CORE_API RangeAllocator create_range_allocator(u32 capacity);
+
+// Returns InvalidRangeOffset when no free range is big enough.
+REAPER_CORE_API u32 range_allocate(RangeAllocator& allocator, u32 size);
+
+// Takes the free range with the lowest offset that fits, as long as it starts before max_offset.
+// Moving allocations there is how users can compact the allocator.
+REAPER_CORE_API u32 range_allocate_lowest(RangeAllocator& allocator, u32 size, u32 max_offset);
+
+REAPER_CORE_API void range_free(RangeAllocator& allocator, u32 offset, u32 size);
+
+REAPER_CORE_API u32 range_largest_free_size(const RangeAllocator& allocator);
+} // namespace Reaper
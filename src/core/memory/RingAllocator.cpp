@@ -0,0 +1,91 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include "RingAllocator.h"
+
+#include "core/Assert.h"
+#include "core/BitTricks.h"
+
+namespace Reaper
+{
+RingAllocator create_ring_allocator(u64 size_bytes)
+{
+    Assert(size_bytes > 0);
+
+    return RingAllocator{
+        .size_bytes = size_bytes,
+        .head_bytes = 0,
+        .tail_bytes = 0,
+        .closed_head_bytes = 0,
+        .pending_batches = {},
+    };
+}
+
+u64 ring_allocate(RingAllocator& allocator, u64 size_bytes, u64 alignment)
+{
+    Assert(size_bytes > 0);
+    Assert(size_bytes <= allocator.size_bytes, "allocation doesn't fit in the ring");
+    Assert(isPowerOfTwo(alignment));
+    Assert(allocator.size_bytes % alignment == 0, "wrapping would break the alignment");
+
+    u64 head_bytes = (allocator.head_bytes + alignment - 1) & ~(alignment - 1);
+    u64 offset_bytes = head_bytes % allocator.size_bytes;
+
+    if (offset_bytes + size_bytes > allocator.size_bytes)
+    {
+        head_bytes += allocator.size_bytes - offset_bytes;
+        offset_bytes = 0;
+    }
+
+    // Nothing is in use, the skipped bytes don't need to wait for any batch.
+    const bool is_empty = allocator.head_bytes == allocator.tail_bytes;
+    const u64  tail_bytes = is_empty ? head_bytes : allocator.tail_bytes;
+
+    if (head_bytes + size_bytes - tail_bytes > allocator.size_bytes)
+        return InvalidRingOffset;
+
+    allocator.head_bytes = head_bytes + size_bytes;
+    allocator.tail_bytes = tail_bytes;
+
+    return offset_bytes;
+}
+
+void ring_close_batch(RingAllocator& allocator, u64 fence_value)
+{
+    if (!ring_has_open_batch(allocator))
+        return;
+
+    Assert(allocator.pending_batches.empty() || allocator.pending_batches.back().fence_value < fence_value,
+           "fence values should keep increasing");
+
+    allocator.pending_batches.push_back(RingAllocatorBatch{
+        .end_bytes = allocator.head_bytes,
+        .fence_value = fence_value,
+    });
+
+    allocator.closed_head_bytes = allocator.head_bytes;
+}
+
+void ring_release(RingAllocator& allocator, u64 completed_fence_value)
+{
+    while (!allocator.pending_batches.empty() && allocator.pending_batches.front().fence_value <= completed_fence_value)
+    {
+        allocator.tail_bytes = allocator.pending_batches.front().end_bytes;
+        allocator.pending_batches.pop_front();
+    }
+}
+
+bool ring_has_open_batch(const RingAllocator& allocator)
+{
+    return allocator.head_bytes != allocator.closed_head_bytes;
+}
+
+u64 ring_used_bytes(const RingAllocator& allocator)
+{
+    return allocator.head_bytes - allocator.tail_bytes;
+}
+} // namespace Reaper
@@ -0,0 +1,54 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "core/CoreExport.h"
+#include "core/Types.h"
+
+#include <deque>
+
+namespace Reaper
+{
+// Hands out offsets in a circular range of memory the allocator doesn't own, like a GPU staging buffer.
+// Allocations are grouped in batches tagged with a fence value (e.g. a timeline semaphore value). A batch is
+// reclaimed in one go once the owner reports that its fence value was reached.
+struct RingAllocatorBatch
+{
+    u64 end_bytes;
+    u64 fence_value;
+};
+
+struct RingAllocator
+{
+    u64 size_bytes;
+
+    // These keep increasing, wrap them with the size to get an actual offset.
+    u64 head_bytes;
+    u64 tail_bytes;
+    u64 closed_head_bytes; // End of the last closed batch
+
+    std::deque<RingAllocatorBatch> pending_batches;
+};
+
+static constexpr u64 InvalidRingOffset = static_cast<u64>(-1);
+
+REAPER_CORE_API RingAllocator create_ring_allocator(u64 size_bytes);
+
+// Allocations never straddle the end of the range, the remaining bytes are skipped instead.
+// Returns InvalidRingOffset when there isn't enough free space left, releasing older batches might help.
+REAPER_CORE_API u64 ring_allocate(RingAllocator& allocator, u64 size_bytes, u64 alignment);
+
+// Every allocation made since the last call will be released once fence_value is reached.
+// Fence values have to increase with every call.
+REAPER_CORE_API void ring_close_batch(RingAllocator& allocator, u64 fence_value);
+
+REAPER_CORE_API void ring_release(RingAllocator& allocator, u64 completed_fence_value);
+
+REAPER_CORE_API bool ring_has_open_batch(const RingAllocator& allocator);
+REAPER_CORE_API u64  ring_used_bytes(const RingAllocator& allocator);
+} // namespace Reaper
@@ -0,0 +1,67 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include <doctest/doctest.h>
+
+#include "core/Platform.h"
+#include "core/fs/FileWatcher.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+using namespace Reaper;
+
+#if defined(REAPER_PLATFORM_LINUX)
+TEST_CASE("File watcher")
+{
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "reaper_file_watcher_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory / "subdirectory");
+
+    FileWatcher* file_watcher = create_file_watcher();
+
+    REQUIRE(add_file_watch_directory(*file_watcher, directory.string()));
+    CHECK_FALSE(add_file_watch_directory(*file_watcher, (directory / "missing").string()));
+
+    std::vector<std::string> file_paths;
+
+    poll_file_watcher(*file_watcher, file_paths);
+    CHECK(file_paths.empty());
+
+    SUBCASE("Write")
+    {
+        std::ofstream(directory / "shader.comp.spv") << "spirv";
+        std::ofstream(directory / "subdirectory" / "ignored.spv") << "spirv";
+
+        poll_file_watcher(*file_watcher, file_paths);
+
+        REQUIRE_EQ(file_paths.size(), 1);
+        CHECK_EQ(file_paths[0], (directory / "shader.comp.spv").string());
+
+        // Events are only reported once
+        file_paths.clear();
+        poll_file_watcher(*file_watcher, file_paths);
+        CHECK(file_paths.empty());
+    }
+
+    SUBCASE("Rename")
+    {
+        std::ofstream(directory / "subdirectory" / "shader.frag.spv") << "spirv";
+        std::filesystem::rename(directory / "subdirectory" / "shader.frag.spv", directory / "shader.frag.spv");
+
+        poll_file_watcher(*file_watcher, file_paths);
+
+        CHECK(std::find(file_paths.begin(), file_paths.end(), (directory / "shader.frag.spv").string())
+              != file_paths.end());
+    }
+
+    destroy_file_watcher(file_watcher);
+
+    std::filesystem::remove_all(directory);
+}
+#endif
@@ -0,0 +1,337 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include <doctest/doctest.h>
+
+#include "core/jobs/JobSystem.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+using namespace Reaper;
+
+TEST_CASE("Job system")
+{
+    const u32 worker_thread_counts[] = {0, 1, 3};
+
+    for (u32 worker_thread_count : worker_thread_counts)
+    {
+        JobSystem* job_system = create_job_system(worker_thread_count);
+
+        CHECK_EQ(get_worker_thread_count(*job_system), worker_thread_count);
+        CHECK_EQ(get_current_thread_index(*job_system), 0);
+
+        // Every job runs exactly once
+        const u32        job_count = 1000;
+        const u32        batch_count = 16;
+        std::vector<u32> run_counts(job_count, 0);
+        std::atomic<u32> total_run_count = 0;
+
+        // Run a few batches in a row to catch workers holding on to an old one
+        for (u32 batch_index = 0; batch_index < batch_count; batch_index++)
+        {
+            parallel_for(*job_system, job_count, [&](u32 job_index) {
+                CHECK_LE(get_current_thread_index(*job_system), worker_thread_count);
+
+                run_counts[job_index] += 1;
+                total_run_count.fetch_add(1, std::memory_order_relaxed);
+            });
+        }
+
+        CHECK_EQ(total_run_count.load(), job_count * batch_count);
+
+        for (u32 run_count : run_counts)
+            CHECK_EQ(run_count, batch_count);
+
+        // Empty batch
+        bool was_called = false;
+
+        parallel_for(*job_system, 0, [&](u32) { was_called = true; });
+
+        CHECK_FALSE(was_called);
+
+        destroy_job_system(job_system);
+    }
+}
+
+TEST_CASE("Job system nested parallel_for")
+{
+    JobSystem* job_system = create_job_system(3);
+
+    const u32        outer_count = 8;
+    const u32        inner_count = 500;
+    std::vector<u32> sums(outer_count, 0);
+
+    // Waiting from inside a job runs other jobs instead of blocking a worker
+    parallel_for(*job_system, outer_count, [&](u32 outer_index) {
+        std::atomic<u32> sum = 0;
+
+        parallel_for(*job_system, inner_count, [&](u32 inner_index) { sum.fetch_add(inner_index); }, 16);
+
+        sums[outer_index] = sum.load();
+    });
+
+    for (u32 sum : sums)
+        CHECK_EQ(sum, inner_count * (inner_count - 1) / 2);
+
+    destroy_job_system(job_system);
+}
+
+TEST_CASE("Job system grain size")
+{
+    const u32 worker_thread_counts[] = {0, 3};
+
+    for (u32 worker_thread_count : worker_thread_counts)
+    {
+        JobSystem* job_system = create_job_system(worker_thread_count);
+
+        const u32 grain_sizes[] = {1, 7, 64, 5000, 100000};
+
+        for (u32 grain_size : grain_sizes)
+        {
+            std::vector<u32> values(10000, 0);
+
+            parallel_for_each(*job_system, std::span(values), [](u32& value) { value += 1; }, grain_size);
+
+            for (u32 value : values)
+                CHECK_EQ(value, 1);
+        }
+
+        destroy_job_system(job_system);
+    }
+}
+
+namespace
+{
+    struct ContinuationTest
+    {
+        std::atomic<u32> first_done_count;
+        u32              first_done_count_seen_by_continuation;
+        std::vector<u32> order;
+        std::mutex       order_mutex;
+    };
+
+    void first_job(void* user_data, u32 job_index)
+    {
+        ContinuationTest& test = *static_cast<ContinuationTest*>(user_data);
+
+        {
+            std::lock_guard<std::mutex> lock(test.order_mutex);
+            test.order.push_back(job_index);
+        }
+
+        test.first_done_count.fetch_add(1);
+    }
+
+    void continuation_job(void* user_data, u32 job_index)
+    {
+        ContinuationTest& test = *static_cast<ContinuationTest*>(user_data);
+
+        test.first_done_count_seen_by_continuation = test.first_done_count.load();
+
+        std::lock_guard<std::mutex> lock(test.order_mutex);
+        test.order.push_back(job_index);
+    }
+} // namespace
+
+TEST_CASE("Job system continuation")
+{
+    const u32 worker_thread_counts[] = {0, 1, 3};
+
+    for (u32 worker_thread_count : worker_thread_counts)
+    {
+        JobSystem* job_system = create_job_system(worker_thread_count);
+
+        const u32 first_job_count = 64;
+        const u32 continuation_index = 1000;
+
+        ContinuationTest test = {};
+
+        std::vector<Job> jobs(first_job_count);
+        for (u32 i = 0; i < first_job_count; i++)
+            jobs[i] = Job{.function = first_job, .user_data = &test, .job_index = i, .counter = nullptr};
+
+        Job continuation = {
+            .function = continuation_job, .user_data = &test, .job_index = continuation_index, .counter = nullptr};
+
+        JobCounter first_counter;
+        JobCounter continuation_counter;
+
+        set_job_continuation(first_counter, continuation, continuation_counter);
+        submit_jobs(*job_system, jobs, first_counter);
+
+        // Only wait on the last link of the chain
+        wait_for_counter(*job_system, continuation_counter);
+
+        CHECK_EQ(test.first_done_count_seen_by_continuation, first_job_count);
+        REQUIRE_EQ(test.order.size(), first_job_count + 1);
+        CHECK_EQ(test.order.back(), continuation_index);
+
+        // Without workers everything runs in submission order
+        if (worker_thread_count == 0)
+        {
+            for (u32 i = 0; i < first_job_count; i++)
+                CHECK_EQ(test.order[i], i);
+        }
+
+        destroy_job_system(job_system);
+    }
+}
+
+TEST_CASE("Job system throughput")
+{
+    JobSystem* job_system = create_job_system(3);
+
+    // Lots of tiny jobs, from the owner thread and from a thread without a queue of its own
+    const u32 job_count = 200000;
+
+    std::atomic<u64> sum = 0;
+
+    const auto add_indices = [&] {
+        parallel_for(*job_system, job_count,
+                     [&](u32 job_index) { sum.fetch_add(job_index, std::memory_order_relaxed); });
+    };
+
+    std::thread external_thread(add_indices);
+    add_indices();
+    external_thread.join();
+
+    CHECK_EQ(sum.load(), 2 * (static_cast<u64>(job_count) * (job_count - 1) / 2));
+
+    destroy_job_system(job_system);
+}
+
+TEST_CASE("Job system fairness")
+{
+    const u32  worker_thread_count = 3;
+    JobSystem* job_system = create_job_system(worker_thread_count);
+
+    // One job per thread, each one blocks until all of them are running.
+    // This only finishes if idle workers steal everything that's queued.
+    const u32        job_count = worker_thread_count + 1;
+    std::atomic<u32> running_count = 0;
+    std::atomic<u32> timeout_count = 0;
+
+    parallel_for(*job_system, job_count, [&](u32) {
+        running_count.fetch_add(1);
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+
+        while (running_count.load() < job_count)
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+            {
+                timeout_count.fetch_add(1);
+                break;
+            }
+
+            std::this_thread::yield();
+        }
+    });
+
+    CHECK_EQ(timeout_count.load(), 0);
+
+    destroy_job_system(job_system);
+}
+
+namespace
+{
+    struct BackgroundTest
+    {
+        JobSystem*        job_system;
+        std::atomic<u32>  run_count;
+        std::atomic<u32>  running_count;
+        std::atomic<u32>  max_running_count;
+        std::atomic<u32>  run_on_owner_thread_count;
+        std::atomic<bool> released;
+    };
+
+    void background_job(void* user_data, u32)
+    {
+        BackgroundTest& test = *static_cast<BackgroundTest*>(user_data);
+
+        if (get_current_thread_index(*test.job_system) == 0)
+            test.run_on_owner_thread_count.fetch_add(1);
+
+        const u32 running_count = test.running_count.fetch_add(1) + 1;
+
+        u32 max_running_count = test.max_running_count.load();
+        while (running_count > max_running_count
+               && !test.max_running_count.compare_exchange_weak(max_running_count, running_count))
+        {
+        }
+
+        // Stands in for a pipeline compile that outlives the frame
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+
+        while (!test.released.load() && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::yield();
+
+        test.running_count.fetch_sub(1);
+        test.run_count.fetch_add(1);
+    }
+} // namespace
+
+TEST_CASE("Job system background jobs")
+{
+    const u32 worker_thread_counts[] = {0, 4};
+
+    for (u32 worker_thread_count : worker_thread_counts)
+    {
+        JobSystem* job_system = create_job_system(worker_thread_count);
+
+        BackgroundTest test = {};
+        test.job_system = job_system;
+        test.released = worker_thread_count == 0; // Nobody could release them
+
+        const u32        background_job_count = 8;
+        std::vector<Job> jobs(background_job_count);
+
+        for (u32 i = 0; i < background_job_count; i++)
+            jobs[i] = Job{.function = background_job, .user_data = &test, .job_index = i, .counter = nullptr};
+
+        JobCounter background_counter;
+
+        submit_background_jobs(*job_system, jobs, background_counter);
+
+        if (worker_thread_count == 0)
+        {
+            // Ran inline
+            CHECK_EQ(background_counter.pending_job_count.load(), 0);
+            CHECK_EQ(test.run_count.load(), background_job_count);
+        }
+        else
+        {
+            // Frame work still goes through while the background jobs hold on to their workers, and the waiting
+            // thread doesn't pick them up
+            for (u32 batch_index = 0; batch_index < 16; batch_index++)
+            {
+                std::atomic<u32> sum = 0;
+
+                parallel_for(*job_system, 1000, [&](u32 job_index) { sum.fetch_add(job_index); });
+
+                CHECK_EQ(sum.load(), 1000 * 999 / 2);
+            }
+
+            CHECK_EQ(test.run_on_owner_thread_count.load(), 0);
+            CHECK_LE(test.max_running_count.load(), worker_thread_count / 2);
+
+            test.released = true;
+
+            wait_for_counter(*job_system, background_counter);
+
+            CHECK_EQ(test.run_count.load(), background_job_count);
+            CHECK_EQ(test.run_on_owner_thread_count.load(), 0);
+        }
+
+        destroy_job_system(job_system);
+    }
+}
@@ -0,0 +1,134 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include <doctest/doctest.h>
+
+#include "core/memory/RangeAllocator.h"
+
+#include <random>
+#include <vector>
+
+using namespace Reaper;
+
+TEST_CASE("Range allocator")
+{
+    RangeAllocator ator = create_range_allocator(100);
+
+    SUBCASE("Alloc and free")
+    {
+        CHECK_EQ(range_allocate(ator, 10), 0);
+        CHECK_EQ(range_allocate(ator, 20), 10);
+        CHECK_EQ(ator.used, 30);
+
+        range_free(ator, 0, 10);
+        range_free(ator, 10, 20);
+
+        CHECK_EQ(ator.used, 0);
+        CHECK_EQ(range_largest_free_size(ator), 100);
+        CHECK_EQ(ator.free_ranges_by_offset.size(), 1);
+    }
+
+    SUBCASE("Out of space")
+    {
+        CHECK_EQ(range_allocate(ator, 100), 0);
+        CHECK_EQ(range_allocate(ator, 1), InvalidRangeOffset);
+    }
+
+    SUBCASE("Best fit")
+    {
+        const u32 a = range_allocate(ator, 30);
+        const u32 b = range_allocate(ator, 10);
+        const u32 c = range_allocate(ator, 20);
+        const u32 d = range_allocate(ator, 10);
+
+        range_free(ator, a, 30);
+        range_free(ator, c, 20);
+
+        // Both holes fit, the smallest one is picked
+        CHECK_EQ(range_allocate(ator, 15), c);
+        CHECK_EQ(range_allocate(ator, 25), a);
+
+        static_cast<void>(b);
+        static_cast<void>(d);
+    }
+
+    SUBCASE("Merge with both neighbours")
+    {
+        const u32 a = range_allocate(ator, 10);
+        const u32 b = range_allocate(ator, 10);
+        const u32 c = range_allocate(ator, 10);
+        range_allocate(ator, 70);
+
+        range_free(ator, a, 10);
+        range_free(ator, c, 10);
+        CHECK_EQ(range_largest_free_size(ator), 10);
+
+        range_free(ator, b, 10);
+        CHECK_EQ(range_largest_free_size(ator), 30);
+        CHECK_EQ(range_allocate(ator, 30), 0);
+    }
+
+    SUBCASE("Lowest")
+    {
+        const u32 a = range_allocate(ator, 10);
+        const u32 b = range_allocate(ator, 10);
+        const u32 c = range_allocate(ator, 10);
+
+        range_free(ator, a, 10);
+
+        // Nothing free before the allocation itself
+        CHECK_EQ(range_allocate_lowest(ator, 10, a), InvalidRangeOffset);
+        CHECK_EQ(range_allocate_lowest(ator, 10, c), a);
+        CHECK_EQ(range_allocate_lowest(ator, 10, c), InvalidRangeOffset);
+
+        static_cast<void>(b);
+    }
+
+    SUBCASE("Random")
+    {
+        struct Alloc
+        {
+            u32 offset;
+            u32 size;
+        };
+
+        std::mt19937       rng(42);
+        std::vector<Alloc> allocs;
+
+        for (u32 i = 0; i < 10000; i++)
+        {
+            if (allocs.empty() || rng() % 2 == 0)
+            {
+                const u32 size = 1 + rng() % 8;
+                const u32 offset = range_allocate(ator, size);
+
+                if (offset != InvalidRangeOffset)
+                {
+                    for (const Alloc& alloc : allocs)
+                        CHECK((offset + size <= alloc.offset || alloc.offset + alloc.size <= offset));
+
+                    allocs.push_back({offset, size});
+                }
+            }
+            else
+            {
+                const u32 index = rng() % allocs.size();
+
+                range_free(ator, allocs[index].offset, allocs[index].size);
+
+                allocs[index] = allocs.back();
+                allocs.pop_back();
+            }
+        }
+
+        for (const Alloc& alloc : allocs)
+            range_free(ator, alloc.offset, alloc.size);
+
+        CHECK_EQ(ator.used, 0);
+        CHECK_EQ(range_largest_free_size(ator), 100);
+    }
+}
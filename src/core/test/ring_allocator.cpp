@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include <doctest/doctest.h>
+
+#include "core/memory/RingAllocator.h"
+
+using namespace Reaper;
+
+TEST_CASE("Ring allocator")
+{
+    RingAllocator ring = create_ring_allocator(256);
+
+    SUBCASE("Alignment")
+    {
+        CHECK_EQ(ring_allocate(ring, 3, 1), 0);
+        CHECK_EQ(ring_allocate(ring, 16, 16), 16);
+        CHECK_EQ(ring_allocate(ring, 1, 4), 32);
+        CHECK_EQ(ring_used_bytes(ring), 33);
+    }
+
+    SUBCASE("Full ring")
+    {
+        CHECK_EQ(ring_allocate(ring, 200, 1), 0);
+        CHECK_EQ(ring_allocate(ring, 100, 1), InvalidRingOffset);
+        CHECK_EQ(ring_used_bytes(ring), 200);
+
+        // Open allocations are never released
+        ring_release(ring, 1000);
+        CHECK_EQ(ring_allocate(ring, 100, 1), InvalidRingOffset);
+    }
+
+    SUBCASE("Batches are released in order")
+    {
+        CHECK_EQ(ring_allocate(ring, 100, 1), 0);
+        ring_close_batch(ring, 1);
+
+        CHECK_EQ(ring_allocate(ring, 100, 1), 100);
+        ring_close_batch(ring, 2);
+
+        CHECK_FALSE(ring_has_open_batch(ring));
+
+        ring_release(ring, 0);
+        CHECK_EQ(ring_used_bytes(ring), 200);
+
+        ring_release(ring, 1);
+        CHECK_EQ(ring_used_bytes(ring), 100);
+
+        ring_release(ring, 2);
+        CHECK_EQ(ring_used_bytes(ring), 0);
+    }
+
+    SUBCASE("Allocations don't straddle the end")
+    {
+        CHECK_EQ(ring_allocate(ring, 100, 1), 0);
+        ring_close_batch(ring, 1);
+
+        CHECK_EQ(ring_allocate(ring, 100, 1), 100);
+        ring_close_batch(ring, 2);
+
+        // Doesn't fit at the end, and the beginning is still in use
+        CHECK_EQ(ring_allocate(ring, 64, 1), InvalidRingOffset);
+
+        ring_release(ring, 1);
+
+        CHECK_EQ(ring_allocate(ring, 64, 1), 0);
+        CHECK_EQ(ring_used_bytes(ring), 100 + 56 + 64);
+
+        // The skipped bytes are given back with the batch
+        ring_close_batch(ring, 3);
+        ring_release(ring, 3);
+        CHECK_EQ(ring_used_bytes(ring), 0);
+    }
+
+    SUBCASE("Empty ring fits any allocation")
+    {
+        CHECK_EQ(ring_allocate(ring, 200, 1), 0);
+        ring_close_batch(ring, 1);
+        ring_release(ring, 1);
+
+        CHECK_EQ(ring_allocate(ring, 250, 1), 0);
+        CHECK_EQ(ring_used_bytes(ring), 250);
+    }
+
+    SUBCASE("Many frames")
+    {
+        u64 fence_value = 0;
+
+        for (u32 frame_index = 0; frame_index < 1000; frame_index++)
+        {
+            const u64 offset = ring_allocate(ring, 24 + frame_index % 40, 8);
+
+            REQUIRE_NE(offset, InvalidRingOffset);
+            CHECK_EQ(offset % 8, 0);
+            CHECK_LE(offset + 24 + frame_index % 40, 256);
+
+            ring_close_batch(ring, ++fence_value);
+
+            // Keep two batches in flight
+            if (fence_value > 2)
+                ring_release(ring, fence_value - 2);
+
+            CHECK_LE(ring_used_bytes(ring), 256);
+        }
+    }
+}
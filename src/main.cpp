@@ -17,6 +17,10 @@
 #include "GameLoop.h"
 
 #include <core/Assert.h>
+#include <core/jobs/JobSystem.h>
+
+#include <algorithm>
+#include <thread>
 
 #if defined(REAPER_USE_GOOGLE_CRASHPAD)
 #    include "CrashpadHandler.h"
@@ -40,6 +44,12 @@ namespace
 
         log_info(root, "engine: start");
 
+        // Leave a core for the main thread, it takes part in the work anyway
+        const u32 worker_thread_count = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+        log_info(root, "engine: create job system with {} worker threads", worker_thread_count);
+        root.job_system = create_job_system(worker_thread_count);
+
         create_renderer(root);
 
         AudioConfig audio_config;
@@ -57,6 +67,9 @@ namespace
 
         destroy_renderer(root);
 
+        destroy_job_system(root.job_system);
+        root.job_system = nullptr;
+
         delete root.log;
         root.log = nullptr;
     }
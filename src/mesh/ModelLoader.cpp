@@ -8,23 +8,149 @@
 #include "ModelLoader.h"
 
 #include <core/Assert.h>
+#include <core/Hash.h>
+#include <core/jobs/JobSystem.h>
+
+#include <profiling/Scope.h>
 
 #include <algorithm>
 #include <cctype>
 #include <fstream>
+#include <unordered_map>
 #include <vector>
 
 #include "tiny_obj_loader.h"
 
+#include <meshoptimizer.h>
+
 #include <glm/geometric.hpp>
 
 namespace Reaper
 {
 namespace
 {
-    // A lot of cache miss with this method.
-    Mesh load_obj_tiny_obj_loader(std::ifstream& src)
+    // Face corners sharing the same triplet of OBJ indices become a single vertex
+    struct ObjVertexKey
+    {
+        int position_index;
+        int normal_index;
+        int texcoord_index;
+
+        bool operator==(const ObjVertexKey& other) const = default;
+    };
+
+    u64 hash_obj_vertex_key(const ObjVertexKey& key)
+    {
+        u64 hash = HashSeed;
+
+        hash = hash_value(hash, key.position_index);
+        hash = hash_value(hash, key.normal_index);
+        hash = hash_value(hash, key.texcoord_index);
+
+        return hash;
+    }
+
+    struct ObjVertexKeyHasher
+    {
+        std::size_t operator()(const ObjVertexKey& key) const
+        {
+            return static_cast<std::size_t>(hash_obj_vertex_key(key));
+        }
+    };
+
+    // Below this, waking up threads costs more than it saves
+    constexpr u32 ParallelWeldMinCornerCount = 1 << 16;
+    constexpr u32 CornerHashGrainSize = 4096;
+
+    // Maps every face corner to the first corner with the same key.
+    // Keys are split into shards by hash, and each shard is welded independently. Corners are bucketed by shard in
+    // order so the result doesn't depend on the shard count.
+    void find_first_corners(std::span<const ObjVertexKey> corner_keys, std::span<u32> first_corners,
+                            JobSystem* job_system)
+    {
+        REAPER_PROFILE_SCOPE_FUNC();
+
+        const u32 corner_count = static_cast<u32>(corner_keys.size());
+        const u32 shard_count = (job_system != nullptr && corner_count >= ParallelWeldMinCornerCount)
+                                    ? get_worker_thread_count(*job_system) + 1
+                                    : 1;
+
+        std::vector<u32> corner_shards(corner_count, 0);
+
+        if (shard_count > 1)
+        {
+            parallel_for(
+                *job_system, corner_count,
+                [&](u32 corner_index) {
+                    const u64 hash = hash_obj_vertex_key(corner_keys[corner_index]);
+                    corner_shards[corner_index] = static_cast<u32>(hash % shard_count);
+                },
+                CornerHashGrainSize);
+        }
+
+        // Counting sort of the corner indices by shard, each bucket stays in corner order
+        std::vector<u32> shard_offsets(shard_count + 1, 0);
+
+        for (u32 shard_index : corner_shards)
+            shard_offsets[shard_index + 1] += 1;
+
+        for (u32 shard_index = 0; shard_index < shard_count; shard_index++)
+            shard_offsets[shard_index + 1] += shard_offsets[shard_index];
+
+        std::vector<u32> shard_corner_indices(corner_count);
+        std::vector<u32> shard_write_offsets(shard_offsets.begin(), shard_offsets.end() - 1);
+
+        for (u32 corner_index = 0; corner_index < corner_count; corner_index++)
+            shard_corner_indices[shard_write_offsets[corner_shards[corner_index]]++] = corner_index;
+
+        const auto weld_shard = [&](u32 shard_index) {
+            const std::span<const u32> corner_indices(shard_corner_indices.data() + shard_offsets[shard_index],
+                                                      shard_corner_indices.data() + shard_offsets[shard_index + 1]);
+
+            std::unordered_map<ObjVertexKey, u32, ObjVertexKeyHasher> first_corner_map;
+            first_corner_map.reserve(corner_indices.size());
+
+            for (u32 corner_index : corner_indices)
+            {
+                const auto [it, inserted] = first_corner_map.try_emplace(corner_keys[corner_index], corner_index);
+                first_corners[corner_index] = it->second;
+            }
+        };
+
+        if (shard_count > 1)
+            parallel_for(*job_system, shard_count, weld_shard);
+        else
+            weld_shard(0);
+    }
+
+    void optimize_vertex_order(Mesh& mesh)
+    {
+        REAPER_PROFILE_SCOPE_FUNC();
+
+        const size_t index_count = mesh.indexes.size();
+        const size_t vertex_count = mesh.positions.size();
+
+        meshopt_optimizeVertexCache(mesh.indexes.data(), mesh.indexes.data(), index_count, vertex_count);
+
+        // Vertices are now reordered in the order they are first used
+        std::vector<u32> remap(vertex_count);
+        const size_t     used_vertex_count =
+            meshopt_optimizeVertexFetchRemap(remap.data(), mesh.indexes.data(), index_count, vertex_count);
+
+        meshopt_remapIndexBuffer(mesh.indexes.data(), mesh.indexes.data(), index_count, remap.data());
+        meshopt_remapVertexBuffer(mesh.positions.data(), mesh.positions.data(), vertex_count,
+                                  sizeof(mesh.positions[0]), remap.data());
+        meshopt_remapVertexBuffer(mesh.attributes.data(), mesh.attributes.data(), vertex_count,
+                                  sizeof(mesh.attributes[0]), remap.data());
+
+        mesh.positions.resize(used_vertex_count);
+        mesh.attributes.resize(used_vertex_count);
+    }
+
+    Mesh load_obj_tiny_obj_loader(std::istream& src, const ObjLoadOptions& options)
     {
+        REAPER_PROFILE_SCOPE_FUNC();
+
         tinyobj::attrib_t                attrib;
         std::vector<tinyobj::shape_t>    shapes;
         std::vector<tinyobj::material_t> materials;
@@ -38,73 +164,102 @@ namespace
         Assert(ret, "could not load obj");
         Assert(shapes.size() > 0, "no shapes to load");
 
-        // FIXME reserve() not at the right size
+        // Flatten face corners of all shapes
+        std::vector<ObjVertexKey> corner_keys;
+
+        for (const tinyobj::shape_t& shape : shapes)
+        {
+            for (auto face_vertex_count : shape.mesh.num_face_vertices)
+                Assert(face_vertex_count == 3, "only triangle faces are supported");
+
+            for (const tinyobj::index_t& index_info : shape.mesh.indices)
+            {
+                corner_keys.push_back(ObjVertexKey{
+                    .position_index = index_info.vertex_index,
+                    .normal_index = index_info.normal_index,
+                    .texcoord_index = index_info.texcoord_index,
+                });
+            }
+        }
+
+        const u32 corner_count = static_cast<u32>(corner_keys.size());
+
+        std::vector<u32> first_corners(corner_count);
+        find_first_corners(corner_keys, first_corners, options.job_system);
+
+        // Only the first corner of each key emits a vertex, the others point to it
+        std::vector<u32> corner_vertex_indices(corner_count);
+
         Mesh mesh;
-        mesh.positions.reserve(attrib.vertices.size());
-        mesh.attributes.reserve(attrib.vertices.size());
+        mesh.indexes.resize(corner_count);
 
-        // Loop over shapes
-        for (size_t s = 0; s < shapes.size(); s++)
+        for (u32 corner_index = 0; corner_index < corner_count; corner_index++)
         {
-            // Loop over faces(polygon)
-            size_t index_offset = 0;
-            for (size_t f = 0; f < shapes[s].mesh.num_face_vertices.size(); f++)
+            const u32 first_corner_index = first_corners[corner_index];
+
+            if (first_corner_index != corner_index)
             {
-                u32 fv = shapes[s].mesh.num_face_vertices[f];
-                Assert(fv == 3, "only triangle faces are supported");
-
-                // Loop over vertices in the face.
-                for (size_t v = 0; v < fv; v++)
-                {
-                    // access to vertex
-                    const u32              index = static_cast<u32>(index_offset + v);
-                    const tinyobj::index_t indexInfo = shapes[s].mesh.indices[index];
-
-                    tinyobj::real_t  vx = attrib.vertices[3 * indexInfo.vertex_index + 0];
-                    tinyobj::real_t  vy = attrib.vertices[3 * indexInfo.vertex_index + 1];
-                    tinyobj::real_t  vz = attrib.vertices[3 * indexInfo.vertex_index + 2];
-                    const glm::fvec3 vertex(vx, vy, vz);
-                    mesh.positions.push_back(vertex);
-                    auto& vertex_attributes = mesh.attributes.emplace_back();
-
-                    if (!attrib.normals.empty())
-                    {
-                        tinyobj::real_t nx = attrib.normals[3 * indexInfo.normal_index + 0];
-                        tinyobj::real_t ny = attrib.normals[3 * indexInfo.normal_index + 1];
-                        tinyobj::real_t nz = attrib.normals[3 * indexInfo.normal_index + 2];
-                        vertex_attributes.normal = glm::fvec3(nx, ny, nz);
-                    }
-                    else
-                    {
-                        vertex_attributes.normal = glm::fvec3(0.0, 0.0, 1.0); // Dummy value
-                    }
-
-                    if (!attrib.texcoords.empty())
-                    {
-                        tinyobj::real_t tx = attrib.texcoords[2 * indexInfo.texcoord_index + 0];
-                        tinyobj::real_t ty = attrib.texcoords[2 * indexInfo.texcoord_index + 1];
-                        vertex_attributes.uv = glm::fvec2(tx, ty);
-                    }
-                    else
-                    {
-                        vertex_attributes.uv = glm::fvec2(0.0, 0.0); // Dummy value
-                    }
-
-                    vertex_attributes.tangent = glm::fvec4(1.0, 0.0, 0.0, 1.0); // Dummy value
-
-                    mesh.indexes.push_back(index);
-                }
-                index_offset += fv;
+                Assert(first_corner_index < corner_index);
+
+                mesh.indexes[corner_index] = corner_vertex_indices[first_corner_index];
+                continue;
             }
+
+            const ObjVertexKey& key = corner_keys[corner_index];
+            const u32           vertex_index = static_cast<u32>(mesh.positions.size());
+
+            corner_vertex_indices[corner_index] = vertex_index;
+            mesh.indexes[corner_index] = vertex_index;
+
+            tinyobj::real_t  vx = attrib.vertices[3 * key.position_index + 0];
+            tinyobj::real_t  vy = attrib.vertices[3 * key.position_index + 1];
+            tinyobj::real_t  vz = attrib.vertices[3 * key.position_index + 2];
+            const glm::fvec3 vertex(vx, vy, vz);
+            mesh.positions.push_back(vertex);
+            auto& vertex_attributes = mesh.attributes.emplace_back();
+
+            if (!attrib.normals.empty() && key.normal_index >= 0)
+            {
+                tinyobj::real_t nx = attrib.normals[3 * key.normal_index + 0];
+                tinyobj::real_t ny = attrib.normals[3 * key.normal_index + 1];
+                tinyobj::real_t nz = attrib.normals[3 * key.normal_index + 2];
+                vertex_attributes.normal = glm::fvec3(nx, ny, nz);
+            }
+            else
+            {
+                vertex_attributes.normal = glm::fvec3(0.0, 0.0, 1.0); // Dummy value
+            }
+
+            if (!attrib.texcoords.empty() && key.texcoord_index >= 0)
+            {
+                tinyobj::real_t tx = attrib.texcoords[2 * key.texcoord_index + 0];
+                tinyobj::real_t ty = attrib.texcoords[2 * key.texcoord_index + 1];
+                vertex_attributes.uv = glm::fvec2(tx, ty);
+            }
+            else
+            {
+                vertex_attributes.uv = glm::fvec2(0.0, 0.0); // Dummy value
+            }
+
+            vertex_attributes.tangent = glm::fvec4(1.0, 0.0, 0.0, 1.0); // Dummy value
         }
+
+        if (options.optimize_vertex_order)
+            optimize_vertex_order(mesh);
+
         return mesh;
     }
 } // namespace
 
-Mesh load_obj(const std::string& filename)
+Mesh load_obj(const std::string& filename, const ObjLoadOptions& options)
 {
     std::ifstream file(filename);
-    return load_obj_tiny_obj_loader(file);
+    return load_obj_tiny_obj_loader(file, options);
+}
+
+Mesh load_obj(std::istream& input, const ObjLoadOptions& options)
+{
+    return load_obj_tiny_obj_loader(input, options);
 }
 
 void save_obj(std::ostream& output, std::span<const Mesh> meshes)
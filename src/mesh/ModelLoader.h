@@ -18,6 +18,16 @@
 
 namespace Reaper
 {
-REAPER_MESH_API Mesh load_obj(const std::string& filename);
+struct JobSystem;
+
+struct ObjLoadOptions
+{
+    bool       optimize_vertex_order = true; // Reorder for the post-transform and vertex fetch caches
+    JobSystem* job_system = nullptr;         // Weld vertices of big files on multiple threads
+};
+
+// Corners sharing the same position, normal and uv indices are welded into a single vertex.
+REAPER_MESH_API Mesh load_obj(const std::string& filename, const ObjLoadOptions& options = {});
+REAPER_MESH_API Mesh load_obj(std::istream& input, const ObjLoadOptions& options = {});
 REAPER_MESH_API void save_obj(std::ostream& output, std::span<const Mesh> meshes);
 }; // namespace Reaper
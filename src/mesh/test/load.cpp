@@ -9,10 +9,66 @@
 
 #include "mesh/ModelLoader.h"
 
-TEST_CASE("Mesh Loading")
+#include <core/jobs/JobSystem.h>
+
+#include <algorithm>
+#include <sstream>
+
+using namespace Reaper;
+
+namespace
 {
-    using namespace Reaper;
+// Grid of quads sharing positions, uvs and a single normal
+std::string generate_grid_obj(u32 quad_count_per_side)
+{
+    const u32 vertex_count_per_side = quad_count_per_side + 1;
+
+    std::ostringstream obj;
+
+    for (u32 y = 0; y < vertex_count_per_side; y++)
+    {
+        for (u32 x = 0; x < vertex_count_per_side; x++)
+        {
+            obj << "v " << x << ' ' << y << " 0\n";
+            obj << "vt " << static_cast<float>(x) / quad_count_per_side << ' '
+                << static_cast<float>(y) / quad_count_per_side << '\n';
+        }
+    }
+
+    obj << "vn 0 0 1\n";
+
+    for (u32 y = 0; y < quad_count_per_side; y++)
+    {
+        for (u32 x = 0; x < quad_count_per_side; x++)
+        {
+            // OBJ indices start at 1
+            const u32 i00 = y * vertex_count_per_side + x + 1;
+            const u32 i10 = i00 + 1;
+            const u32 i01 = i00 + vertex_count_per_side;
+            const u32 i11 = i01 + 1;
+
+            obj << "f " << i00 << '/' << i00 << "/1 " << i10 << '/' << i10 << "/1 " << i11 << '/' << i11 << "/1\n";
+            obj << "f " << i00 << '/' << i00 << "/1 " << i11 << '/' << i11 << "/1 " << i01 << '/' << i01 << "/1\n";
+        }
+    }
 
+    return obj.str();
+}
+
+// Positions of each triangle corner, independent of the vertex order
+std::vector<glm::fvec3> get_corner_positions(const Mesh& mesh)
+{
+    std::vector<glm::fvec3> positions;
+
+    for (u32 index : mesh.indexes)
+        positions.push_back(mesh.positions[index]);
+
+    return positions;
+}
+} // namespace
+
+TEST_CASE("Mesh Loading")
+{
     SUBCASE("Small OBJ files")
     {
         load_obj("res/model/quad.obj");
@@ -24,3 +80,84 @@ TEST_CASE("Mesh Loading")
         load_obj("res/model/bunny.obj");
     }
 }
+
+TEST_CASE("OBJ vertex welding")
+{
+    ObjLoadOptions options = {};
+    options.optimize_vertex_order = false;
+
+    SUBCASE("Shared corners")
+    {
+        std::istringstream obj(generate_grid_obj(1));
+        const Mesh         mesh = load_obj(obj, options);
+
+        CHECK_EQ(mesh.indexes.size(), 6);
+        CHECK_EQ(mesh.positions.size(), 4);
+        CHECK_EQ(mesh.attributes.size(), 4);
+
+        // Vertices come in the order they're first used
+        const std::vector<u32> expected_indexes = {0, 1, 2, 0, 2, 3};
+        CHECK_EQ(mesh.indexes, expected_indexes);
+    }
+
+    SUBCASE("Different attributes are not welded")
+    {
+        std::istringstream obj("v 0 0 0\nv 1 0 0\nv 0 1 0\nvn 0 0 1\nvn 0 0 -1\n"
+                               "f 1//1 2//1 3//1\nf 1//2 3//2 2//2\n");
+        const Mesh         mesh = load_obj(obj, options);
+
+        CHECK_EQ(mesh.indexes.size(), 6);
+        CHECK_EQ(mesh.positions.size(), 6);
+        CHECK_EQ(mesh.attributes[3].normal, glm::fvec3(0.f, 0.f, -1.f));
+    }
+
+    SUBCASE("Vertex order optimization keeps the same triangles")
+    {
+        const std::string obj_string = generate_grid_obj(16);
+
+        std::istringstream obj(obj_string);
+        const Mesh         mesh = load_obj(obj, options);
+
+        std::istringstream obj_optimized(obj_string);
+        const Mesh         optimized_mesh = load_obj(obj_optimized, ObjLoadOptions{});
+
+        CHECK_EQ(mesh.positions.size(), 17 * 17);
+        CHECK_EQ(optimized_mesh.positions.size(), mesh.positions.size());
+        CHECK_EQ(optimized_mesh.indexes.size(), mesh.indexes.size());
+
+        // meshopt can rotate triangles, only compare the set of corners
+        std::vector<glm::fvec3> corners = get_corner_positions(mesh);
+        std::vector<glm::fvec3> optimized_corners = get_corner_positions(optimized_mesh);
+
+        const auto compare_positions = [](const glm::fvec3& a, const glm::fvec3& b) {
+            return a.x != b.x ? a.x < b.x : (a.y != b.y ? a.y < b.y : a.z < b.z);
+        };
+
+        std::sort(corners.begin(), corners.end(), compare_positions);
+        std::sort(optimized_corners.begin(), optimized_corners.end(), compare_positions);
+
+        CHECK(corners == optimized_corners);
+    }
+
+    SUBCASE("Parallel welding is deterministic")
+    {
+        // Big enough to go wide
+        const std::string obj_string = generate_grid_obj(128);
+
+        JobSystem* job_system = create_job_system(3);
+
+        std::istringstream obj(obj_string);
+        const Mesh         mesh = load_obj(obj, options);
+
+        options.job_system = job_system;
+
+        std::istringstream obj_parallel(obj_string);
+        const Mesh         parallel_mesh = load_obj(obj_parallel, options);
+
+        destroy_job_system(job_system);
+
+        CHECK_EQ(mesh.positions.size(), 129 * 129);
+        CHECK(mesh.indexes == parallel_mesh.indexes);
+        CHECK(mesh.positions == parallel_mesh.positions);
+    }
+}
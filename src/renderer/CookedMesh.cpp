@@ -0,0 +1,235 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include "CookedMesh.h"
+
+#include "core/Assert.h"
+#include "core/Hash.h"
+#include "core/fs/MappedFile.h"
+#include "profiling/Scope.h"
+
+#include <fstream>
+
+namespace Reaper
+{
+// The layout is part of the format, changing it means bumping CookedMeshVersion
+static_assert(sizeof(CookedMeshFileHeader) == 24);
+static_assert(sizeof(CookedMeshLodEntry) == 48);
+static_assert(sizeof(CookedMeshEntry) == 224);
+
+namespace
+{
+    u64 align_offset(u64 offset)
+    {
+        return (offset + CookedMeshAlignment - 1) & ~(CookedMeshAlignment - 1);
+    }
+
+    template <typename T>
+    u64 reserve_array(u64& offset_bytes, std::span<const T> data)
+    {
+        const u64 array_offset_bytes = align_offset(offset_bytes);
+
+        offset_bytes = array_offset_bytes + data.size_bytes();
+
+        return array_offset_bytes;
+    }
+
+    void write_padding(std::ofstream& output, u64& offset_bytes, u64 target_offset_bytes)
+    {
+        Assert(target_offset_bytes >= offset_bytes);
+
+        const char zero = 0;
+
+        for (; offset_bytes < target_offset_bytes; offset_bytes++)
+            output.write(&zero, 1);
+    }
+
+    template <typename T>
+    void write_array(std::ofstream& output, u64& offset_bytes, u64 array_offset_bytes, std::span<const T> data)
+    {
+        write_padding(output, offset_bytes, array_offset_bytes);
+
+        output.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size_bytes()));
+
+        offset_bytes += data.size_bytes();
+    }
+
+    template <typename T>
+    bool get_array_view(std::span<const u8> file_data, u64 offset_bytes, u32 count, std::span<const T>& output)
+    {
+        const u64 size_bytes = static_cast<u64>(count) * sizeof(T);
+
+        if (offset_bytes % CookedMeshAlignment != 0 || offset_bytes > file_data.size()
+            || size_bytes > file_data.size() - offset_bytes)
+        {
+            return false;
+        }
+
+        output = std::span(reinterpret_cast<const T*>(file_data.data() + offset_bytes), count);
+
+        return true;
+    }
+} // namespace
+
+std::string get_cooked_mesh_path(const std::string& source_path)
+{
+    return source_path + ".rmesh";
+}
+
+u64 hash_cooked_mesh_source(const std::string& source_path)
+{
+    REAPER_PROFILE_SCOPE_FUNC();
+
+    MappedFile source_file;
+    Assert(map_file(source_path, source_file), "could not open mesh source");
+
+    const u64 hash = hash_bytes(HashSeed, source_file.data, source_file.size_bytes);
+
+    unmap_file(source_file);
+
+    return hash;
+}
+
+bool write_cooked_mesh_file(const std::string& file_path, std::span<const MeshletMesh> meshes, u64 source_hash)
+{
+    REAPER_PROFILE_SCOPE_FUNC();
+
+    const CookedMeshFileHeader header = {
+        .magic = CookedMeshMagic,
+        .version = CookedMeshVersion,
+        .source_hash = source_hash,
+        .mesh_count = static_cast<u32>(meshes.size()),
+        ._pad0 = 0,
+    };
+
+    std::vector<CookedMeshEntry> entries(meshes.size());
+
+    // Compute the layout first so the entries can be written before the data
+    u64 offset_bytes = sizeof(CookedMeshFileHeader) + entries.size() * sizeof(CookedMeshEntry);
+
+    for (u32 mesh_index = 0; mesh_index < meshes.size(); mesh_index++)
+    {
+        const MeshletMesh& meshlet_mesh = meshes[mesh_index];
+        CookedMeshEntry&   entry = entries[mesh_index];
+
+        Assert(!meshlet_mesh.lods.empty() && meshlet_mesh.lods.size() <= Mesh2::MAX_MESH_LODS);
+
+        entry = {};
+        entry.lod_count = static_cast<u32>(meshlet_mesh.lods.size());
+        entry.aabb_min_ms = meshlet_mesh.aabb_min_ms;
+        entry.aabb_max_ms = meshlet_mesh.aabb_max_ms;
+
+        for (u32 lod_index = 0; lod_index < entry.lod_count; lod_index++)
+        {
+            const MeshletLod& lod = meshlet_mesh.lods[lod_index];
+
+            entry.lods[lod_index] = {
+                .index_count = static_cast<u32>(lod.mesh.indexes.size()),
+                .vertex_count = static_cast<u32>(lod.mesh.positions.size()),
+                .meshlet_count = static_cast<u32>(lod.meshlets.size()),
+                .error_ms = lod.error_ms,
+                .index_offset_bytes = reserve_array(offset_bytes, std::span(lod.mesh.indexes)),
+                .position_offset_bytes = reserve_array(offset_bytes, std::span(lod.mesh.positions)),
+                .attributes_offset_bytes = reserve_array(offset_bytes, std::span(lod.mesh.attributes)),
+                .meshlet_offset_bytes = reserve_array(offset_bytes, std::span(lod.meshlets)),
+            };
+        }
+    }
+
+    std::ofstream output(file_path, std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if (!output.is_open())
+        return false;
+
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.write(reinterpret_cast<const char*>(entries.data()),
+                 static_cast<std::streamsize>(entries.size() * sizeof(CookedMeshEntry)));
+
+    offset_bytes = sizeof(CookedMeshFileHeader) + entries.size() * sizeof(CookedMeshEntry);
+
+    for (u32 mesh_index = 0; mesh_index < meshes.size(); mesh_index++)
+    {
+        const MeshletMesh&     meshlet_mesh = meshes[mesh_index];
+        const CookedMeshEntry& entry = entries[mesh_index];
+
+        for (u32 lod_index = 0; lod_index < entry.lod_count; lod_index++)
+        {
+            const MeshletLod&         lod = meshlet_mesh.lods[lod_index];
+            const CookedMeshLodEntry& lod_entry = entry.lods[lod_index];
+
+            write_array(output, offset_bytes, lod_entry.index_offset_bytes, std::span(lod.mesh.indexes));
+            write_array(output, offset_bytes, lod_entry.position_offset_bytes, std::span(lod.mesh.positions));
+            write_array(output, offset_bytes, lod_entry.attributes_offset_bytes, std::span(lod.mesh.attributes));
+            write_array(output, offset_bytes, lod_entry.meshlet_offset_bytes, std::span(lod.meshlets));
+        }
+    }
+
+    return output.good();
+}
+
+bool get_cooked_mesh_views(std::span<const u8> file_data, u64 expected_source_hash,
+                           std::vector<MeshletMeshView>& output_views)
+{
+    if (file_data.size() < sizeof(CookedMeshFileHeader))
+        return false;
+
+    const CookedMeshFileHeader& header = *reinterpret_cast<const CookedMeshFileHeader*>(file_data.data());
+
+    if (header.magic != CookedMeshMagic || header.version != CookedMeshVersion
+        || header.source_hash != expected_source_hash)
+    {
+        return false;
+    }
+
+    const u64 entries_size_bytes = static_cast<u64>(header.mesh_count) * sizeof(CookedMeshEntry);
+
+    if (entries_size_bytes > file_data.size() - sizeof(CookedMeshFileHeader))
+        return false;
+
+    const std::span<const CookedMeshEntry> entries(
+        reinterpret_cast<const CookedMeshEntry*>(file_data.data() + sizeof(CookedMeshFileHeader)), header.mesh_count);
+
+    std::vector<MeshletMeshView> views(entries.size());
+
+    for (u32 mesh_index = 0; mesh_index < entries.size(); mesh_index++)
+    {
+        const CookedMeshEntry& entry = entries[mesh_index];
+        MeshletMeshView&       view = views[mesh_index];
+
+        if (entry.lod_count == 0 || entry.lod_count > Mesh2::MAX_MESH_LODS)
+            return false;
+
+        view.lod_count = entry.lod_count;
+        view.aabb_min_ms = entry.aabb_min_ms;
+        view.aabb_max_ms = entry.aabb_max_ms;
+
+        for (u32 lod_index = 0; lod_index < entry.lod_count; lod_index++)
+        {
+            const CookedMeshLodEntry& lod_entry = entry.lods[lod_index];
+            MeshletLodView&           lod_view = view.lods[lod_index];
+
+            const bool is_valid =
+                get_array_view(file_data, lod_entry.index_offset_bytes, lod_entry.index_count, lod_view.indexes)
+                && get_array_view(file_data, lod_entry.position_offset_bytes, lod_entry.vertex_count,
+                                  lod_view.positions)
+                && get_array_view(file_data, lod_entry.attributes_offset_bytes, lod_entry.vertex_count,
+                                  lod_view.attributes)
+                && get_array_view(file_data, lod_entry.meshlet_offset_bytes, lod_entry.meshlet_count,
+                                  lod_view.meshlets);
+
+            if (!is_valid)
+                return false;
+
+            lod_view.error_ms = lod_entry.error_ms;
+        }
+    }
+
+    output_views.insert(output_views.end(), views.begin(), views.end());
+
+    return true;
+}
+} // namespace Reaper
@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "renderer/MeshletBuilder.h"
+#include "renderer/RendererExport.h"
+
+#include "core/Types.h"
+
+#include <span>
+#include <string>
+#include <vector>
+
+namespace Reaper
+{
+// Binary file holding the output of build_meshlet_mesh() for one or more meshes, written by the mesh cooker.
+// Layout: CookedMeshFileHeader, mesh_count CookedMeshEntry, then the arrays of every LOD of every mesh.
+// Array offsets are in bytes from the start of the file and aligned to CookedMeshAlignment, so a mapped file can be
+// read in place and copied to the mesh cache staging memory without any parsing.
+static constexpr u32 CookedMeshMagic = 0x48534d52; // "RMSH"
+
+// Bump this when the layout or the output of the meshlet builder changes, older files will be rejected.
+static constexpr u32 CookedMeshVersion = 2;
+
+static constexpr u64 CookedMeshAlignment = 64;
+
+struct CookedMeshFileHeader
+{
+    u32 magic;
+    u32 version;
+    u64 source_hash; // See hash_cooked_mesh_source()
+    u32 mesh_count;
+    u32 _pad0;
+};
+
+struct CookedMeshLodEntry
+{
+    u32   index_count;
+    u32   vertex_count;
+    u32   meshlet_count;
+    float error_ms;
+
+    u64 index_offset_bytes;
+    u64 position_offset_bytes;
+    u64 attributes_offset_bytes;
+    u64 meshlet_offset_bytes;
+};
+
+struct CookedMeshEntry
+{
+    u32 lod_count;
+    u32 _pad0;
+
+    glm::fvec3 aabb_min_ms;
+    glm::fvec3 aabb_max_ms;
+
+    CookedMeshLodEntry lods[Mesh2::MAX_MESH_LODS];
+};
+
+// Cooked files are written next to their source.
+REAPER_RENDERER_API std::string get_cooked_mesh_path(const std::string& source_path);
+
+// Hash of the source file content, a cooked file is stale as soon as its source changes.
+REAPER_RENDERER_API u64 hash_cooked_mesh_source(const std::string& source_path);
+
+REAPER_RENDERER_API bool write_cooked_mesh_file(const std::string& file_path, std::span<const MeshletMesh> meshes,
+                                                u64 source_hash);
+
+// Validates the header and points the views to the arrays inside file_data, nothing is copied.
+// Returns false for files that are truncated, stale or written by an older cooker.
+REAPER_RENDERER_API bool get_cooked_mesh_views(std::span<const u8> file_data, u64 expected_source_hash,
+                                               std::vector<MeshletMeshView>& output_views);
+} // namespace Reaper
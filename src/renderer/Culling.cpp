@@ -0,0 +1,157 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Culling.h"
+
+#include <core/Assert.h>
+#include <core/BitTricks.h>
+#include <core/Platform.h>
+
+#include <profiling/Scope.h>
+
+#if defined(REAPER_CPU_ARCH_X86_64)
+#    include <xmmintrin.h>
+#    define REAPER_CULLING_USE_SSE 1
+#else
+#    define REAPER_CULLING_USE_SSE 0
+#endif
+
+namespace Reaper
+{
+namespace
+{
+    glm::fvec4 normalize_plane(glm::fvec4 plane)
+    {
+        const float normal_length = glm::length(glm::fvec3(plane));
+
+        // Happens with an infinite far plane, let everything through
+        if (normal_length < 1e-6f)
+            return glm::fvec4(0.f, 0.f, 0.f, 1.f);
+
+        return plane / normal_length;
+    }
+
+    bool is_sphere_visible(const Frustum& frustum, glm::fvec3 center, float radius)
+    {
+        for (const glm::fvec4& plane : frustum.planes)
+        {
+            const float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+
+            if (distance < -radius)
+                return false;
+        }
+
+        return true;
+    }
+} // namespace
+
+Frustum build_frustum(const glm::fmat4& ws_to_cs_matrix)
+{
+    // Gribb-Hartmann, glm matrices are column-major so we have to gather the rows first
+    const glm::fmat4 m = glm::transpose(ws_to_cs_matrix);
+
+    Frustum frustum;
+    frustum.planes[0] = normalize_plane(m[3] + m[0]); // Left
+    frustum.planes[1] = normalize_plane(m[3] - m[0]); // Right
+    frustum.planes[2] = normalize_plane(m[3] + m[1]); // Bottom (or top with a flipped Y)
+    frustum.planes[3] = normalize_plane(m[3] - m[1]); // Top
+    frustum.planes[4] = normalize_plane(m[2]);        // Near (or far with reverse Z)
+    frustum.planes[5] = normalize_plane(m[3] - m[2]); // Far
+
+    return frustum;
+}
+
+void resize_bounding_spheres(BoundingSpheres& spheres, u32 count)
+{
+    spheres.center_x.resize(count);
+    spheres.center_y.resize(count);
+    spheres.center_z.resize(count);
+    spheres.radius.resize(count);
+}
+
+void set_bounding_sphere(BoundingSpheres& spheres, u32 index, const glm::fmat4x3& transform, glm::fvec3 center_ms,
+                         float radius_ms)
+{
+    const glm::fvec3 center_ws = transform * glm::fvec4(center_ms, 1.f);
+    const float      max_scale_sq = glm::max(glm::max(glm::dot(transform[0], transform[0]),
+                                                      glm::dot(transform[1], transform[1])),
+                                             glm::dot(transform[2], transform[2]));
+
+    spheres.center_x[index] = center_ws.x;
+    spheres.center_y[index] = center_ws.y;
+    spheres.center_z[index] = center_ws.z;
+    spheres.radius[index] = radius_ms * glm::sqrt(max_scale_sq);
+}
+
+void cull_bounding_spheres(const Frustum& frustum, const BoundingSpheres& spheres, std::vector<u32>& visible_indices)
+{
+    REAPER_PROFILE_SCOPE_FUNC();
+
+    const u32 sphere_count = static_cast<u32>(spheres.radius.size());
+
+    Assert(spheres.center_x.size() == sphere_count);
+    Assert(spheres.center_y.size() == sphere_count);
+    Assert(spheres.center_z.size() == sphere_count);
+
+    u32 sphere_index = 0;
+
+#if REAPER_CULLING_USE_SSE
+    // Four spheres per iteration, planes are broadcast across the lanes
+    __m128 plane_x[6], plane_y[6], plane_z[6], plane_w[6];
+
+    for (u32 plane_index = 0; plane_index < 6; plane_index++)
+    {
+        const glm::fvec4& plane = frustum.planes[plane_index];
+
+        plane_x[plane_index] = _mm_set1_ps(plane.x);
+        plane_y[plane_index] = _mm_set1_ps(plane.y);
+        plane_z[plane_index] = _mm_set1_ps(plane.z);
+        plane_w[plane_index] = _mm_set1_ps(plane.w);
+    }
+
+    const __m128 zero = _mm_setzero_ps();
+
+    for (; sphere_index + 4 <= sphere_count; sphere_index += 4)
+    {
+        const __m128 center_x = _mm_loadu_ps(&spheres.center_x[sphere_index]);
+        const __m128 center_y = _mm_loadu_ps(&spheres.center_y[sphere_index]);
+        const __m128 center_z = _mm_loadu_ps(&spheres.center_z[sphere_index]);
+        const __m128 minus_radius = _mm_sub_ps(zero, _mm_loadu_ps(&spheres.radius[sphere_index]));
+
+        __m128 visible_mask = _mm_cmpeq_ps(zero, zero); // All bits set
+
+        for (u32 plane_index = 0; plane_index < 6; plane_index++)
+        {
+            // Same operation order as the scalar version to get the exact same result
+            __m128 distance = _mm_mul_ps(plane_x[plane_index], center_x);
+            distance = _mm_add_ps(distance, _mm_mul_ps(plane_y[plane_index], center_y));
+            distance = _mm_add_ps(distance, _mm_mul_ps(plane_z[plane_index], center_z));
+            distance = _mm_add_ps(distance, plane_w[plane_index]);
+
+            visible_mask = _mm_and_ps(visible_mask, _mm_cmpge_ps(distance, minus_radius));
+        }
+
+        const u32 visible_bits = static_cast<u32>(_mm_movemask_ps(visible_mask));
+
+        for (u32 lane_index = 0; lane_index < 4; lane_index++)
+        {
+            if (visible_bits & bit(lane_index))
+                visible_indices.push_back(sphere_index + lane_index);
+        }
+    }
+#endif
+
+    for (; sphere_index < sphere_count; sphere_index++)
+    {
+        const glm::fvec3 center(spheres.center_x[sphere_index], spheres.center_y[sphere_index],
+                                spheres.center_z[sphere_index]);
+
+        if (is_sphere_visible(frustum, center, spheres.radius[sphere_index]))
+            visible_indices.push_back(sphere_index);
+    }
+}
+} // namespace Reaper
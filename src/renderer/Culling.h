@@ -0,0 +1,48 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "renderer/RendererExport.h"
+
+#include <core/Types.h>
+
+#include <vector>
+
+namespace Reaper
+{
+// Normals point inside and are normalized, dot(plane.xyz, p) + plane.w is a signed distance.
+struct Frustum
+{
+    glm::fvec4 planes[6];
+};
+
+// Works for any projection with a [0, 1] clip space depth, reverse Z included.
+REAPER_RENDERER_API Frustum build_frustum(const glm::fmat4& ws_to_cs_matrix);
+
+// World space spheres stored as structure-of-arrays so we can test a few of them at once.
+struct BoundingSpheres
+{
+    std::vector<float> center_x;
+    std::vector<float> center_y;
+    std::vector<float> center_z;
+    std::vector<float> radius;
+};
+
+REAPER_RENDERER_API void resize_bounding_spheres(BoundingSpheres& spheres, u32 count);
+
+// Assumes the transform has no skew, non-uniform scale only makes the sphere bigger.
+REAPER_RENDERER_API void set_bounding_sphere(BoundingSpheres& spheres, u32 index, const glm::fmat4x3& transform,
+                                             glm::fvec3 center_ms, float radius_ms);
+
+// Appends the indices of spheres touching the frustum, in increasing order.
+// Conservative: a sphere outside of the frustum but close to one of its corners is kept.
+REAPER_RENDERER_API void cull_bounding_spheres(const Frustum& frustum, const BoundingSpheres& spheres,
+                                               std::vector<u32>& visible_indices);
+} // namespace Reaper
@@ -31,9 +31,11 @@ void renderer_start(ReaperRoot& root, VulkanBackend& backend, IWindow* window)
 
     log_debug(root, "imgui: upload fonts");
 
-    CommandBuffer& cmdBuffer = backend.resources->gfxCmdBuffer;
+    // No frame was recorded yet, the first context is free
+    FrameContext&  frame_context = backend.resources->frame_contexts[0];
+    CommandBuffer& cmdBuffer = frame_context.batch_cmd_buffers[FrameGraph::QueueType::Graphics][0];
 
-    AssertVk(vkResetCommandPool(backend.device, backend.resources->gfxCommandPool, VK_FLAGS_NONE));
+    AssertVk(vkResetCommandPool(backend.device, frame_context.gfx_command_pool, VK_FLAGS_NONE));
 
     const VkCommandBufferBeginInfo cmdBufferBeginInfo = {.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
                                                          .pNext = nullptr,
@@ -105,14 +107,14 @@ void renderer_execute_frame(ReaperRoot& root, const SceneGraph& scene, std::vect
         build_renderer_perspective_projection(viewport.aspect_ratio, near_plane_distance, far_plane_distance,
                                               half_fov_horizontal_radian, MainPassUseReverseZ);
 
-    const glm::fmat4x3 main_camera_transform = get_scene_node_transform_slow(scene.camera_node);
+    const glm::fmat4x3 main_camera_transform = get_scene_node_transform(scene, scene.camera_node);
 
     const RendererPerspectiveCamera main_camera =
         build_renderer_perspective_camera(main_camera_transform, perspective_projection, viewport);
 
     PreparedData prepared;
     prepare_scene(scene, prepared, backend.resources->mesh_cache, main_camera,
-                  static_cast<u32>(audio_output.size() / 8));
+                  static_cast<u32>(audio_output.size() / 8), *root.job_system);
 
     prepared.debug_draw_commands = debug_draw_commands;
 
@@ -121,8 +123,7 @@ void renderer_execute_frame(ReaperRoot& root, const SceneGraph& scene, std::vect
 
     ImDrawData* imgui_draw_data = ImGui::GetDrawData();
 
-    backend_execute_frame(root, backend, backend.resources->gfxCmdBuffer, prepared, tiled_lighting_frame,
-                          *backend.resources, imgui_draw_data);
+    backend_execute_frame(root, backend, prepared, tiled_lighting_frame, *backend.resources, imgui_draw_data);
 
     if (false) // Re-enable when we're playing with GPU-based sound again
     {
@@ -7,8 +7,11 @@
 
 #pragma once
 
+#include <core/Assert.h>
 #include <core/Types.h>
 
+#include <glm/glm.hpp>
+
 namespace Reaper
 {
 struct MeshAlloc
@@ -19,24 +22,48 @@ struct MeshAlloc
 
     // Buffer offsets
     u32 index_offset;
-    u32 position_offset;
-    u32 attributes_offset;
+    u32 vertex_offset; // Shared by the position and attributes buffers
     u32 meshlet_offset;
 };
 
+// LODs go from the most detailed (LOD0) to the least detailed one.
 struct Mesh2
 {
     u32 lod_count;
 
     static constexpr u32 MAX_MESH_LODS = 4;
     MeshAlloc            lods_allocs[MAX_MESH_LODS];
+    float                lods_error_ms[MAX_MESH_LODS]; // How far each LOD strays from LOD0, zero for LOD0
+
+    // Mesh space bounds, shared by all LODs
+    glm::fvec3 aabb_min_ms;
+    glm::fvec3 aabb_max_ms;
+    glm::fvec3 bounding_sphere_center_ms;
+    float      bounding_sphere_radius_ms;
 };
 
-inline Mesh2 create_mesh2(MeshAlloc alloc)
+// The bounding sphere is the one enclosing the AABB, it's not the tightest fit but it's cheap.
+inline Mesh2 create_mesh2(MeshAlloc alloc, glm::fvec3 aabb_min_ms, glm::fvec3 aabb_max_ms)
 {
     return {
-        1,
-        {alloc, {}, {}, {}},
+        .lod_count = 1,
+        .lods_allocs = {alloc, {}, {}, {}},
+        .lods_error_ms = {0.f, 0.f, 0.f, 0.f},
+        .aabb_min_ms = aabb_min_ms,
+        .aabb_max_ms = aabb_max_ms,
+        .bounding_sphere_center_ms = (aabb_min_ms + aabb_max_ms) * 0.5f,
+        .bounding_sphere_radius_ms = glm::length(aabb_max_ms - aabb_min_ms) * 0.5f,
     };
 }
+
+// Errors should never decrease from one LOD to the next.
+inline void add_mesh2_lod(Mesh2& mesh2, MeshAlloc alloc, float error_ms)
+{
+    Assert(mesh2.lod_count < Mesh2::MAX_MESH_LODS);
+    Assert(error_ms >= mesh2.lods_error_ms[mesh2.lod_count - 1]);
+
+    mesh2.lods_allocs[mesh2.lod_count] = alloc;
+    mesh2.lods_error_ms[mesh2.lod_count] = error_ms;
+    mesh2.lod_count += 1;
+}
 } // namespace Reaper
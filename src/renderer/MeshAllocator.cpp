@@ -0,0 +1,278 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include "MeshAllocator.h"
+
+#include <core/Assert.h>
+#include <profiling/Scope.h>
+
+#include <algorithm>
+#include <span>
+
+namespace Reaper
+{
+namespace
+{
+    u32& get_alloc_offset(MeshAlloc& alloc, MeshRange::Type range)
+    {
+        switch (range)
+        {
+        case MeshRange::Index:
+            return alloc.index_offset;
+        case MeshRange::Vertex:
+            return alloc.vertex_offset;
+        case MeshRange::Meshlet:
+            return alloc.meshlet_offset;
+        default:
+            AssertUnreachable();
+            return alloc.index_offset;
+        }
+    }
+
+    u32 get_alloc_count(const MeshAlloc& alloc, MeshRange::Type range)
+    {
+        switch (range)
+        {
+        case MeshRange::Index:
+            return alloc.index_count;
+        case MeshRange::Vertex:
+            return alloc.vertex_count;
+        case MeshRange::Meshlet:
+            return alloc.meshlet_count;
+        default:
+            AssertUnreachable();
+            return 0;
+        }
+    }
+
+    // Buffers that live in a range
+    std::span<const MeshCacheBuffer::Type> get_range_buffers(MeshRange::Type range)
+    {
+        static constexpr MeshCacheBuffer::Type IndexBuffers[] = {MeshCacheBuffer::Index};
+        static constexpr MeshCacheBuffer::Type VertexBuffers[] = {
+            MeshCacheBuffer::Position, MeshCacheBuffer::Attributes, MeshCacheBuffer::QuantizedPosition,
+            MeshCacheBuffer::QuantizedAttributes};
+        static constexpr MeshCacheBuffer::Type MeshletBuffers[] = {MeshCacheBuffer::Meshlet};
+
+        switch (range)
+        {
+        case MeshRange::Index:
+            return IndexBuffers;
+        case MeshRange::Vertex:
+            return VertexBuffers;
+        case MeshRange::Meshlet:
+            return MeshletBuffers;
+        default:
+            AssertUnreachable();
+            return {};
+        }
+    }
+
+    void retire_range(MeshAllocator& allocator, MeshRange::Type range, u32 offset, u32 count, u64 fence_value)
+    {
+        allocator.retired_ranges.push_back(RetiredMeshRange{
+            .range = range,
+            .offset = offset,
+            .count = count,
+            .fence_value = fence_value,
+        });
+    }
+
+    // Free slots are marked with a zero LOD count, live meshes always have at least one.
+    bool is_mesh_slot_live(const MeshAllocator& allocator, u32 mesh_index)
+    {
+        return allocator.mesh2_instances[mesh_index].lod_count > 0;
+    }
+} // namespace
+
+MeshAllocator create_mesh_allocator(u32 index_capacity, u32 vertex_capacity, u32 meshlet_capacity)
+{
+    MeshAllocator allocator = {};
+
+    allocator.range_allocators[MeshRange::Index] = create_range_allocator(index_capacity);
+    allocator.range_allocators[MeshRange::Vertex] = create_range_allocator(vertex_capacity);
+    allocator.range_allocators[MeshRange::Meshlet] = create_range_allocator(meshlet_capacity);
+
+    allocator.defrag_cursor = 0;
+
+    return allocator;
+}
+
+bool allocate_mesh_ranges(MeshAllocator& allocator, u32 index_count, u32 vertex_count, u32 meshlet_count,
+                          MeshAlloc& output_alloc)
+{
+    MeshAlloc alloc = {};
+    alloc.index_count = index_count;
+    alloc.vertex_count = vertex_count;
+    alloc.meshlet_count = meshlet_count;
+
+    for (u32 range_index = 0; range_index < MeshRange::Count; range_index++)
+    {
+        const auto range = static_cast<MeshRange::Type>(range_index);
+        const u32  count = get_alloc_count(alloc, range);
+
+        if (count == 0)
+            continue;
+
+        const u32 offset = range_allocate(allocator.range_allocators[range], count);
+
+        if (offset == InvalidRangeOffset)
+        {
+            // Roll back what we got so far
+            for (u32 previous_index = 0; previous_index < range_index; previous_index++)
+            {
+                const auto previous_range = static_cast<MeshRange::Type>(previous_index);
+                const u32  previous_count = get_alloc_count(alloc, previous_range);
+
+                if (previous_count > 0)
+                {
+                    range_free(allocator.range_allocators[previous_range], get_alloc_offset(alloc, previous_range),
+                               previous_count);
+                }
+            }
+
+            return false;
+        }
+
+        get_alloc_offset(alloc, range) = offset;
+    }
+
+    output_alloc = alloc;
+
+    return true;
+}
+
+MeshHandle insert_mesh2(MeshAllocator& allocator, const Mesh2& mesh2)
+{
+    Assert(mesh2.lod_count > 0);
+
+    u32 mesh_index;
+
+    if (!allocator.free_mesh_indices.empty())
+    {
+        mesh_index = allocator.free_mesh_indices.back();
+        allocator.free_mesh_indices.pop_back();
+    }
+    else
+    {
+        mesh_index = static_cast<u32>(allocator.mesh2_instances.size());
+
+        Assert(mesh_index < MeshHandleIndexMask, "too many meshes");
+
+        allocator.mesh2_instances.emplace_back();
+        allocator.mesh_generations.push_back(0);
+    }
+
+    allocator.mesh2_instances[mesh_index] = mesh2;
+
+    return make_mesh_handle(mesh_index, allocator.mesh_generations[mesh_index]);
+}
+
+void remove_mesh2(MeshAllocator& allocator, MeshHandle handle, u64 fence_value)
+{
+    Assert(is_mesh_handle_valid(allocator, handle), "stale or invalid mesh handle");
+
+    const u32 mesh_index = get_mesh_handle_index(handle);
+    Mesh2&    mesh2 = allocator.mesh2_instances[mesh_index];
+
+    for (u32 lod_index = 0; lod_index < mesh2.lod_count; lod_index++)
+    {
+        MeshAlloc& alloc = mesh2.lods_allocs[lod_index];
+
+        for (u32 range_index = 0; range_index < MeshRange::Count; range_index++)
+        {
+            const auto range = static_cast<MeshRange::Type>(range_index);
+            const u32  count = get_alloc_count(alloc, range);
+
+            if (count > 0)
+                retire_range(allocator, range, get_alloc_offset(alloc, range), count, fence_value);
+        }
+    }
+
+    mesh2.lod_count = 0;
+
+    allocator.mesh_generations[mesh_index] = (allocator.mesh_generations[mesh_index] + 1) & MeshHandleGenerationMask;
+    allocator.free_mesh_indices.push_back(mesh_index);
+}
+
+bool is_mesh_handle_valid(const MeshAllocator& allocator, MeshHandle handle)
+{
+    const u32 mesh_index = get_mesh_handle_index(handle);
+
+    return handle != InvalidMeshHandle && mesh_index < allocator.mesh_generations.size()
+           && allocator.mesh_generations[mesh_index] == get_mesh_handle_generation(handle)
+           && is_mesh_slot_live(allocator, mesh_index);
+}
+
+void release_retired_mesh_ranges(MeshAllocator& allocator, u64 completed_fence_value)
+{
+    std::erase_if(allocator.retired_ranges, [&allocator, completed_fence_value](const RetiredMeshRange& range) {
+        if (range.fence_value > completed_fence_value)
+            return false;
+
+        range_free(allocator.range_allocators[range.range], range.offset, range.count);
+
+        return true;
+    });
+}
+
+void defragment_mesh_allocator(MeshAllocator& allocator, u32 max_mesh_count, u64 fence_value,
+                               std::vector<MeshRangeMove>& output_moves)
+{
+    REAPER_PROFILE_SCOPE_FUNC();
+
+    const u32 slot_count = static_cast<u32>(allocator.mesh2_instances.size());
+    const u32 visit_count = std::min(max_mesh_count, slot_count);
+
+    for (u32 visit_index = 0; visit_index < visit_count; visit_index++)
+    {
+        const u32 mesh_index = allocator.defrag_cursor % slot_count;
+
+        allocator.defrag_cursor = (mesh_index + 1) % slot_count;
+
+        if (!is_mesh_slot_live(allocator, mesh_index))
+            continue;
+
+        Mesh2& mesh2 = allocator.mesh2_instances[mesh_index];
+
+        for (u32 lod_index = 0; lod_index < mesh2.lod_count; lod_index++)
+        {
+            MeshAlloc& alloc = mesh2.lods_allocs[lod_index];
+
+            for (u32 range_index = 0; range_index < MeshRange::Count; range_index++)
+            {
+                const auto range = static_cast<MeshRange::Type>(range_index);
+                const u32  count = get_alloc_count(alloc, range);
+                u32&       offset = get_alloc_offset(alloc, range);
+
+                if (count == 0)
+                    continue;
+
+                // The old range is still allocated, so the new one can't overlap with it.
+                const u32 new_offset = range_allocate_lowest(allocator.range_allocators[range], count, offset);
+
+                if (new_offset == InvalidRangeOffset)
+                    continue;
+
+                for (MeshCacheBuffer::Type buffer : get_range_buffers(range))
+                {
+                    output_moves.push_back(MeshRangeMove{
+                        .buffer = buffer,
+                        .src_offset = offset,
+                        .dst_offset = new_offset,
+                        .count = count,
+                    });
+                }
+
+                retire_range(allocator, range, offset, count, fence_value);
+
+                offset = new_offset;
+            }
+        }
+    }
+}
+} // namespace Reaper
@@ -0,0 +1,111 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "renderer/Mesh2.h"
+#include "renderer/RendererExport.h"
+#include "renderer/ResourceHandle.h"
+
+#include "core/Assert.h"
+#include "core/memory/RangeAllocator.h"
+
+#include <array>
+#include <vector>
+
+namespace Reaper
+{
+namespace MeshCacheBuffer
+{
+    enum Type : u32
+    {
+        Index,
+        Position,
+        Attributes,
+        QuantizedPosition,   // Only allocated with quantized vertices
+        QuantizedAttributes, // Only allocated with quantized vertices
+        Meshlet,
+        Count,
+    };
+}
+
+// All vertex buffers are indexed with the same vertex id, so they share a single range.
+namespace MeshRange
+{
+    enum Type : u32
+    {
+        Index,
+        Vertex,
+        Meshlet,
+        Count,
+    };
+}
+
+// Ranges of unloaded or moved meshes can still be read by frames in flight.
+// They only go back to the allocator once the matching fence value is reached.
+struct RetiredMeshRange
+{
+    MeshRange::Type range;
+    u32             offset;
+    u32             count;
+    u64             fence_value;
+};
+
+// CPU side bookkeeping of the mesh cache, offsets and counts are in elements of each buffer.
+struct MeshAllocator
+{
+    std::array<RangeAllocator, MeshRange::Count> range_allocators;
+
+    // Indexed with the handle index, free slots keep their last Mesh2 around.
+    std::vector<Mesh2> mesh2_instances;
+    std::vector<u32>   mesh_generations;
+    std::vector<u32>   free_mesh_indices;
+
+    std::vector<RetiredMeshRange> retired_ranges;
+
+    u32 defrag_cursor;
+};
+
+REAPER_RENDERER_API MeshAllocator create_mesh_allocator(u32 index_capacity, u32 vertex_capacity,
+                                                        u32 meshlet_capacity);
+
+// Returns false when one of the ranges is out of space, nothing is allocated in that case.
+REAPER_RENDERER_API bool allocate_mesh_ranges(MeshAllocator& allocator, u32 index_count, u32 vertex_count,
+                                              u32 meshlet_count, MeshAlloc& output_alloc);
+
+REAPER_RENDERER_API MeshHandle insert_mesh2(MeshAllocator& allocator, const Mesh2& mesh2);
+
+// The ranges of every LOD are retired with fence_value, and the handle becomes invalid right away.
+REAPER_RENDERER_API void remove_mesh2(MeshAllocator& allocator, MeshHandle handle, u64 fence_value);
+
+REAPER_RENDERER_API bool is_mesh_handle_valid(const MeshAllocator& allocator, MeshHandle handle);
+
+inline const Mesh2& get_mesh2(const MeshAllocator& allocator, MeshHandle handle)
+{
+    Assert(is_mesh_handle_valid(allocator, handle), "stale or invalid mesh handle");
+
+    return allocator.mesh2_instances[get_mesh_handle_index(handle)];
+}
+
+REAPER_RENDERER_API void release_retired_mesh_ranges(MeshAllocator& allocator, u64 completed_fence_value);
+
+struct MeshRangeMove
+{
+    MeshCacheBuffer::Type buffer;
+    u32                   src_offset;
+    u32                   dst_offset;
+    u32                   count;
+};
+
+// Moves the ranges of up to max_mesh_count meshes to the lowest free offsets that come before them.
+// The Mesh2 allocs are patched right away, the caller has to copy the data according to the output moves before
+// anything reads the new offsets. A moved vertex range outputs one move per vertex buffer.
+// Source ranges are retired with fence_value.
+// Consecutive calls go over all meshes in a round-robin fashion.
+REAPER_RENDERER_API void defragment_mesh_allocator(MeshAllocator& allocator, u32 max_mesh_count, u64 fence_value,
+                                                   std::vector<MeshRangeMove>& output_moves);
+} // namespace Reaper
@@ -0,0 +1,144 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include "MeshQuantization.h"
+
+#include <core/Assert.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Reaper
+{
+namespace
+{
+    constexpr u32 PositionBitsPerChannel = 16;
+    constexpr u32 NormalBitsPerChannel = 16;
+    constexpr u32 TangentBitsPerChannel = 15;
+    constexpr u32 TangentSignBit = 31;
+
+    float get_unorm_max_value(u32 bits_per_channel)
+    {
+        return static_cast<float>((1u << bits_per_channel) - 1);
+    }
+
+    // Same convention as lib/format/unorm.hlsl, except that we round to nearest
+    u32 float_to_unorm(float value, u32 bits_per_channel)
+    {
+        return static_cast<u32>(std::round(std::clamp(value, 0.f, 1.f) * get_unorm_max_value(bits_per_channel)));
+    }
+
+    float unorm_to_float(u32 value, u32 bits_per_channel)
+    {
+        const u32 mask = (1u << bits_per_channel) - 1;
+
+        return static_cast<float>(value & mask) / get_unorm_max_value(bits_per_channel);
+    }
+
+    // Same convention as lib/format/snorm.hlsl, zero is NOT exactly representable
+    u32 float_to_snorm(float value, u32 bits_per_channel)
+    {
+        return float_to_unorm(value * 0.5f + 0.5f, bits_per_channel);
+    }
+
+    float snorm_to_float(u32 value, u32 bits_per_channel)
+    {
+        return unorm_to_float(value, bits_per_channel) * 2.f - 1.f;
+    }
+
+    float sign_not_zero(float value)
+    {
+        return value >= 0.f ? 1.f : -1.f;
+    }
+
+    float quantize_in_range(float value, float range_min, float range_max)
+    {
+        const float extent = range_max - range_min;
+
+        return extent > 0.f ? (value - range_min) / extent : 0.f;
+    }
+} // namespace
+
+QuantizedPosition quantize_position(glm::fvec3 position_ms, glm::fvec3 aabb_min_ms, glm::fvec3 aabb_max_ms)
+{
+    return QuantizedPosition{
+        .x = static_cast<u16>(
+            float_to_unorm(quantize_in_range(position_ms.x, aabb_min_ms.x, aabb_max_ms.x), PositionBitsPerChannel)),
+        .y = static_cast<u16>(
+            float_to_unorm(quantize_in_range(position_ms.y, aabb_min_ms.y, aabb_max_ms.y), PositionBitsPerChannel)),
+        .z = static_cast<u16>(
+            float_to_unorm(quantize_in_range(position_ms.z, aabb_min_ms.z, aabb_max_ms.z), PositionBitsPerChannel)),
+    };
+}
+
+glm::fvec3 dequantize_position(QuantizedPosition position, glm::fvec3 aabb_min_ms, glm::fvec3 aabb_max_ms)
+{
+    const glm::fvec3 position_unorm = glm::fvec3(unorm_to_float(position.x, PositionBitsPerChannel),
+                                                 unorm_to_float(position.y, PositionBitsPerChannel),
+                                                 unorm_to_float(position.z, PositionBitsPerChannel));
+
+    // Same as the shader side, see pull_position_quantized()
+    return aabb_min_ms + position_unorm * (aabb_max_ms - aabb_min_ms);
+}
+
+u32 encode_unit_vector_oct_snorm(glm::fvec3 unit_vector, u32 bits_per_channel)
+{
+    Assert(bits_per_channel <= 16);
+
+    const glm::fvec3 v = unit_vector / (std::abs(unit_vector.x) + std::abs(unit_vector.y) + std::abs(unit_vector.z));
+
+    glm::fvec2 encoded = glm::fvec2(v.x, v.y);
+
+    // Fold the lower hemisphere over the diagonals
+    if (v.z < 0.f)
+    {
+        encoded = glm::fvec2((1.f - std::abs(v.y)) * sign_not_zero(v.x), (1.f - std::abs(v.x)) * sign_not_zero(v.y));
+    }
+
+    return float_to_snorm(encoded.x, bits_per_channel)
+           | float_to_snorm(encoded.y, bits_per_channel) << bits_per_channel;
+}
+
+glm::fvec3 decode_unit_vector_oct_snorm(u32 encoded, u32 bits_per_channel)
+{
+    const float x = snorm_to_float(encoded, bits_per_channel);
+    const float y = snorm_to_float(encoded >> bits_per_channel, bits_per_channel);
+
+    glm::fvec3 v = glm::fvec3(x, y, 1.f - std::abs(x) - std::abs(y));
+
+    const float t = std::max(-v.z, 0.f);
+
+    v.x += v.x >= 0.f ? -t : t;
+    v.y += v.y >= 0.f ? -t : t;
+
+    return glm::normalize(v);
+}
+
+QuantizedVertexAttributes quantize_vertex_attributes(const VertexAttributes& attributes)
+{
+    const glm::fvec3 tangent = glm::fvec3(attributes.tangent);
+    const u32        bitangent_sign_bit = attributes.tangent.w < 0.f ? 1u << TangentSignBit : 0u;
+
+    return QuantizedVertexAttributes{
+        .normal_oct_snorm16 = encode_unit_vector_oct_snorm(attributes.normal, NormalBitsPerChannel),
+        .tangent_oct_snorm15_sign = encode_unit_vector_oct_snorm(tangent, TangentBitsPerChannel) | bitangent_sign_bit,
+        .uv_half2 = glm::packHalf2x16(attributes.uv),
+    };
+}
+
+VertexAttributes dequantize_vertex_attributes(const QuantizedVertexAttributes& attributes)
+{
+    const float bitangent_sign = (attributes.tangent_oct_snorm15_sign >> TangentSignBit) != 0 ? -1.f : 1.f;
+
+    return VertexAttributes{
+        .normal = decode_unit_vector_oct_snorm(attributes.normal_oct_snorm16, NormalBitsPerChannel),
+        .uv = glm::unpackHalf2x16(attributes.uv_half2),
+        .tangent = glm::fvec4(decode_unit_vector_oct_snorm(attributes.tangent_oct_snorm15_sign, TangentBitsPerChannel),
+                              bitangent_sign),
+    };
+}
+} // namespace Reaper
@@ -0,0 +1,57 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "renderer/RendererExport.h"
+
+#include <core/Types.h>
+
+#include "mesh/Mesh.h"
+
+#include <glm/glm.hpp>
+
+// Compressed vertex streams, uploaded to the mesh cache when Backend::Options::enable_quantized_vertices is set.
+// The vis-buffer and shadow passes decode them with the *_quantized() helpers of lib/vertex_pull.hlsl.
+namespace Reaper
+{
+// unorm16 in the mesh AABB. Shaders get back to mesh space with aabb_min_ms + position * (aabb_max_ms - aabb_min_ms).
+struct QuantizedPosition
+{
+    u16 x;
+    u16 y;
+    u16 z;
+    u16 _pad0 = 0;
+};
+
+static_assert(sizeof(QuantizedPosition) == 8);
+
+// Octahedral normal and tangent, half float UVs
+struct QuantizedVertexAttributes
+{
+    u32 normal_oct_snorm16;
+    u32 tangent_oct_snorm15_sign; // Bitangent sign in the top bit
+    u32 uv_half2;
+};
+
+static_assert(sizeof(QuantizedVertexAttributes) == 12);
+
+REAPER_RENDERER_API QuantizedPosition quantize_position(glm::fvec3 position_ms, glm::fvec3 aabb_min_ms,
+                                                        glm::fvec3 aabb_max_ms);
+
+REAPER_RENDERER_API glm::fvec3 dequantize_position(QuantizedPosition position, glm::fvec3 aabb_min_ms,
+                                                   glm::fvec3 aabb_max_ms);
+
+// Octahedral encoding for unit vectors on the full sphere, same as encode_normal_octahedral_stubbe()
+REAPER_RENDERER_API u32 encode_unit_vector_oct_snorm(glm::fvec3 unit_vector, u32 bits_per_channel);
+
+REAPER_RENDERER_API glm::fvec3 decode_unit_vector_oct_snorm(u32 encoded, u32 bits_per_channel);
+
+REAPER_RENDERER_API QuantizedVertexAttributes quantize_vertex_attributes(const VertexAttributes& attributes);
+
+REAPER_RENDERER_API VertexAttributes dequantize_vertex_attributes(const QuantizedVertexAttributes& attributes);
+} // namespace Reaper
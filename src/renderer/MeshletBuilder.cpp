@@ -0,0 +1,202 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include "MeshletBuilder.h"
+
+#include "core/Assert.h"
+#include "core/jobs/JobSystem.h"
+#include "profiling/Scope.h"
+
+#include <meshoptimizer.h>
+
+#include <algorithm>
+
+namespace Reaper
+{
+namespace
+{
+    // Each LOD aims for half the triangles of the previous one
+    constexpr float LodTargetIndexRatio = 0.5f;
+    constexpr float LodMinIndexReductionRatio = 0.85f;
+    constexpr float LodMaxRelativeError = 0.05f;
+
+    void compute_mesh_aabb(const Mesh& mesh, glm::fvec3& aabb_min_ms, glm::fvec3& aabb_max_ms)
+    {
+        aabb_min_ms = mesh.positions[0];
+        aabb_max_ms = mesh.positions[0];
+
+        for (const glm::fvec3& position : mesh.positions)
+        {
+            aabb_min_ms = glm::min(aabb_min_ms, position);
+            aabb_max_ms = glm::max(aabb_max_ms, position);
+        }
+    }
+
+    // Indices point into the vertices of the input mesh, they don't have to be its own indices.
+    void build_meshlet_lod(const Mesh& mesh, std::span<const u32> indexes, MeshletLod& output)
+    {
+        Assert(!indexes.empty());
+
+        const size_t max_vertices = MeshletMaxTriangleCount * 3;
+        const size_t max_triangles = MeshletMaxTriangleCount;
+        const float  cone_weight = 0.5f; // FIXME fold in a constant
+
+        Assert(max_vertices < 256); // NOTE: u8 indices
+
+        size_t max_meshlets = meshopt_buildMeshletsBound(indexes.size(), max_vertices, max_triangles);
+
+        std::vector<meshopt_Meshlet> meshlets(max_meshlets);
+        std::vector<u32>             meshlet_vertices(max_meshlets * max_vertices);
+        std::vector<u8>              meshlet_indices(max_meshlets * max_triangles * 3);
+
+        size_t meshlet_count =
+            meshopt_buildMeshlets(meshlets.data(), meshlet_vertices.data(), meshlet_indices.data(), indexes.data(),
+                                  indexes.size(), &mesh.positions[0].x, mesh.positions.size(),
+                                  sizeof(mesh.positions[0]), max_vertices, max_triangles, cone_weight);
+
+        Assert(meshlet_count > 0);
+
+        const meshopt_Meshlet& last = meshlets[meshlet_count - 1];
+
+        meshlet_vertices.resize(last.vertex_offset + last.vertex_count);
+        meshlet_indices.resize(last.triangle_offset + last.triangle_count * 3);
+        meshlets.resize(meshlet_count);
+
+        const u32 meshlet_vertex_count = static_cast<u32>(meshlet_vertices.size());
+        const u32 total_mesh_index_count = static_cast<u32>(meshlet_indices.size());
+
+        Mesh&                 output_mesh = output.mesh;
+        std::vector<Meshlet>& output_meshlets = output.meshlets;
+
+        output.error_ms = 0.f;
+
+        output_mesh.indexes.resize(total_mesh_index_count);
+        output_mesh.positions.resize(meshlet_vertex_count);
+        output_mesh.attributes.resize(meshlet_vertex_count);
+        output_meshlets.resize(meshlet_count);
+
+        for (u32 i = 0; i < meshlet_vertex_count; i++)
+        {
+            const u32 index = meshlet_vertices[i];
+
+            output_mesh.positions[i] = mesh.positions[index];
+            output_mesh.attributes[i] = mesh.attributes[index];
+        }
+
+        u32 index_output_offset = 0;
+
+        // We also do index buffer compaction in the same pass
+        for (u32 meshlet_index = 0; meshlet_index < meshlets.size(); meshlet_index++)
+        {
+            const meshopt_Meshlet& meshlet = meshlets[meshlet_index];
+            const meshopt_Bounds   boundsMeshlet =
+                meshopt_computeMeshletBounds(&meshlet_vertices[meshlet.vertex_offset],
+                                             &meshlet_indices[meshlet.triangle_offset], meshlet.triangle_count,
+                                             &mesh.positions[0].x, mesh.positions.size(), sizeof(mesh.positions[0]));
+
+            const u32 meshlet_index_count = meshlet.triangle_count * 3;
+
+            Meshlet& meshlet_instance = output_meshlets[meshlet_index];
+            meshlet_instance.vertex_offset = meshlet.vertex_offset;
+            meshlet_instance.vertex_count = meshlet.vertex_count;
+            meshlet_instance.index_offset = index_output_offset;
+            meshlet_instance.index_count = meshlet_index_count;
+            meshlet_instance.center_ms =
+                glm::fvec3(boundsMeshlet.center[0], boundsMeshlet.center[1], boundsMeshlet.center[2]);
+            meshlet_instance.radius = boundsMeshlet.radius;
+            meshlet_instance.cone_axis_ms =
+                glm::fvec3(boundsMeshlet.cone_axis[0], boundsMeshlet.cone_axis[1], boundsMeshlet.cone_axis[2]);
+            meshlet_instance.cone_cutoff = boundsMeshlet.cone_cutoff;
+            meshlet_instance.cone_apex_ms =
+                glm::fvec3(boundsMeshlet.cone_apex[0], boundsMeshlet.cone_apex[1], boundsMeshlet.cone_apex[2]);
+
+            // Copy index buffer
+            for (u32 index = 0; index < meshlet_index_count; index++)
+            {
+                const u32 index_input_offset = meshlet.triangle_offset + index;
+
+                output_mesh.indexes[index_output_offset + index] =
+                    static_cast<u32>(meshlet_indices[index_input_offset]);
+            }
+
+            index_output_offset += meshlet_index_count;
+        }
+
+        output_mesh.indexes.resize(index_output_offset); // Trim excess
+    }
+} // namespace
+
+void build_meshlet_mesh(const Mesh& mesh, MeshletMesh& output)
+{
+    REAPER_PROFILE_SCOPE_FUNC();
+
+    Assert(!mesh.indexes.empty());
+    Assert(mesh.attributes.size() == mesh.positions.size());
+
+    output.lods.clear();
+
+    build_meshlet_lod(mesh, mesh.indexes, output.lods.emplace_back());
+
+    compute_mesh_aabb(output.lods[0].mesh, output.aabb_min_ms, output.aabb_max_ms);
+
+    // meshopt reports errors relative to the mesh extent
+    const float simplify_scale =
+        meshopt_simplifyScale(&mesh.positions[0].x, mesh.positions.size(), sizeof(mesh.positions[0]));
+
+    std::vector<u32> lod_indexes(mesh.indexes.size());
+    size_t           previous_index_count = mesh.indexes.size();
+
+    // Every LOD is simplified from the full mesh so errors are all relative to LOD0
+    while (output.lods.size() < Mesh2::MAX_MESH_LODS)
+    {
+        const size_t target_index_count = static_cast<size_t>(previous_index_count * LodTargetIndexRatio) / 3 * 3;
+        float        lod_error = 0.f;
+
+        const size_t lod_index_count =
+            meshopt_simplify(lod_indexes.data(), mesh.indexes.data(), mesh.indexes.size(), &mesh.positions[0].x,
+                             mesh.positions.size(), sizeof(mesh.positions[0]), target_index_count,
+                             LodMaxRelativeError, 0, &lod_error);
+
+        // The error budget or the topology won't let us go much further
+        if (lod_index_count == 0 || lod_index_count > previous_index_count * LodMinIndexReductionRatio)
+            break;
+
+        MeshletLod& lod = output.lods.emplace_back();
+
+        build_meshlet_lod(mesh, std::span(lod_indexes.data(), lod_index_count), lod);
+
+        // Keep errors monotonic, LOD selection relies on it
+        lod.error_ms = std::max(lod_error * simplify_scale, output.lods[output.lods.size() - 2].error_ms);
+
+        previous_index_count = lod_index_count;
+    }
+}
+
+void build_meshlet_meshes(std::span<const Mesh> meshes, std::span<MeshletMesh> outputs, JobSystem* job_system)
+{
+    REAPER_PROFILE_SCOPE_FUNC();
+
+    Assert(outputs.size() >= meshes.size());
+
+    const u32 mesh_count = static_cast<u32>(meshes.size());
+
+    // One job per mesh, each one writes to its own output
+    const auto build_job = [meshes, outputs](u32 mesh_index) {
+        build_meshlet_mesh(meshes[mesh_index], outputs[mesh_index]);
+    };
+
+    if (job_system != nullptr)
+    {
+        parallel_for(*job_system, mesh_count, build_job);
+    }
+    else
+    {
+        for (u32 mesh_index = 0; mesh_index < mesh_count; mesh_index++)
+            build_job(mesh_index);
+    }
+}
+} // namespace Reaper
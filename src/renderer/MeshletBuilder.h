@@ -0,0 +1,95 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "renderer/Mesh2.h"
+#include "renderer/RendererExport.h"
+
+#include "core/Assert.h"
+#include "mesh/Mesh.h"
+
+#include <span>
+#include <vector>
+
+#include "renderer/shader/meshlet/meshlet.share.hlsl"
+
+namespace Reaper
+{
+struct JobSystem;
+
+// Mesh data laid out the way the mesh cache expects it.
+// Vertices are duplicated for each meshlet that uses them, and indices are local to their meshlet.
+struct MeshletLod
+{
+    Mesh                 mesh;
+    std::vector<Meshlet> meshlets;
+    float                error_ms; // Deviation from LOD0 in mesh space units, see Mesh2::lods_error_ms
+};
+
+struct MeshletMesh
+{
+    std::vector<MeshletLod> lods; // LOD0 first, at most Mesh2::MAX_MESH_LODS
+
+    // Mesh space, shared by all LODs
+    glm::fvec3 aabb_min_ms;
+    glm::fvec3 aabb_max_ms;
+};
+
+// Same data without ownership, it can point to a mapped cooked mesh file for instance.
+struct MeshletLodView
+{
+    std::span<const u32>              indexes;
+    std::span<const glm::fvec3>       positions;
+    std::span<const VertexAttributes> attributes;
+    std::span<const Meshlet>          meshlets;
+    float                             error_ms;
+};
+
+struct MeshletMeshView
+{
+    u32            lod_count;
+    MeshletLodView lods[Mesh2::MAX_MESH_LODS];
+
+    glm::fvec3 aabb_min_ms;
+    glm::fvec3 aabb_max_ms;
+};
+
+inline MeshletMeshView get_meshlet_mesh_view(const MeshletMesh& meshlet_mesh)
+{
+    Assert(meshlet_mesh.lods.size() <= Mesh2::MAX_MESH_LODS);
+
+    MeshletMeshView view = {};
+    view.lod_count = static_cast<u32>(meshlet_mesh.lods.size());
+    view.aabb_min_ms = meshlet_mesh.aabb_min_ms;
+    view.aabb_max_ms = meshlet_mesh.aabb_max_ms;
+
+    for (u32 lod_index = 0; lod_index < view.lod_count; lod_index++)
+    {
+        const MeshletLod& lod = meshlet_mesh.lods[lod_index];
+
+        view.lods[lod_index] = MeshletLodView{
+            .indexes = lod.mesh.indexes,
+            .positions = lod.mesh.positions,
+            .attributes = lod.mesh.attributes,
+            .meshlets = lod.meshlets,
+            .error_ms = lod.error_ms,
+        };
+    }
+
+    return view;
+}
+
+// Builds LOD0 from the input mesh, then simplified LODs as long as the simplifier makes enough progress.
+// Only touches its arguments, so it's safe to call from any thread.
+REAPER_RENDERER_API void build_meshlet_mesh(const Mesh& mesh, MeshletMesh& output);
+
+// Calls build_meshlet_mesh() for every mesh, spread over the job system when there is one.
+// The output doesn't depend on the number of threads.
+REAPER_RENDERER_API void build_meshlet_meshes(std::span<const Mesh> meshes, std::span<MeshletMesh> outputs,
+                                              JobSystem* job_system);
+} // namespace Reaper
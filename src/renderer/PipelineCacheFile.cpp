@@ -0,0 +1,106 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include "PipelineCacheFile.h"
+
+#include "core/Hash.h"
+#include "profiling/Scope.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace Reaper
+{
+// The layout is part of the format, changing it means bumping PipelineCacheVersion
+static_assert(sizeof(PipelineCacheFileHeader) == 48);
+static_assert(sizeof(PipelineCacheHeaderVersionOne) == 32);
+
+namespace
+{
+    bool is_same_device(const PipelineCacheDeviceInfo& a, const PipelineCacheDeviceInfo& b)
+    {
+        return a.vendor_id == b.vendor_id && a.device_id == b.device_id && a.driver_version == b.driver_version
+               && memcmp(a.pipeline_cache_uuid, b.pipeline_cache_uuid, PipelineCacheUUIDSize) == 0;
+    }
+} // namespace
+
+bool is_pipeline_cache_data_compatible(std::span<const u8> cache_data, const PipelineCacheDeviceInfo& device_info)
+{
+    if (cache_data.size() < sizeof(PipelineCacheHeaderVersionOne))
+        return false;
+
+    PipelineCacheHeaderVersionOne header;
+    memcpy(&header, cache_data.data(), sizeof(header));
+
+    return header.header_size >= sizeof(PipelineCacheHeaderVersionOne) && header.header_size <= cache_data.size()
+           && header.header_version == PipelineCacheHeaderVersionOneValue && header.vendor_id == device_info.vendor_id
+           && header.device_id == device_info.device_id
+           && memcmp(header.pipeline_cache_uuid, device_info.pipeline_cache_uuid, PipelineCacheUUIDSize) == 0;
+}
+
+bool write_pipeline_cache_file(const std::string& file_path, const PipelineCacheDeviceInfo& device_info,
+                               std::span<const u8> cache_data)
+{
+    REAPER_PROFILE_SCOPE_FUNC();
+
+    PipelineCacheFileHeader header = {};
+    header.magic = PipelineCacheMagic;
+    header.version = PipelineCacheVersion;
+    header.device_info = device_info;
+    header.data_size_bytes = static_cast<u32>(cache_data.size());
+    header.data_hash = hash_bytes(HashSeed, cache_data.data(), cache_data.size());
+
+    std::ofstream output(file_path, std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if (!output.is_open())
+        return false;
+
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.write(reinterpret_cast<const char*>(cache_data.data()), static_cast<std::streamsize>(cache_data.size()));
+
+    return output.good();
+}
+
+bool read_pipeline_cache_file(const std::string& file_path, const PipelineCacheDeviceInfo& device_info,
+                              std::vector<u8>& output_cache_data)
+{
+    REAPER_PROFILE_SCOPE_FUNC();
+
+    output_cache_data.clear();
+
+    std::ifstream input(file_path, std::ios::in | std::ios::binary);
+
+    if (!input.is_open())
+        return false;
+
+    PipelineCacheFileHeader header;
+
+    if (!input.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        return false;
+
+    if (header.magic != PipelineCacheMagic || header.version != PipelineCacheVersion)
+        return false;
+
+    if (!is_same_device(header.device_info, device_info))
+        return false;
+
+    std::vector<u8> cache_data(header.data_size_bytes);
+
+    if (!input.read(reinterpret_cast<char*>(cache_data.data()), static_cast<std::streamsize>(cache_data.size())))
+        return false;
+
+    if (hash_bytes(HashSeed, cache_data.data(), cache_data.size()) != header.data_hash)
+        return false;
+
+    if (!is_pipeline_cache_data_compatible(cache_data, device_info))
+        return false;
+
+    output_cache_data = std::move(cache_data);
+
+    return true;
+}
+} // namespace Reaper
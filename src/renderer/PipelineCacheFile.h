@@ -0,0 +1,74 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "renderer/RendererExport.h"
+
+#include "core/Types.h"
+
+#include <span>
+#include <string>
+#include <vector>
+
+namespace Reaper
+{
+// On-disk copy of a VkPipelineCache.
+// Layout: PipelineCacheFileHeader then the blob returned by vkGetPipelineCacheData.
+// The blob already starts with the vendor, device and cache UUID of the driver that wrote it, the file header adds
+// the driver version so that a driver update drops the cache as well, and a hash to catch truncated files.
+static constexpr u32 PipelineCacheMagic = 0x43505352; // "RSPC"
+
+// Bump this when the layout changes, older files will be rejected.
+static constexpr u32 PipelineCacheVersion = 1;
+
+static constexpr u32 PipelineCacheUUIDSize = 16; // VK_UUID_SIZE
+
+// Mirrors VkPipelineCacheHeaderVersionOne, the first bytes of every pipeline cache blob.
+struct PipelineCacheHeaderVersionOne
+{
+    u32 header_size;
+    u32 header_version; // VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+    u32 vendor_id;
+    u32 device_id;
+    u8  pipeline_cache_uuid[PipelineCacheUUIDSize];
+};
+
+static constexpr u32 PipelineCacheHeaderVersionOneValue = 1;
+
+// Taken from VkPhysicalDeviceProperties.
+struct PipelineCacheDeviceInfo
+{
+    u32 vendor_id;
+    u32 device_id;
+    u32 driver_version;
+    u8  pipeline_cache_uuid[PipelineCacheUUIDSize];
+};
+
+struct PipelineCacheFileHeader
+{
+    u32                     magic;
+    u32                     version;
+    PipelineCacheDeviceInfo device_info;
+    u32                     data_size_bytes;
+    u64                     data_hash;
+};
+
+// Checks that the blob was written by the same device, the driver version isn't part of it.
+REAPER_RENDERER_API bool is_pipeline_cache_data_compatible(std::span<const u8>            cache_data,
+                                                           const PipelineCacheDeviceInfo& device_info);
+
+REAPER_RENDERER_API bool write_pipeline_cache_file(const std::string&             file_path,
+                                                   const PipelineCacheDeviceInfo& device_info,
+                                                   std::span<const u8>            cache_data);
+
+// Returns false when the file is missing, damaged, or was written by another device or driver version.
+// The cache should start empty in that case.
+REAPER_RENDERER_API bool read_pipeline_cache_file(const std::string&             file_path,
+                                                  const PipelineCacheDeviceInfo& device_info,
+                                                  std::vector<u8>&               output_cache_data);
+} // namespace Reaper
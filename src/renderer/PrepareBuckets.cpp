@@ -8,14 +8,18 @@
 #include "PrepareBuckets.h"
 
 #include "Camera.h"
+#include "Culling.h"
 
 #include "renderer/vulkan/MeshCache.h"
 #include "renderer/vulkan/renderpass/ShadowConstants.h"
 
 #include "profiling/Scope.h"
 
+#include <core/jobs/JobSystem.h>
+
 #include "math/Constants.h"
 
+#include <algorithm>
 #include <cmath>
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -62,37 +66,34 @@ namespace
     }
 } // namespace
 
-SceneNode* create_scene_node(SceneGraph& scene, glm::mat4x3 transform_matrix, SceneNode* parent_node)
+SceneNodeHandle create_scene_node(SceneGraph& scene, glm::mat4x3 transform_matrix, SceneNodeHandle parent_node)
 {
-    SceneNode* node = new SceneNode;
-    node->transform_matrix = transform_matrix;
-    node->parent = parent_node;
-
-    static_cast<void>(scene); // FIXME use for some kind of pool allocator?
-
-    return node;
+    return create_transform_node(scene.scene_nodes, transform_matrix, parent_node);
 }
 
-void destroy_scene_node(SceneGraph& scene, SceneNode* node)
+void destroy_scene_node(SceneGraph& scene, SceneNodeHandle node)
 {
-    static_cast<void>(scene); // FIXME use for some kind of pool allocator?
-
-    delete node;
+    destroy_transform_node(scene.scene_nodes, node);
 }
 
-glm::fmat4x3 get_scene_node_transform_slow(SceneNode* node)
+void set_scene_node_transform(SceneGraph& scene, SceneNodeHandle node, const glm::fmat4x3& transform_matrix)
 {
-    Assert(node != nullptr);
+    set_local_transform(scene.scene_nodes, node, transform_matrix);
+}
 
-    glm::fmat4x4 accum = node->transform_matrix;
+glm::fmat4x3 get_scene_node_local_transform(const SceneGraph& scene, SceneNodeHandle node)
+{
+    return get_local_transform(scene.scene_nodes, node);
+}
 
-    while (node->parent != nullptr)
-    {
-        accum = glm::fmat4(node->parent->transform_matrix) * accum;
-        node = node->parent;
-    }
+void update_scene_transforms(SceneGraph& scene)
+{
+    update_world_transforms(scene.scene_nodes);
+}
 
-    return accum;
+glm::fmat4x3 get_scene_node_transform(const SceneGraph& scene, SceneNodeHandle node)
+{
+    return get_world_transform(scene.scene_nodes, node);
 }
 
 namespace
@@ -107,75 +108,409 @@ namespace
         consts.meshlet_offset = mesh_alloc.meshlet_offset;
         consts.meshlet_count = mesh_alloc.meshlet_count;
         consts.first_index = mesh_alloc.index_offset;
-        consts.first_vertex = mesh_alloc.position_offset;
+        consts.first_vertex = mesh_alloc.vertex_offset;
         consts.cull_instance_offset = cull_instance_index_start;
 
         CullCmd& command = cull_pass.cull_commands.emplace_back();
         command.instance_count = cull_instance_count;
         command.push_constants = consts;
     }
+
+    // What a culling pass sees the scene from
+    struct CullPassView
+    {
+        glm::fmat4x3 ws_to_vs_matrix;
+        glm::fmat4   ws_to_cs_matrix;
+        glm::fvec3   position_ws;
+        float        lod_error_scale; // Pixels covered by one unit at a distance of one unit
+        float        max_lod_error_px;
+    };
+
+    CullPassView build_cull_pass_view(const glm::fmat4x3& ws_to_vs_matrix, const glm::fmat4& ws_to_cs_matrix,
+                                      glm::fvec2 output_size_ts, float max_lod_error_px)
+    {
+        const glm::fmat4 vs_to_ws_matrix = glm::inverse(glm::fmat4(ws_to_vs_matrix));
+        const glm::fmat4 vs_to_cs_matrix = ws_to_cs_matrix * vs_to_ws_matrix;
+
+        return CullPassView{
+            .ws_to_vs_matrix = ws_to_vs_matrix,
+            .ws_to_cs_matrix = ws_to_cs_matrix,
+            .position_ws = glm::fvec3(vs_to_ws_matrix[3]),
+            .lod_error_scale = 0.5f * output_size_ts.y * std::abs(vs_to_cs_matrix[1][1]),
+            .max_lod_error_px = max_lod_error_px,
+        };
+    }
+
+    // LOD errors are in mesh space, the bounding spheres tell us how much the instance is scaled.
+    // We measure the distance to the sphere instead of its center to stay conservative up close.
+    u32 select_mesh_lod(const CullPassView& view, const Mesh2& mesh2, glm::fvec3 center_ws, float radius_ws)
+    {
+        const float ms_to_ws_scale =
+            mesh2.bounding_sphere_radius_ms > 0.f ? radius_ws / mesh2.bounding_sphere_radius_ms : 1.f;
+        const float distance = std::max(glm::length(center_ws - view.position_ws) - radius_ws, 0.001f);
+        const float px_per_ms_unit = ms_to_ws_scale * view.lod_error_scale / distance;
+
+        u32 lod_index = 0;
+
+        while (lod_index + 1 < mesh2.lod_count
+               && mesh2.lods_error_ms[lod_index + 1] * px_per_ms_unit <= view.max_lod_error_px)
+        {
+            lod_index++;
+        }
+
+        return lod_index;
+    }
+
+    // The sort key groups instances by mesh first and LOD second
+    constexpr u32 MeshLodBits = 2;
+    static_assert(Mesh2::MAX_MESH_LODS <= (1u << MeshLodBits));
+    static_assert(MeshHandleIndexBits + MeshLodBits <= 32);
+
+    u32 make_mesh_lod_key(MeshHandle mesh_handle, u32 lod_index)
+    {
+        return (get_mesh_handle_index(mesh_handle) << MeshLodBits) | lod_index;
+    }
+
+    u32 get_mesh_lod_key_lod(u32 key)
+    {
+        return key & ((1u << MeshLodBits) - 1);
+    }
+
+    void build_mesh_lod_keys(const SceneGraph& scene, const MeshCache& mesh_cache, const CullPassView& view,
+                             const BoundingSpheres& bounding_spheres, std::span<const u32> mesh_indices,
+                             std::vector<u32>& keys)
+    {
+        REAPER_PROFILE_SCOPE_FUNC();
+
+        keys.resize(mesh_indices.size());
+
+        for (u32 i = 0; i < mesh_indices.size(); i++)
+        {
+            const u32        mesh_index = mesh_indices[i];
+            const MeshHandle mesh_handle = scene.scene_meshes[mesh_index].mesh_handle;
+            const glm::fvec3 center_ws = glm::fvec3(bounding_spheres.center_x[mesh_index],
+                                                    bounding_spheres.center_y[mesh_index],
+                                                    bounding_spheres.center_z[mesh_index]);
+
+            const u32 lod_index = select_mesh_lod(view, get_mesh2(mesh_cache, mesh_handle), center_ws,
+                                                  bounding_spheres.radius[mesh_index]);
+
+            keys[i] = make_mesh_lod_key(mesh_handle, lod_index);
+        }
+    }
+
+    CullMeshInstanceParams build_cull_instance(const CullPassView& view, const glm::fmat4x3& mesh_transform,
+                                               u32 instance_id)
+    {
+        const glm::mat4x3 ms_to_vs_matrix = glm::mat4(view.ws_to_vs_matrix) * glm::mat4(mesh_transform);
+        const glm::mat4x3 vs_to_ms_matrix = glm::inverse(glm::mat4(ms_to_vs_matrix));
+
+        CullMeshInstanceParams cull_instance;
+        cull_instance.ms_to_cs_matrix = view.ws_to_cs_matrix * glm::mat4(mesh_transform);
+        cull_instance.vs_to_ms_matrix_translate = vs_to_ms_matrix * glm::vec4(0.f, 0.f, 0.f, 1.f);
+        cull_instance.instance_id = instance_id;
+
+        return cull_instance;
+    }
+
+    // Stable LSD radix sort, 8 bits at a time. Passes above the highest key are skipped.
+    // Keys are sorted along with the mesh indices.
+    void sort_mesh_indices_by_key(std::vector<u32>& keys, std::vector<u32>& mesh_indices)
+    {
+        REAPER_PROFILE_SCOPE_FUNC();
+
+        Assert(keys.size() == mesh_indices.size());
+
+        const u32 mesh_index_count = static_cast<u32>(mesh_indices.size());
+
+        u32 max_key = 0;
+
+        for (u32 key : keys)
+            max_key = std::max(max_key, key);
+
+        std::vector<u32> sorted_keys(mesh_index_count);
+        std::vector<u32> sorted_mesh_indices(mesh_index_count);
+
+        constexpr u32 RadixBits = 8;
+        constexpr u32 BucketCount = 1 << RadixBits;
+
+        for (u32 shift = 0; shift < 32 && (max_key >> shift) != 0; shift += RadixBits)
+        {
+            u32 bucket_offsets[BucketCount] = {};
+
+            for (u32 key : keys)
+                bucket_offsets[(key >> shift) & (BucketCount - 1)] += 1;
+
+            u32 offset = 0;
+
+            for (u32& bucket_offset : bucket_offsets)
+            {
+                const u32 bucket_size = bucket_offset;
+                bucket_offset = offset;
+                offset += bucket_size;
+            }
+
+            for (u32 i = 0; i < mesh_index_count; i++)
+            {
+                const u32 output_index = bucket_offsets[(keys[i] >> shift) & (BucketCount - 1)]++;
+
+                sorted_keys[output_index] = keys[i];
+                sorted_mesh_indices[output_index] = mesh_indices[i];
+            }
+
+            std::swap(keys, sorted_keys);
+            std::swap(mesh_indices, sorted_mesh_indices);
+        }
+    }
+
+    // Instances are dispatched along Y, this is the minimum maxComputeWorkGroupCount[1] allowed by the spec.
+    constexpr u32 MaxInstancesPerCullCommand = 65535;
+
+    // Instances using the same mesh LOD are next to each other, they share a single command.
+    void insert_cull_commands(const SceneGraph& scene, const MeshCache& mesh_cache,
+                              std::span<const u32> sorted_mesh_indices, std::span<const u32> sorted_keys,
+                              CullPassData& cull_pass, u32 cull_instance_offset)
+    {
+        const u32 instance_count = static_cast<u32>(sorted_mesh_indices.size());
+
+        u32 run_start = 0;
+
+        while (run_start < instance_count)
+        {
+            const MeshHandle mesh_handle = scene.scene_meshes[sorted_mesh_indices[run_start]].mesh_handle;
+            const u32        key = sorted_keys[run_start];
+
+            u32 run_end = run_start + 1;
+
+            while (run_end < instance_count && run_end - run_start < MaxInstancesPerCullCommand
+                   && sorted_keys[run_end] == key)
+            {
+                run_end++;
+            }
+
+            const Mesh2&     mesh2 = get_mesh2(mesh_cache, mesh_handle);
+            const MeshAlloc& mesh_alloc = mesh2.lods_allocs[get_mesh_lod_key_lod(key)];
+
+            insert_cull_command(cull_pass, mesh_alloc, cull_instance_offset + run_start, run_end - run_start);
+
+            run_start = run_end;
+        }
+    }
+
+    // Instance ids index the per-pass instance arrays, so they are contiguous even when meshes get culled
+    void prepare_shadow_pass(const SceneGraph& scene, const MeshCache& mesh_cache, const CullPassView& view,
+                             std::span<const u32> visible_mesh_indices, std::span<const u32> visible_mesh_keys,
+                             CullPassData& cull_pass,
+                             std::span<ShadowMapInstanceParams> shadow_instances,
+                             std::span<CullMeshInstanceParams> cull_instances, u32 cull_instance_offset)
+    {
+        REAPER_PROFILE_SCOPE_FUNC();
+
+        for (u32 i = 0; i < visible_mesh_indices.size(); i++)
+        {
+            const SceneMesh&   scene_mesh = scene.scene_meshes[visible_mesh_indices[i]];
+            const glm::fmat4x3 mesh_transform = get_scene_node_transform(scene, scene_mesh.scene_node);
+            const Mesh2&       mesh2 = get_mesh2(mesh_cache, scene_mesh.mesh_handle);
+
+            cull_instances[i] = build_cull_instance(view, mesh_transform, i);
+
+            ShadowMapInstanceParams& shadow_instance = shadow_instances[i];
+            shadow_instance.ms_to_cs_matrix = cull_instances[i].ms_to_cs_matrix;
+            shadow_instance.position_dequantization_offset_ms = mesh2.aabb_min_ms;
+            shadow_instance.position_dequantization_scale_ms = mesh2.aabb_max_ms - mesh2.aabb_min_ms;
+        }
+
+        insert_cull_commands(scene, mesh_cache, visible_mesh_indices, visible_mesh_keys, cull_pass,
+                             cull_instance_offset);
+    }
+
+    void prepare_main_pass(const SceneGraph& scene, const MeshCache& mesh_cache, const CullPassView& view,
+                           std::span<const u32> visible_mesh_indices, std::span<const u32> visible_mesh_keys,
+                           CullPassData& cull_pass,
+                           std::span<MeshInstance> mesh_instances, std::span<CullMeshInstanceParams> cull_instances,
+                           u32 cull_instance_offset)
+    {
+        REAPER_PROFILE_SCOPE_FUNC();
+
+        for (u32 i = 0; i < visible_mesh_indices.size(); i++)
+        {
+            const SceneMesh&   scene_mesh = scene.scene_meshes[visible_mesh_indices[i]];
+            const glm::fmat4x3 mesh_transform = get_scene_node_transform(scene, scene_mesh.scene_node);
+            const Mesh2&       mesh2 = get_mesh2(mesh_cache, scene_mesh.mesh_handle);
+
+            // Assumption that our 3x3 submatrix is orthonormal (no skew/non-uniform scaling)
+            // FIXME use 4x3 matrices directly
+            const glm::mat4x3 ms_to_vs_matrix = glm::mat4(view.ws_to_vs_matrix) * glm::mat4(mesh_transform);
+
+            cull_instances[i] = build_cull_instance(view, mesh_transform, i);
+
+            MeshInstance& mesh_instance = mesh_instances[i];
+            mesh_instance.ms_to_cs_matrix = cull_instances[i].ms_to_cs_matrix;
+            mesh_instance.ms_to_ws_matrix = mesh_transform;
+            mesh_instance.normal_ms_to_vs_matrix = glm::mat3(ms_to_vs_matrix);
+            // Quantized positions are stored in the mesh AABB, see quantize_position()
+            mesh_instance.position_dequantization_offset_ms = mesh2.aabb_min_ms;
+            mesh_instance.position_dequantization_scale_ms = mesh2.aabb_max_ms - mesh2.aabb_min_ms;
+            mesh_instance.material_index = static_cast<u32>(scene_mesh.material_handle);
+        }
+
+        insert_cull_commands(scene, mesh_cache, visible_mesh_indices, visible_mesh_keys, cull_pass,
+                             cull_instance_offset);
+    }
 } // namespace
 
 void prepare_scene(const SceneGraph& scene, PreparedData& prepared, const MeshCache& mesh_cache,
-                   const RendererPerspectiveCamera& main_camera, u32 current_audio_frame)
+                   const RendererPerspectiveCamera& main_camera, u32 current_audio_frame, JobSystem& job_system)
 {
     REAPER_PROFILE_SCOPE_FUNC();
 
-    // Shadow pass
-    for (const auto& light : scene.scene_lights)
+    Assert(prepared.cull_passes.empty() && prepared.shadow_passes.empty(), "Prepared data should start empty");
+
+    std::vector<u32> shadow_light_indices;
+
+    for (u32 scene_light_index = 0; scene_light_index < scene.scene_lights.size(); scene_light_index++)
     {
-        if (light.shadow_map_size == glm::uvec2(0, 0))
-            continue;
+        if (scene.scene_lights[scene_light_index].shadow_map_size != glm::uvec2(0, 0))
+            shadow_light_indices.push_back(scene_light_index);
+    }
 
-        ShadowPassData& shadow_pass = prepared.shadow_passes.emplace_back();
-        shadow_pass.pass_index = static_cast<u32>(prepared.shadow_passes.size() - 1);
+    const u32 mesh_count = static_cast<u32>(scene.scene_meshes.size());
+    const u32 shadow_pass_count = static_cast<u32>(shadow_light_indices.size());
+    const u32 cull_pass_count = shadow_pass_count + 1;
 
-        shadow_pass.instance_offset = static_cast<u32>(prepared.shadow_instance_params.size());
+    std::vector<CullPassView> cull_pass_views(cull_pass_count);
 
-        CullPassData& cull_pass = prepared.cull_passes.emplace_back();
-        cull_pass.pass_index = static_cast<u32>(prepared.cull_passes.size() - 1);
+    prepared.shadow_passes.resize(shadow_pass_count);
+    prepared.cull_passes.resize(cull_pass_count);
+
+    for (u32 shadow_pass_index = 0; shadow_pass_index < shadow_pass_count; shadow_pass_index++)
+    {
+        const SceneLight& light = scene.scene_lights[shadow_light_indices[shadow_pass_index]];
+
+        // Shadow passes come first so they share their index with their culling pass
+        CullPassData& cull_pass = prepared.cull_passes[shadow_pass_index];
+        cull_pass.pass_index = shadow_pass_index;
         cull_pass.output_size_ts = glm::fvec2(light.shadow_map_size);
         cull_pass.main_pass = false;
 
+        ShadowPassData& shadow_pass = prepared.shadow_passes[shadow_pass_index];
+        shadow_pass.pass_index = shadow_pass_index;
         shadow_pass.culling_pass_index = cull_pass.pass_index;
         shadow_pass.shadow_map_size = light.shadow_map_size;
 
-        const glm::fmat4x3 light_transform = get_scene_node_transform_slow(light.scene_node);
+        const glm::fmat4x3 light_transform = get_scene_node_transform(scene, light.scene_node);
         const glm::fmat4x3 light_transform_inv = glm::inverse(glm::fmat4(light_transform));
-        const glm::fmat4   light_projection_matrix = default_light_projection_matrix();
-        const glm::fmat4   light_view_proj_matrix = light_projection_matrix * glm::mat4(light_transform_inv);
 
-        for (u32 i = 0; i < scene.scene_meshes.size(); i++)
-        {
-            const SceneMesh&   scene_mesh = scene.scene_meshes[i];
-            const glm::fmat4x3 mesh_transform = get_scene_node_transform_slow(scene_mesh.scene_node);
+        const glm::fmat4 light_ws_to_cs = default_light_projection_matrix() * glm::mat4(light_transform_inv);
+
+        cull_pass_views[shadow_pass_index] = build_cull_pass_view(
+            light_transform_inv, light_ws_to_cs, cull_pass.output_size_ts, scene.lod_settings.shadow_pass_max_error_px);
+    }
+
+    {
+        CullPassData& cull_pass = prepared.cull_passes[shadow_pass_count];
+        cull_pass.pass_index = shadow_pass_count;
+        cull_pass.output_size_ts = glm::fvec2(main_camera.viewport.extent);
+        cull_pass.main_pass = true;
 
-            ShadowMapInstanceParams& shadow_instance = prepared.shadow_instance_params.emplace_back();
-            shadow_instance.ms_to_cs_matrix = light_view_proj_matrix * glm::mat4(mesh_transform);
+        prepared.main_culling_pass_index = cull_pass.pass_index;
 
-            const u32               cull_instance_index = static_cast<u32>(prepared.cull_mesh_instance_params.size());
-            CullMeshInstanceParams& cull_instance = prepared.cull_mesh_instance_params.emplace_back();
+        cull_pass_views[shadow_pass_count] =
+            build_cull_pass_view(main_camera.ws_to_vs_matrix, main_camera.ws_to_cs_matrix, cull_pass.output_size_ts,
+                                 scene.lod_settings.main_pass_max_error_px);
+    }
 
-            cull_instance.ms_to_cs_matrix = shadow_instance.ms_to_cs_matrix;
+    // World space bounds are shared by all passes
+    BoundingSpheres bounding_spheres;
+    resize_bounding_spheres(bounding_spheres, mesh_count);
 
-            const glm::mat4x3 ms_to_vs_matrix = glm::mat4(light_transform_inv) * glm::mat4(mesh_transform);
-            const glm::mat4x3 vs_to_ms_matrix = glm::inverse(glm::mat4(ms_to_vs_matrix));
+    const u32 bounding_sphere_grain_size = 4096;
 
-            cull_instance.vs_to_ms_matrix_translate = vs_to_ms_matrix * glm::vec4(0.f, 0.f, 0.f, 1.f);
-            cull_instance.instance_id = i;
+    parallel_for(
+        job_system, mesh_count,
+        [&](u32 mesh_index) {
+            const SceneMesh& scene_mesh = scene.scene_meshes[mesh_index];
+            const Mesh2&     mesh2 = get_mesh2(mesh_cache, scene_mesh.mesh_handle);
 
-            const Mesh2&     mesh2 = mesh_cache.mesh2_instances[scene_mesh.mesh_handle];
-            const MeshAlloc& mesh_alloc = mesh2.lods_allocs[0];
+            set_bounding_sphere(bounding_spheres, mesh_index, get_scene_node_transform(scene, scene_mesh.scene_node),
+                                mesh2.bounding_sphere_center_ms, mesh2.bounding_sphere_radius_ms);
+        },
+        bounding_sphere_grain_size);
 
-            insert_cull_command(cull_pass, mesh_alloc, cull_instance_index, 1);
-        }
+    // Off-screen meshes don't get any instance or cull command
+    std::vector<std::vector<u32>> visible_mesh_indices(cull_pass_count);
+    std::vector<std::vector<u32>> visible_mesh_keys(cull_pass_count);
+
+    parallel_for(job_system, cull_pass_count, [&](u32 cull_pass_index) {
+        const CullPassView& view = cull_pass_views[cull_pass_index];
+        const Frustum       frustum = build_frustum(view.ws_to_cs_matrix);
+
+        visible_mesh_indices[cull_pass_index].reserve(mesh_count);
+
+        cull_bounding_spheres(frustum, bounding_spheres, visible_mesh_indices[cull_pass_index]);
+
+        build_mesh_lod_keys(scene, mesh_cache, view, bounding_spheres, visible_mesh_indices[cull_pass_index],
+                            visible_mesh_keys[cull_pass_index]);
+
+        // Group instances by mesh LOD so we can emit a single command per mesh LOD
+        sort_mesh_indices_by_key(visible_mesh_keys[cull_pass_index], visible_mesh_indices[cull_pass_index]);
+    });
+
+    // Every pass gets a fixed range in the output arrays, that way they can be filled in parallel and still end up
+    // exactly where a serial loop would have put them.
+    std::vector<u32> cull_instance_offsets(cull_pass_count);
+    u32              cull_instance_count = 0;
+    u32              shadow_instance_count = 0;
+
+    for (u32 cull_pass_index = 0; cull_pass_index < cull_pass_count; cull_pass_index++)
+    {
+        const u32 visible_mesh_count = static_cast<u32>(visible_mesh_indices[cull_pass_index].size());
+
+        cull_instance_offsets[cull_pass_index] = cull_instance_count;
+        cull_instance_count += visible_mesh_count;
+
+        if (cull_pass_index < shadow_pass_count)
+        {
+            ShadowPassData& shadow_pass = prepared.shadow_passes[cull_pass_index];
+            shadow_pass.instance_offset = shadow_instance_count;
+            shadow_pass.instance_count = visible_mesh_count;
 
-        // Count instances we just inserted
-        const u32 shadow_total_instance_count = static_cast<u32>(prepared.shadow_instance_params.size());
-        shadow_pass.instance_count = shadow_total_instance_count - shadow_pass.instance_offset;
+            shadow_instance_count += visible_mesh_count;
+        }
     }
 
-    // Main + culling pass
+    prepared.cull_mesh_instance_params.resize(cull_instance_count);
+    prepared.shadow_instance_params.resize(shadow_instance_count);
+    prepared.mesh_instances.resize(visible_mesh_indices[shadow_pass_count].size());
+
+    parallel_for(job_system, cull_pass_count, [&](u32 cull_pass_index) {
+        CullPassData&              cull_pass = prepared.cull_passes[cull_pass_index];
+        const CullPassView&        view = cull_pass_views[cull_pass_index];
+        const std::span<const u32> visible_indices = visible_mesh_indices[cull_pass_index];
+        const std::span<const u32> visible_keys = visible_mesh_keys[cull_pass_index];
+
+        const u32                         cull_instance_offset = cull_instance_offsets[cull_pass_index];
+        std::span<CullMeshInstanceParams> cull_instances = std::span(prepared.cull_mesh_instance_params)
+                                                               .subspan(cull_instance_offset, visible_indices.size());
+
+        if (cull_pass.main_pass)
+        {
+            prepare_main_pass(scene, mesh_cache, view, visible_indices, visible_keys, cull_pass,
+                              prepared.mesh_instances, cull_instances, cull_instance_offset);
+        }
+        else
+        {
+            const ShadowPassData& shadow_pass = prepared.shadow_passes[cull_pass_index];
+
+            std::span<ShadowMapInstanceParams> shadow_instances =
+                std::span(prepared.shadow_instance_params).subspan(shadow_pass.instance_offset, visible_indices.size());
+
+            prepare_shadow_pass(scene, mesh_cache, view, visible_indices, visible_keys, cull_pass, shadow_instances,
+                                cull_instances, cull_instance_offset);
+        }
+    });
+
+    // Forward pass and lights
     prepared.forward_pass_constants.ws_to_vs_matrix = main_camera.ws_to_vs_matrix;
     prepared.forward_pass_constants.ws_to_cs_matrix = main_camera.ws_to_cs_matrix;
     prepared.forward_pass_constants.point_light_count = static_cast<u32>(scene.scene_lights.size());
@@ -186,7 +521,7 @@ void prepare_scene(const SceneGraph& scene, PreparedData& prepared, const MeshCa
     for (u32 scene_light_index = 0; scene_light_index < scene.scene_lights.size(); scene_light_index++)
     {
         const SceneLight&  light = scene.scene_lights[scene_light_index];
-        const glm::fmat4x3 light_transform = get_scene_node_transform_slow(light.scene_node);
+        const glm::fmat4x3 light_transform = get_scene_node_transform(scene, light.scene_node);
         const glm::fmat4x3 light_transform_inv = glm::inverse(glm::fmat4(light_transform));
 
         const glm::vec3 light_position_ws = light_transform * glm::vec4(0.f, 0.f, 0.f, 1.0f);
@@ -209,58 +544,17 @@ void prepare_scene(const SceneGraph& scene, PreparedData& prepared, const MeshCa
         }
     }
 
-    {
-        CullPassData& cull_pass = prepared.cull_passes.emplace_back();
-        cull_pass.pass_index = static_cast<u32>(prepared.cull_passes.size() - 1);
-        cull_pass.output_size_ts = glm::fvec2(main_camera.viewport.extent);
-        cull_pass.main_pass = true;
-
-        prepared.main_culling_pass_index = cull_pass.pass_index;
+    prepared.mesh_materials.reserve(scene.scene_materials.size());
 
-        prepared.mesh_materials.reserve(scene.scene_materials.size());
-
-        for (u32 i = 0; i < scene.scene_materials.size(); i++)
-        {
-            const SceneMaterial& scene_material = scene.scene_materials[i];
-
-            MeshMaterial& mesh_material = prepared.mesh_materials.emplace_back();
-            mesh_material.albedo_texture_index = scene_material.base_color_texture;
-            mesh_material.roughness_texture_index = scene_material.metal_roughness_texture;
-            mesh_material.normal_texture_index = scene_material.normal_map_texture;
-            mesh_material.ao_texture_index = scene_material.ao_texture;
-        }
-
-        prepared.mesh_instances.reserve(scene.scene_meshes.size());
-
-        for (u32 i = 0; i < scene.scene_meshes.size(); i++)
-        {
-            const SceneMesh&   scene_mesh = scene.scene_meshes[i];
-            const glm::fmat4x3 mesh_transform = get_scene_node_transform_slow(scene_mesh.scene_node);
-
-            // Assumption that our 3x3 submatrix is orthonormal (no skew/non-uniform scaling)
-            // FIXME use 4x3 matrices directly
-            const glm::mat4x3 ms_to_vs_matrix = glm::mat4(main_camera.ws_to_vs_matrix) * glm::mat4(mesh_transform);
-
-            MeshInstance& mesh_instance = prepared.mesh_instances.emplace_back();
-            mesh_instance.ms_to_cs_matrix = main_camera.ws_to_cs_matrix * glm::mat4(mesh_transform);
-            mesh_instance.ms_to_ws_matrix = mesh_transform;
-            mesh_instance.normal_ms_to_vs_matrix = glm::mat3(ms_to_vs_matrix);
-            mesh_instance.material_index = static_cast<u32>(scene_mesh.material_handle);
-
-            const u32               cull_instance_index = static_cast<u32>(prepared.cull_mesh_instance_params.size());
-            CullMeshInstanceParams& cull_instance = prepared.cull_mesh_instance_params.emplace_back();
-
-            cull_instance.ms_to_cs_matrix = mesh_instance.ms_to_cs_matrix;
-
-            const glm::mat4x3 vs_to_ms_matrix = glm::inverse(glm::mat4(ms_to_vs_matrix));
-            cull_instance.vs_to_ms_matrix_translate = vs_to_ms_matrix * glm::vec4(0.f, 0.f, 0.f, 1.f);
-            cull_instance.instance_id = i;
-
-            const Mesh2&     mesh2 = mesh_cache.mesh2_instances[scene_mesh.mesh_handle];
-            const MeshAlloc& mesh_alloc = mesh2.lods_allocs[0];
+    for (u32 i = 0; i < scene.scene_materials.size(); i++)
+    {
+        const SceneMaterial& scene_material = scene.scene_materials[i];
 
-            insert_cull_command(cull_pass, mesh_alloc, cull_instance_index, 1);
-        }
+        MeshMaterial& mesh_material = prepared.mesh_materials.emplace_back();
+        mesh_material.albedo_texture_index = scene_material.base_color_texture;
+        mesh_material.roughness_texture_index = scene_material.metal_roughness_texture;
+        mesh_material.normal_texture_index = scene_material.normal_map_texture;
+        mesh_material.ao_texture_index = scene_material.ao_texture;
     }
 
     // Audio pass
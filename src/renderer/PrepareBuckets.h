@@ -12,6 +12,7 @@
 #include "renderer/Mesh2.h" // FIXME
 #include "renderer/RendererExport.h"
 #include "renderer/ResourceHandle.h"
+#include "renderer/TransformHierarchy.h"
 
 #include <span>
 #include <vector>
@@ -30,12 +31,6 @@
 
 namespace Reaper
 {
-struct SceneNode
-{
-    glm::fmat4x3 transform_matrix; // Local space to parent space
-    SceneNode*   parent = nullptr; // If no parent, parent space is world space
-};
-
 struct SceneMaterial
 {
     TextureHandle base_color_texture;
@@ -52,27 +47,37 @@ static constexpr SceneMaterialHandle InvalidSceneMaterialHandle = SceneMaterialH
 
 struct SceneMesh
 {
-    SceneNode*          scene_node;
+    SceneNodeHandle     scene_node;
     MeshHandle          mesh_handle;
     SceneMaterialHandle material_handle;
 };
 
 struct SceneLight
 {
-    glm::mat4  projection_matrix;
-    glm::vec3  color;
-    float      intensity;
-    float      radius;
-    SceneNode* scene_node;
-    glm::uvec2 shadow_map_size; // Set to zero to disable shadow
+    glm::mat4       projection_matrix;
+    glm::vec3       color;
+    float           intensity;
+    float           radius;
+    SceneNodeHandle scene_node;
+    glm::uvec2      shadow_map_size; // Set to zero to disable shadow
+};
+
+// Each instance gets the coarsest LOD whose projected error stays under the threshold of the pass.
+// Shadow maps are filtered and usually lower resolution, so they can get away with a coarser LOD.
+struct SceneLodSettings
+{
+    float main_pass_max_error_px = 1.f;
+    float shadow_pass_max_error_px = 4.f;
 };
 
 struct SceneGraph
 {
-    SceneNode*                 camera_node;
+    TransformHierarchy         scene_nodes;
+    SceneNodeHandle            camera_node;
     std::vector<SceneMesh>     scene_meshes;
     std::vector<SceneMaterial> scene_materials;
     std::vector<SceneLight>    scene_lights;
+    SceneLodSettings           lod_settings;
 };
 
 inline SceneMaterialHandle alloc_scene_material(SceneGraph& scene)
@@ -96,13 +101,23 @@ inline HandleSpan<SceneMaterialHandle> alloc_scene_materials(SceneGraph& scene,
     };
 }
 
-REAPER_RENDERER_API SceneNode* create_scene_node(SceneGraph& scene, glm::mat4x3 transform_matrix,
-                                                 SceneNode* parent_node = nullptr);
+// If no parent, parent space is world space
+REAPER_RENDERER_API SceneNodeHandle create_scene_node(SceneGraph& scene, glm::mat4x3 transform_matrix,
+                                                      SceneNodeHandle parent_node = InvalidSceneNodeHandle);
+
+REAPER_RENDERER_API void destroy_scene_node(SceneGraph& scene, SceneNodeHandle node);
+
+// Local space to parent space
+REAPER_RENDERER_API void set_scene_node_transform(SceneGraph& scene, SceneNodeHandle node,
+                                                  const glm::fmat4x3& transform_matrix);
+
+REAPER_RENDERER_API glm::fmat4x3 get_scene_node_local_transform(const SceneGraph& scene, SceneNodeHandle node);
 
-REAPER_RENDERER_API void destroy_scene_node(SceneGraph& scene, SceneNode* node);
+// Needs to be called after moving nodes and before rendering the scene
+REAPER_RENDERER_API void update_scene_transforms(SceneGraph& scene);
 
-// FIXME Support proper parenting with caching and disallow cycles!
-REAPER_RENDERER_API glm::fmat4x3 get_scene_node_transform_slow(SceneNode* node);
+// Local space to world space, this is a simple lookup
+REAPER_RENDERER_API glm::fmat4x3 get_scene_node_transform(const SceneGraph& scene, SceneNodeHandle node);
 
 struct CullCmd
 {
@@ -154,7 +169,10 @@ struct PreparedData
 
 struct MeshCache;
 struct RendererPerspectiveCamera;
+struct JobSystem;
 
+// Each culling pass is filled by its own job, the output is the same regardless of the worker count.
+REAPER_RENDERER_API
 void prepare_scene(const SceneGraph& scene, PreparedData& prepared, const MeshCache& mesh_cache,
-                   const RendererPerspectiveCamera& main_camera, u32 current_audio_frame);
+                   const RendererPerspectiveCamera& main_camera, u32 current_audio_frame, JobSystem& job_system);
 } // namespace Reaper
@@ -18,11 +18,31 @@ struct HandleSpan
     u32 count;
 };
 
+// Mesh handles pack a slot index with the generation of the slot, so handles to unloaded meshes can be caught.
 enum MeshHandle : u32
 {
 };
 static constexpr MeshHandle InvalidMeshHandle = MeshHandle(0xFFFFFFFF);
 
+static constexpr u32 MeshHandleIndexBits = 20;
+static constexpr u32 MeshHandleIndexMask = (1u << MeshHandleIndexBits) - 1;
+static constexpr u32 MeshHandleGenerationMask = (1u << (32 - MeshHandleIndexBits)) - 1;
+
+constexpr MeshHandle make_mesh_handle(u32 index, u32 generation)
+{
+    return MeshHandle(((generation & MeshHandleGenerationMask) << MeshHandleIndexBits) | (index & MeshHandleIndexMask));
+}
+
+constexpr u32 get_mesh_handle_index(MeshHandle handle)
+{
+    return handle & MeshHandleIndexMask;
+}
+
+constexpr u32 get_mesh_handle_generation(MeshHandle handle)
+{
+    return handle >> MeshHandleIndexBits;
+}
+
 enum TextureHandle : u32
 {
 };
@@ -0,0 +1,357 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include "ShaderPack.h"
+
+#include "core/Assert.h"
+#include "core/Hash.h"
+#include "profiling/Scope.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+
+namespace Reaper
+{
+// The layout is part of the format, changing it means bumping ShaderPackVersion
+static_assert(sizeof(ShaderPackFileHeader) == 48);
+static_assert(sizeof(ShaderPackEntry) == 24);
+
+namespace
+{
+    constexpr u32 InvalidSlot = 0xFFFFFFFF;
+
+    // Displacements are tried in order, a handful is usually enough
+    constexpr u32 MaxDisplacement = 1 << 24;
+
+    u64 align_offset(u64 offset)
+    {
+        return (offset + ShaderPackAlignment - 1) & ~(ShaderPackAlignment - 1);
+    }
+
+    u32 get_bucket_index(std::string_view name, u32 bucket_count)
+    {
+        return static_cast<u32>(hash_bytes(HashSeed, name.data(), name.size()) % bucket_count);
+    }
+
+    u32 get_slot_index(std::string_view name, u32 displacement, u32 slot_count)
+    {
+        const u64 seed = hash_value(HashSeed, displacement);
+
+        return static_cast<u32>(hash_bytes(seed, name.data(), name.size()) % slot_count);
+    }
+
+    // Hash and displace: the largest buckets are placed first, each one looks for a displacement that sends all of
+    // its names to free slots.
+    void build_perfect_hash(std::span<const std::string_view> names, std::vector<u32>& displacements,
+                            std::vector<u32>& slots)
+    {
+        const u32 entry_count = static_cast<u32>(names.size());
+        const u32 bucket_count = std::max(entry_count, 1u);
+
+        std::vector<std::vector<u32>> buckets(bucket_count);
+
+        for (u32 entry_index = 0; entry_index < entry_count; entry_index++)
+            buckets[get_bucket_index(names[entry_index], bucket_count)].push_back(entry_index);
+
+        std::vector<u32> bucket_order(bucket_count);
+        std::iota(bucket_order.begin(), bucket_order.end(), 0);
+        std::ranges::stable_sort(bucket_order,
+                                 [&buckets](u32 a, u32 b) { return buckets[a].size() > buckets[b].size(); });
+
+        displacements.assign(bucket_count, 0);
+        slots.assign(entry_count, InvalidSlot);
+
+        std::vector<u32> candidate_slots;
+
+        for (u32 bucket_index : bucket_order)
+        {
+            const std::vector<u32>& bucket = buckets[bucket_index];
+
+            if (bucket.empty())
+                break;
+
+            for (u32 displacement = 0;; displacement++)
+            {
+                Assert(displacement < MaxDisplacement, "could not build the shader pack hash table");
+
+                candidate_slots.clear();
+
+                for (u32 entry_index : bucket)
+                {
+                    const u32 slot_index = get_slot_index(names[entry_index], displacement, entry_count);
+
+                    if (slots[slot_index] != InvalidSlot || std::ranges::count(candidate_slots, slot_index) > 0)
+                        break;
+
+                    candidate_slots.push_back(slot_index);
+                }
+
+                if (candidate_slots.size() != bucket.size())
+                    continue;
+
+                for (u32 i = 0; i < bucket.size(); i++)
+                    slots[candidate_slots[i]] = bucket[i];
+
+                displacements[bucket_index] = displacement;
+                break;
+            }
+        }
+    }
+
+    void write_padding(std::ofstream& output, u64& offset_bytes, u64 target_offset_bytes)
+    {
+        Assert(target_offset_bytes >= offset_bytes);
+
+        const char zero = 0;
+
+        for (; offset_bytes < target_offset_bytes; offset_bytes++)
+            output.write(&zero, 1);
+    }
+
+    void write_bytes(std::ofstream& output, u64& offset_bytes, const void* data, u64 size_bytes)
+    {
+        output.write(static_cast<const char*>(data), static_cast<std::streamsize>(size_bytes));
+
+        offset_bytes += size_bytes;
+    }
+
+    template <typename T>
+    bool get_array_view(std::span<const u8> file_data, u64 offset_bytes, u32 count, std::span<const T>& output)
+    {
+        const u64 size_bytes = static_cast<u64>(count) * sizeof(T);
+
+        if (offset_bytes % ShaderPackAlignment != 0 || offset_bytes > file_data.size()
+            || size_bytes > file_data.size() - offset_bytes)
+        {
+            return false;
+        }
+
+        output = std::span(reinterpret_cast<const T*>(file_data.data() + offset_bytes), count);
+
+        return true;
+    }
+
+    bool is_range_valid(std::span<const u8> file_data, u64 offset_bytes, u64 size_bytes)
+    {
+        return offset_bytes <= file_data.size() && size_bytes <= file_data.size() - offset_bytes;
+    }
+
+    std::string_view get_entry_name(const ShaderPackView& view, const ShaderPackEntry& entry)
+    {
+        return std::string_view(view.names + entry.name_offset_bytes, entry.name_size_bytes);
+    }
+} // namespace
+
+bool write_shader_pack_file(const std::string& file_path, std::span<const ShaderPackSource> sources)
+{
+    REAPER_PROFILE_SCOPE_FUNC();
+
+    // Sorted entries keep the output deterministic
+    std::vector<const ShaderPackSource*> sorted_sources;
+
+    for (const ShaderPackSource& source : sources)
+        sorted_sources.push_back(&source);
+
+    std::ranges::sort(sorted_sources,
+                      [](const ShaderPackSource* a, const ShaderPackSource* b) { return a->name < b->name; });
+
+    std::vector<std::string_view> names;
+
+    for (const ShaderPackSource* source : sorted_sources)
+    {
+        Assert(names.empty() || names.back() != source->name, "duplicate shader name");
+        Assert(source->code.size() % sizeof(u32) == 0);
+
+        names.push_back(source->name);
+    }
+
+    std::vector<u32> displacements;
+    std::vector<u32> slots;
+
+    build_perfect_hash(names, displacements, slots);
+
+    ShaderPackFileHeader header = {
+        .magic = ShaderPackMagic,
+        .version = ShaderPackVersion,
+        .entry_count = static_cast<u32>(sorted_sources.size()),
+        .bucket_count = static_cast<u32>(displacements.size()),
+        .entries_offset_bytes = 0,
+        .displacements_offset_bytes = 0,
+        .slots_offset_bytes = 0,
+        .names_offset_bytes = 0,
+    };
+
+    // Compute the layout first so the table of contents can be written before the data
+    header.entries_offset_bytes = align_offset(sizeof(ShaderPackFileHeader));
+    header.displacements_offset_bytes =
+        align_offset(header.entries_offset_bytes + header.entry_count * sizeof(ShaderPackEntry));
+    header.slots_offset_bytes =
+        align_offset(header.displacements_offset_bytes + header.bucket_count * sizeof(u32));
+    header.names_offset_bytes = align_offset(header.slots_offset_bytes + header.entry_count * sizeof(u32));
+
+    std::vector<ShaderPackEntry> entries(sorted_sources.size());
+
+    u64 name_offset_bytes = 0;
+
+    for (u32 entry_index = 0; entry_index < entries.size(); entry_index++)
+    {
+        entries[entry_index].name_offset_bytes = static_cast<u32>(name_offset_bytes);
+        entries[entry_index].name_size_bytes = static_cast<u32>(names[entry_index].size());
+
+        name_offset_bytes += names[entry_index].size();
+    }
+
+    u64 offset_bytes = header.names_offset_bytes + name_offset_bytes;
+
+    for (u32 entry_index = 0; entry_index < entries.size(); entry_index++)
+    {
+        entries[entry_index].code_offset_bytes = align_offset(offset_bytes);
+        entries[entry_index].code_size_bytes = sorted_sources[entry_index]->code.size();
+
+        offset_bytes = entries[entry_index].code_offset_bytes + entries[entry_index].code_size_bytes;
+    }
+
+    // Written next to the destination then renamed over it, so a running renderer keeps its mapping of the old file
+    const std::string temp_file_path = file_path + ".tmp";
+
+    std::ofstream output(temp_file_path, std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if (!output.is_open())
+        return false;
+
+    offset_bytes = 0;
+
+    write_bytes(output, offset_bytes, &header, sizeof(header));
+
+    write_padding(output, offset_bytes, header.entries_offset_bytes);
+    write_bytes(output, offset_bytes, entries.data(), entries.size() * sizeof(ShaderPackEntry));
+
+    write_padding(output, offset_bytes, header.displacements_offset_bytes);
+    write_bytes(output, offset_bytes, displacements.data(), displacements.size() * sizeof(u32));
+
+    write_padding(output, offset_bytes, header.slots_offset_bytes);
+    write_bytes(output, offset_bytes, slots.data(), slots.size() * sizeof(u32));
+
+    write_padding(output, offset_bytes, header.names_offset_bytes);
+
+    for (std::string_view name : names)
+        write_bytes(output, offset_bytes, name.data(), name.size());
+
+    for (u32 entry_index = 0; entry_index < entries.size(); entry_index++)
+    {
+        const std::vector<char>& code = sorted_sources[entry_index]->code;
+
+        write_padding(output, offset_bytes, entries[entry_index].code_offset_bytes);
+        write_bytes(output, offset_bytes, code.data(), code.size());
+    }
+
+    output.close();
+
+    if (!output.good())
+        return false;
+
+    std::error_code error;
+    std::filesystem::rename(temp_file_path, file_path, error);
+
+    return !error;
+}
+
+bool get_shader_pack_view(std::span<const u8> file_data, ShaderPackView& output)
+{
+    if (file_data.size() < sizeof(ShaderPackFileHeader))
+        return false;
+
+    const ShaderPackFileHeader& header = *reinterpret_cast<const ShaderPackFileHeader*>(file_data.data());
+
+    if (header.magic != ShaderPackMagic || header.version != ShaderPackVersion)
+        return false;
+
+    if (header.bucket_count == 0 || header.names_offset_bytes > file_data.size())
+        return false;
+
+    ShaderPackView view = {
+        .file_data = file_data,
+        .entries = {},
+        .displacements = {},
+        .slots = {},
+        .names = reinterpret_cast<const char*>(file_data.data() + header.names_offset_bytes),
+    };
+
+    const bool is_valid =
+        get_array_view(file_data, header.entries_offset_bytes, header.entry_count, view.entries)
+        && get_array_view(file_data, header.displacements_offset_bytes, header.bucket_count, view.displacements)
+        && get_array_view(file_data, header.slots_offset_bytes, header.entry_count, view.slots);
+
+    if (!is_valid)
+        return false;
+
+    for (u32 slot : view.slots)
+    {
+        if (slot >= header.entry_count)
+            return false;
+    }
+
+    for (const ShaderPackEntry& entry : view.entries)
+    {
+        if (!is_range_valid(file_data, header.names_offset_bytes + entry.name_offset_bytes, entry.name_size_bytes))
+            return false;
+
+        if (entry.code_offset_bytes % ShaderPackAlignment != 0 || entry.code_size_bytes % sizeof(u32) != 0
+            || !is_range_valid(file_data, entry.code_offset_bytes, entry.code_size_bytes))
+        {
+            return false;
+        }
+    }
+
+    output = view;
+
+    return true;
+}
+
+u32 find_shader_pack_entry_index(const ShaderPackView& view, std::string_view name)
+{
+    if (view.entries.empty())
+        return ShaderPackInvalidEntryIndex;
+
+    const u32 bucket_index = get_bucket_index(name, static_cast<u32>(view.displacements.size()));
+    const u32 slot_index =
+        get_slot_index(name, view.displacements[bucket_index], static_cast<u32>(view.entries.size()));
+
+    const u32 entry_index = view.slots[slot_index];
+
+    // Names that aren't in the pack still land on some slot
+    if (get_entry_name(view, view.entries[entry_index]) != name)
+        return ShaderPackInvalidEntryIndex;
+
+    return entry_index;
+}
+
+std::span<const u32> get_shader_pack_entry_code(const ShaderPackView& view, u32 entry_index)
+{
+    const ShaderPackEntry& entry = view.entries[entry_index];
+    const u32*             code = reinterpret_cast<const u32*>(view.file_data.data() + entry.code_offset_bytes);
+
+    return std::span(code, entry.code_size_bytes / sizeof(u32));
+}
+
+std::span<const u32> find_shader_pack_code(const ShaderPackView& view, std::string_view name)
+{
+    const u32 entry_index = find_shader_pack_entry_index(view, name);
+
+    if (entry_index == ShaderPackInvalidEntryIndex)
+        return {};
+
+    return get_shader_pack_entry_code(view, entry_index);
+}
+
+std::string_view get_shader_pack_entry_name(const ShaderPackView& view, u32 entry_index)
+{
+    return get_entry_name(view, view.entries[entry_index]);
+}
+} // namespace Reaper
@@ -0,0 +1,87 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "renderer/RendererExport.h"
+
+#include "core/Types.h"
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Reaper
+{
+// Binary file holding every SPIR-V module of the renderer, written by the shader packer at build time.
+// Layout: ShaderPackFileHeader, entry_count ShaderPackEntry sorted by name, bucket_count displacements, entry_count
+// slots, the names, then the code of every module.
+// Lookups go through a minimal perfect hash: the name picks a bucket, the bucket displacement picks a slot, and the
+// slot holds the index of the entry. Code offsets are aligned to ShaderPackAlignment so a mapped file can be handed
+// to Vulkan in place.
+static constexpr u32 ShaderPackMagic = 0x56505352; // "RSPV"
+
+// Bump this when the layout changes, older files will be rejected.
+static constexpr u32 ShaderPackVersion = 1;
+
+static constexpr u64 ShaderPackAlignment = 64;
+
+static constexpr u32 ShaderPackInvalidEntryIndex = 0xFFFFFFFF;
+
+struct ShaderPackFileHeader
+{
+    u32 magic;
+    u32 version;
+    u32 entry_count;
+    u32 bucket_count;
+    u64 entries_offset_bytes;
+    u64 displacements_offset_bytes;
+    u64 slots_offset_bytes;
+    u64 names_offset_bytes;
+};
+
+struct ShaderPackEntry
+{
+    u32 name_offset_bytes; // From ShaderPackFileHeader::names_offset_bytes
+    u32 name_size_bytes;
+    u64 code_offset_bytes;
+    u64 code_size_bytes;
+};
+
+struct ShaderPackSource
+{
+    std::string       name; // Path relative to the shader output folder, with forward slashes
+    std::vector<char> code;
+};
+
+struct ShaderPackView
+{
+    std::span<const u8>              file_data;
+    std::span<const ShaderPackEntry> entries;
+    std::span<const u32>             displacements;
+    std::span<const u32>             slots;
+    const char*                      names;
+};
+
+// Names have to be unique and code sizes a multiple of 4 bytes.
+REAPER_RENDERER_API bool write_shader_pack_file(const std::string&                 file_path,
+                                                std::span<const ShaderPackSource> sources);
+
+// Validates the header and every entry, nothing is copied.
+// Returns false for files that are truncated or written by an older packer.
+REAPER_RENDERER_API bool get_shader_pack_view(std::span<const u8> file_data, ShaderPackView& output);
+
+// Points inside the file data, the span is empty when there is no module with this name.
+REAPER_RENDERER_API std::span<const u32> find_shader_pack_code(const ShaderPackView& view, std::string_view name);
+
+// Entries are indexed in [0, entries.size()), ShaderPackInvalidEntryIndex when there is no module with this name.
+REAPER_RENDERER_API u32 find_shader_pack_entry_index(const ShaderPackView& view, std::string_view name);
+
+REAPER_RENDERER_API std::span<const u32> get_shader_pack_entry_code(const ShaderPackView& view, u32 entry_index);
+REAPER_RENDERER_API std::string_view     get_shader_pack_entry_name(const ShaderPackView& view, u32 entry_index);
+} // namespace Reaper
@@ -0,0 +1,200 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include "TransformHierarchy.h"
+
+#include <core/Assert.h>
+#include <profiling/Scope.h>
+
+namespace Reaper
+{
+namespace
+{
+    u32 get_node_index(const TransformHierarchy& hierarchy, SceneNodeHandle handle)
+    {
+        Assert(handle < hierarchy.node_indices.size(), "Invalid scene node handle");
+
+        const u32 node_index = hierarchy.node_indices[handle];
+        Assert(node_index != InvalidTransformIndex, "Scene node was destroyed");
+
+        return node_index;
+    }
+
+    // Both transforms are affine, we can skip the last row of the 4x4 product
+    glm::fmat4x3 concatenate_transforms(const glm::fmat4x3& parent, const glm::fmat4x3& child)
+    {
+        const glm::fmat3 parent_rotation_scale = glm::fmat3(parent);
+
+        return glm::fmat4x3(parent_rotation_scale * child[0], parent_rotation_scale * child[1],
+                            parent_rotation_scale * child[2], parent_rotation_scale * child[3] + parent[3]);
+    }
+
+    // Remove destroyed nodes while keeping the parent-first order
+    void compact_transform_hierarchy(TransformHierarchy& hierarchy)
+    {
+        REAPER_PROFILE_SCOPE_FUNC();
+
+        const u32 node_count = static_cast<u32>(hierarchy.node_handles.size());
+
+        // Parents come first so their new index is always known when we reach their children
+        std::vector<u32> new_indices(node_count, InvalidTransformIndex);
+        u32              new_node_count = 0;
+
+        for (u32 node_index = 0; node_index < node_count; node_index++)
+        {
+            const SceneNodeHandle handle = hierarchy.node_handles[node_index];
+
+            if (handle == InvalidSceneNodeHandle)
+                continue;
+
+            const u32 parent_index = hierarchy.parent_indices[node_index];
+            const u32 new_index = new_node_count;
+
+            Assert(parent_index == InvalidTransformIndex || new_indices[parent_index] != InvalidTransformIndex,
+                   "Parent scene node was destroyed before its child");
+
+            hierarchy.parent_indices[new_index] =
+                parent_index == InvalidTransformIndex ? InvalidTransformIndex : new_indices[parent_index];
+            hierarchy.local_transforms[new_index] = hierarchy.local_transforms[node_index];
+            hierarchy.world_transforms[new_index] = hierarchy.world_transforms[node_index];
+            hierarchy.dirty_flags[new_index] = hierarchy.dirty_flags[node_index];
+            hierarchy.node_handles[new_index] = handle;
+            hierarchy.node_indices[handle] = new_index;
+
+            new_indices[node_index] = new_index;
+            new_node_count++;
+        }
+
+        hierarchy.parent_indices.resize(new_node_count);
+        hierarchy.local_transforms.resize(new_node_count);
+        hierarchy.world_transforms.resize(new_node_count);
+        hierarchy.dirty_flags.resize(new_node_count);
+        hierarchy.node_handles.resize(new_node_count);
+
+        hierarchy.destroyed_node_count = 0;
+    }
+} // namespace
+
+SceneNodeHandle create_transform_node(TransformHierarchy& hierarchy, const glm::fmat4x3& local_transform,
+                                      SceneNodeHandle parent_handle)
+{
+    SceneNodeHandle handle;
+
+    if (hierarchy.free_handles.empty())
+    {
+        handle = SceneNodeHandle(hierarchy.node_indices.size());
+        hierarchy.node_indices.push_back(InvalidTransformIndex);
+    }
+    else
+    {
+        handle = hierarchy.free_handles.back();
+        hierarchy.free_handles.pop_back();
+    }
+
+    // The parent already exists so appending keeps the parent-first order
+    const u32 parent_index =
+        parent_handle == InvalidSceneNodeHandle ? InvalidTransformIndex : get_node_index(hierarchy, parent_handle);
+    const u32 node_index = static_cast<u32>(hierarchy.node_handles.size());
+
+    hierarchy.parent_indices.push_back(parent_index);
+    hierarchy.local_transforms.push_back(local_transform);
+    hierarchy.world_transforms.push_back(local_transform);
+    hierarchy.dirty_flags.push_back(1);
+    hierarchy.node_handles.push_back(handle);
+
+    hierarchy.node_indices[handle] = node_index;
+    hierarchy.has_pending_changes = true;
+
+    return handle;
+}
+
+void destroy_transform_node(TransformHierarchy& hierarchy, SceneNodeHandle handle)
+{
+    const u32 node_index = get_node_index(hierarchy, handle);
+
+    // The slot is reclaimed during the next compaction
+    hierarchy.node_handles[node_index] = InvalidSceneNodeHandle;
+    hierarchy.dirty_flags[node_index] = 0;
+    hierarchy.node_indices[handle] = InvalidTransformIndex;
+    hierarchy.free_handles.push_back(handle);
+
+    hierarchy.destroyed_node_count += 1;
+    hierarchy.has_pending_changes = true;
+}
+
+void set_local_transform(TransformHierarchy& hierarchy, SceneNodeHandle handle, const glm::fmat4x3& local_transform)
+{
+    const u32 node_index = get_node_index(hierarchy, handle);
+
+    hierarchy.local_transforms[node_index] = local_transform;
+    hierarchy.dirty_flags[node_index] = 1;
+    hierarchy.has_pending_changes = true;
+}
+
+glm::fmat4x3 get_local_transform(const TransformHierarchy& hierarchy, SceneNodeHandle handle)
+{
+    return hierarchy.local_transforms[get_node_index(hierarchy, handle)];
+}
+
+void update_world_transforms(TransformHierarchy& hierarchy)
+{
+    REAPER_PROFILE_SCOPE_FUNC();
+
+    if (!hierarchy.has_pending_changes)
+        return;
+
+    const u32 node_count = static_cast<u32>(hierarchy.node_handles.size());
+
+    // Don't bother compacting for a handful of holes
+    if (hierarchy.destroyed_node_count * 2 > node_count)
+        compact_transform_hierarchy(hierarchy);
+
+    const u32 live_node_count = static_cast<u32>(hierarchy.node_handles.size());
+
+    // Dirtiness is pushed down to children as we go, parents are always up to date when we reach their children.
+    for (u32 node_index = 0; node_index < live_node_count; node_index++)
+    {
+        if (hierarchy.node_handles[node_index] == InvalidSceneNodeHandle)
+            continue;
+
+        const u32 parent_index = hierarchy.parent_indices[node_index];
+
+        if (parent_index == InvalidTransformIndex)
+        {
+            if (hierarchy.dirty_flags[node_index])
+                hierarchy.world_transforms[node_index] = hierarchy.local_transforms[node_index];
+        }
+        else
+        {
+            Assert(parent_index < node_index, "Scene node was stored before its parent");
+            Assert(hierarchy.node_handles[parent_index] != InvalidSceneNodeHandle,
+                   "Parent scene node was destroyed before its child");
+
+            hierarchy.dirty_flags[node_index] |= hierarchy.dirty_flags[parent_index];
+
+            if (hierarchy.dirty_flags[node_index])
+            {
+                hierarchy.world_transforms[node_index] = concatenate_transforms(
+                    hierarchy.world_transforms[parent_index], hierarchy.local_transforms[node_index]);
+            }
+        }
+    }
+
+    // Children read the flags of their parents so we can only clear them once everything is done
+    for (u32 node_index = 0; node_index < live_node_count; node_index++)
+        hierarchy.dirty_flags[node_index] = 0;
+
+    hierarchy.has_pending_changes = false;
+}
+
+glm::fmat4x3 get_world_transform(const TransformHierarchy& hierarchy, SceneNodeHandle handle)
+{
+    Assert(!hierarchy.has_pending_changes, "World transforms are out of date");
+
+    return hierarchy.world_transforms[get_node_index(hierarchy, handle)];
+}
+} // namespace Reaper
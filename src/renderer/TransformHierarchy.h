@@ -0,0 +1,66 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "renderer/RendererExport.h"
+
+#include <core/Types.h>
+
+#include <vector>
+
+namespace Reaper
+{
+enum SceneNodeHandle : u32
+{
+};
+
+static constexpr SceneNodeHandle InvalidSceneNodeHandle = SceneNodeHandle(0xFFFFFFFF);
+static constexpr u32             InvalidTransformIndex = 0xFFFFFFFF;
+
+// Structure-of-arrays transform hierarchy.
+// Parents always come before their children in the arrays, that way all world transforms can be computed in a
+// single linear pass. Handles stay valid when the arrays get compacted, they are only recycled once destroyed.
+struct TransformHierarchy
+{
+    // Indexed by node handle
+    std::vector<u32>             node_indices; // InvalidTransformIndex for free handles
+    std::vector<SceneNodeHandle> free_handles;
+
+    // Indexed by node index
+    std::vector<u32>             parent_indices;   // InvalidTransformIndex for root nodes
+    std::vector<glm::fmat4x3>    local_transforms; // Local space to parent space
+    std::vector<glm::fmat4x3>    world_transforms; // Local space to world space
+    std::vector<u8>              dirty_flags;      // Local transform changed since the last update
+    std::vector<SceneNodeHandle> node_handles;     // InvalidSceneNodeHandle for destroyed nodes
+
+    u32  destroyed_node_count;
+    bool has_pending_changes;
+};
+
+// The parent has to be alive for as long as the node is.
+REAPER_RENDERER_API
+SceneNodeHandle create_transform_node(TransformHierarchy& hierarchy, const glm::fmat4x3& local_transform,
+                                      SceneNodeHandle parent_handle = InvalidSceneNodeHandle);
+
+// Children have to be destroyed first.
+REAPER_RENDERER_API void destroy_transform_node(TransformHierarchy& hierarchy, SceneNodeHandle handle);
+
+REAPER_RENDERER_API
+void set_local_transform(TransformHierarchy& hierarchy, SceneNodeHandle handle, const glm::fmat4x3& local_transform);
+
+REAPER_RENDERER_API glm::fmat4x3 get_local_transform(const TransformHierarchy& hierarchy, SceneNodeHandle handle);
+
+// Compute world transforms of dirty nodes and their children, and compact the arrays if needed.
+// Call this once per frame after moving nodes around.
+REAPER_RENDERER_API void update_world_transforms(TransformHierarchy& hierarchy);
+
+// Only valid after update_world_transforms()
+REAPER_RENDERER_API glm::fmat4x3 get_world_transform(const TransformHierarchy& hierarchy, SceneNodeHandle handle);
+} // namespace Reaper
@@ -0,0 +1,186 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include "CompileCache.h"
+
+#include "FrameGraphBuilder.h"
+#include "ResourcePool.h"
+
+#include <core/Assert.h>
+#include <core/Hash.h>
+#include <profiling/Scope.h>
+
+namespace Reaper::FrameGraph
+{
+namespace
+{
+    u64 hash_resource_handle(u64 hash, ResourceHandle resource_handle)
+    {
+        hash = hash_value(hash, static_cast<u32>(resource_handle.index));
+        hash = hash_value(hash, static_cast<u32>(resource_handle.is_texture));
+
+        return hash;
+    }
+
+    u64 hash_resource_access(u64 hash, const GPUResourceAccess& access)
+    {
+        hash = hash_value(hash, access.stage_mask);
+        hash = hash_value(hash, access.access_mask);
+        hash = hash_value(hash, access.image_layout);
+
+        return hash;
+    }
+
+    // Works for passes, usages and resources
+    template <typename T>
+    void store_used_flags(std::vector<bool>& flags, const std::vector<T>& nodes)
+    {
+        flags.resize(nodes.size());
+
+        for (u32 index = 0; index < nodes.size(); index++)
+            flags[index] = nodes[index].is_used;
+    }
+
+    template <typename T>
+    void load_used_flags(const std::vector<bool>& flags, std::vector<T>& nodes)
+    {
+        Assert(flags.size() == nodes.size());
+
+        for (u32 index = 0; index < nodes.size(); index++)
+            nodes[index].is_used = flags[index];
+    }
+} // namespace
+
+u64 compute_topology_hash(const FrameGraph& framegraph)
+{
+    REAPER_PROFILE_SCOPE_FUNC();
+
+    u64 hash = HashSeed;
+
+    hash = hash_value(hash, framegraph.RenderPasses.size());
+
+    for (const RenderPass& render_pass : framegraph.RenderPasses)
+    {
+        hash = hash_value(hash, render_pass.has_side_effects);
+        hash = hash_value(hash, render_pass.queue_type);
+        hash = hash_value(hash, render_pass.ResourceUsageHandles.size());
+
+        for (ResourceUsageHandle usage_handle : render_pass.ResourceUsageHandles)
+            hash = hash_value(hash, usage_handle);
+    }
+
+    hash = hash_value(hash, framegraph.ResourceUsages.size());
+
+    for (const ResourceUsage& usage : framegraph.ResourceUsages)
+    {
+        hash = hash_value(hash, usage.type);
+        hash = hash_resource_handle(hash, usage.resource_handle);
+        hash = hash_value(hash, usage.render_pass);
+        hash = hash_value(hash, usage.parent_usage_handle);
+        hash = hash_resource_access(hash, usage.access);
+    }
+
+    hash = hash_value(hash, framegraph.TextureResources.size());
+
+    for (const Resource& resource : framegraph.TextureResources)
+        hash = hash_value(hash, hash_texture_properties(resource.properties.texture));
+
+    hash = hash_value(hash, framegraph.BufferResources.size());
+
+    for (const Resource& resource : framegraph.BufferResources)
+        hash = hash_value(hash, hash_buffer_properties(resource.properties.buffer));
+
+    return hash;
+}
+
+void invalidate_compile_cache(CompileCache& cache)
+{
+    cache.has_culling = false;
+    cache.has_order = false;
+    cache.has_barriers = false;
+}
+
+bool build_cached(CompileCache& cache, FrameGraph& framegraph)
+{
+    REAPER_PROFILE_SCOPE_FUNC();
+
+    const u64 topology_hash = compute_topology_hash(framegraph);
+
+    if (cache.has_culling && cache.topology_hash == topology_hash)
+    {
+        load_used_flags(cache.render_pass_used, framegraph.RenderPasses);
+        load_used_flags(cache.usage_used, framegraph.ResourceUsages);
+        load_used_flags(cache.texture_used, framegraph.TextureResources);
+        load_used_flags(cache.buffer_used, framegraph.BufferResources);
+
+        return true;
+    }
+
+    Builder builder(framegraph);
+    builder.build();
+
+    store_used_flags(cache.render_pass_used, framegraph.RenderPasses);
+    store_used_flags(cache.usage_used, framegraph.ResourceUsages);
+    store_used_flags(cache.texture_used, framegraph.TextureResources);
+    store_used_flags(cache.buffer_used, framegraph.BufferResources);
+
+    cache.topology_hash = topology_hash;
+    cache.has_culling = true;
+
+    // Everything that was computed from the previous culling is stale now
+    cache.has_order = false;
+    cache.has_barriers = false;
+
+    return false;
+}
+
+bool compute_schedule_order_cached(CompileCache& cache, const FrameGraph& framegraph, bool enable_async_compute)
+{
+    REAPER_PROFILE_SCOPE_FUNC();
+
+    Assert(cache.has_culling, "Build the frame graph first");
+
+    const u64 order_hash = hash_value(cache.topology_hash, enable_async_compute);
+
+    if (cache.has_order && cache.order_hash == order_hash)
+        return true;
+
+    compute_schedule_order(framegraph, cache.schedule, enable_async_compute);
+
+    cache.order_hash = order_hash;
+    cache.has_order = true;
+    cache.has_barriers = false;
+
+    return false;
+}
+
+bool compute_schedule_barriers_cached(CompileCache& cache, const FrameGraph& framegraph,
+                                      std::span<const ResourceAlias> aliases)
+{
+    REAPER_PROFILE_SCOPE_FUNC();
+
+    Assert(cache.has_order, "Compute the schedule order first");
+
+    u64 barriers_hash = hash_value(cache.order_hash, aliases.size());
+
+    for (const ResourceAlias& alias : aliases)
+    {
+        barriers_hash = hash_resource_handle(barriers_hash, alias.resource_handle);
+        barriers_hash = hash_resource_handle(barriers_hash, alias.previous_resource_handle);
+    }
+
+    if (cache.has_barriers && cache.barriers_hash == barriers_hash)
+        return true;
+
+    compute_schedule_barriers(framegraph, aliases, cache.schedule);
+
+    cache.barriers_hash = barriers_hash;
+    cache.has_barriers = true;
+
+    return false;
+}
+} // namespace Reaper::FrameGraph
@@ -0,0 +1,63 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "FrameGraph.h"
+
+#include <span>
+#include <vector>
+
+namespace Reaper::FrameGraph
+{
+// The frame graph is recorded again every frame, but most of the time it ends up exactly the same as the last one.
+// Compiling it only depends on its topology: passes, resource properties and accesses.
+// We keep the result of the last compilation around and skip all the work when the topology didn't change.
+struct CompileCache
+{
+    u64 topology_hash;
+    u64 order_hash;
+    u64 barriers_hash;
+
+    bool has_culling;
+    bool has_order;
+    bool has_barriers;
+
+    // Culling result, indexed by frame graph handles
+    std::vector<bool> render_pass_used;
+    std::vector<bool> usage_used;
+    std::vector<bool> texture_used;
+    std::vector<bool> buffer_used;
+
+    // Reused as-is across frames, don't keep a copy of it.
+    FrameGraphSchedule schedule;
+};
+
+// Views and debug names are left out, they are only read when recording commands.
+REAPER_RENDERER_API
+u64 compute_topology_hash(const FrameGraph& framegraph);
+
+// Forget everything, the next compilation will do all the work again.
+REAPER_RENDERER_API
+void invalidate_compile_cache(CompileCache& cache);
+
+// Same as Builder::build(), but the culling result is taken from the cache when the topology matches.
+// Returns true when the cache was hit.
+REAPER_RENDERER_API
+bool build_cached(CompileCache& cache, FrameGraph& framegraph);
+
+// Fills cache.schedule, the order is only computed again if the culling or the queue setup changed.
+// Returns true when the cache was hit.
+REAPER_RENDERER_API
+bool compute_schedule_order_cached(CompileCache& cache, const FrameGraph& framegraph, bool enable_async_compute);
+
+// Needs compute_schedule_order_cached() to be called first.
+// Returns true when the cache was hit.
+REAPER_RENDERER_API
+bool compute_schedule_barriers_cached(CompileCache& cache, const FrameGraph& framegraph,
+                                      std::span<const ResourceAlias> aliases);
+} // namespace Reaper::FrameGraph
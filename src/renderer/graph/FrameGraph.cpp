@@ -11,6 +11,7 @@
 #include <profiling/Scope.h>
 
 #include <algorithm>
+#include <iterator>
 
 namespace Reaper::FrameGraph
 {
@@ -28,6 +29,10 @@ namespace BarrierType
             return "SplitBegin";
         case BarrierType::SplitEnd:
             return "SplitEnd";
+        case BarrierType::QueueRelease:
+            return "QueueRelease";
+        case BarrierType::QueueAcquire:
+            return "QueueAcquire";
         default:
             AssertUnreachable();
             return "Invalid";
@@ -99,39 +104,49 @@ ResourceViewHandles allocate_buffer_views(FrameGraph& framegraph, std::span<cons
     };
 }
 
-namespace
+bool ComputeTopologicalOrder(const DirectedAcyclicGraph&                    graph,
+                             std::vector<DirectedAcyclicGraph::index_type>& outOrder)
 {
-    // Thibault S. (29/11/2017) Yep it's recursive.
-    bool HasCyclesRecursive(const DirectedAcyclicGraph&                    graph,
-                            DirectedAcyclicGraph::index_type               nodeIndex,
-                            std::vector<DirectedAcyclicGraph::index_type>& ancestors)
+    REAPER_PROFILE_SCOPE_FUNC();
+
+    const u32 nodeCount = get_node_count(graph);
+
+    std::vector<u32> inDegrees(nodeCount, 0);
+
+    for (const auto& childNodeIndex : graph.Children)
+        inDegrees[childNodeIndex] += 1;
+
+    outOrder.clear();
+    outOrder.reserve(nodeCount);
+
+    for (u32 nodeIndex = 0; nodeIndex < nodeCount; nodeIndex++)
     {
-        if (std::find(ancestors.begin(), ancestors.end(), nodeIndex) != ancestors.end())
-            return true;
+        if (inDegrees[nodeIndex] == 0)
+            outOrder.push_back(nodeIndex);
+    }
 
-        ancestors.push_back(nodeIndex);
-        for (const auto& childNodeIndex : graph.Nodes[nodeIndex].Children)
+    // The output doubles as the queue of nodes that don't have any incoming edge left
+    for (u32 outOrderIndex = 0; outOrderIndex < outOrder.size(); outOrderIndex++) // Size is dynamic here
+    {
+        for (const auto& childNodeIndex : get_children(graph, outOrder[outOrderIndex]))
         {
-            if (HasCyclesRecursive(graph, childNodeIndex, ancestors))
-                return true;
+            Assert(inDegrees[childNodeIndex] > 0);
+            inDegrees[childNodeIndex] -= 1;
+
+            if (inDegrees[childNodeIndex] == 0)
+                outOrder.push_back(childNodeIndex);
         }
-        ancestors.pop_back();
-        return false;
     }
-} // namespace
 
-// Uses depth-first traversal
-bool HasCycles(const DirectedAcyclicGraph& graph, std::span<const DirectedAcyclicGraph::index_type> rootNodes)
+    // Nodes that are part of a cycle never lose all their incoming edges
+    return outOrder.size() == nodeCount;
+}
+
+bool HasCycles(const DirectedAcyclicGraph& graph)
 {
-    Assert(!rootNodes.empty(), "No root nodes were specified");
-    std::vector<DirectedAcyclicGraph::index_type> ancestorStack;
+    std::vector<DirectedAcyclicGraph::index_type> order;
 
-    for (const auto& rootNode : rootNodes)
-    {
-        if (HasCyclesRecursive(graph, rootNode, ancestorStack))
-            return true;
-    }
-    return false;
+    return !ComputeTopologicalOrder(graph, order);
 }
 
 // Uses breadth-first traversal
@@ -142,54 +157,75 @@ void ComputeTransitiveClosure(const DirectedAcyclicGraph& graph,
 {
     REAPER_PROFILE_SCOPE_FUNC();
 
-    const u32 nodeCount = static_cast<u32>(graph.Nodes.size());
+    const u32 nodeCount = get_node_count(graph);
 
     Assert(nodeCount != 0, "Empty graph");
-    Assert(nodeCount < 1000, "Big graph");
     Assert(!rootNodes.empty(), "No root nodes were specified");
     Assert(outClosure.empty(), "Non-empty closure output");
 
-    // Keep track of visited nodes
+    // Nodes are marked when they are queued so they never end up twice in the closure
     std::vector<bool> visitedNodes(nodeCount, false);
-    // Fill(visitedNodes.begin(), visitedNodes.end(), false);
 
-    // Initialize algorithm with root nodes
-    // Thibault S. (22/08/2017) Copy PODs, 2017 edition. Zero cost abstraction right there...
-    outClosure.insert(outClosure.begin(), rootNodes.begin(), rootNodes.end());
+    for (const auto& rootNode : rootNodes)
+    {
+        if (!visitedNodes[rootNode])
+        {
+            visitedNodes[rootNode] = true;
+            outClosure.push_back(rootNode);
+        }
+    }
 
     // Breadth-first traversal
     for (u32 outClosureIndex = 0; outClosureIndex < outClosure.size(); outClosureIndex++) // Size is dynamic here
     {
-        DirectedAcyclicGraph::index_type nodeIndex = outClosure[outClosureIndex];
+        const DirectedAcyclicGraph::index_type nodeIndex = outClosure[outClosureIndex];
 
-        for (const auto& dependencyIndex : graph.Nodes[nodeIndex].Children)
+        for (const auto& dependencyIndex : get_children(graph, nodeIndex))
         {
             Assert(dependencyIndex != nodeIndex, "This node self-loops");
 
-            if (visitedNodes[dependencyIndex])
-                continue;
-            else
+            if (!visitedNodes[dependencyIndex])
+            {
+                visitedNodes[dependencyIndex] = true;
                 outClosure.push_back(dependencyIndex);
+            }
         }
-        visitedNodes[nodeIndex] = true;
     }
 }
 
 namespace
 {
-    void place_automatic_barriers(FrameGraphSchedule& schedule, const FrameGraph& framegraph)
+    void place_automatic_barriers(FrameGraphSchedule& schedule, const FrameGraph& framegraph,
+                                  std::span<const ResourceAlias> aliases)
     {
         // Indexed by resource handle
         const u32 texture_count = static_cast<u32>(framegraph.TextureResources.size());
         const u32 buffer_count = static_cast<u32>(framegraph.BufferResources.size());
 
         // Small trickery to treat all resource types with the same array
+        const auto get_resource_index = [texture_count](ResourceHandle handle) -> u32 {
+            return handle.is_texture ? handle.index : handle.index + texture_count;
+        };
+
         std::vector<std::vector<ResourceUsageEvent>> per_resource_events(texture_count + buffer_count);
+        std::vector<std::vector<u32>>                per_resource_aliased_resources(texture_count + buffer_count);
+
+        for (const ResourceAlias& alias : aliases)
+        {
+            per_resource_aliased_resources[get_resource_index(alias.resource_handle)].push_back(
+                get_resource_index(alias.previous_resource_handle));
+        }
+
+        // Queues run in parallel, but resources still need to be handed over in record order
+        std::vector<RenderPassHandle> execution_order;
+        std::merge(schedule.queue0.begin(), schedule.queue0.end(), schedule.queue1.begin(), schedule.queue1.end(),
+                   std::back_inserter(execution_order));
 
         // Append resource usage by scheduled execution order
-        for (const auto& renderPassHandle : schedule.queue0)
+        for (const auto& renderPassHandle : execution_order)
         {
             const RenderPass& renderPass = framegraph.RenderPasses[renderPassHandle];
+            const u32         render_pass_queue = schedule.render_pass_queues[renderPassHandle];
 
             for (const auto& resourceUsageHandle : renderPass.ResourceUsageHandles)
             {
@@ -198,9 +234,8 @@ namespace
 
                 Assert(resourceUsage.is_used, "Accessing unused resource");
 
-                std::vector<ResourceUsageEvent>& resource_events =
-                    per_resource_events[resourceHandle.is_texture ? resourceHandle.index
-                                                                  : resourceHandle.index + texture_count];
+                const u32                        resource_index = get_resource_index(resourceHandle);
+                std::vector<ResourceUsageEvent>& resource_events = per_resource_events[resource_index];
 
                 // Assume that the resource WILL be created every frame and we need to transition it out of UNDEFINED
                 // layout
@@ -208,19 +243,44 @@ namespace
                 if (resource_events.empty())
                 {
                     ResourceUsageEvent& initial_usage = resource_events.emplace_back();
-                    initial_usage.render_pass = schedule.queue0[0];
+                    initial_usage.render_pass = get_queue_render_passes(schedule, render_pass_queue)[0];
+                    initial_usage.last_render_pass = initial_usage.render_pass;
                     initial_usage.usage_handle =
                         resourceUsageHandle; // FIXME it's wrong but it doesn't break the framegraph (yet)
                     initial_usage.access = {VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, VK_ACCESS_2_NONE,
                                             VK_IMAGE_LAYOUT_UNDEFINED};
+
+                    // The memory might still be in use by other resources, wait until the last one is done with it.
+                    // Their lifetimes ended before this pass so their events are already complete.
+                    for (u32 previous_resource_index : per_resource_aliased_resources[resource_index])
+                    {
+                        const std::vector<ResourceUsageEvent>& previous_events =
+                            per_resource_events[previous_resource_index];
+                        Assert(!previous_events.empty(), "Aliased resource was not used before");
+
+                        const ResourceUsageEvent& last_event = previous_events.back();
+                        Assert(last_event.last_render_pass < renderPassHandle, "Overlapping aliased resources");
+                        Assert(schedule.render_pass_queues[last_event.last_render_pass] == render_pass_queue,
+                               "Aliased resources can't be shared between queues");
+
+                        initial_usage.render_pass = std::max(initial_usage.render_pass, last_event.last_render_pass);
+                        initial_usage.last_render_pass = initial_usage.render_pass;
+                        initial_usage.access.stage_mask |= last_event.access.stage_mask;
+                        initial_usage.access.access_mask |= last_event.access.access_mask;
+                    }
                 }
 
                 ResourceUsageEvent&  previous_resource_event = resource_events.back();
                 const ResourceUsage& previous_resource_usage =
                     GetResourceUsage(framegraph, previous_resource_event.usage_handle);
 
+                const bool is_same_queue =
+                    schedule.render_pass_queues[previous_resource_event.render_pass] == render_pass_queue;
+
                 // If we are in a multiple-reader situation, merge both accesses at earliest time
-                if (previous_resource_usage.type == UsageType::Input && resourceUsage.type == UsageType::Input)
+                // Readers on different queues still need to hand over the resource.
+                if (is_same_queue && previous_resource_usage.type == UsageType::Input
+                    && resourceUsage.type == UsageType::Input)
                 {
                     const GPUResourceAccess old_access = previous_resource_usage.access;
                     const GPUResourceAccess new_access = resourceUsage.access;
@@ -232,11 +292,13 @@ namespace
                     previous_resource_event.access = {old_access.stage_mask | new_access.stage_mask,
                                                       old_access.access_mask | new_access.access_mask,
                                                       old_access.image_layout};
+                    previous_resource_event.last_render_pass = renderPassHandle;
                 }
                 else
                 {
                     ResourceUsageEvent& resource_event = resource_events.emplace_back();
                     resource_event.render_pass = renderPassHandle;
+                    resource_event.last_render_pass = renderPassHandle;
                     resource_event.usage_handle = resourceUsageHandle;
                     resource_event.access = resourceUsage.access;
                 }
@@ -244,35 +306,127 @@ namespace
         }
 
         // Build barriers now that we consolidated the successive accesses for each resource
-        for (const auto& resource_events : per_resource_events)
+        for (u32 resource_index = 0; resource_index < per_resource_events.size(); resource_index++)
         {
+            const std::vector<ResourceUsageEvent>& resource_events = per_resource_events[resource_index];
+            const bool                             is_aliased = !per_resource_aliased_resources[resource_index].empty();
+
             for (u32 i = 1; i < resource_events.size(); i++)
             {
                 const ResourceUsageEvent& src_resource_event = resource_events[i - 1];
                 const ResourceUsageEvent& dst_resource_event = resource_events[i];
 
                 const ResourceUsage& usage = GetResourceUsage(framegraph, dst_resource_event.usage_handle);
-                Assert(!usage.resource_handle.is_texture
+                const u32            src_queue = schedule.render_pass_queues[src_resource_event.last_render_pass];
+                const u32            dst_queue = schedule.render_pass_queues[dst_resource_event.render_pass];
+                const bool           is_cross_queue = src_queue != dst_queue;
+
+                Assert(is_cross_queue || !usage.resource_handle.is_texture
                            || src_resource_event.access.image_layout != dst_resource_event.access.image_layout,
                        "Mismatching image layout");
+                Assert(!is_cross_queue || src_resource_event.last_render_pass < dst_resource_event.render_pass,
+                       "Cross-queue dependencies have to follow record order");
 
                 Barrier& barrier = schedule.barriers.emplace_back();
                 barrier.src = src_resource_event;
                 barrier.dst = dst_resource_event;
+                barrier.is_aliasing = is_aliased && i == 1;
             }
         }
     }
+
+
+    void compute_submit_batches(FrameGraphSchedule& schedule)
+    {
+        const u32 renderPassCount = static_cast<u32>(schedule.render_pass_queues.size());
+
+        // Only passes that acquire resources from another queue need to wait
+        std::vector<bool> render_pass_waits(renderPassCount, false);
+
+        for (const BarrierEvent& barrier_event : schedule.barrier_events)
+        {
+            if (barrier_event.barrier_type == BarrierType::QueueAcquire)
+                render_pass_waits[barrier_event.render_pass_handle] = true;
+        }
+
+        schedule.submit_batches.clear();
+        schedule.render_pass_batches.assign(renderPassCount, InvalidSubmitBatch);
+
+        for (u32 queue_type = 0; queue_type < QueueType::Count; queue_type++)
+        {
+            const std::span<const RenderPassHandle> queue_render_passes = get_queue_render_passes(schedule, queue_type);
+            u32                                     queue_batch_count = 0;
+
+            for (u32 pass_index = 0; pass_index < queue_render_passes.size(); pass_index++)
+            {
+                const RenderPassHandle render_pass_handle = queue_render_passes[pass_index];
+
+                if (pass_index == 0 || render_pass_waits[render_pass_handle])
+                {
+                    queue_batch_count += 1;
+
+                    schedule.submit_batches.emplace_back(SubmitBatch{
+                        .queue_type = queue_type,
+                        .pass_offset = pass_index,
+                        .pass_count = 0,
+                        .signal_value = queue_batch_count,
+                        .wait_values = {},
+                    });
+                }
+
+                schedule.submit_batches.back().pass_count += 1;
+                schedule.render_pass_batches[render_pass_handle] = static_cast<u32>(schedule.submit_batches.size() - 1);
+            }
+        }
+
+        // A batch only waits for batches that started earlier in record order, so there's no way to deadlock.
+        for (const BarrierEvent& barrier_event : schedule.barrier_events)
+        {
+            if (barrier_event.barrier_type != BarrierType::QueueAcquire)
+                continue;
+
+            const Barrier&     barrier = schedule.barriers[barrier_event.barrier_handle];
+            const u32          src_batch_index = schedule.render_pass_batches[barrier.src.last_render_pass];
+            const u32          dst_batch_index = schedule.render_pass_batches[barrier.dst.render_pass];
+            const SubmitBatch& src_batch = schedule.submit_batches[src_batch_index];
+            SubmitBatch&       dst_batch = schedule.submit_batches[dst_batch_index];
+
+            Assert(get_queue_render_passes(schedule, dst_batch.queue_type)[dst_batch.pass_offset]
+                       == barrier.dst.render_pass,
+                   "Waiting in the middle of a batch");
+
+            u32& wait_value = dst_batch.wait_values[src_batch.queue_type];
+            wait_value = std::max(wait_value, src_batch.signal_value);
+        }
+    }
 } // namespace
 
+std::span<const RenderPassHandle> get_queue_render_passes(const FrameGraphSchedule& schedule, u32 queue_type)
+{
+    switch (queue_type)
+    {
+    case QueueType::Graphics:
+        return schedule.queue0;
+    case QueueType::AsyncCompute:
+        return schedule.queue1;
+    default:
+        AssertUnreachable();
+        return {};
+    }
+}
+
 // NOTE: SUPER Trivial scheduling for now, matches user record order.
 // We rely on the fact that render passes are appended in compatible rendering order, which saves our asses.
-// NO fancy multiqueue stuff here. yet.
-FrameGraphSchedule compute_schedule(const FrameGraph& framegraph)
+// Passes are dispatched to their preferred queue, each queue keeps the record order.
+void compute_schedule_order(const FrameGraph& framegraph, FrameGraphSchedule& schedule, bool enable_async_compute)
 {
     REAPER_PROFILE_SCOPE_FUNC();
 
-    FrameGraphSchedule schedule;
-    const u32          renderPassCount = static_cast<u32>(framegraph.RenderPasses.size());
+    const u32 renderPassCount = static_cast<u32>(framegraph.RenderPasses.size());
+
+    schedule.queue0.clear();
+    schedule.queue1.clear();
+    schedule.render_pass_queues.assign(renderPassCount, QueueType::Graphics);
 
     for (u32 renderPassIndex = 0; renderPassIndex < renderPassCount; renderPassIndex++)
     {
@@ -280,86 +434,131 @@ FrameGraphSchedule compute_schedule(const FrameGraph& framegraph)
 
         if (renderPass.is_used)
         {
-            schedule.queue0.emplace_back(RenderPassHandle(renderPassIndex));
+            const bool use_async_compute = enable_async_compute && renderPass.queue_type == QueueType::AsyncCompute;
+
+            if (use_async_compute)
+            {
+                schedule.queue1.emplace_back(RenderPassHandle(renderPassIndex));
+                schedule.render_pass_queues[renderPassIndex] = QueueType::AsyncCompute;
+            }
+            else
+            {
+                schedule.queue0.emplace_back(RenderPassHandle(renderPassIndex));
+            }
         }
     }
+}
+
+void compute_schedule_barriers(const FrameGraph& framegraph, std::span<const ResourceAlias> aliases,
+                               FrameGraphSchedule& schedule)
+{
+    REAPER_PROFILE_SCOPE_FUNC();
 
-    place_automatic_barriers(schedule, framegraph);
+    schedule.barriers.clear();
+
+    place_automatic_barriers(schedule, framegraph, aliases);
 
     // We have the complete list of barriers to execute, now
     // let's build the timeline of commands to execute for each pass
     // This takes care of putting two events for a split barriers
+    std::vector<BarrierEvent> unsorted_barrier_events;
+
     for (u32 i = 0; i < schedule.barriers.size(); i++)
     {
         const Barrier& barrier = schedule.barriers[i];
 
+        // The src queue gives up ownership and the dst queue takes it after waiting on a semaphore.
+        // The backend will skip the release when both queues share the same family.
+        const bool is_cross_queue = schedule.render_pass_queues[barrier.src.last_render_pass]
+                                    != schedule.render_pass_queues[barrier.dst.render_pass];
+
         // Test here if the render passes are consecutive. If so just do an immediate barrier
         // NOTE: This doesn't catch all cases of really consecutive passes
         const bool is_usage_immediate = (barrier.src.render_pass + 1 == barrier.dst.render_pass);
 
-        if (is_usage_immediate)
+        if (is_cross_queue)
+        {
+            // Release after the last reader, otherwise the other readers would use a resource we don't own anymore.
+            unsorted_barrier_events.emplace_back(
+                BarrierEvent{BarrierType::QueueRelease, i, barrier.src.last_render_pass});
+            unsorted_barrier_events.emplace_back(BarrierEvent{BarrierType::QueueAcquire, i, barrier.dst.render_pass});
+        }
+        else if (is_usage_immediate)
         {
-            schedule.barrier_events.emplace_back(BarrierEvent{BarrierType::ImmediateAfter, i, barrier.src.render_pass});
+            unsorted_barrier_events.emplace_back(BarrierEvent{BarrierType::ImmediateAfter, i, barrier.src.render_pass});
         }
         else
         {
             if (barrier.src.render_pass == barrier.dst.render_pass)
             {
-                schedule.barrier_events.emplace_back(
+                unsorted_barrier_events.emplace_back(
                     BarrierEvent{BarrierType::ImmediateBefore, i, barrier.dst.render_pass});
             }
             else
             {
-                schedule.barrier_events.emplace_back(BarrierEvent{BarrierType::SplitBegin, i, barrier.src.render_pass});
-                schedule.barrier_events.emplace_back(BarrierEvent{BarrierType::SplitEnd, i, barrier.dst.render_pass});
+                unsorted_barrier_events.emplace_back(BarrierEvent{BarrierType::SplitBegin, i, barrier.src.render_pass});
+                unsorted_barrier_events.emplace_back(BarrierEvent{BarrierType::SplitEnd, i, barrier.dst.render_pass});
             }
         }
     }
 
-    // Sort first by renderpass and then by before/after marker
-    auto comparison_less_lambda = [](BarrierEvent a, BarrierEvent b) -> bool {
-        if (a.render_pass_handle == b.render_pass_handle)
-        {
-            const bool a_execute_before = (a.barrier_type & BarrierType::ExecuteBeforePass) > 0;
-            const bool b_execute_after = (b.barrier_type & BarrierType::ExecuteAfterPass) > 0;
+    // Scatter barrier events in per-pass slots so it's then trivial to gather them at runtime.
+    // This is a counting sort, events keep their relative order inside a slot.
+    const u32 slot_count = static_cast<u32>(framegraph.RenderPasses.size()) * 2;
 
-            return a_execute_before && b_execute_after;
-        }
+    std::vector<u32> slot_event_counts(slot_count, 0);
 
-        return a.render_pass_handle < b.render_pass_handle;
-    };
+    for (const BarrierEvent& barrier_event : unsorted_barrier_events)
+    {
+        const bool execute_before_pass = (barrier_event.barrier_type & BarrierType::ExecuteBeforePass) > 0;
+        const u32  slot = get_barrier_event_slot(barrier_event.render_pass_handle, execute_before_pass);
+
+        slot_event_counts[slot] += 1;
+    }
+
+    schedule.barrier_event_offsets.resize(slot_count + 1);
+    schedule.barrier_event_offsets[0] = 0;
 
-    // Sort barrier events so it's then trivial to gather them at runtime.
-    // We could also just scatter them in arrays for each render passes and be done with it
-    std::sort(schedule.barrier_events.begin(), schedule.barrier_events.end(), comparison_less_lambda);
+    for (u32 slot = 0; slot < slot_count; slot++)
+        schedule.barrier_event_offsets[slot + 1] = schedule.barrier_event_offsets[slot] + slot_event_counts[slot];
+
+    schedule.barrier_events.resize(unsorted_barrier_events.size());
+
+    std::vector<u32> slot_write_offsets(schedule.barrier_event_offsets.begin(),
+                                        schedule.barrier_event_offsets.end() - 1);
+
+    for (const BarrierEvent& barrier_event : unsorted_barrier_events)
+    {
+        const bool execute_before_pass = (barrier_event.barrier_type & BarrierType::ExecuteBeforePass) > 0;
+        const u32  slot = get_barrier_event_slot(barrier_event.render_pass_handle, execute_before_pass);
+
+        schedule.barrier_events[slot_write_offsets[slot]] = barrier_event;
+        slot_write_offsets[slot] += 1;
+    }
+
+    compute_submit_batches(schedule);
+}
+
+FrameGraphSchedule compute_schedule(const FrameGraph& framegraph)
+{
+    FrameGraphSchedule schedule;
+
+    compute_schedule_order(framegraph, schedule);
+    compute_schedule_barriers(framegraph, {}, schedule);
 
     return schedule;
 }
 
-// This assumes the events are sorted by render pass
 std::span<const BarrierEvent> get_barriers_to_execute(const FrameGraphSchedule& schedule,
                                                       RenderPassHandle render_pass_handle, bool execute_before_pass)
 {
-    const BarrierEvent* begin = nullptr;
-    const BarrierEvent* end = nullptr;
+    const u32 slot = get_barrier_event_slot(render_pass_handle, execute_before_pass);
 
-    for (u32 i = 0; i < schedule.barrier_events.size(); i++)
-    {
-        const BarrierEvent& barrier_event = schedule.barrier_events[i];
-        const bool          match_order =
-            execute_before_pass == ((barrier_event.barrier_type & BarrierType::ExecuteBeforePass) > 0);
+    Assert(slot + 1 < schedule.barrier_event_offsets.size(), "Invalid render pass handle");
 
-        if (!begin && barrier_event.render_pass_handle == render_pass_handle && match_order)
-        {
-            begin = schedule.barrier_events.data() + i;
-        }
-
-        if (begin && barrier_event.render_pass_handle == render_pass_handle && match_order)
-        {
-            end = schedule.barrier_events.data() + i + 1;
-        }
-    }
+    const u32 offset = schedule.barrier_event_offsets[slot];
+    const u32 count = schedule.barrier_event_offsets[slot + 1] - offset;
 
-    return std::span(begin, end);
+    return std::span(schedule.barrier_events).subspan(offset, count);
 }
 } // namespace Reaper::FrameGraph
@@ -15,6 +15,7 @@
 #include "renderer/texture/GPUTextureView.h"
 #include "renderer/vulkan/Barrier.h"
 
+#include <array>
 #include <vector>
 
 #include <span>
@@ -25,6 +26,7 @@ struct RenderPass
 {
     const char*                      debug_name;
     bool                             has_side_effects;
+    u32                              queue_type; // QueueType, preferred queue
     std::vector<ResourceUsageHandle> ResourceUsageHandles;
     bool                             is_used;
 };
@@ -85,17 +87,30 @@ struct REAPER_RENDERER_API FrameGraph
     std::vector<GPUBufferView>  BufferViews;
 };
 
+// Adjacency is stored in compressed sparse row form to avoid one allocation per node.
+// The children of node i are Children[ChildOffsets[i]] to Children[ChildOffsets[i + 1] - 1].
 struct DirectedAcyclicGraph
 {
     using index_type = u32;
-    struct node_type
-    {
-        std::vector<index_type> Children;
-    };
 
-    std::vector<node_type> Nodes;
+    std::vector<u32>        ChildOffsets; // Node count + 1 entries
+    std::vector<index_type> Children;
 };
 
+inline u32 get_node_count(const DirectedAcyclicGraph& graph)
+{
+    return graph.ChildOffsets.empty() ? 0 : static_cast<u32>(graph.ChildOffsets.size() - 1);
+}
+
+inline std::span<const DirectedAcyclicGraph::index_type> get_children(const DirectedAcyclicGraph&      graph,
+                                                                      DirectedAcyclicGraph::index_type node_index)
+{
+    const u32 offset = graph.ChildOffsets[node_index];
+    const u32 count = graph.ChildOffsets[node_index + 1] - offset;
+
+    return std::span(graph.Children).subspan(offset, count);
+}
+
 const ResourceUsage& GetResourceUsage(const FrameGraph& framegraph, ResourceUsageHandle resourceUsageHandle);
 const Resource&      GetResource(const FrameGraph& framegraph, ResourceHandle resource_handle);
 Resource&            GetResource(FrameGraph& framegraph, ResourceHandle resource_handle);
@@ -105,8 +120,12 @@ Resource&            GetResource(FrameGraph& framegraph, const ResourceUsage& re
 ResourceViewHandles allocate_texture_views(FrameGraph& framegraph, std::span<const GPUTextureView> texture_views);
 ResourceViewHandles allocate_buffer_views(FrameGraph& framegraph, std::span<const GPUBufferView> buffer_views);
 
-// Uses depth-first traversal
-bool HasCycles(const DirectedAcyclicGraph& graph, std::span<const DirectedAcyclicGraph::index_type> rootNodes);
+// Iterative topological sort (Kahn's algorithm), linear in the number of nodes and edges.
+// Returns false if the graph has cycles, in that case the order is incomplete.
+bool ComputeTopologicalOrder(const DirectedAcyclicGraph&                    graph,
+                             std::vector<DirectedAcyclicGraph::index_type>& outOrder);
+
+bool HasCycles(const DirectedAcyclicGraph& graph);
 
 // Uses breadth-first traversal
 void ComputeTransitiveClosure(const DirectedAcyclicGraph& graph,
@@ -117,6 +136,7 @@ void ComputeTransitiveClosure(const DirectedAcyclicGraph& graph,
 struct ResourceUsageEvent
 {
     RenderPassHandle    render_pass;
+    RenderPassHandle    last_render_pass; // Differs from render_pass when the accesses of several readers were merged
     ResourceUsageHandle usage_handle;
     GPUResourceAccess   access;
 };
@@ -125,6 +145,14 @@ struct Barrier
 {
     ResourceUsageEvent src;
     ResourceUsageEvent dst;
+    bool               is_aliasing; // src is the last access of another resource that used the same memory
+};
+
+// Both resources share memory, the previous one has to be done with it before the other one can be used.
+struct ResourceAlias
+{
+    ResourceHandle resource_handle;
+    ResourceHandle previous_resource_handle;
 };
 
 namespace BarrierType
@@ -135,11 +163,14 @@ namespace BarrierType
         Split = bit(1),
         ExecuteBeforePass = bit(2),
         ExecuteAfterPass = bit(3),
+        CrossQueue = bit(4),
 
         ImmediateAfter = Immediate | ExecuteAfterPass,
         ImmediateBefore = Immediate | ExecuteBeforePass,
         SplitBegin = Split | ExecuteAfterPass,
         SplitEnd = Split | ExecuteBeforePass,
+        QueueRelease = CrossQueue | ExecuteAfterPass, // Recorded on the src queue
+        QueueAcquire = CrossQueue | ExecuteBeforePass, // Recorded on the dst queue, after waiting for the src one
     };
 
     const char* to_string(Type barrier_type);
@@ -152,13 +183,52 @@ struct BarrierEvent
     RenderPassHandle  render_pass_handle;
 };
 
+static constexpr u32 InvalidSubmitBatch = 0xFFFFFFFF;
+
+// Consecutive passes of one queue that can be submitted together.
+// A new batch is started every time a pass has to wait for work from another queue.
+// Each batch signals its queue timeline with signal_value once done, values are relative to the start of the frame.
+struct SubmitBatch
+{
+    u32                               queue_type;
+    u32                               pass_offset; // Index in the queue
+    u32                               pass_count;
+    u32                               signal_value;
+    std::array<u32, QueueType::Count> wait_values; // Indexed by queue type, 0 means no wait
+};
+
 struct FrameGraphSchedule
 {
-    std::vector<RenderPassHandle> queue0;
+    std::vector<RenderPassHandle> queue0;              // Graphics
+    std::vector<RenderPassHandle> queue1;              // Async compute
+    std::vector<u32>              render_pass_queues;  // Indexed by render pass handle
+    std::vector<u32>              render_pass_batches; // Indexed by render pass handle, InvalidSubmitBatch if culled
+    std::vector<SubmitBatch>      submit_batches;      // Sorted by queue, then by execution order
     std::vector<Barrier>          barriers;
-    std::vector<BarrierEvent>     barrier_events;
+    std::vector<BarrierEvent>     barrier_events;        // Sorted by render pass, then before/after marker
+    std::vector<u32>              barrier_event_offsets; // See get_barrier_event_slot()
 };
 
+// Barrier events of one slot are barrier_events[offsets[slot]] to barrier_events[offsets[slot + 1] - 1].
+inline u32 get_barrier_event_slot(RenderPassHandle render_pass_handle, bool execute_before_pass)
+{
+    return render_pass_handle * 2 + (execute_before_pass ? 0 : 1);
+}
+
+std::span<const RenderPassHandle> get_queue_render_passes(const FrameGraphSchedule& schedule, u32 queue_type);
+
+// Fills the render pass queues, the barriers are left empty.
+// Passes that asked for async compute only get their own queue when it's enabled.
+void compute_schedule_order(const FrameGraph& framegraph, FrameGraphSchedule& schedule,
+                            bool enable_async_compute = false);
+
+// Needs the order to be computed first.
+// Aliased resources wait for the previous users of their memory before their first access.
+// Resources going from one queue to another get a release/acquire pair and the submit batches are built from those.
+void compute_schedule_barriers(const FrameGraph& framegraph, std::span<const ResourceAlias> aliases,
+                               FrameGraphSchedule& schedule);
+
+// Order and barriers in one go, without any memory aliasing
 FrameGraphSchedule compute_schedule(const FrameGraph& framegraph);
 
 std::span<const BarrierEvent> get_barriers_to_execute(const FrameGraphSchedule& schedule,
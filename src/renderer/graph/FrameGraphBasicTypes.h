@@ -21,6 +21,18 @@ namespace UsageType
     };
 }
 
+// Render passes can ask to run on another queue than the graphics one.
+// This is only a hint, the schedule decides where they really end up.
+namespace QueueType
+{
+    enum type : u32
+    {
+        Graphics = 0,
+        AsyncCompute = 1,
+        Count = 2,
+    };
+}
+
 // Kinda type-safe handle types used throughout
 // the framegraph code.
 enum RenderPassHandle : u32
@@ -117,12 +117,15 @@ ResourceUsageHandle Builder::write_resource_generic(RenderPassHandle           r
     return resourceUsageHandle;
 }
 
-RenderPassHandle Builder::create_render_pass(const char* debug_name, bool has_side_effects)
+RenderPassHandle Builder::create_render_pass(const char* debug_name, bool has_side_effects, u32 queue_type)
 {
+    Assert(queue_type < QueueType::Count, "Invalid queue type");
+
     // TODO test for name clashes
     RenderPass& newRenderPass = m_Graph.RenderPasses.emplace_back();
     newRenderPass.debug_name = debug_name;
     newRenderPass.has_side_effects = has_side_effects;
+    newRenderPass.queue_type = queue_type;
 
     return RenderPassHandle(m_Graph.RenderPasses.size() - 1);
 }
@@ -215,61 +218,80 @@ namespace
         // can be used interchangeably.
         // Renderpass node indexes are NOT the same for both graphs but
         // can be retrieved with an offset.
-        DirectedAcyclicGraph dag;
-        dag.Nodes.resize(resourceUsageCount + renderPassCount);
-
-        // Convert edges
-        for (u32 renderPassIndex = 0; renderPassIndex < renderPassCount; renderPassIndex++)
-        {
-            const RenderPass&                      renderPass = frameGraph.RenderPasses[renderPassIndex];
-            const DirectedAcyclicGraph::index_type renderPassIndexInDAG = renderPassIndex + resourceUsageCount;
+        const u32 nodeCount = resourceUsageCount + renderPassCount;
 
-            // Renderpasses that have side effects cannot be pruned
-            // We use them as terminal nodes in the DAG so that orphan nodes
-            // can properly be pruned later.
-            if (renderPass.has_side_effects)
+        // Edges are directed in reverse compared to the rendering flow.
+        // This part is critical and not necessarily intuitive because of this. Draw a graph!
+        // The callback is called once to count the edges of each node and a second time to fill them.
+        const auto for_each_edge = [&frameGraph, resourceUsageCount, renderPassCount](auto&& add_edge) {
+            for (u32 renderPassIndex = 0; renderPassIndex < renderPassCount; renderPassIndex++)
             {
-                outRootNodes.push_back(renderPassIndexInDAG);
+                const RenderPass&                      renderPass = frameGraph.RenderPasses[renderPassIndex];
+                const DirectedAcyclicGraph::index_type renderPassIndexInDAG = renderPassIndex + resourceUsageCount;
+
+                for (const auto& resourceUsageHandle : renderPass.ResourceUsageHandles)
+                {
+                    // Index conversion
+                    const DirectedAcyclicGraph::index_type resourceUsageIndexInDAG = resourceUsageHandle;
+
+                    const ResourceUsage& resourceUsage = GetResourceUsage(frameGraph, resourceUsageHandle);
+
+                    if (resourceUsage.type == UsageType::Input)
+                    {
+                        add_edge(renderPassIndexInDAG, resourceUsageIndexInDAG);
+
+                        // Add extra edge to link to the previously written/created resource
+                        Assert(is_valid(resourceUsage.parent_usage_handle), "Invalid resource usage handle");
+                        add_edge(resourceUsageIndexInDAG, resourceUsage.parent_usage_handle);
+                    }
+                    else if (resourceUsage.type == UsageType::Output)
+                    {
+                        add_edge(resourceUsageIndexInDAG, renderPassIndexInDAG);
+                    }
+                    else if (resourceUsage.type == (UsageType::Input | UsageType::Output))
+                    {
+                        add_edge(resourceUsageIndexInDAG, renderPassIndexInDAG);
+
+                        // Add extra edge to link to the previously written/created resource
+                        Assert(is_valid(resourceUsage.parent_usage_handle), "Invalid resource usage handle");
+                        add_edge(resourceUsageIndexInDAG, resourceUsage.parent_usage_handle);
+                    }
+                    else
+                    {
+                        AssertUnreachable();
+                    }
+                }
             }
+        };
 
-            for (const auto& resourceUsageHandle : renderPass.ResourceUsageHandles)
-            {
-                // Index conversion
-                const DirectedAcyclicGraph::index_type resourceUsageIndexInDAG = resourceUsageHandle;
+        DirectedAcyclicGraph dag;
+        dag.ChildOffsets.assign(nodeCount + 1, 0);
 
-                const ResourceUsage& resourceUsage = GetResourceUsage(frameGraph, resourceUsageHandle);
+        // Count edges, shifted by one so the prefix sum directly gives the offsets
+        for_each_edge([&dag](DirectedAcyclicGraph::index_type parent, DirectedAcyclicGraph::index_type) {
+            dag.ChildOffsets[parent + 1] += 1;
+        });
 
-                // Edges are directed in reverse compared to the rendering flow.
-                // This part is critical and not necessarily intuitive because of this. Draw a graph!
-                if (resourceUsage.type == UsageType::Input)
-                {
-                    dag.Nodes[renderPassIndexInDAG].Children.push_back(resourceUsageIndexInDAG);
+        for (u32 nodeIndex = 0; nodeIndex < nodeCount; nodeIndex++)
+            dag.ChildOffsets[nodeIndex + 1] += dag.ChildOffsets[nodeIndex];
 
-                    // Add extra edge to link to the previously written/created resource
-                    Assert(is_valid(resourceUsage.parent_usage_handle), "Invalid resource usage handle");
-                    DirectedAcyclicGraph::index_type parentUsageIndexInDAG = resourceUsage.parent_usage_handle;
+        dag.Children.resize(dag.ChildOffsets[nodeCount]);
 
-                    dag.Nodes[resourceUsageIndexInDAG].Children.push_back(parentUsageIndexInDAG);
-                }
-                else if (resourceUsage.type == UsageType::Output)
-                {
-                    dag.Nodes[resourceUsageIndexInDAG].Children.push_back(renderPassIndexInDAG);
-                }
-                else if (resourceUsage.type == (UsageType::Input | UsageType::Output))
-                {
-                    dag.Nodes[resourceUsageIndexInDAG].Children.push_back(renderPassIndexInDAG);
+        std::vector<u32> writeOffsets(dag.ChildOffsets.begin(), dag.ChildOffsets.end() - 1);
 
-                    // Add extra edge to link to the previously written/created resource
-                    Assert(is_valid(resourceUsage.parent_usage_handle), "Invalid resource usage handle");
-                    DirectedAcyclicGraph::index_type parentUsageIndexInDAG = resourceUsage.parent_usage_handle;
+        for_each_edge([&dag, &writeOffsets](DirectedAcyclicGraph::index_type parent,
+                                            DirectedAcyclicGraph::index_type child) {
+            dag.Children[writeOffsets[parent]] = child;
+            writeOffsets[parent] += 1;
+        });
 
-                    dag.Nodes[resourceUsageIndexInDAG].Children.push_back(parentUsageIndexInDAG);
-                }
-                else
-                {
-                    AssertUnreachable();
-                }
-            }
+        // Renderpasses that have side effects cannot be pruned
+        // We use them as terminal nodes in the DAG so that orphan nodes
+        // can properly be pruned later.
+        for (u32 renderPassIndex = 0; renderPassIndex < renderPassCount; renderPassIndex++)
+        {
+            if (frameGraph.RenderPasses[renderPassIndex].has_side_effects)
+                outRootNodes.push_back(renderPassIndex + resourceUsageCount);
         }
 
         // Check if the whole graph is likely to be pruned
@@ -353,7 +375,7 @@ void Builder::build()
 
     DirectedAcyclicGraph dag = ConvertFrameGraphToDAG(m_Graph, rootNodes);
 
-    Assert(!HasCycles(dag, rootNodes), "The framegraph DAG has cycles");
+    Assert(!HasCycles(dag), "The framegraph DAG has cycles");
 
     // Compute the set of useful nodes with a flood fill from root nodes
     std::vector<DirectedAcyclicGraph::index_type> closure;
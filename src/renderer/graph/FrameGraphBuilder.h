@@ -42,7 +42,8 @@ public:
     Builder(FrameGraph& frameGraph);
 
 public:
-    RenderPassHandle create_render_pass(const char* debug_name, bool has_side_effects = false);
+    RenderPassHandle create_render_pass(const char* debug_name, bool has_side_effects = false,
+                                        u32 queue_type = QueueType::Graphics);
 
 public:
     ResourceUsageHandle
@@ -16,7 +16,7 @@
 
 namespace Reaper::FrameGraph
 {
-void DumpFrameGraph(const FrameGraph& frameGraph)
+void DumpFrameGraph(const FrameGraph& frameGraph, std::span<const TransientHeapLayout> heap_layouts)
 {
     std::ofstream outResFile("resource.txt");
     std::ofstream outRenderPassFile("renderpass.txt");
@@ -90,5 +90,29 @@ void DumpFrameGraph(const FrameGraph& frameGraph)
             }
         }
     }
+
+    if (!heap_layouts.empty())
+    {
+        std::ofstream outMemoryFile("memory.txt");
+
+        u64 total_heap_size_bytes = 0;
+        u64 total_resource_size_bytes = 0;
+
+        for (u32 heap_index = 0; heap_index < heap_layouts.size(); heap_index++)
+        {
+            const TransientHeapLayout& layout = heap_layouts[heap_index];
+
+            outMemoryFile << fmt::format("heap {0}: {1} bytes for {2} bytes of resources, {3} aliases", heap_index,
+                                         layout.heap_size_bytes, layout.total_size_bytes, layout.aliases.size())
+                          << std::endl;
+
+            total_heap_size_bytes += layout.heap_size_bytes;
+            total_resource_size_bytes += layout.total_size_bytes;
+        }
+
+        outMemoryFile << fmt::format("saved {0} bytes with memory aliasing",
+                                     total_resource_size_bytes - total_heap_size_bytes)
+                      << std::endl;
+    }
 }
 } // namespace Reaper::FrameGraph
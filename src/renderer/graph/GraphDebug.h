@@ -8,6 +8,9 @@
 #pragma once
 
 #include "FrameGraph.h"
+#include "MemoryAliasing.h"
+
+#include <span>
 
 namespace Reaper::FrameGraph
 {
@@ -18,6 +21,7 @@ struct FrameGraph;
 // (you may need to modify it).
 // A script should be available to you containing a makefile
 // and the necessary templates to build a png from this data.
+// Transient heap layouts are optional, they're used to report how much memory aliasing saves.
 REAPER_RENDERER_API
-void DumpFrameGraph(const FrameGraph& frameGraph);
+void DumpFrameGraph(const FrameGraph& frameGraph, std::span<const TransientHeapLayout> heap_layouts = {});
 } // namespace Reaper::FrameGraph
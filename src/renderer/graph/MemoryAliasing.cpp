@@ -0,0 +1,188 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include "MemoryAliasing.h"
+
+#include <core/Assert.h>
+#include <core/memory/Allocator.h>
+#include <profiling/Scope.h>
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+
+namespace Reaper::FrameGraph
+{
+namespace
+{
+    struct MemoryRange
+    {
+        u64 begin;
+        u64 end;
+    };
+
+    bool memory_ranges_overlap(MemoryRange a, MemoryRange b)
+    {
+        return a.begin < b.end && b.begin < a.end;
+    }
+} // namespace
+
+void compute_resource_lifetimes(const FrameGraph& framegraph, const FrameGraphSchedule& schedule,
+                                std::vector<ResourceLifetime>& texture_lifetimes,
+                                std::vector<ResourceLifetime>& buffer_lifetimes)
+{
+    REAPER_PROFILE_SCOPE_FUNC();
+
+    const ResourceLifetime invalid_lifetime = {
+        .first_pass_index = InvalidPassIndex,
+        .last_pass_index = InvalidPassIndex,
+    };
+
+    texture_lifetimes.assign(framegraph.TextureResources.size(), invalid_lifetime);
+    buffer_lifetimes.assign(framegraph.BufferResources.size(), invalid_lifetime);
+
+    std::vector<RenderPassHandle> execution_order;
+    std::merge(schedule.queue0.begin(), schedule.queue0.end(), schedule.queue1.begin(), schedule.queue1.end(),
+               std::back_inserter(execution_order));
+
+    const u32 pass_count = static_cast<u32>(execution_order.size());
+
+    for (u32 pass_index = 0; pass_index < pass_count; pass_index++)
+    {
+        const RenderPassHandle render_pass_handle = execution_order[pass_index];
+        const RenderPass&      render_pass = framegraph.RenderPasses[render_pass_handle];
+
+        // Passes on other queues overlap with an unknown part of the graphics queue.
+        // Their resources are kept alive for the whole frame so they never get aliased.
+        const bool is_async = schedule.render_pass_queues[render_pass_handle] != QueueType::Graphics;
+
+        for (const auto& usage_handle : render_pass.ResourceUsageHandles)
+        {
+            const ResourceUsage& usage = GetResourceUsage(framegraph, usage_handle);
+            const ResourceHandle resource_handle = usage.resource_handle;
+
+            Assert(usage.is_used, "Accessing unused resource");
+
+            ResourceLifetime& lifetime = resource_handle.is_texture ? texture_lifetimes[resource_handle.index]
+                                                                    : buffer_lifetimes[resource_handle.index];
+
+            if (is_async)
+            {
+                lifetime.first_pass_index = 0;
+                lifetime.last_pass_index = pass_count - 1;
+            }
+            else if (lifetime.first_pass_index == InvalidPassIndex)
+            {
+                lifetime.first_pass_index = pass_index;
+                lifetime.last_pass_index = pass_index;
+            }
+            else
+            {
+                lifetime.last_pass_index = std::max(lifetime.last_pass_index, pass_index);
+            }
+        }
+    }
+}
+
+bool lifetimes_overlap(ResourceLifetime a, ResourceLifetime b)
+{
+    return a.first_pass_index <= b.last_pass_index && b.first_pass_index <= a.last_pass_index;
+}
+
+void compute_transient_heap_layout(std::span<const TransientResource> resources, TransientHeapLayout& layout)
+{
+    REAPER_PROFILE_SCOPE_FUNC();
+
+    const u32 resource_count = static_cast<u32>(resources.size());
+
+    layout.offsets.assign(resource_count, 0);
+    layout.aliases.clear();
+    layout.heap_size_bytes = 0;
+    layout.total_size_bytes = 0;
+
+    // Biggest resources first, smaller ones will fill the gaps afterwards.
+    // The sort is stable so the layout only depends on the input order.
+    std::vector<u32> placement_order(resource_count);
+    std::iota(placement_order.begin(), placement_order.end(), 0);
+    std::stable_sort(placement_order.begin(), placement_order.end(),
+                     [resources](u32 a, u32 b) { return resources[a].size_bytes > resources[b].size_bytes; });
+
+    std::vector<u32>         placed_resources;
+    std::vector<MemoryRange> occupied_ranges;
+
+    for (u32 resource_index : placement_order)
+    {
+        const TransientResource& resource = resources[resource_index];
+
+        Assert(resource.size_bytes > 0);
+        Assert(resource.lifetime.first_pass_index != InvalidPassIndex, "Unused resource");
+        Assert(resource.lifetime.first_pass_index <= resource.lifetime.last_pass_index);
+
+        // Gather memory that is taken during the lifetime of this resource
+        occupied_ranges.clear();
+
+        for (u32 placed_index : placed_resources)
+        {
+            const TransientResource& placed_resource = resources[placed_index];
+
+            if (lifetimes_overlap(placed_resource.lifetime, resource.lifetime))
+            {
+                const u64 placed_offset = layout.offsets[placed_index];
+                occupied_ranges.push_back(MemoryRange{placed_offset, placed_offset + placed_resource.size_bytes});
+            }
+        }
+
+        std::sort(occupied_ranges.begin(), occupied_ranges.end(),
+                  [](MemoryRange a, MemoryRange b) { return a.begin < b.begin; });
+
+        // First-fit
+        u64 offset = 0;
+
+        for (const MemoryRange& range : occupied_ranges)
+        {
+            offset = alignOffset(offset, resource.alignment);
+
+            if (offset + resource.size_bytes <= range.begin)
+                break;
+
+            offset = std::max(offset, range.end);
+        }
+
+        offset = alignOffset(offset, resource.alignment);
+
+        layout.offsets[resource_index] = offset;
+        layout.heap_size_bytes = std::max(layout.heap_size_bytes, offset + resource.size_bytes);
+        layout.total_size_bytes += resource.size_bytes;
+
+        placed_resources.push_back(resource_index);
+    }
+
+    // Resources sharing memory never overlap in time, the barriers still need to know who used the memory before.
+    for (u32 resource_index = 0; resource_index < resource_count; resource_index++)
+    {
+        const TransientResource& resource = resources[resource_index];
+        const u64                offset = layout.offsets[resource_index];
+        const MemoryRange        range = {offset, offset + resource.size_bytes};
+
+        for (u32 previous_index = 0; previous_index < resource_count; previous_index++)
+        {
+            const TransientResource& previous_resource = resources[previous_index];
+            const u64                previous_offset = layout.offsets[previous_index];
+            const MemoryRange        previous_range = {previous_offset, previous_offset + previous_resource.size_bytes};
+
+            if (previous_resource.lifetime.last_pass_index < resource.lifetime.first_pass_index
+                && memory_ranges_overlap(range, previous_range))
+            {
+                layout.aliases.push_back(ResourceAlias{
+                    .resource_handle = resource.resource_handle,
+                    .previous_resource_handle = previous_resource.resource_handle,
+                });
+            }
+        }
+    }
+}
+} // namespace Reaper::FrameGraph
@@ -0,0 +1,58 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "FrameGraph.h"
+
+#include <span>
+#include <vector>
+
+namespace Reaper::FrameGraph
+{
+// Transient resources only live for a part of the frame.
+// When their lifetimes don't overlap, two resources can be placed at the same spot in memory.
+// This only deals with offsets and sizes, the backend is in charge of getting the memory requirements and binding.
+static constexpr u32 InvalidPassIndex = 0xFFFFFFFF;
+
+struct ResourceLifetime
+{
+    u32 first_pass_index; // Index in the schedule, InvalidPassIndex when the resource is unused
+    u32 last_pass_index;
+};
+
+struct TransientResource
+{
+    ResourceHandle   resource_handle;
+    u64              size_bytes;
+    u64              alignment;
+    ResourceLifetime lifetime;
+};
+
+struct TransientHeapLayout
+{
+    std::vector<u64>           offsets; // Same order as the input resources
+    std::vector<ResourceAlias> aliases;
+    u64                        heap_size_bytes;
+    u64                        total_size_bytes; // What the resources would take without aliasing
+};
+
+// Lifetimes are expressed in execution order of the used passes, not in render pass handles.
+// Resources touched by async compute passes live for the whole frame.
+REAPER_RENDERER_API
+void compute_resource_lifetimes(const FrameGraph& framegraph, const FrameGraphSchedule& schedule,
+                                std::vector<ResourceLifetime>& texture_lifetimes,
+                                std::vector<ResourceLifetime>& buffer_lifetimes);
+
+REAPER_RENDERER_API
+bool lifetimes_overlap(ResourceLifetime a, ResourceLifetime b);
+
+// Greedy first-fit packing, biggest resources are placed first.
+// Every pair of resources that end up sharing memory is reported as an alias so we can place barriers later.
+REAPER_RENDERER_API
+void compute_transient_heap_layout(std::span<const TransientResource> resources, TransientHeapLayout& layout);
+} // namespace Reaper::FrameGraph
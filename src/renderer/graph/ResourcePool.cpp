@@ -0,0 +1,240 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include "ResourcePool.h"
+
+#include <core/Assert.h>
+#include <core/Hash.h>
+#include <profiling/Scope.h>
+
+namespace Reaper::FrameGraph
+{
+namespace
+{
+    bool is_same_texture_properties(const GPUTextureProperties& a, const GPUTextureProperties& b)
+    {
+        return a.type == b.type && a.width == b.width && a.height == b.height && a.depth == b.depth
+               && a.format == b.format && a.mip_count == b.mip_count && a.layer_count == b.layer_count
+               && a.sample_count == b.sample_count && a.usage_flags == b.usage_flags && a.misc_flags == b.misc_flags;
+    }
+
+    bool is_same_buffer_properties(const GPUBufferProperties& a, const GPUBufferProperties& b)
+    {
+        return a.element_count == b.element_count && a.element_size_bytes == b.element_size_bytes
+               && a.stride == b.stride && a.usage_flags == b.usage_flags;
+    }
+
+    bool is_same_properties(const ResourcePoolEntry& entry, const Resource& resource, bool is_texture)
+    {
+        if (entry.is_texture != is_texture)
+            return false;
+
+        if (is_texture)
+            return is_same_texture_properties(entry.properties.texture, resource.properties.texture);
+        else
+            return is_same_buffer_properties(entry.properties.buffer, resource.properties.buffer);
+    }
+
+    u32 acquire_entry(ResourcePool& pool, const Resource& resource, bool is_texture, u64 placement_offset,
+                      u64 frame_index, std::vector<u32>& created_entries)
+    {
+        const u64 properties_key = is_texture ? hash_texture_properties(resource.properties.texture)
+                                              : hash_buffer_properties(resource.properties.buffer);
+        const u64 key = hash_value(properties_key, placement_offset);
+
+        // Try to reuse an entry that wasn't already taken this frame
+        const auto [range_begin, range_end] = pool.entries_by_key.equal_range(key);
+
+        for (auto it = range_begin; it != range_end; ++it)
+        {
+            const u32          entry_index = it->second;
+            ResourcePoolEntry& entry = pool.entries[entry_index];
+
+            Assert(entry.is_alive);
+
+            if (entry.last_used_frame != frame_index && entry.placement_offset == placement_offset
+                && is_same_properties(entry, resource, is_texture))
+            {
+                entry.last_used_frame = frame_index;
+                return entry_index;
+            }
+        }
+
+        u32 entry_index;
+
+        if (pool.free_entries.empty())
+        {
+            entry_index = static_cast<u32>(pool.entries.size());
+            pool.entries.emplace_back();
+        }
+        else
+        {
+            entry_index = pool.free_entries.back();
+            pool.free_entries.pop_back();
+        }
+
+        pool.entries[entry_index] = ResourcePoolEntry{
+            .properties = resource.properties,
+            .key = key,
+            .placement_offset = placement_offset,
+            .last_used_frame = frame_index,
+            .is_texture = is_texture,
+            .is_alive = true,
+        };
+
+        pool.entries_by_key.emplace(key, entry_index);
+        created_entries.push_back(entry_index);
+
+        return entry_index;
+    }
+
+    void evict_entry(ResourcePool& pool, u32 entry_index, std::vector<u32>& evicted_entries)
+    {
+        ResourcePoolEntry& entry = pool.entries[entry_index];
+        Assert(entry.is_alive);
+
+        const auto [range_begin, range_end] = pool.entries_by_key.equal_range(entry.key);
+
+        for (auto it = range_begin; it != range_end; ++it)
+        {
+            if (it->second == entry_index)
+            {
+                pool.entries_by_key.erase(it);
+                break;
+            }
+        }
+
+        entry.is_alive = false;
+
+        pool.free_entries.push_back(entry_index);
+        evicted_entries.push_back(entry_index);
+    }
+} // namespace
+
+ResourcePool create_resource_pool(u32 max_unused_frames)
+{
+    ResourcePool pool = {};
+    pool.max_unused_frames = max_unused_frames;
+
+    return pool;
+}
+
+u64 hash_texture_properties(const GPUTextureProperties& properties)
+{
+    u64 hash = HashSeed;
+
+    hash = hash_value(hash, properties.type);
+    hash = hash_value(hash, properties.width);
+    hash = hash_value(hash, properties.height);
+    hash = hash_value(hash, properties.depth);
+    hash = hash_value(hash, properties.format);
+    hash = hash_value(hash, properties.mip_count);
+    hash = hash_value(hash, properties.layer_count);
+    hash = hash_value(hash, properties.sample_count);
+    hash = hash_value(hash, properties.usage_flags);
+    hash = hash_value(hash, properties.misc_flags);
+
+    return hash;
+}
+
+u64 hash_buffer_properties(const GPUBufferProperties& properties)
+{
+    u64 hash = HashSeed;
+
+    hash = hash_value(hash, properties.element_count);
+    hash = hash_value(hash, properties.element_size_bytes);
+    hash = hash_value(hash, properties.stride);
+    hash = hash_value(hash, properties.usage_flags);
+
+    return hash;
+}
+
+void resource_pool_acquire(ResourcePool& pool, const FrameGraph& framegraph, u64 frame_index,
+                           ResourcePoolFrameAllocation& allocation)
+{
+    resource_pool_acquire(pool, framegraph, frame_index, {}, {}, allocation);
+}
+
+void resource_pool_acquire(ResourcePool& pool, const FrameGraph& framegraph, u64 frame_index,
+                           std::span<const u64> texture_placements, std::span<const u64> buffer_placements,
+                           ResourcePoolFrameAllocation& allocation)
+{
+    REAPER_PROFILE_SCOPE_FUNC();
+
+    Assert(texture_placements.empty() || texture_placements.size() == framegraph.TextureResources.size());
+    Assert(buffer_placements.empty() || buffer_placements.size() == framegraph.BufferResources.size());
+
+    allocation.created_entries.clear();
+    allocation.evicted_entries.clear();
+
+    allocation.texture_entries.assign(framegraph.TextureResources.size(), InvalidResourcePoolEntry);
+    allocation.buffer_entries.assign(framegraph.BufferResources.size(), InvalidResourcePoolEntry);
+
+    for (u32 index = 0; index < framegraph.TextureResources.size(); index++)
+    {
+        const Resource& resource = framegraph.TextureResources[index];
+
+        if (resource.is_used)
+        {
+            const u64 placement_offset = texture_placements.empty() ? DedicatedPlacement : texture_placements[index];
+
+            allocation.texture_entries[index] =
+                acquire_entry(pool, resource, true, placement_offset, frame_index, allocation.created_entries);
+        }
+    }
+
+    for (u32 index = 0; index < framegraph.BufferResources.size(); index++)
+    {
+        const Resource& resource = framegraph.BufferResources[index];
+
+        if (resource.is_used)
+        {
+            const u64 placement_offset = buffer_placements.empty() ? DedicatedPlacement : buffer_placements[index];
+
+            allocation.buffer_entries[index] =
+                acquire_entry(pool, resource, false, placement_offset, frame_index, allocation.created_entries);
+        }
+    }
+
+    // Only evict after acquiring, that way an entry created this frame can't land on a slot evicted this frame.
+    for (u32 entry_index = 0; entry_index < pool.entries.size(); entry_index++)
+    {
+        const ResourcePoolEntry& entry = pool.entries[entry_index];
+
+        if (entry.is_alive && entry.last_used_frame + pool.max_unused_frames < frame_index)
+        {
+            evict_entry(pool, entry_index, allocation.evicted_entries);
+        }
+    }
+}
+
+void resource_pool_evict_placed(ResourcePool& pool, bool is_texture, std::vector<u32>& evicted_entries)
+{
+    for (u32 entry_index = 0; entry_index < pool.entries.size(); entry_index++)
+    {
+        const ResourcePoolEntry& entry = pool.entries[entry_index];
+
+        if (entry.is_alive && entry.is_texture == is_texture && entry.placement_offset != DedicatedPlacement)
+        {
+            evict_entry(pool, entry_index, evicted_entries);
+        }
+    }
+}
+
+void resource_pool_clear(ResourcePool& pool, std::vector<u32>& evicted_entries)
+{
+    for (u32 entry_index = 0; entry_index < pool.entries.size(); entry_index++)
+    {
+        if (pool.entries[entry_index].is_alive)
+        {
+            evict_entry(pool, entry_index, evicted_entries);
+        }
+    }
+
+    Assert(pool.entries_by_key.empty());
+}
+} // namespace Reaper::FrameGraph
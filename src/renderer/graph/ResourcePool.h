@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "FrameGraph.h"
+
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace Reaper::FrameGraph
+{
+// Keeps track of frame graph resources across frames so they can be reused instead of being re-created every time.
+// Entries are keyed by their creation properties, which means that identical frame graphs map to identical entries.
+// The pool has no knowledge of the backend, it only tells the caller which entries should be created or destroyed.
+static constexpr u32 InvalidResourcePoolEntry = 0xFFFFFFFF;
+
+// Resources can either get their own memory or be placed at an offset in a shared heap.
+// Placed entries are only reused for the same offset since the backend can't rebind memory.
+static constexpr u64 DedicatedPlacement = 0xFFFFFFFFFFFFFFFF;
+
+struct ResourcePoolEntry
+{
+    GPUResourceProperties properties;
+    u64                   key;
+    u64                   placement_offset;
+    u64                   last_used_frame;
+    bool                  is_texture;
+    bool                  is_alive;
+};
+
+struct ResourcePool
+{
+    u32 max_unused_frames;
+
+    std::vector<ResourcePoolEntry>    entries;
+    std::vector<u32>                  free_entries;
+    std::unordered_multimap<u64, u32> entries_by_key;
+};
+
+struct ResourcePoolFrameAllocation
+{
+    // Indexed by frame graph resource handles
+    std::vector<u32> texture_entries;
+    std::vector<u32> buffer_entries;
+
+    // Entries the backend needs to create or destroy for this frame
+    std::vector<u32> created_entries;
+    std::vector<u32> evicted_entries;
+};
+
+REAPER_RENDERER_API ResourcePool create_resource_pool(u32 max_unused_frames);
+
+u64 hash_texture_properties(const GPUTextureProperties& properties);
+u64 hash_buffer_properties(const GPUBufferProperties& properties);
+
+// Assign a pool entry to each used resource of the frame graph.
+// Two resources of the same frame never share an entry.
+// Entries that weren't used for more than max_unused_frames are evicted at the same time.
+REAPER_RENDERER_API
+void resource_pool_acquire(ResourcePool& pool, const FrameGraph& framegraph, u64 frame_index,
+                           ResourcePoolFrameAllocation& allocation);
+
+// Placements are indexed by frame graph resource handles, leave them empty when everything is dedicated.
+REAPER_RENDERER_API
+void resource_pool_acquire(ResourcePool& pool, const FrameGraph& framegraph, u64 frame_index,
+                           std::span<const u64> texture_placements, std::span<const u64> buffer_placements,
+                           ResourcePoolFrameAllocation& allocation);
+
+// Evict all placed entries of one type, call this before the backend destroys the heap they live in.
+REAPER_RENDERER_API
+void resource_pool_evict_placed(ResourcePool& pool, bool is_texture, std::vector<u32>& evicted_entries);
+
+// Evict everything, this is useful when tearing down the backend.
+REAPER_RENDERER_API
+void resource_pool_clear(ResourcePool& pool, std::vector<u32>& evicted_entries);
+} // namespace Reaper::FrameGraph
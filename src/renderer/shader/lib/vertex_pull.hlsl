@@ -8,6 +8,11 @@
 #ifndef LIB_VERTEX_PULL_INCLUDED
 #define LIB_VERTEX_PULL_INCLUDED
 
+#include "lib/format/bitfield.hlsl"
+#include "lib/format/octahedral.hlsl"
+#include "lib/format/snorm.hlsl"
+#include "lib/format/unorm.hlsl"
+
 // https://github.com/KhronosGroup/glslang/issues/3297
 float3 pull_position(ByteAddressBuffer buffer_position, uint vertex_id)
 {
@@ -34,4 +39,52 @@ float2 pull_uv(ByteAddressBuffer buffer_attributes, uint vertex_id)
     return asfloat(buffer_attributes.Load2(vertex_id * AttributesSizeBytes + AttributesUVOffsetBytes));
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Quantized streams, the encode side lives in renderer/MeshQuantization.cpp
+
+const uint QuantizedPositionSizeBytes = 2 * 4;
+
+// Positions are unorm16 in the mesh AABB
+float3 pull_position_quantized(ByteAddressBuffer buffer_position, uint vertex_id, float3 dequantization_offset_ms,
+                               float3 dequantization_scale_ms)
+{
+    const uint2 position_unorm16 = buffer_position.Load2(vertex_id * QuantizedPositionSizeBytes);
+
+    const float3 position_unorm = float3(rg_unorm_generic_to_rg32_float(position_unorm16.x, 16),
+                                         r_unorm_generic_to_r32_float(position_unorm16.y & 0xFFFF, 16));
+
+    return dequantization_offset_ms + position_unorm * dequantization_scale_ms;
+}
+
+const uint QuantizedAttributesSizeBytes = 3 * 4;
+const uint QuantizedAttributesNormalOffsetBytes = 0;
+const uint QuantizedAttributesTangentOffsetBytes = 1 * 4;
+const uint QuantizedAttributesUVOffsetBytes = 2 * 4;
+const uint QuantizedTangentBitsPerChannel = 15;
+
+float3 pull_normal_quantized(ByteAddressBuffer buffer_attributes, uint vertex_id)
+{
+    const uint normal_oct_snorm16 = buffer_attributes.Load(vertex_id * QuantizedAttributesSizeBytes + QuantizedAttributesNormalOffsetBytes);
+
+    return decode_normal_octahedral_stubbe(rg_snorm_generic_to_rg32_float(normal_oct_snorm16, 16));
+}
+
+// The top bit holds the bitangent sign
+float4 pull_tangent_quantized(ByteAddressBuffer buffer_attributes, uint vertex_id)
+{
+    const uint tangent_oct = buffer_attributes.Load(vertex_id * QuantizedAttributesSizeBytes + QuantizedAttributesTangentOffsetBytes);
+
+    const float3 tangent = decode_normal_octahedral_stubbe(rg_snorm_generic_to_rg32_float(tangent_oct, QuantizedTangentBitsPerChannel));
+    const float bitangent_sign = bitfield_extract(tangent_oct, 31, 1) ? -1.0 : 1.0;
+
+    return float4(tangent, bitangent_sign);
+}
+
+float2 pull_uv_quantized(ByteAddressBuffer buffer_attributes, uint vertex_id)
+{
+    const uint uv_half2 = buffer_attributes.Load(vertex_id * QuantizedAttributesSizeBytes + QuantizedAttributesUVOffsetBytes);
+
+    return float2(f16tof32(uv_half2), f16tof32(uv_half2 >> 16));
+}
+
 #endif
@@ -17,4 +17,21 @@ struct StandardMaterial
     float ao;
 };
 
+// Texture residency feedback, read back by the CPU to decide which mips to stream in, see TextureResidency.h.
+// Views only cover the resident mips, view_mip_offset is the full resolution mip that the view starts at.
+// Each texture keeps the finest mip it was sampled at during the frame.
+void write_texture_feedback(RWByteAddressBuffer feedback, uint texture_index, uint view_mip_offset,
+                            Texture2D<float3> texture, float2 uv_ddx, float2 uv_ddy)
+{
+    uint width;
+    uint height;
+    texture.GetDimensions(width, height);
+
+    const float2 size = float2(width, height);
+    const float lod_view = log2(max(length(uv_ddx * size), length(uv_ddy * size)));
+    const int desired_mip = max(int(floor(lod_view)) + int(view_mip_offset), 0);
+
+    feedback.InterlockedMin(texture_index * 4, uint(desired_mip));
+}
+
 #endif
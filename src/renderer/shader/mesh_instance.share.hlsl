@@ -14,13 +14,18 @@
 static const hlsl_uint MaterialTextureMaxCount = 16;
 static const hlsl_uint ShadowMapMaxCount  = 8;
 
+// Cleared value of the texture residency feedback
+static const hlsl_uint TextureFeedbackNotSampled = 0xFFFFFFFF;
+
 struct MeshInstance
 {
     hlsl_float4x4 ms_to_cs_matrix; // FIXME
     hlsl_float3x4 ms_to_ws_matrix;
     hlsl_float3x3 normal_ms_to_vs_matrix;
-    hlsl_uint3    _pad;
+    hlsl_float3   position_dequantization_offset_ms; // Only read with quantized vertices
     hlsl_uint     material_index;
+    hlsl_float3   position_dequantization_scale_ms;
+    hlsl_float    _pad;
 };
 
 #endif
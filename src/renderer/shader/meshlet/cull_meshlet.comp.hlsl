@@ -48,7 +48,7 @@ void main(/*uint3 gtid : SV_GroupThreadID,*/
 
     if (spec_enable_frustum_culling)
     {
-        const CullMeshInstanceParams mesh_instance = cull_mesh_instance_params[consts.cull_instance_offset];
+        const CullMeshInstanceParams mesh_instance = cull_mesh_instance_params[cull_instance_id];
 
         float3 meshlet_aabb_min_ndc = FLT_MAX;
         float3 meshlet_aabb_max_ndc = -FLT_MAX;
@@ -88,7 +88,7 @@ void main(/*uint3 gtid : SV_GroupThreadID,*/
     // to do frustum/occlusion culling, the formula that doesn't use the apex may be preferable.
     if (spec_enable_cone_culling)
     {
-        const CullMeshInstanceParams mesh_instance = cull_mesh_instance_params[consts.cull_instance_offset];
+        const CullMeshInstanceParams mesh_instance = cull_mesh_instance_params[cull_instance_id];
 
         // FIXME only for perspective
         const float3 camera_position_ms = mesh_instance.vs_to_ms_matrix_translate;
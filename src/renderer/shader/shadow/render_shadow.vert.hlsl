@@ -18,8 +18,16 @@ struct VS_OUTPUT
 
 void main(in VS_INPUT input, uint instance_id : SV_InstanceID, out VS_OUTPUT output)
 {
+    const ShadowMapInstanceParams instance_data = instance_params[instance_id];
+
+#if defined(ENABLE_QUANTIZED_VERTICES)
+    const float3 position_ms = pull_position_quantized(buffer_position_ms, input.vertex_id,
+                                                       instance_data.position_dequantization_offset_ms,
+                                                       instance_data.position_dequantization_scale_ms);
+#else
     const float3 position_ms = pull_position(buffer_position_ms, input.vertex_id);
-    const float4 position_cs = mul(instance_params[instance_id].ms_to_cs_matrix, float4(position_ms, 1.0));
+#endif
+    const float4 position_cs = mul(instance_data.ms_to_cs_matrix, float4(position_ms, 1.0));
 
     output.position_cs = position_cs;
 }
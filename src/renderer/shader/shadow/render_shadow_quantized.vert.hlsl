@@ -0,0 +1,2 @@
+#define ENABLE_QUANTIZED_VERTICES
+#include "render_shadow.vert.hlsl"
@@ -13,6 +13,10 @@
 struct ShadowMapInstanceParams
 {
     hlsl_float4x4 ms_to_cs_matrix;
+    hlsl_float3   position_dequantization_offset_ms; // Only read with quantized vertices
+    hlsl_float    _pad0;
+    hlsl_float3   position_dequantization_scale_ms;
+    hlsl_float    _pad1;
 };
 
 #endif
@@ -41,15 +41,38 @@ VK_BINDING(0, Slot_visible_meshlets) StructuredBuffer<VisibleMeshlet> visible_me
 VK_BINDING(0, Slot_mesh_materials) StructuredBuffer<MeshMaterial> mesh_materials;
 VK_BINDING(0, Slot_diffuse_map_sampler) SamplerState diffuse_map_sampler;
 VK_BINDING(0, Slot_material_maps) Texture2D<float3> material_maps[MaterialTextureMaxCount];
+VK_BINDING(0, Slot_texture_view_mip_offsets) StructuredBuffer<uint> texture_view_mip_offsets;
+VK_BINDING(0, Slot_texture_feedback) RWByteAddressBuffer texture_feedback;
 
 struct VertexData
 {
     float3 position_ms;
     float3 normal_ms;
-    float3 tangent_ms;
+    float4 tangent_ms; // w is the bitangent sign
     float2 uv;
 };
 
+VertexData pull_vertex_data(MeshInstance instance_data, uint vertex_id)
+{
+    VertexData vertex_data;
+
+#if defined(ENABLE_QUANTIZED_VERTICES)
+    vertex_data.position_ms = pull_position_quantized(buffer_position_ms, vertex_id,
+                                                      instance_data.position_dequantization_offset_ms,
+                                                      instance_data.position_dequantization_scale_ms);
+    vertex_data.normal_ms = pull_normal_quantized(buffer_attributes, vertex_id);
+    vertex_data.tangent_ms = pull_tangent_quantized(buffer_attributes, vertex_id);
+    vertex_data.uv = pull_uv_quantized(buffer_attributes, vertex_id);
+#else
+    vertex_data.position_ms = pull_position(buffer_position_ms, vertex_id);
+    vertex_data.normal_ms = pull_normal(buffer_attributes, vertex_id);
+    vertex_data.tangent_ms = pull_tangent(buffer_attributes, vertex_id);
+    vertex_data.uv = pull_uv(buffer_attributes, vertex_id);
+#endif
+
+    return vertex_data;
+}
+
 [numthreads(GBufferFillThreadCountX, GBufferFillThreadCountY, 1)]
 void main(uint3 gtid : SV_GroupThreadID,
           uint3 gid  : SV_GroupID,
@@ -92,31 +115,15 @@ void main(uint3 gtid : SV_GroupThreadID,
     uint packed_indices = visible_index_buffer.Load(visible_index_offset * 4);
     uint3 indices = split_uint_32_to_3x8(packed_indices) + visible_meshlet.vertex_offset;
 
-    VertexData p0;
-    VertexData p1;
-    VertexData p2;
+    MeshInstance instance_data = instance_params[visible_meshlet.mesh_instance_id];
 
     // FIXME AoS or SoA?
-    p0.position_ms = pull_position(buffer_position_ms, indices.x);
-    p1.position_ms = pull_position(buffer_position_ms, indices.y);
-    p2.position_ms = pull_position(buffer_position_ms, indices.z);
+    VertexData p0 = pull_vertex_data(instance_data, indices.x);
+    VertexData p1 = pull_vertex_data(instance_data, indices.y);
+    VertexData p2 = pull_vertex_data(instance_data, indices.z);
 
-    p0.normal_ms = pull_normal(buffer_attributes, indices.x);
-    p1.normal_ms = pull_normal(buffer_attributes, indices.y);
-    p2.normal_ms = pull_normal(buffer_attributes, indices.z);
+    const float p0_bitangent_sign = p0.tangent_ms.w;
 
-    const float4 p0_tangent = pull_tangent(buffer_attributes, indices.x);
-    const float p0_bitangent_sign = p0_tangent.w;
-
-    p0.tangent_ms = p0_tangent.xyz;
-    p1.tangent_ms = pull_tangent(buffer_attributes, indices.y).xyz;
-    p2.tangent_ms = pull_tangent(buffer_attributes, indices.z).xyz;
-
-    p0.uv = pull_uv(buffer_attributes, indices.x);
-    p1.uv = pull_uv(buffer_attributes, indices.y);
-    p2.uv = pull_uv(buffer_attributes, indices.z);
-
-    MeshInstance instance_data = instance_params[visible_meshlet.mesh_instance_id];
     float4 p0_cs = mul(instance_data.ms_to_cs_matrix, float4(p0.position_ms, 1.0));
     float4 p1_cs = mul(instance_data.ms_to_cs_matrix, float4(p1.position_ms, 1.0));
     float4 p2_cs = mul(instance_data.ms_to_cs_matrix, float4(p2.position_ms, 1.0));
@@ -138,7 +145,7 @@ void main(uint3 gtid : SV_GroupThreadID,
     float3 geometric_normal_ms = interpolate_barycentrics_simple_float3(barycentrics.lambda, p0.normal_ms, p1.normal_ms, p2.normal_ms);
     float3 geometric_normal_vs = normalize(mul(instance_data.normal_ms_to_vs_matrix, geometric_normal_ms));
 
-    float3 tangent_ms = interpolate_barycentrics_simple_float3(barycentrics.lambda, p0.tangent_ms, p1.tangent_ms, p2.tangent_ms);
+    float3 tangent_ms = interpolate_barycentrics_simple_float3(barycentrics.lambda, p0.tangent_ms.xyz, p1.tangent_ms.xyz, p2.tangent_ms.xyz);
     float3 tangent_vs = normalize(mul(instance_data.normal_ms_to_vs_matrix, tangent_ms));
 
     MeshMaterial mesh_material = mesh_materials[instance_data.material_index];
@@ -153,6 +160,24 @@ void main(uint3 gtid : SV_GroupThreadID,
     material.f0 = material_maps[NonUniformResourceIndex(mesh_material.roughness_texture_index)].SampleGrad(diffuse_map_sampler, uv, uv_ddx, uv_ddy).y;
     material.ao = material_maps[NonUniformResourceIndex(mesh_material.ao_texture_index)].SampleGrad(diffuse_map_sampler, uv, uv_ddx, uv_ddy).x;
 
+    if (all(position_ts % TextureFeedbackTileSize == 0))
+    {
+        const uint texture_indices[4] = {
+            mesh_material.albedo_texture_index,
+            mesh_material.roughness_texture_index,
+            mesh_material.normal_texture_index,
+            mesh_material.ao_texture_index,
+        };
+
+        for (uint i = 0; i < 4; i++)
+        {
+            const uint texture_index = texture_indices[i];
+
+            write_texture_feedback(texture_feedback, texture_index, texture_view_mip_offsets[texture_index],
+                                   material_maps[NonUniformResourceIndex(texture_index)], uv_ddx, uv_ddy);
+        }
+    }
+
     const GBuffer gbuffer = gbuffer_from_standard_material(material);
     const GBufferRaw gbuffer_raw = encode_gbuffer(gbuffer);
 
@@ -23,6 +23,11 @@
 #define Slot_mesh_materials         10
 #define Slot_diffuse_map_sampler    11
 #define Slot_material_maps          12
+#define Slot_texture_view_mip_offsets 13
+#define Slot_texture_feedback       14
+
+// Only one pixel per tile writes texture feedback, the atomics would be too contended otherwise
+static const hlsl_uint TextureFeedbackTileSize = 4;
 
 static const hlsl_uint GBufferFillThreadCountX = 16;
 static const hlsl_uint GBufferFillThreadCountY = 16;
@@ -0,0 +1,3 @@
+#define ENABLE_MSAA_VIS_BUFFER
+#define ENABLE_QUANTIZED_VERTICES
+#include "fill_gbuffer.comp.hlsl"
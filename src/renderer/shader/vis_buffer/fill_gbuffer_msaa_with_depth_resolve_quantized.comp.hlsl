@@ -0,0 +1,4 @@
+#define ENABLE_MSAA_VIS_BUFFER
+#define ENABLE_MSAA_DEPTH_RESOLVE
+#define ENABLE_QUANTIZED_VERTICES
+#include "fill_gbuffer.comp.hlsl"
@@ -23,10 +23,17 @@ struct VS_OUTPUT
 void main(in VS_INPUT input, out VS_OUTPUT output)
 {
     VisibleMeshlet visible_meshlet = visible_meshlets[input.visible_meshlet_index];
+    MeshInstance instance_data = instance_params[visible_meshlet.mesh_instance_id];
 
-    float3 position_ms = pull_position(buffer_position_ms, input.vertex_id + visible_meshlet.vertex_offset);
+    const uint vertex_id = input.vertex_id + visible_meshlet.vertex_offset;
 
-    MeshInstance instance_data = instance_params[visible_meshlet.mesh_instance_id];
+#if defined(ENABLE_QUANTIZED_VERTICES)
+    float3 position_ms = pull_position_quantized(buffer_position_ms, vertex_id,
+                                                 instance_data.position_dequantization_offset_ms,
+                                                 instance_data.position_dequantization_scale_ms);
+#else
+    float3 position_ms = pull_position(buffer_position_ms, vertex_id);
+#endif
 
     output.position_cs = mul(instance_data.ms_to_cs_matrix, float4(position_ms, 1.0));
     output.visible_meshlet_index = input.visible_meshlet_index;
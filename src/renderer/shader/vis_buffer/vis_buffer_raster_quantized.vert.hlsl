@@ -0,0 +1,2 @@
+#define ENABLE_QUANTIZED_VERTICES
+#include "vis_buffer_raster.vert.hlsl"
@@ -0,0 +1,137 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include <doctest/doctest.h>
+
+#include "renderer/CookedMesh.h"
+
+#include <core/fs/MappedFile.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+using namespace Reaper;
+
+namespace
+{
+// Every LOD drops one triangle, the last LOD keeps at least one
+MeshletMesh create_test_meshlet_mesh(u32 triangle_count, u32 lod_count)
+{
+    MeshletMesh meshlet_mesh = {};
+
+    for (u32 lod_index = 0; lod_index < lod_count; lod_index++)
+    {
+        MeshletLod& lod = meshlet_mesh.lods.emplace_back();
+        const u32   lod_triangle_count = std::max(triangle_count - lod_index, 1u);
+
+        for (u32 i = 0; i < lod_triangle_count * 3; i++)
+        {
+            lod.mesh.indexes.push_back(i);
+            lod.mesh.positions.push_back(glm::fvec3(static_cast<float>(i), 1.f, 2.f));
+            lod.mesh.attributes.push_back(VertexAttributes{
+                .normal = glm::fvec3(0.f, 0.f, 1.f),
+                .uv = glm::fvec2(0.f, 0.f),
+                .tangent = glm::fvec4(1.f, 0.f, 0.f, 1.f),
+            });
+        }
+
+        Meshlet& meshlet = lod.meshlets.emplace_back();
+        meshlet.index_count = lod_triangle_count * 3;
+        meshlet.vertex_count = lod_triangle_count * 3;
+
+        lod.error_ms = static_cast<float>(lod_index) * 0.5f;
+    }
+
+    meshlet_mesh.aabb_min_ms = glm::fvec3(0.f, 1.f, 2.f);
+    meshlet_mesh.aabb_max_ms = glm::fvec3(static_cast<float>(triangle_count * 3 - 1), 1.f, 2.f);
+
+    return meshlet_mesh;
+}
+
+template <typename T>
+bool is_bit_identical(std::span<const T> a, const std::vector<T>& b)
+{
+    return a.size() == b.size() && memcmp(a.data(), b.data(), a.size_bytes()) == 0;
+}
+} // namespace
+
+TEST_CASE("Cooked mesh")
+{
+    const std::string file_path = (std::filesystem::temp_directory_path() / "reaper_cooked_mesh_test.rmesh").string();
+    const u64         source_hash = 0x1234;
+
+    const std::vector<MeshletMesh> meshes = {
+        create_test_meshlet_mesh(1, 1),
+        create_test_meshlet_mesh(7, Mesh2::MAX_MESH_LODS),
+    };
+
+    REQUIRE(write_cooked_mesh_file(file_path, meshes, source_hash));
+
+    MappedFile file;
+    REQUIRE(map_file(file_path, file));
+
+    const std::span<const u8> file_data(file.data, file.size_bytes);
+
+    SUBCASE("Round trip")
+    {
+        std::vector<MeshletMeshView> views;
+        REQUIRE(get_cooked_mesh_views(file_data, source_hash, views));
+        REQUIRE_EQ(views.size(), meshes.size());
+
+        for (u32 mesh_index = 0; mesh_index < meshes.size(); mesh_index++)
+        {
+            const MeshletMeshView& view = views[mesh_index];
+            const MeshletMesh&     expected = meshes[mesh_index];
+
+            REQUIRE_EQ(view.lod_count, expected.lods.size());
+            CHECK(view.aabb_min_ms == expected.aabb_min_ms);
+            CHECK(view.aabb_max_ms == expected.aabb_max_ms);
+
+            for (u32 lod_index = 0; lod_index < view.lod_count; lod_index++)
+            {
+                const MeshletLodView& lod_view = view.lods[lod_index];
+                const MeshletLod&     expected_lod = expected.lods[lod_index];
+
+                CHECK(is_bit_identical(lod_view.indexes, expected_lod.mesh.indexes));
+                CHECK(is_bit_identical(lod_view.positions, expected_lod.mesh.positions));
+                CHECK(is_bit_identical(lod_view.attributes, expected_lod.mesh.attributes));
+                CHECK(is_bit_identical(lod_view.meshlets, expected_lod.meshlets));
+                CHECK_EQ(lod_view.error_ms, expected_lod.error_ms);
+
+                // Arrays are read in place
+                CHECK_EQ(reinterpret_cast<uintptr_t>(lod_view.meshlets.data()) % CookedMeshAlignment, 0);
+            }
+        }
+    }
+
+    SUBCASE("Stale source")
+    {
+        std::vector<MeshletMeshView> views;
+        CHECK_FALSE(get_cooked_mesh_views(file_data, source_hash + 1, views));
+        CHECK(views.empty());
+    }
+
+    SUBCASE("Older version")
+    {
+        std::vector<u8> data(file_data.begin(), file_data.end());
+        reinterpret_cast<CookedMeshFileHeader*>(data.data())->version = CookedMeshVersion - 1;
+
+        std::vector<MeshletMeshView> views;
+        CHECK_FALSE(get_cooked_mesh_views(data, source_hash, views));
+    }
+
+    SUBCASE("Truncated")
+    {
+        std::vector<MeshletMeshView> views;
+        CHECK_FALSE(get_cooked_mesh_views(file_data.first(file_data.size() - 1), source_hash, views));
+        CHECK_FALSE(get_cooked_mesh_views(file_data.first(sizeof(CookedMeshFileHeader) - 1), source_hash, views));
+    }
+
+    unmap_file(file);
+    std::filesystem::remove(file_path);
+}
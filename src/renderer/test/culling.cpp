@@ -7,87 +7,161 @@
 
 #include <doctest/doctest.h>
 
+#include "renderer/Culling.h"
+
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
-struct Frustum
-{
-    glm::vec4 plane[6];
-};
+#include <chrono>
+#include <random>
 
-struct AABB
-{
-    glm::vec3 min;
-    glm::vec3 max;
-};
+using namespace Reaper;
 
 namespace
 {
-inline void transform_point(glm::vec3* p, const glm::mat3x4* mat)
+// Same test without any of the SoA/SIMD business
+std::vector<u32> cull_bounding_spheres_reference(const Frustum& frustum, const BoundingSpheres& spheres)
+{
+    std::vector<u32> visible_indices;
+
+    for (u32 sphere_index = 0; sphere_index < spheres.radius.size(); sphere_index++)
+    {
+        bool is_visible = true;
+
+        for (const glm::fvec4& plane : frustum.planes)
+        {
+            const float distance = plane.x * spheres.center_x[sphere_index] + plane.y * spheres.center_y[sphere_index]
+                                   + plane.z * spheres.center_z[sphere_index] + plane.w;
+
+            if (distance < -spheres.radius[sphere_index])
+                is_visible = false;
+        }
+
+        if (is_visible)
+            visible_indices.push_back(sphere_index);
+    }
+
+    return visible_indices;
+}
+
+BoundingSpheres generate_random_spheres(u32 count)
 {
-    glm::vec3 op = *p;
-    *p = (*mat) * op;
+    std::mt19937                          generator(42);
+    std::uniform_real_distribution<float> position_distribution(-200.f, 200.f);
+    std::uniform_real_distribution<float> radius_distribution(0.1f, 5.f);
+
+    BoundingSpheres spheres;
+    resize_bounding_spheres(spheres, count);
+
+    for (u32 i = 0; i < count; i++)
+    {
+        glm::fmat4x3 transform(1.f);
+        transform[3] = glm::fvec3(position_distribution(generator), position_distribution(generator),
+                                  position_distribution(generator));
+
+        set_bounding_sphere(spheres, i, transform, glm::fvec3(0.f), radius_distribution(generator));
+    }
+
+    return spheres;
 }
 
-inline float dot(const glm::vec3* v, const glm::vec4* p)
+glm::fmat4 test_view_proj_matrix()
 {
-    return v->x * p->x + v->y * p->y + v->z * p->z + p->w;
+    const glm::fmat4 projection = glm::perspective(glm::pi<float>() * 0.5f, 16.f / 9.f, 0.1f, 100.f);
+    const glm::fmat4 view = glm::lookAt(glm::fvec3(0.f), glm::fvec3(1.f, 0.f, 0.f), glm::fvec3(0.f, 1.f, 0.f));
+
+    return projection * view;
 }
+} // namespace
 
-bool is_visible(glm::mat3x4* transform, AABB* aabb, Frustum* frustum)
+TEST_CASE("Frustum culling")
 {
-    // get aabb points
-    glm::vec3 points[] = {{aabb->min.x, aabb->min.y, aabb->min.z}, {aabb->max.x, aabb->min.y, aabb->min.z},
-                          {aabb->max.x, aabb->max.y, aabb->min.z}, {aabb->min.x, aabb->max.y, aabb->min.z},
+    // Camera at the origin looking down +X
+    const Frustum frustum = build_frustum(test_view_proj_matrix());
 
-                          {aabb->min.x, aabb->min.y, aabb->max.z}, {aabb->max.x, aabb->min.y, aabb->max.z},
-                          {aabb->max.x, aabb->max.y, aabb->max.z}, {aabb->min.x, aabb->max.y, aabb->max.z}};
+    BoundingSpheres spheres;
+    resize_bounding_spheres(spheres, 6);
 
-    // transform points to world space
-    for (int i = 0; i < 8; ++i)
+    const glm::fmat4x3 identity(1.f);
+
+    set_bounding_sphere(spheres, 0, identity, glm::fvec3(10.f, 0.f, 0.f), 1.f);   // In front
+    set_bounding_sphere(spheres, 1, identity, glm::fvec3(-10.f, 0.f, 0.f), 1.f);  // Behind
+    set_bounding_sphere(spheres, 2, identity, glm::fvec3(200.f, 0.f, 0.f), 1.f);  // Past the far plane
+    set_bounding_sphere(spheres, 3, identity, glm::fvec3(10.f, 0.f, 30.f), 1.f);  // Way off to the side
+    set_bounding_sphere(spheres, 4, identity, glm::fvec3(10.f, 0.f, 30.f), 25.f); // Big enough to poke in
+    set_bounding_sphere(spheres, 5, identity, glm::fvec3(-0.5f, 0.f, 0.f), 1.f);  // Around the camera
+
+    std::vector<u32> visible_indices;
+    cull_bounding_spheres(frustum, spheres, visible_indices);
+
+    const std::vector<u32> expected_visible_indices = {0, 4, 5};
+    CHECK_EQ(visible_indices, expected_visible_indices);
+
+    SUBCASE("Scaled transform")
     {
-        transform_point(points + i, transform);
+        glm::fmat4x3 scale(1.f);
+        scale[2] = glm::fvec3(0.f, 0.f, 30.f);
+
+        set_bounding_sphere(spheres, 3, scale, glm::fvec3(10.f, 0.f, 1.f), 1.f);
+
+        CHECK_EQ(spheres.radius[3], 30.f);
+        CHECK_EQ(spheres.center_z[3], 30.f);
+
+        visible_indices.clear();
+        cull_bounding_spheres(frustum, spheres, visible_indices);
+
+        const std::vector<u32> expected_scaled_visible_indices = {0, 3, 4, 5};
+        CHECK_EQ(visible_indices, expected_scaled_visible_indices);
     }
 
-    // for each plane…
-    for (int i = 0; i < 6; ++i)
+    SUBCASE("Matches scalar version")
     {
-        bool inside = false;
+        // Not a multiple of the SIMD width on purpose
+        const BoundingSpheres random_spheres = generate_random_spheres(10003);
 
-        for (int j = 0; j < 8; ++j)
-        {
-            if (dot(points + j, frustum->plane + i) > 0)
-            {
-                inside = true;
-                break;
-            }
-        }
+        visible_indices.clear();
+        cull_bounding_spheres(frustum, random_spheres, visible_indices);
 
-        if (!inside)
-        {
-            return false;
-        }
+        CHECK(!visible_indices.empty());
+        CHECK_EQ(visible_indices, cull_bounding_spheres_reference(frustum, random_spheres));
     }
-
-    return true;
 }
-} // namespace
 
-TEST_CASE("Frustum culling")
+TEST_CASE("Frustum culling benchmark")
 {
-    float     angle = 30.0f;
-    glm::vec3 translation(125.0f, 5.0f, 10.0f);
-    glm::vec3 rotationDirection(3.0f, 1.0f, 0.0f);
-    glm::mat4 transform = glm::translate(glm::rotate(glm::mat4(1.0f), angle, rotationDirection), translation);
+    const u32             instance_count = 100000;
+    const u32             iteration_count = 20;
+    const Frustum         frustum = build_frustum(test_view_proj_matrix());
+    const BoundingSpheres spheres = generate_random_spheres(instance_count);
+
+    std::vector<u32> visible_indices;
+    visible_indices.reserve(instance_count);
+
+    using clock = std::chrono::high_resolution_clock;
+
+    const auto simd_start = clock::now();
+
+    for (u32 i = 0; i < iteration_count; i++)
+    {
+        visible_indices.clear();
+        cull_bounding_spheres(frustum, spheres, visible_indices);
+    }
+
+    const auto simd_end = clock::now();
+
+    std::vector<u32> reference_visible_indices;
 
-    AABB box = {{-1, -2, -3}, {1, 2, 3}};
+    for (u32 i = 0; i < iteration_count; i++)
+        reference_visible_indices = cull_bounding_spheres_reference(frustum, spheres);
 
-    // TODO compute frustum plane equations
-    Frustum frustum = {{{1, 0, 0, 10}, {-1, 0, 0, 10}, {0, 1, 0, 10}, {0, -1, 0, 10}, {0, 0, 1, 10}, {0, 0, -1, 10}}};
+    const auto reference_end = clock::now();
 
-    glm::mat3x4 hmatrix = {{0.123f, 0.456f, 0.789f, 1}, {0.456f, 0.123f, 0.789f, -1}, {0.789f, 0.123f, 0.456f, 1}};
+    CHECK_EQ(visible_indices, reference_visible_indices);
 
-    // glm::mat3x4 hmatrix = transform;
+    const auto simd_us = std::chrono::duration_cast<std::chrono::microseconds>(simd_end - simd_start).count();
+    const auto reference_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(reference_end - simd_end).count();
 
-    SUBCASE("visible") { CHECK(is_visible(&hmatrix, &box, &frustum)); }
+    MESSAGE("culling " << instance_count << " instances, " << visible_indices.size() << " visible: "
+                       << simd_us / iteration_count << "us (reference " << reference_us / iteration_count << "us)");
 }
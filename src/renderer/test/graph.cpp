@@ -7,11 +7,15 @@
 
 #include <doctest/doctest.h>
 
+#include "renderer/graph/CompileCache.h"
 #include "renderer/graph/FrameGraph.h"
 #include "renderer/graph/FrameGraphBuilder.h"
+#include "renderer/graph/MemoryAliasing.h"
+#include "renderer/graph/ResourcePool.h"
 
 #include "renderer/graph/GraphDebug.h"
 
+#include <chrono>
 #include <fstream>
 
 namespace Reaper
@@ -181,6 +185,38 @@ namespace FrameGraph
             CompositePass(builder, compositeOut, lightingOut);
             PresentPass(builder, compositeOut);
         }
+
+        // Long chain of passes where each one also reads a texture from a few passes before.
+        // Useful to stress the compiler with something bigger than a real frame.
+        void RecordSyntheticFrame(Builder& builder, u32 pass_count)
+        {
+            const GPUTextureProperties properties =
+                default_texture_properties(256, 256, PixelFormat::R16G16B16A16_UNORM, dummy_usage_flags);
+
+            const GPUTextureAccess write_access = {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                                   VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+                                                   VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL};
+            const GPUTextureAccess read_access = {VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT,
+                                                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+
+            const u32 read_distance = 4;
+
+            std::vector<ResourceUsageHandle> outputs;
+
+            for (u32 pass_index = 0; pass_index < pass_count; pass_index++)
+            {
+                const bool             is_last_pass = pass_index + 1 == pass_count;
+                const RenderPassHandle pass = builder.create_render_pass("Synthetic", is_last_pass);
+
+                if (pass_index > 0)
+                    builder.read_texture(pass, outputs[pass_index - 1], read_access);
+
+                if (pass_index >= read_distance)
+                    builder.read_texture(pass, outputs[pass_index - read_distance], read_access);
+
+                outputs.push_back(builder.create_texture(pass, "Output", properties, write_access));
+            }
+        }
     } // namespace
 } // namespace FrameGraph
 } // namespace Reaper
@@ -198,3 +234,678 @@ TEST_CASE("Frame Graph")
 
     // DumpFrameGraph(frameGraph);
 }
+
+TEST_CASE("Frame Graph resource pool")
+{
+    const u32    max_unused_frames = 2;
+    ResourcePool pool = create_resource_pool(max_unused_frames);
+
+    ResourcePoolFrameAllocation allocation;
+
+    u32 used_resource_count = 0;
+
+    // First frame, everything needs to be created
+    {
+        FrameGraph frameGraph;
+        Builder    builder(frameGraph);
+
+        RecordFrame(builder);
+
+        builder.build();
+
+        resource_pool_acquire(pool, frameGraph, 1, allocation);
+
+        for (const auto& resource : frameGraph.TextureResources)
+            used_resource_count += resource.is_used ? 1 : 0;
+
+        for (const auto& resource : frameGraph.BufferResources)
+            used_resource_count += resource.is_used ? 1 : 0;
+
+        CHECK(used_resource_count > 0);
+        CHECK_EQ(allocation.created_entries.size(), used_resource_count);
+        CHECK(allocation.evicted_entries.empty());
+
+        // Pruned resources don't get anything from the pool
+        for (u32 index = 0; index < frameGraph.TextureResources.size(); index++)
+        {
+            const bool has_entry = allocation.texture_entries[index] != InvalidResourcePoolEntry;
+            CHECK_EQ(has_entry, frameGraph.TextureResources[index].is_used);
+        }
+    }
+
+    const std::vector<u32> first_frame_texture_entries = allocation.texture_entries;
+
+    // Identical second frame, nothing should be allocated
+    {
+        FrameGraph frameGraph;
+        Builder    builder(frameGraph);
+
+        RecordFrame(builder);
+
+        builder.build();
+
+        resource_pool_acquire(pool, frameGraph, 2, allocation);
+
+        CHECK(allocation.created_entries.empty());
+        CHECK(allocation.evicted_entries.empty());
+        CHECK(allocation.texture_entries == first_frame_texture_entries);
+    }
+
+    SUBCASE("Same properties in the same frame")
+    {
+        FrameGraph frameGraph;
+        Builder    builder(frameGraph);
+
+        const RenderPassHandle             pass = builder.create_render_pass("Pass", true);
+        const Reaper::GPUTextureProperties properties = Reaper::default_texture_properties(
+            512, 512, PixelFormat::R16G16B16A16_UNORM, Reaper::dummy_usage_flags);
+
+        builder.create_texture(pass, "A", properties, Reaper::GPUTextureAccess{});
+        builder.create_texture(pass, "B", properties, Reaper::GPUTextureAccess{});
+
+        builder.build();
+
+        resource_pool_acquire(pool, frameGraph, 3, allocation);
+
+        // The shadow map from the previous frames can be reused once, but not twice
+        CHECK_EQ(allocation.created_entries.size(), 1);
+        CHECK(allocation.texture_entries[0] != allocation.texture_entries[1]);
+    }
+
+    SUBCASE("Eviction")
+    {
+        FrameGraph frameGraph;
+        Builder    builder(frameGraph);
+
+        const RenderPassHandle pass = builder.create_render_pass("Empty", true);
+        static_cast<void>(pass);
+
+        builder.build();
+
+        resource_pool_acquire(pool, frameGraph, 2 + max_unused_frames, allocation);
+        CHECK(allocation.evicted_entries.empty());
+
+        resource_pool_acquire(pool, frameGraph, 3 + max_unused_frames, allocation);
+        CHECK_EQ(allocation.evicted_entries.size(), used_resource_count);
+
+        std::vector<u32> evicted_entries;
+        resource_pool_clear(pool, evicted_entries);
+        CHECK(evicted_entries.empty());
+    }
+}
+
+TEST_CASE("Frame Graph memory aliasing")
+{
+    const ResourceHandle handle_a = {.index = 0, .is_texture = true};
+    const ResourceHandle handle_b = {.index = 1, .is_texture = true};
+    const ResourceHandle handle_c = {.index = 2, .is_texture = true};
+
+    TransientHeapLayout layout;
+
+    SUBCASE("Disjoint lifetimes")
+    {
+        const TransientResource resources[] = {
+            {.resource_handle = handle_a, .size_bytes = 1000, .alignment = 256, .lifetime = {0, 1}},
+            {.resource_handle = handle_b, .size_bytes = 500, .alignment = 256, .lifetime = {2, 3}},
+        };
+
+        compute_transient_heap_layout(resources, layout);
+
+        CHECK_EQ(layout.offsets[0], 0);
+        CHECK_EQ(layout.offsets[1], 0);
+        CHECK_EQ(layout.heap_size_bytes, 1000);
+        CHECK_EQ(layout.total_size_bytes, 1500);
+
+        REQUIRE_EQ(layout.aliases.size(), 1);
+        CHECK_EQ(layout.aliases[0].resource_handle.index, handle_b.index);
+        CHECK_EQ(layout.aliases[0].previous_resource_handle.index, handle_a.index);
+    }
+
+    SUBCASE("Overlapping lifetimes")
+    {
+        const TransientResource resources[] = {
+            {.resource_handle = handle_a, .size_bytes = 1000, .alignment = 256, .lifetime = {0, 2}},
+            {.resource_handle = handle_b, .size_bytes = 1000, .alignment = 256, .lifetime = {2, 3}},
+            {.resource_handle = handle_c, .size_bytes = 100, .alignment = 64, .lifetime = {3, 3}},
+        };
+
+        compute_transient_heap_layout(resources, layout);
+
+        // B can't start before the end of A, aligned
+        CHECK_EQ(layout.offsets[0], 0);
+        CHECK_EQ(layout.offsets[1], 1024);
+        CHECK_EQ(layout.heap_size_bytes, 2024);
+
+        // C fits in the memory left by A
+        CHECK_EQ(layout.offsets[2], 0);
+        REQUIRE_EQ(layout.aliases.size(), 1);
+        CHECK_EQ(layout.aliases[0].resource_handle.index, handle_c.index);
+        CHECK_EQ(layout.aliases[0].previous_resource_handle.index, handle_a.index);
+    }
+
+    SUBCASE("Aliasing barriers")
+    {
+        FrameGraph frameGraph;
+        Builder    builder(frameGraph);
+
+        const Reaper::GPUTextureProperties properties =
+            Reaper::default_texture_properties(512, 512, PixelFormat::R16G16B16A16_UNORM, Reaper::dummy_usage_flags);
+
+        const Reaper::GPUTextureAccess write_access = {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                                       VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+                                                       VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL};
+        const Reaper::GPUTextureAccess read_access = {VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+                                                      VK_ACCESS_2_SHADER_READ_BIT,
+                                                      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+
+        // Simple chain where each texture is only alive for two passes
+        const RenderPassHandle    pass_0 = builder.create_render_pass("Pass 0");
+        const ResourceUsageHandle usage_a = builder.create_texture(pass_0, "A", properties, write_access);
+
+        const RenderPassHandle    pass_1 = builder.create_render_pass("Pass 1");
+        const ResourceUsageHandle usage_b = builder.create_texture(pass_1, "B", properties, write_access);
+        builder.read_texture(pass_1, usage_a, read_access);
+
+        const RenderPassHandle    pass_2 = builder.create_render_pass("Pass 2");
+        const ResourceUsageHandle usage_c = builder.create_texture(pass_2, "C", properties, write_access);
+        builder.read_texture(pass_2, usage_b, read_access);
+
+        const RenderPassHandle pass_3 = builder.create_render_pass("Pass 3", true);
+        builder.read_texture(pass_3, usage_c, read_access);
+
+        builder.build();
+
+        FrameGraphSchedule schedule;
+        compute_schedule_order(frameGraph, schedule);
+
+        std::vector<ResourceLifetime> texture_lifetimes;
+        std::vector<ResourceLifetime> buffer_lifetimes;
+        compute_resource_lifetimes(frameGraph, schedule, texture_lifetimes, buffer_lifetimes);
+
+        REQUIRE_EQ(texture_lifetimes.size(), 3);
+        CHECK_EQ(texture_lifetimes[0].first_pass_index, 0);
+        CHECK_EQ(texture_lifetimes[0].last_pass_index, 1);
+        CHECK_EQ(texture_lifetimes[2].first_pass_index, 2);
+        CHECK_EQ(texture_lifetimes[2].last_pass_index, 3);
+
+        std::vector<TransientResource> resources;
+
+        for (u32 index = 0; index < texture_lifetimes.size(); index++)
+        {
+            resources.push_back(TransientResource{
+                .resource_handle = ResourceHandle{.index = index, .is_texture = true},
+                .size_bytes = 1024,
+                .alignment = 1024,
+                .lifetime = texture_lifetimes[index],
+            });
+        }
+
+        compute_transient_heap_layout(resources, layout);
+
+        // A and C share memory
+        CHECK_EQ(layout.heap_size_bytes, 2048);
+        CHECK_EQ(layout.offsets[0], layout.offsets[2]);
+        REQUIRE_EQ(layout.aliases.size(), 1);
+
+        compute_schedule_barriers(frameGraph, layout.aliases, schedule);
+
+        u32 aliasing_barrier_count = 0;
+
+        for (const Barrier& barrier : schedule.barriers)
+        {
+            if (barrier.is_aliasing)
+            {
+                aliasing_barrier_count++;
+
+                // C waits for the last read of A before being written to
+                CHECK_EQ(barrier.src.render_pass, pass_1);
+                CHECK_EQ(barrier.dst.render_pass, pass_2);
+                CHECK_EQ(barrier.src.access.image_layout, VK_IMAGE_LAYOUT_UNDEFINED);
+                CHECK((barrier.src.access.stage_mask & VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT) != 0);
+            }
+        }
+
+        CHECK_EQ(aliasing_barrier_count, 1);
+
+        // Without aliases the schedule should be identical to a regular one
+        const FrameGraphSchedule regular_schedule = compute_schedule(frameGraph);
+        compute_schedule_barriers(frameGraph, {}, schedule);
+
+        CHECK_EQ(schedule.barriers.size(), regular_schedule.barriers.size());
+        CHECK_EQ(schedule.barrier_events.size(), regular_schedule.barrier_events.size());
+    }
+}
+
+TEST_CASE("Frame Graph async compute")
+{
+    using namespace Reaper::FrameGraph;
+
+    FrameGraph frameGraph;
+    Builder    builder(frameGraph);
+
+    const Reaper::GPUTextureProperties properties =
+        Reaper::default_texture_properties(512, 512, PixelFormat::R16G16B16A16_UNORM, Reaper::dummy_usage_flags);
+
+    const Reaper::GPUTextureAccess render_access = {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                                    VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+                                                    VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL};
+    const Reaper::GPUTextureAccess compute_access = {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                                                     VK_ACCESS_2_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL};
+    const Reaper::GPUTextureAccess read_access = {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                                                  VK_ACCESS_2_SHADER_READ_BIT,
+                                                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+
+    // Depth -> HZB on async compute, shading in parallel on the graphics queue, both joined for the composite.
+    const RenderPassHandle    pass_depth = builder.create_render_pass("Depth");
+    const ResourceUsageHandle depth_usage = builder.create_texture(pass_depth, "Depth", properties, render_access);
+
+    const RenderPassHandle pass_hzb = builder.create_render_pass("HZB", false, QueueType::AsyncCompute);
+    builder.read_texture(pass_hzb, depth_usage, read_access);
+    const ResourceUsageHandle hzb_usage = builder.create_texture(pass_hzb, "HZB", properties, compute_access);
+
+    const RenderPassHandle    pass_shading = builder.create_render_pass("Shading");
+    const ResourceUsageHandle color_usage = builder.create_texture(pass_shading, "Color", properties, render_access);
+
+    const RenderPassHandle pass_composite = builder.create_render_pass("Composite", true);
+    builder.read_texture(pass_composite, hzb_usage, read_access);
+    builder.read_texture(pass_composite, color_usage, read_access);
+
+    builder.build();
+
+    SUBCASE("Disabled")
+    {
+        FrameGraphSchedule schedule;
+        compute_schedule_order(frameGraph, schedule, false);
+        compute_schedule_barriers(frameGraph, {}, schedule);
+
+        CHECK_EQ(schedule.queue0.size(), 4);
+        CHECK(schedule.queue1.empty());
+
+        REQUIRE_EQ(schedule.submit_batches.size(), 1);
+        CHECK_EQ(schedule.submit_batches[0].queue_type, QueueType::Graphics);
+        CHECK_EQ(schedule.submit_batches[0].pass_count, 4);
+        CHECK_EQ(schedule.submit_batches[0].wait_values[QueueType::AsyncCompute], 0);
+
+        for (const BarrierEvent& barrier_event : schedule.barrier_events)
+        {
+            CHECK_EQ(barrier_event.barrier_type & BarrierType::CrossQueue, 0);
+        }
+
+        const FrameGraphSchedule regular_schedule = compute_schedule(frameGraph);
+
+        CHECK_EQ(schedule.barriers.size(), regular_schedule.barriers.size());
+        CHECK_EQ(schedule.barrier_events.size(), regular_schedule.barrier_events.size());
+    }
+
+    SUBCASE("Enabled")
+    {
+        FrameGraphSchedule schedule;
+        compute_schedule_order(frameGraph, schedule, true);
+
+        REQUIRE_EQ(schedule.queue0.size(), 3);
+        REQUIRE_EQ(schedule.queue1.size(), 1);
+        CHECK_EQ(schedule.queue1[0], pass_hzb);
+        CHECK_EQ(schedule.render_pass_queues[pass_hzb], QueueType::AsyncCompute);
+
+        // Async resources can't be aliased, they live for the whole frame
+        std::vector<ResourceLifetime> texture_lifetimes;
+        std::vector<ResourceLifetime> buffer_lifetimes;
+        compute_resource_lifetimes(frameGraph, schedule, texture_lifetimes, buffer_lifetimes);
+
+        REQUIRE_EQ(texture_lifetimes.size(), 3);
+        CHECK_EQ(texture_lifetimes[1].first_pass_index, 0);
+        CHECK_EQ(texture_lifetimes[1].last_pass_index, 3);
+        CHECK_EQ(texture_lifetimes[2].first_pass_index, 2);
+        CHECK_EQ(texture_lifetimes[2].last_pass_index, 3);
+
+        compute_schedule_barriers(frameGraph, {}, schedule);
+
+        u32 release_count = 0;
+        u32 acquire_count = 0;
+
+        for (const BarrierEvent& barrier_event : schedule.barrier_events)
+        {
+            const Barrier& barrier = schedule.barriers[barrier_event.barrier_handle];
+
+            if (barrier_event.barrier_type == BarrierType::QueueRelease)
+            {
+                release_count++;
+                CHECK_EQ(barrier_event.render_pass_handle, barrier.src.last_render_pass);
+            }
+            else if (barrier_event.barrier_type == BarrierType::QueueAcquire)
+            {
+                acquire_count++;
+                CHECK_EQ(barrier_event.render_pass_handle, barrier.dst.render_pass);
+                CHECK((barrier_event.render_pass_handle == pass_hzb
+                       || barrier_event.render_pass_handle == pass_composite));
+            }
+        }
+
+        // Depth goes to the compute queue, HZB comes back
+        CHECK_EQ(release_count, 2);
+        CHECK_EQ(acquire_count, 2);
+
+        // The composite needs its own batch since it waits on the compute queue
+        REQUIRE_EQ(schedule.submit_batches.size(), 3);
+
+        const SubmitBatch& graphics_batch_0 = schedule.submit_batches[schedule.render_pass_batches[pass_depth]];
+        const SubmitBatch& graphics_batch_1 = schedule.submit_batches[schedule.render_pass_batches[pass_composite]];
+        const SubmitBatch& compute_batch = schedule.submit_batches[schedule.render_pass_batches[pass_hzb]];
+
+        CHECK_EQ(schedule.render_pass_batches[pass_depth], schedule.render_pass_batches[pass_shading]);
+        CHECK_EQ(graphics_batch_0.pass_count, 2);
+        CHECK_EQ(graphics_batch_0.signal_value, 1);
+        CHECK_EQ(graphics_batch_0.wait_values[QueueType::AsyncCompute], 0);
+
+        CHECK_EQ(graphics_batch_1.pass_offset, 2);
+        CHECK_EQ(graphics_batch_1.signal_value, 2);
+        CHECK_EQ(graphics_batch_1.wait_values[QueueType::AsyncCompute], compute_batch.signal_value);
+
+        CHECK_EQ(compute_batch.queue_type, QueueType::AsyncCompute);
+        CHECK_EQ(compute_batch.signal_value, 1);
+        CHECK_EQ(compute_batch.wait_values[QueueType::Graphics], graphics_batch_0.signal_value);
+    }
+}
+
+TEST_CASE("Frame Graph async compute readers")
+{
+    using namespace Reaper::FrameGraph;
+
+    FrameGraph frameGraph;
+    Builder    builder(frameGraph);
+
+    const Reaper::GPUTextureProperties properties =
+        Reaper::default_texture_properties(512, 512, PixelFormat::R16G16B16A16_UNORM, Reaper::dummy_usage_flags);
+
+    const Reaper::GPUTextureAccess render_access = {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                                    VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+                                                    VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL};
+    const Reaper::GPUTextureAccess read_access = {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                                                  VK_ACCESS_2_SHADER_READ_BIT,
+                                                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+
+    const RenderPassHandle    pass_render = builder.create_render_pass("Render");
+    const ResourceUsageHandle scene_usage = builder.create_texture(pass_render, "Scene", properties, render_access);
+
+    const RenderPassHandle pass_histogram = builder.create_render_pass("Histogram", true, QueueType::AsyncCompute);
+    builder.read_texture(pass_histogram, scene_usage, read_access);
+
+    const RenderPassHandle pass_exposure = builder.create_render_pass("Exposure", true, QueueType::AsyncCompute);
+    builder.read_texture(pass_exposure, scene_usage, read_access);
+
+    const RenderPassHandle pass_overwrite = builder.create_render_pass("Overwrite", true);
+    builder.write_texture(pass_overwrite, scene_usage, render_access);
+
+    builder.build();
+
+    FrameGraphSchedule schedule;
+    compute_schedule_order(frameGraph, schedule, true);
+    compute_schedule_barriers(frameGraph, {}, schedule);
+
+    u32 release_count = 0;
+
+    for (const BarrierEvent& barrier_event : schedule.barrier_events)
+    {
+        if (barrier_event.barrier_type == BarrierType::QueueRelease
+            && schedule.render_pass_queues[barrier_event.render_pass_handle] == QueueType::AsyncCompute)
+        {
+            release_count++;
+
+            // Both readers were merged, the compute queue can only let go of the texture after the last one
+            CHECK_EQ(barrier_event.render_pass_handle, pass_exposure);
+        }
+    }
+
+    CHECK_EQ(release_count, 1);
+
+    // Both compute passes only wait once
+    CHECK_EQ(schedule.render_pass_batches[pass_histogram], schedule.render_pass_batches[pass_exposure]);
+}
+
+TEST_CASE("Frame Graph compile cache")
+{
+    const u32 pass_count = 8;
+
+    CompileCache cache = {};
+
+    FrameGraph first_frame;
+    {
+        Builder builder(first_frame);
+        RecordSyntheticFrame(builder, pass_count);
+    }
+
+    CHECK_FALSE(build_cached(cache, first_frame));
+    CHECK_FALSE(compute_schedule_order_cached(cache, first_frame, false));
+    CHECK_FALSE(compute_schedule_barriers_cached(cache, first_frame, {}));
+
+    // Identical second frame, everything comes from the cache
+    FrameGraph second_frame;
+    {
+        Builder builder(second_frame);
+        RecordSyntheticFrame(builder, pass_count);
+    }
+
+    CHECK_EQ(compute_topology_hash(first_frame), compute_topology_hash(second_frame));
+
+    CHECK(build_cached(cache, second_frame));
+
+    for (u32 index = 0; index < second_frame.RenderPasses.size(); index++)
+        CHECK_EQ(second_frame.RenderPasses[index].is_used, first_frame.RenderPasses[index].is_used);
+
+    for (u32 index = 0; index < second_frame.TextureResources.size(); index++)
+        CHECK_EQ(second_frame.TextureResources[index].is_used, first_frame.TextureResources[index].is_used);
+
+    SUBCASE("Same schedule")
+    {
+        CHECK(compute_schedule_order_cached(cache, second_frame, false));
+        CHECK(compute_schedule_barriers_cached(cache, second_frame, {}));
+
+        const FrameGraphSchedule regular_schedule = compute_schedule(second_frame);
+
+        CHECK(cache.schedule.queue0 == regular_schedule.queue0);
+        REQUIRE_EQ(cache.schedule.barrier_events.size(), regular_schedule.barrier_events.size());
+
+        for (u32 index = 0; index < regular_schedule.barrier_events.size(); index++)
+        {
+            const BarrierEvent& cached_event = cache.schedule.barrier_events[index];
+            const BarrierEvent& regular_event = regular_schedule.barrier_events[index];
+
+            CHECK_EQ(cached_event.barrier_type, regular_event.barrier_type);
+            CHECK_EQ(cached_event.barrier_handle, regular_event.barrier_handle);
+            CHECK_EQ(cached_event.render_pass_handle, regular_event.render_pass_handle);
+        }
+    }
+
+    SUBCASE("Async compute toggle")
+    {
+        CHECK_FALSE(compute_schedule_order_cached(cache, second_frame, true));
+        CHECK_FALSE(compute_schedule_barriers_cached(cache, second_frame, {}));
+    }
+
+    SUBCASE("Different aliases")
+    {
+        // The first texture is last read by pass 4, the one created by pass 5 can reuse its memory
+        const ResourceHandle handle_a = {.index = 0, .is_texture = true};
+        const ResourceHandle handle_b = {.index = 5, .is_texture = true};
+        const ResourceAlias  aliases[] = {{.resource_handle = handle_b, .previous_resource_handle = handle_a}};
+
+        CHECK(compute_schedule_order_cached(cache, second_frame, false));
+        CHECK_FALSE(compute_schedule_barriers_cached(cache, second_frame, aliases));
+    }
+
+    SUBCASE("Different topology")
+    {
+        FrameGraph resized_frame;
+        Builder    builder(resized_frame);
+
+        RecordSyntheticFrame(builder, pass_count);
+
+        resized_frame.TextureResources[0].properties.texture.width *= 2;
+
+        CHECK_NE(compute_topology_hash(resized_frame), compute_topology_hash(second_frame));
+        CHECK_FALSE(build_cached(cache, resized_frame));
+        CHECK_FALSE(compute_schedule_order_cached(cache, resized_frame, false));
+    }
+}
+
+TEST_CASE("Frame Graph compile cache benchmark")
+{
+    using clock = std::chrono::steady_clock;
+
+    const u32 pass_count = 256;
+    const u32 iteration_count = 100;
+
+    FrameGraph frameGraph;
+    Builder    builder(frameGraph);
+
+    RecordSyntheticFrame(builder, pass_count);
+
+    CompileCache cache = {};
+
+    const auto compile = [&]() {
+        build_cached(cache, frameGraph);
+        compute_schedule_order_cached(cache, frameGraph, false);
+        compute_schedule_barriers_cached(cache, frameGraph, {});
+    };
+
+    const clock::time_point cold_start = clock::now();
+
+    for (u32 iteration = 0; iteration < iteration_count; iteration++)
+    {
+        invalidate_compile_cache(cache);
+        compile();
+    }
+
+    const clock::time_point cached_start = clock::now();
+
+    for (u32 iteration = 0; iteration < iteration_count; iteration++)
+    {
+        compile();
+    }
+
+    const clock::time_point cached_end = clock::now();
+
+    const auto cold_us = std::chrono::duration_cast<std::chrono::microseconds>(cached_start - cold_start).count();
+    const auto cached_us = std::chrono::duration_cast<std::chrono::microseconds>(cached_end - cached_start).count();
+
+    MESSAGE("compiling " << pass_count << " passes: cold " << cold_us / iteration_count << "us, cached "
+                         << cached_us / iteration_count << "us");
+
+    CHECK_EQ(cache.schedule.queue0.size(), pass_count);
+}
+
+TEST_CASE("Frame Graph DAG")
+{
+    // 0 -> 1 -> 3 and 0 -> 2 -> 3
+    DirectedAcyclicGraph dag;
+    dag.ChildOffsets = {0, 2, 3, 4, 4};
+    dag.Children = {1, 2, 3, 3};
+
+    REQUIRE_EQ(get_node_count(dag), 4);
+    CHECK_EQ(get_children(dag, 0).size(), 2);
+    CHECK(get_children(dag, 3).empty());
+
+    SUBCASE("Topological order")
+    {
+        std::vector<DirectedAcyclicGraph::index_type> order;
+        CHECK(ComputeTopologicalOrder(dag, order));
+
+        REQUIRE_EQ(order.size(), 4);
+        CHECK_EQ(order.front(), 0);
+        CHECK_EQ(order.back(), 3);
+        CHECK_FALSE(HasCycles(dag));
+    }
+
+    SUBCASE("Cycle")
+    {
+        // 3 -> 1
+        dag.ChildOffsets = {0, 2, 3, 4, 5};
+        dag.Children = {1, 2, 3, 3, 1};
+
+        CHECK(HasCycles(dag));
+    }
+
+    SUBCASE("Transitive closure")
+    {
+        const DirectedAcyclicGraph::index_type root_nodes[] = {1};
+
+        std::vector<DirectedAcyclicGraph::index_type> closure;
+        ComputeTransitiveClosure(dag, root_nodes, closure);
+
+        // Nodes reachable through several paths only appear once
+        REQUIRE_EQ(closure.size(), 2);
+        CHECK_EQ(closure[0], 1);
+        CHECK_EQ(closure[1], 3);
+    }
+}
+
+TEST_CASE("Frame Graph barrier event ranges")
+{
+    const u32 pass_count = 16;
+
+    FrameGraph frameGraph;
+    Builder    builder(frameGraph);
+
+    RecordSyntheticFrame(builder, pass_count);
+
+    builder.build();
+
+    const FrameGraphSchedule schedule = compute_schedule(frameGraph);
+
+    u32 event_count = 0;
+
+    for (u32 pass_index = 0; pass_index < pass_count; pass_index++)
+    {
+        for (bool execute_before_pass : {true, false})
+        {
+            const RenderPassHandle render_pass_handle = RenderPassHandle(pass_index);
+
+            for (const BarrierEvent& barrier_event :
+                 get_barriers_to_execute(schedule, render_pass_handle, execute_before_pass))
+            {
+                CHECK_EQ(barrier_event.render_pass_handle, render_pass_handle);
+                CHECK_EQ((barrier_event.barrier_type & BarrierType::ExecuteBeforePass) != 0, execute_before_pass);
+                event_count++;
+            }
+        }
+    }
+
+    // Every event is reachable from its pass
+    CHECK_EQ(event_count, schedule.barrier_events.size());
+}
+
+TEST_CASE("Frame Graph large graph benchmark")
+{
+    using clock = std::chrono::steady_clock;
+
+    // Roughly what we get with per-light shadow passes, per-cascade passes and per-view culling
+    const u32 pass_count = 10000;
+
+    FrameGraph frameGraph;
+    Builder    builder(frameGraph);
+
+    const clock::time_point record_start = clock::now();
+
+    RecordSyntheticFrame(builder, pass_count);
+
+    const clock::time_point build_start = clock::now();
+
+    builder.build();
+
+    const clock::time_point schedule_start = clock::now();
+
+    const FrameGraphSchedule schedule = compute_schedule(frameGraph);
+
+    const clock::time_point schedule_end = clock::now();
+
+    const auto to_us = [](clock::duration duration) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    };
+
+    MESSAGE("compiling " << pass_count << " passes: record " << to_us(build_start - record_start) << "us, build "
+                         << to_us(schedule_start - build_start) << "us, schedule "
+                         << to_us(schedule_end - schedule_start) << "us");
+
+    CHECK_EQ(schedule.queue0.size(), pass_count);
+    CHECK_FALSE(schedule.barrier_events.empty());
+}
@@ -0,0 +1,131 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include <doctest/doctest.h>
+
+#include "renderer/MeshAllocator.h"
+
+#include <array>
+#include <vector>
+
+using namespace Reaper;
+
+namespace
+{
+MeshHandle allocate_test_mesh(MeshAllocator& allocator, u32 index_count, u32 vertex_count, u32 meshlet_count)
+{
+    MeshAlloc alloc;
+
+    if (!allocate_mesh_ranges(allocator, index_count, vertex_count, meshlet_count, alloc))
+        return InvalidMeshHandle;
+
+    return insert_mesh2(allocator, create_mesh2(alloc, glm::fvec3(-1.f), glm::fvec3(1.f)));
+}
+} // namespace
+
+TEST_CASE("Mesh allocator")
+{
+    MeshAllocator allocator = create_mesh_allocator(300, 100, 10);
+
+    SUBCASE("Handles")
+    {
+        const MeshHandle a = allocate_test_mesh(allocator, 30, 10, 1);
+        const MeshHandle b = allocate_test_mesh(allocator, 30, 10, 1);
+
+        REQUIRE_NE(a, InvalidMeshHandle);
+        REQUIRE_NE(b, InvalidMeshHandle);
+        CHECK(is_mesh_handle_valid(allocator, a));
+        CHECK(is_mesh_handle_valid(allocator, b));
+        CHECK_FALSE(is_mesh_handle_valid(allocator, InvalidMeshHandle));
+
+        remove_mesh2(allocator, a, 0);
+        CHECK_FALSE(is_mesh_handle_valid(allocator, a));
+        CHECK(is_mesh_handle_valid(allocator, b));
+
+        // The slot is reused but the old handle stays stale
+        const MeshHandle c = allocate_test_mesh(allocator, 30, 10, 1);
+
+        CHECK_EQ(get_mesh_handle_index(c), get_mesh_handle_index(a));
+        CHECK_NE(get_mesh_handle_generation(c), get_mesh_handle_generation(a));
+        CHECK(is_mesh_handle_valid(allocator, c));
+        CHECK_FALSE(is_mesh_handle_valid(allocator, a));
+    }
+
+    SUBCASE("Deferred release")
+    {
+        const MeshHandle a = allocate_test_mesh(allocator, 300, 100, 10);
+
+        REQUIRE_NE(a, InvalidMeshHandle);
+        CHECK_EQ(allocate_test_mesh(allocator, 3, 1, 1), InvalidMeshHandle);
+
+        remove_mesh2(allocator, a, 5);
+
+        // Frames in flight might still read the ranges
+        release_retired_mesh_ranges(allocator, 4);
+        CHECK_EQ(allocate_test_mesh(allocator, 3, 1, 1), InvalidMeshHandle);
+
+        release_retired_mesh_ranges(allocator, 5);
+        CHECK(allocator.retired_ranges.empty());
+        CHECK_NE(allocate_test_mesh(allocator, 300, 100, 10), InvalidMeshHandle);
+    }
+
+    SUBCASE("Failed allocation rolls back")
+    {
+        MeshAlloc alloc;
+
+        // Meshlets don't fit, indices and vertices shouldn't leak
+        CHECK_FALSE(allocate_mesh_ranges(allocator, 30, 10, 11, alloc));
+
+        for (const RangeAllocator& range_allocator : allocator.range_allocators)
+            CHECK_EQ(range_allocator.used, 0);
+    }
+
+    SUBCASE("Defragmentation")
+    {
+        const MeshHandle a = allocate_test_mesh(allocator, 30, 10, 1);
+        const MeshHandle b = allocate_test_mesh(allocator, 30, 10, 1);
+
+        remove_mesh2(allocator, a, 1);
+        release_retired_mesh_ranges(allocator, 1);
+
+        std::vector<MeshRangeMove> moves;
+        defragment_mesh_allocator(allocator, 8, 2, moves);
+
+        // Every buffer of b moves down to where a was, the vertex range moves every vertex buffer
+        CHECK_EQ(moves.size(), MeshCacheBuffer::Count);
+
+        std::array<u32, MeshCacheBuffer::Count> move_counts = {};
+
+        for (const MeshRangeMove& move : moves)
+        {
+            CHECK_EQ(move.dst_offset, 0);
+            CHECK_GT(move.src_offset, move.dst_offset);
+
+            move_counts[move.buffer] += 1;
+        }
+
+        for (u32 move_count : move_counts)
+            CHECK_EQ(move_count, 1);
+
+        const MeshAlloc& alloc = get_mesh2(allocator, b).lods_allocs[0];
+
+        CHECK_EQ(alloc.index_offset, 0);
+        CHECK_EQ(alloc.vertex_offset, 0);
+        CHECK_EQ(alloc.meshlet_offset, 0);
+
+        // Already compact
+        moves.clear();
+        defragment_mesh_allocator(allocator, 8, 2, moves);
+        CHECK(moves.empty());
+
+        // Old ranges come back once the copies are done
+        release_retired_mesh_ranges(allocator, 2);
+
+        for (const RangeAllocator& range_allocator : allocator.range_allocators)
+            CHECK_EQ(range_largest_free_size(range_allocator), range_allocator.capacity - range_allocator.used);
+    }
+}
@@ -0,0 +1,97 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include <doctest/doctest.h>
+
+#include "renderer/MeshQuantization.h"
+
+#include <cmath>
+#include <random>
+
+using namespace Reaper;
+
+namespace
+{
+glm::fvec3 random_unit_vector(std::mt19937& rng)
+{
+    std::normal_distribution<float> distribution;
+
+    glm::fvec3 v;
+
+    do
+    {
+        v = glm::fvec3(distribution(rng), distribution(rng), distribution(rng));
+    } while (glm::length(v) < 0.001f);
+
+    return glm::normalize(v);
+}
+} // namespace
+
+TEST_CASE("Mesh quantization")
+{
+    std::mt19937 rng(42);
+
+    SUBCASE("Positions")
+    {
+        const glm::fvec3 aabb_min_ms = glm::fvec3(-3.f, 0.f, 10.f);
+        const glm::fvec3 aabb_max_ms = glm::fvec3(5.f, 0.5f, 10.f); // Flat along Z
+
+        // Half a step in the largest axis
+        const float max_error = 8.f / 65535.f * 0.5f + 0.00001f;
+
+        std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+        for (u32 i = 0; i < 1000; i++)
+        {
+            const glm::fvec3 position_ms =
+                aabb_min_ms + glm::fvec3(unit(rng), unit(rng), unit(rng)) * (aabb_max_ms - aabb_min_ms);
+
+            const glm::fvec3 decoded_ms =
+                dequantize_position(quantize_position(position_ms, aabb_min_ms, aabb_max_ms), aabb_min_ms, aabb_max_ms);
+
+            CHECK(glm::length(decoded_ms - position_ms) <= max_error);
+        }
+
+        // Bounds are exact
+        CHECK(dequantize_position(quantize_position(aabb_min_ms, aabb_min_ms, aabb_max_ms), aabb_min_ms, aabb_max_ms)
+              == aabb_min_ms);
+        CHECK(dequantize_position(quantize_position(aabb_max_ms, aabb_min_ms, aabb_max_ms), aabb_min_ms, aabb_max_ms)
+              == aabb_max_ms);
+    }
+
+    SUBCASE("Vertex attributes")
+    {
+        std::uniform_real_distribution<float> uv_distribution(-4.f, 4.f);
+
+        for (u32 i = 0; i < 1000; i++)
+        {
+            const VertexAttributes attributes = {
+                .normal = random_unit_vector(rng),
+                .uv = glm::fvec2(uv_distribution(rng), uv_distribution(rng)),
+                .tangent = glm::fvec4(random_unit_vector(rng), (i % 2 == 0) ? 1.f : -1.f),
+            };
+
+            const VertexAttributes decoded = dequantize_vertex_attributes(quantize_vertex_attributes(attributes));
+
+            CHECK(glm::length(decoded.normal - attributes.normal) < 0.0002f);
+            CHECK(glm::length(glm::fvec3(decoded.tangent) - glm::fvec3(attributes.tangent)) < 0.0004f);
+            CHECK_EQ(decoded.tangent.w, attributes.tangent.w);
+
+            // Half floats keep 11 bits of mantissa
+            CHECK(std::abs(decoded.uv.x - attributes.uv.x) <= std::abs(attributes.uv.x) / 2048.f);
+            CHECK(std::abs(decoded.uv.y - attributes.uv.y) <= std::abs(attributes.uv.y) / 2048.f);
+        }
+
+        // Poles and axes go through the octahedron edges
+        for (glm::fvec3 axis : {glm::fvec3(0.f, 0.f, 1.f), glm::fvec3(0.f, 0.f, -1.f), glm::fvec3(1.f, 0.f, 0.f),
+                                glm::fvec3(0.f, -1.f, 0.f)})
+        {
+            CHECK(glm::length(decode_unit_vector_oct_snorm(encode_unit_vector_oct_snorm(axis, 16), 16) - axis)
+                  < 0.0002f);
+        }
+    }
+}
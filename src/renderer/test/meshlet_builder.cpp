@@ -0,0 +1,159 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include <doctest/doctest.h>
+
+#include "renderer/MeshletBuilder.h"
+
+#include <core/jobs/JobSystem.h>
+
+#include <cstring>
+#include <vector>
+
+using namespace Reaper;
+
+namespace
+{
+// Indexed grid of quads, big enough to need several meshlets
+Mesh create_grid_mesh(u32 quad_count_per_side)
+{
+    const u32 vertex_count_per_side = quad_count_per_side + 1;
+
+    Mesh mesh;
+
+    for (u32 y = 0; y < vertex_count_per_side; y++)
+    {
+        for (u32 x = 0; x < vertex_count_per_side; x++)
+        {
+            mesh.positions.push_back(glm::fvec3(static_cast<float>(x), static_cast<float>(y), 0.f));
+            mesh.attributes.push_back(VertexAttributes{
+                .normal = glm::fvec3(0.f, 0.f, 1.f),
+                .uv = glm::fvec2(static_cast<float>(x), static_cast<float>(y)),
+                .tangent = glm::fvec4(1.f, 0.f, 0.f, 1.f),
+            });
+        }
+    }
+
+    for (u32 y = 0; y < quad_count_per_side; y++)
+    {
+        for (u32 x = 0; x < quad_count_per_side; x++)
+        {
+            const u32 i = y * vertex_count_per_side + x;
+
+            for (u32 index : {i, i + 1, i + vertex_count_per_side, i + 1, i + vertex_count_per_side + 1,
+                              i + vertex_count_per_side})
+            {
+                mesh.indexes.push_back(index);
+            }
+        }
+    }
+
+    return mesh;
+}
+
+template <typename T>
+bool is_bit_identical(const std::vector<T>& a, const std::vector<T>& b)
+{
+    return a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+}
+} // namespace
+
+TEST_CASE("Meshlet builder")
+{
+    std::vector<Mesh> meshes;
+
+    for (u32 i = 0; i < 16; i++)
+        meshes.push_back(create_grid_mesh(1 + i * 3));
+
+    std::vector<MeshletMesh> reference(meshes.size());
+    build_meshlet_meshes(meshes, reference, nullptr);
+
+    SUBCASE("Layout")
+    {
+        for (u32 mesh_index = 0; mesh_index < meshes.size(); mesh_index++)
+        {
+            const MeshletMesh& output = reference[mesh_index];
+
+            REQUIRE(!output.lods.empty());
+            CHECK(output.lods.size() <= Mesh2::MAX_MESH_LODS);
+            CHECK_EQ(output.lods[0].mesh.indexes.size(), meshes[mesh_index].indexes.size());
+            CHECK_EQ(output.lods[0].error_ms, 0.f);
+
+            for (const MeshletLod& lod : output.lods)
+            {
+                CHECK_EQ(lod.mesh.positions.size(), lod.mesh.attributes.size());
+
+                u32 index_offset = 0;
+
+                for (const Meshlet& meshlet : lod.meshlets)
+                {
+                    CHECK_EQ(meshlet.index_offset, index_offset);
+                    CHECK(meshlet.index_count <= MeshletMaxTriangleCount * 3);
+                    CHECK(meshlet.vertex_offset + meshlet.vertex_count <= lod.mesh.positions.size());
+
+                    // Indices are local to the meshlet
+                    for (u32 i = 0; i < meshlet.index_count; i++)
+                        CHECK(lod.mesh.indexes[meshlet.index_offset + i] < meshlet.vertex_count);
+
+                    index_offset += meshlet.index_count;
+                }
+
+                CHECK_EQ(index_offset, lod.mesh.indexes.size());
+            }
+        }
+    }
+
+    SUBCASE("LOD chain")
+    {
+        // The biggest grid has plenty of triangles to simplify
+        const MeshletMesh& output = reference.back();
+
+        CHECK(output.lods.size() > 1);
+
+        for (u32 lod_index = 1; lod_index < output.lods.size(); lod_index++)
+        {
+            const MeshletLod& lod = output.lods[lod_index];
+            const MeshletLod& previous_lod = output.lods[lod_index - 1];
+
+            CHECK(lod.mesh.indexes.size() < previous_lod.mesh.indexes.size());
+            CHECK(lod.error_ms >= previous_lod.error_ms);
+        }
+    }
+
+    SUBCASE("Threading doesn't change the output")
+    {
+        JobSystem* job_system = create_job_system(3);
+
+        std::vector<MeshletMesh> outputs(meshes.size());
+        build_meshlet_meshes(meshes, outputs, job_system);
+
+        for (u32 mesh_index = 0; mesh_index < meshes.size(); mesh_index++)
+        {
+            const MeshletMesh& output = outputs[mesh_index];
+            const MeshletMesh& expected = reference[mesh_index];
+
+            REQUIRE_EQ(output.lods.size(), expected.lods.size());
+
+            for (u32 lod_index = 0; lod_index < output.lods.size(); lod_index++)
+            {
+                const MeshletLod& lod = output.lods[lod_index];
+                const MeshletLod& expected_lod = expected.lods[lod_index];
+
+                CHECK(is_bit_identical(lod.meshlets, expected_lod.meshlets));
+                CHECK(is_bit_identical(lod.mesh.indexes, expected_lod.mesh.indexes));
+                CHECK(is_bit_identical(lod.mesh.positions, expected_lod.mesh.positions));
+                CHECK(is_bit_identical(lod.mesh.attributes, expected_lod.mesh.attributes));
+                CHECK_EQ(lod.error_ms, expected_lod.error_ms);
+            }
+
+            CHECK_EQ(memcmp(&output.aabb_min_ms, &expected.aabb_min_ms, sizeof(glm::fvec3)), 0);
+            CHECK_EQ(memcmp(&output.aabb_max_ms, &expected.aabb_max_ms, sizeof(glm::fvec3)), 0);
+        }
+
+        destroy_job_system(job_system);
+    }
+}
@@ -0,0 +1,138 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include <doctest/doctest.h>
+
+#include "renderer/PipelineCacheFile.h"
+
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace Reaper;
+
+namespace
+{
+PipelineCacheDeviceInfo create_test_device_info()
+{
+    PipelineCacheDeviceInfo device_info = {
+        .vendor_id = 0x1002,
+        .device_id = 0x73bf,
+        .driver_version = 42,
+        .pipeline_cache_uuid = {},
+    };
+
+    for (u32 i = 0; i < PipelineCacheUUIDSize; i++)
+        device_info.pipeline_cache_uuid[i] = static_cast<u8>(i * 7);
+
+    return device_info;
+}
+
+// What a driver would hand back from vkGetPipelineCacheData
+std::vector<u8> create_test_cache_data(const PipelineCacheDeviceInfo& device_info, u32 payload_size_bytes)
+{
+    const PipelineCacheHeaderVersionOne header = {
+        .header_size = sizeof(PipelineCacheHeaderVersionOne),
+        .header_version = PipelineCacheHeaderVersionOneValue,
+        .vendor_id = device_info.vendor_id,
+        .device_id = device_info.device_id,
+        .pipeline_cache_uuid = {},
+    };
+
+    std::vector<u8> data(sizeof(header) + payload_size_bytes);
+
+    memcpy(data.data(), &header, sizeof(header));
+    memcpy(data.data() + offsetof(PipelineCacheHeaderVersionOne, pipeline_cache_uuid), device_info.pipeline_cache_uuid,
+           PipelineCacheUUIDSize);
+
+    for (u32 i = 0; i < payload_size_bytes; i++)
+        data[sizeof(header) + i] = static_cast<u8>(i);
+
+    return data;
+}
+} // namespace
+
+TEST_CASE("Pipeline cache file")
+{
+    const std::string file_path = (std::filesystem::temp_directory_path() / "reaper_pipeline_cache_test.bin").string();
+
+    const PipelineCacheDeviceInfo device_info = create_test_device_info();
+    const std::vector<u8>         cache_data = create_test_cache_data(device_info, 1000);
+
+    SUBCASE("Blob header")
+    {
+        CHECK(is_pipeline_cache_data_compatible(cache_data, device_info));
+        CHECK_FALSE(is_pipeline_cache_data_compatible(std::span(cache_data).first(16), device_info));
+
+        PipelineCacheDeviceInfo other_device = device_info;
+        other_device.pipeline_cache_uuid[3] += 1;
+        CHECK_FALSE(is_pipeline_cache_data_compatible(cache_data, other_device));
+
+        // The blob doesn't know about the driver version
+        PipelineCacheDeviceInfo other_driver = device_info;
+        other_driver.driver_version += 1;
+        CHECK(is_pipeline_cache_data_compatible(cache_data, other_driver));
+    }
+
+    REQUIRE(write_pipeline_cache_file(file_path, device_info, cache_data));
+
+    SUBCASE("Round trip")
+    {
+        std::vector<u8> read_data;
+        REQUIRE(read_pipeline_cache_file(file_path, device_info, read_data));
+        CHECK(read_data == cache_data);
+    }
+
+    SUBCASE("Driver update")
+    {
+        PipelineCacheDeviceInfo other_driver = device_info;
+        other_driver.driver_version += 1;
+
+        std::vector<u8> read_data;
+        CHECK_FALSE(read_pipeline_cache_file(file_path, other_driver, read_data));
+        CHECK(read_data.empty());
+    }
+
+    SUBCASE("Other device")
+    {
+        PipelineCacheDeviceInfo other_device = device_info;
+        other_device.device_id += 1;
+
+        std::vector<u8> read_data;
+        CHECK_FALSE(read_pipeline_cache_file(file_path, other_device, read_data));
+    }
+
+    SUBCASE("Truncated")
+    {
+        std::filesystem::resize_file(file_path, sizeof(PipelineCacheFileHeader) + cache_data.size() - 1);
+
+        std::vector<u8> read_data;
+        CHECK_FALSE(read_pipeline_cache_file(file_path, device_info, read_data));
+    }
+
+    SUBCASE("Damaged")
+    {
+        {
+            std::fstream file(file_path, std::ios::in | std::ios::out | std::ios::binary);
+            file.seekp(sizeof(PipelineCacheFileHeader) + 100);
+            file.put(static_cast<char>(0xff));
+        }
+
+        std::vector<u8> read_data;
+        CHECK_FALSE(read_pipeline_cache_file(file_path, device_info, read_data));
+    }
+
+    std::filesystem::remove(file_path);
+
+    SUBCASE("Missing file")
+    {
+        std::vector<u8> read_data;
+        CHECK_FALSE(read_pipeline_cache_file(file_path, device_info, read_data));
+    }
+}
@@ -7,7 +7,411 @@
 
 #include <doctest/doctest.h>
 
+#include "renderer/Camera.h"
+#include "renderer/PrepareBuckets.h"
+#include "renderer/TransformHierarchy.h"
+#include "renderer/vulkan/MeshCache.h"
+
+#include <core/jobs/JobSystem.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <array>
+#include <cstring>
+
+using namespace Reaper;
+
+namespace
+{
+glm::fmat4x3 translation_transform(glm::fvec3 translation)
+{
+    glm::fmat4x3 transform(1.f);
+    transform[3] = translation;
+
+    return transform;
+}
+
+glm::fvec3 get_translation(const glm::fmat4x3& transform)
+{
+    return transform[3];
+}
+} // namespace
+
 TEST_CASE("Scene")
 {
-    // FIXME
+    TransformHierarchy hierarchy = {};
+
+    const SceneNodeHandle root = create_transform_node(hierarchy, translation_transform(glm::fvec3(1.f, 0.f, 0.f)));
+    const SceneNodeHandle child =
+        create_transform_node(hierarchy, translation_transform(glm::fvec3(0.f, 2.f, 0.f)), root);
+    const SceneNodeHandle grand_child =
+        create_transform_node(hierarchy, translation_transform(glm::fvec3(0.f, 0.f, 3.f)), child);
+
+    update_world_transforms(hierarchy);
+
+    CHECK(get_translation(get_world_transform(hierarchy, root)) == glm::fvec3(1.f, 0.f, 0.f));
+    CHECK(get_translation(get_world_transform(hierarchy, child)) == glm::fvec3(1.f, 2.f, 0.f));
+    CHECK(get_translation(get_world_transform(hierarchy, grand_child)) == glm::fvec3(1.f, 2.f, 3.f));
+
+    SUBCASE("Moving a parent moves its children")
+    {
+        set_local_transform(hierarchy, root, translation_transform(glm::fvec3(-1.f, 0.f, 0.f)));
+        update_world_transforms(hierarchy);
+
+        CHECK(get_translation(get_world_transform(hierarchy, grand_child)) == glm::fvec3(-1.f, 2.f, 3.f));
+        CHECK(get_translation(get_local_transform(hierarchy, grand_child)) == glm::fvec3(0.f, 0.f, 3.f));
+    }
+
+    SUBCASE("Rotated parent")
+    {
+        // Quarter turn around Z, X becomes Y
+        glm::fmat4x3 rotation(1.f);
+        rotation[0] = glm::fvec3(0.f, 1.f, 0.f);
+        rotation[1] = glm::fvec3(-1.f, 0.f, 0.f);
+
+        set_local_transform(hierarchy, child, rotation);
+        set_local_transform(hierarchy, grand_child, translation_transform(glm::fvec3(1.f, 0.f, 0.f)));
+        update_world_transforms(hierarchy);
+
+        CHECK(get_translation(get_world_transform(hierarchy, grand_child)) == glm::fvec3(1.f, 1.f, 0.f));
+    }
+
+    SUBCASE("Handles survive compaction")
+    {
+        std::vector<SceneNodeHandle> leaves;
+
+        for (u32 i = 0; i < 8; i++)
+            leaves.push_back(create_transform_node(hierarchy, translation_transform(glm::fvec3(0.f)), child));
+
+        const SceneNodeHandle last_leaf =
+            create_transform_node(hierarchy, translation_transform(glm::fvec3(5.f, 0.f, 0.f)), grand_child);
+
+        for (SceneNodeHandle leaf : leaves)
+            destroy_transform_node(hierarchy, leaf);
+
+        update_world_transforms(hierarchy);
+
+        // Holes were removed
+        CHECK_EQ(hierarchy.node_handles.size(), 4);
+        CHECK_EQ(hierarchy.destroyed_node_count, 0);
+        CHECK(get_translation(get_world_transform(hierarchy, last_leaf)) == glm::fvec3(6.f, 2.f, 3.f));
+
+        // Destroyed handles get recycled
+        const SceneNodeHandle new_node = create_transform_node(hierarchy, translation_transform(glm::fvec3(0.f)));
+        CHECK_EQ(hierarchy.node_indices.size(), 12);
+        CHECK(new_node < 12);
+
+        update_world_transforms(hierarchy);
+
+        // Parents are still stored before their children
+        for (u32 node_index = 0; node_index < hierarchy.parent_indices.size(); node_index++)
+        {
+            const u32 parent_index = hierarchy.parent_indices[node_index];
+            CHECK((parent_index == InvalidTransformIndex || parent_index < node_index));
+        }
+    }
+}
+
+TEST_CASE("Prepare scene")
+{
+    SceneGraph scene = {};
+    MeshCache  mesh_cache = {};
+
+    const u32                                 unique_mesh_count = 3;
+    std::array<MeshHandle, unique_mesh_count> mesh_handles;
+
+    for (u32 i = 0; i < unique_mesh_count; i++)
+    {
+        MeshAlloc mesh_alloc = {};
+        mesh_alloc.index_count = 3 * 64;
+        mesh_alloc.meshlet_count = 1;
+        mesh_alloc.meshlet_offset = i; // Lets us find the mesh handle back from the command
+
+        mesh_handles[i] =
+            insert_mesh2(mesh_cache.allocator, create_mesh2(mesh_alloc, glm::fvec3(-1.f), glm::fvec3(1.f)));
+    }
+
+    // Everything looks down -Z
+    scene.camera_node = create_scene_node(scene, translation_transform(glm::fvec3(0.f)));
+
+    const u32 light_count = 3;
+
+    for (u32 i = 0; i < light_count; i++)
+    {
+        SceneLight& light = scene.scene_lights.emplace_back();
+        light.color = glm::fvec3(1.f);
+        light.intensity = 1.f;
+        light.radius = 10.f;
+        light.scene_node = create_scene_node(scene, translation_transform(glm::fvec3(static_cast<float>(i), 5.f, 0.f)));
+        light.shadow_map_size = (i == 1) ? glm::uvec2(0, 0) : glm::uvec2(512, 512); // Skip one shadow
+    }
+
+    // Half of the meshes are in front of the camera and lights, the other half is behind
+    const u32 mesh_count = 200;
+    const u32 visible_mesh_count = mesh_count / 2;
+
+    for (u32 i = 0; i < mesh_count; i++)
+    {
+        const float      depth = (i % 2 == 0) ? -20.f : 20.f;
+        const glm::fvec3 position(static_cast<float>(i % 10) - 5.f, 0.f, depth);
+
+        SceneMesh& scene_mesh = scene.scene_meshes.emplace_back();
+        scene_mesh.scene_node = create_scene_node(scene, translation_transform(position));
+        scene_mesh.mesh_handle = mesh_handles[i % unique_mesh_count];
+        scene_mesh.material_handle = SceneMaterialHandle(i % unique_mesh_count);
+    }
+
+    update_scene_transforms(scene);
+
+    RendererPerspectiveCamera main_camera = {};
+    main_camera.vs_to_ws_matrix = get_scene_node_transform(scene, scene.camera_node);
+    main_camera.ws_to_vs_matrix = glm::inverse(glm::fmat4(main_camera.vs_to_ws_matrix));
+    main_camera.viewport.extent = glm::uvec2(800, 600);
+    main_camera.ws_to_cs_matrix = glm::perspective(glm::pi<float>() * 0.5f, 4.f / 3.f, 0.1f, 100.f)
+                                  * glm::fmat4(main_camera.ws_to_vs_matrix);
+    main_camera.cs_to_ws_matrix = glm::inverse(main_camera.ws_to_cs_matrix);
+
+    JobSystem* single_thread_jobs = create_job_system(0);
+    JobSystem* multi_thread_jobs = create_job_system(3);
+
+    PreparedData reference = {};
+    prepare_scene(scene, reference, mesh_cache, main_camera, 0, *single_thread_jobs);
+
+    const u32 shadow_pass_count = 2;
+
+    REQUIRE_EQ(reference.shadow_passes.size(), shadow_pass_count);
+    REQUIRE_EQ(reference.cull_passes.size(), shadow_pass_count + 1);
+    CHECK_EQ(reference.main_culling_pass_index, shadow_pass_count);
+    CHECK_EQ(reference.shadow_instance_params.size(), shadow_pass_count * visible_mesh_count);
+    CHECK_EQ(reference.cull_mesh_instance_params.size(), (shadow_pass_count + 1) * visible_mesh_count);
+    CHECK_EQ(reference.mesh_instances.size(), visible_mesh_count);
+
+    u32 cull_instance_offset = 0;
+
+    for (u32 cull_pass_index = 0; cull_pass_index < reference.cull_passes.size(); cull_pass_index++)
+    {
+        const CullPassData& cull_pass = reference.cull_passes[cull_pass_index];
+
+        CHECK_EQ(cull_pass.pass_index, cull_pass_index);
+
+        // One command per mesh, sorted by handle
+        REQUIRE_EQ(cull_pass.cull_commands.size(), unique_mesh_count);
+
+        if (!cull_pass.main_pass)
+            CHECK_EQ(reference.shadow_passes[cull_pass_index].instance_count, visible_mesh_count);
+
+        u32 pass_instance_count = 0;
+
+        for (u32 mesh_index = 0; mesh_index < unique_mesh_count; mesh_index++)
+        {
+            const CullCmd& command = cull_pass.cull_commands[mesh_index];
+
+            CHECK_EQ(command.push_constants.meshlet_offset, mesh_index);
+
+            // Culled instances leave no hole behind
+            CHECK_EQ(command.push_constants.cull_instance_offset, cull_instance_offset + pass_instance_count);
+
+            for (u32 i = 0; i < command.instance_count; i++)
+            {
+                const u32 instance_id = pass_instance_count + i;
+                const u32 cull_instance_index = command.push_constants.cull_instance_offset + i;
+
+                CHECK_EQ(reference.cull_mesh_instance_params[cull_instance_index].instance_id, instance_id);
+
+                if (cull_pass.main_pass)
+                    CHECK_EQ(reference.mesh_instances[instance_id].material_index, mesh_index);
+            }
+
+            pass_instance_count += command.instance_count;
+        }
+
+        CHECK_EQ(pass_instance_count, visible_mesh_count);
+
+        cull_instance_offset += pass_instance_count;
+    }
+
+    // Running on more threads doesn't change a single bit of the output
+    for (u32 iteration = 0; iteration < 8; iteration++)
+    {
+        PreparedData prepared = {};
+        prepare_scene(scene, prepared, mesh_cache, main_camera, 0, *multi_thread_jobs);
+
+        REQUIRE_EQ(prepared.cull_passes.size(), reference.cull_passes.size());
+
+        for (u32 cull_pass_index = 0; cull_pass_index < reference.cull_passes.size(); cull_pass_index++)
+        {
+            const std::vector<CullCmd>& commands = prepared.cull_passes[cull_pass_index].cull_commands;
+            const std::vector<CullCmd>& reference_commands = reference.cull_passes[cull_pass_index].cull_commands;
+
+            REQUIRE_EQ(commands.size(), reference_commands.size());
+            CHECK_EQ(memcmp(commands.data(), reference_commands.data(), commands.size() * sizeof(CullCmd)), 0);
+        }
+
+        CHECK_EQ(memcmp(prepared.cull_mesh_instance_params.data(), reference.cull_mesh_instance_params.data(),
+                        reference.cull_mesh_instance_params.size() * sizeof(CullMeshInstanceParams)),
+                 0);
+        CHECK_EQ(memcmp(prepared.shadow_instance_params.data(), reference.shadow_instance_params.data(),
+                        reference.shadow_instance_params.size() * sizeof(ShadowMapInstanceParams)),
+                 0);
+        CHECK_EQ(memcmp(prepared.mesh_instances.data(), reference.mesh_instances.data(),
+                        reference.mesh_instances.size() * sizeof(MeshInstance)),
+                 0);
+    }
+
+    destroy_job_system(multi_thread_jobs);
+    destroy_job_system(single_thread_jobs);
+}
+
+TEST_CASE("Prepare scene instanced cull command")
+{
+    SceneGraph scene = {};
+    MeshCache  mesh_cache = {};
+
+    MeshAlloc mesh_alloc = {};
+    mesh_alloc.index_count = 3;
+    mesh_alloc.meshlet_count = 1;
+
+    const MeshHandle mesh_handle =
+        insert_mesh2(mesh_cache.allocator, create_mesh2(mesh_alloc, glm::fvec3(-1.f), glm::fvec3(1.f)));
+
+    scene.camera_node = create_scene_node(scene, translation_transform(glm::fvec3(0.f)));
+
+    // Same mesh, different places in front of the camera
+    const std::array<glm::fvec3, 2> positions = {glm::fvec3(-2.f, 0.f, -10.f), glm::fvec3(3.f, 1.f, -20.f)};
+
+    for (const glm::fvec3& position : positions)
+    {
+        SceneMesh& scene_mesh = scene.scene_meshes.emplace_back();
+        scene_mesh.scene_node = create_scene_node(scene, translation_transform(position));
+        scene_mesh.mesh_handle = mesh_handle;
+        scene_mesh.material_handle = SceneMaterialHandle(0);
+    }
+
+    update_scene_transforms(scene);
+
+    RendererPerspectiveCamera main_camera = {};
+    main_camera.vs_to_ws_matrix = get_scene_node_transform(scene, scene.camera_node);
+    main_camera.ws_to_vs_matrix = glm::inverse(glm::fmat4(main_camera.vs_to_ws_matrix));
+    main_camera.viewport.extent = glm::uvec2(800, 600);
+    main_camera.ws_to_cs_matrix = glm::perspective(glm::pi<float>() * 0.5f, 4.f / 3.f, 0.1f, 100.f)
+                                  * glm::fmat4(main_camera.ws_to_vs_matrix);
+    main_camera.cs_to_ws_matrix = glm::inverse(main_camera.ws_to_cs_matrix);
+
+    JobSystem* job_system = create_job_system(0);
+
+    PreparedData prepared = {};
+    prepare_scene(scene, prepared, mesh_cache, main_camera, 0, *job_system);
+
+    REQUIRE_EQ(prepared.cull_passes.size(), 1);
+    REQUIRE_EQ(prepared.cull_passes[0].cull_commands.size(), 1);
+
+    const CullCmd& command = prepared.cull_passes[0].cull_commands[0];
+    REQUIRE_EQ(command.instance_count, positions.size());
+
+    // The cull shader reads the params of instance gid.y at cull_instance_offset + gid.y, each instance has to
+    // carry its own transform there
+    for (u32 i = 0; i < command.instance_count; i++)
+    {
+        const CullMeshInstanceParams& params =
+            prepared.cull_mesh_instance_params[command.push_constants.cull_instance_offset + i];
+
+        const hlsl_float4x4 expected_ms_to_cs =
+            main_camera.ws_to_cs_matrix * glm::fmat4(translation_transform(positions[i]));
+
+        CHECK_EQ(memcmp(&params.ms_to_cs_matrix, &expected_ms_to_cs, sizeof(hlsl_float4x4)), 0);
+    }
+
+    const CullMeshInstanceParams& first =
+        prepared.cull_mesh_instance_params[command.push_constants.cull_instance_offset];
+    const CullMeshInstanceParams& second =
+        prepared.cull_mesh_instance_params[command.push_constants.cull_instance_offset + 1];
+
+    CHECK_NE(memcmp(&first.ms_to_cs_matrix, &second.ms_to_cs_matrix, sizeof(hlsl_float4x4)), 0);
+    CHECK_NE(memcmp(&first.vs_to_ms_matrix_translate, &second.vs_to_ms_matrix_translate, sizeof(hlsl_float3)), 0);
+
+    destroy_job_system(job_system);
+}
+
+TEST_CASE("Prepare scene LOD selection")
+{
+    SceneGraph scene = {};
+    MeshCache  mesh_cache = {};
+
+    // Each LOD gets its own meshlet offset so we can tell them apart in the commands
+    const float lod_errors_ms[Mesh2::MAX_MESH_LODS] = {0.f, 0.01f, 0.1f, 1.f};
+
+    Mesh2 mesh2 = {};
+
+    for (u32 lod_index = 0; lod_index < Mesh2::MAX_MESH_LODS; lod_index++)
+    {
+        MeshAlloc mesh_alloc = {};
+        mesh_alloc.index_count = 3;
+        mesh_alloc.meshlet_count = 1;
+        mesh_alloc.meshlet_offset = lod_index;
+
+        if (lod_index == 0)
+            mesh2 = create_mesh2(mesh_alloc, glm::fvec3(-1.f), glm::fvec3(1.f));
+        else
+            add_mesh2_lod(mesh2, mesh_alloc, lod_errors_ms[lod_index]);
+    }
+
+    const MeshHandle mesh_handle = insert_mesh2(mesh_cache.allocator, mesh2);
+
+    scene.camera_node = create_scene_node(scene, translation_transform(glm::fvec3(0.f)));
+
+    // The light sits behind the camera so it sees both meshes too
+    SceneLight& light = scene.scene_lights.emplace_back();
+    light.color = glm::fvec3(1.f);
+    light.intensity = 1.f;
+    light.radius = 10.f;
+    light.scene_node = create_scene_node(scene, translation_transform(glm::fvec3(0.f, 0.f, 5.f)));
+    light.shadow_map_size = glm::uvec2(512, 512);
+
+    for (float depth : {-3.f, -90.f})
+    {
+        SceneMesh& scene_mesh = scene.scene_meshes.emplace_back();
+        scene_mesh.scene_node = create_scene_node(scene, translation_transform(glm::fvec3(0.f, 0.f, depth)));
+        scene_mesh.mesh_handle = mesh_handle;
+        scene_mesh.material_handle = SceneMaterialHandle(0);
+    }
+
+    update_scene_transforms(scene);
+
+    RendererPerspectiveCamera main_camera = {};
+    main_camera.vs_to_ws_matrix = get_scene_node_transform(scene, scene.camera_node);
+    main_camera.ws_to_vs_matrix = glm::inverse(glm::fmat4(main_camera.vs_to_ws_matrix));
+    main_camera.viewport.extent = glm::uvec2(800, 600);
+    main_camera.ws_to_cs_matrix = glm::perspective(glm::pi<float>() * 0.5f, 4.f / 3.f, 0.1f, 100.f)
+                                  * glm::fmat4(main_camera.ws_to_vs_matrix);
+    main_camera.cs_to_ws_matrix = glm::inverse(main_camera.ws_to_cs_matrix);
+
+    // Shadows don't care about detail at all here
+    scene.lod_settings.main_pass_max_error_px = 1.f;
+    scene.lod_settings.shadow_pass_max_error_px = 1000000.f;
+
+    JobSystem* job_system = create_job_system(0);
+
+    PreparedData prepared = {};
+    prepare_scene(scene, prepared, mesh_cache, main_camera, 0, *job_system);
+
+    REQUIRE_EQ(prepared.cull_passes.size(), 2);
+
+    // 300 pixels per unit at a distance of one unit. The near mesh would show LOD1 errors over 2 pixels, the far
+    // one hides LOD2 errors under half a pixel but not LOD3 ones.
+    const CullPassData& main_pass = prepared.cull_passes[prepared.main_culling_pass_index];
+
+    REQUIRE_EQ(main_pass.cull_commands.size(), 2);
+    CHECK_EQ(main_pass.cull_commands[0].push_constants.meshlet_offset, 0);
+    CHECK_EQ(main_pass.cull_commands[0].instance_count, 1);
+    CHECK_EQ(main_pass.cull_commands[1].push_constants.meshlet_offset, 2);
+    CHECK_EQ(main_pass.cull_commands[1].instance_count, 1);
+
+    // Both instances share the coarsest LOD
+    const CullPassData& shadow_pass = prepared.cull_passes[0];
+
+    REQUIRE_EQ(shadow_pass.cull_commands.size(), 1);
+    CHECK_EQ(shadow_pass.cull_commands[0].push_constants.meshlet_offset, Mesh2::MAX_MESH_LODS - 1);
+    CHECK_EQ(shadow_pass.cull_commands[0].instance_count, 2);
+
+    destroy_job_system(job_system);
 }
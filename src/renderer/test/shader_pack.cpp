@@ -0,0 +1,119 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include <doctest/doctest.h>
+
+#include "renderer/ShaderPack.h"
+
+#include <core/fs/MappedFile.h>
+
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+using namespace Reaper;
+
+namespace
+{
+// Fake SPIR-V, every word holds the index of the module
+ShaderPackSource create_test_source(std::string name, u32 index, u32 word_count)
+{
+    ShaderPackSource source = {
+        .name = std::move(name),
+        .code = std::vector<char>(word_count * sizeof(u32)),
+    };
+
+    for (u32 i = 0; i < word_count; i++)
+        memcpy(source.code.data() + i * sizeof(u32), &index, sizeof(u32));
+
+    return source;
+}
+} // namespace
+
+TEST_CASE("Shader pack")
+{
+    const std::string file_path = (std::filesystem::temp_directory_path() / "reaper_shader_pack_test.rspv").string();
+
+    std::vector<ShaderPackSource> sources;
+
+    for (u32 i = 0; i < 50; i++)
+    {
+        const std::string name = "folder_" + std::to_string(i % 3) + "/shader_" + std::to_string(i) + ".comp.spv";
+
+        sources.push_back(create_test_source(name, i, i + 1));
+    }
+
+    REQUIRE(write_shader_pack_file(file_path, sources));
+    CHECK_FALSE(std::filesystem::exists(file_path + ".tmp"));
+
+    MappedFile file;
+    REQUIRE(map_file(file_path, file));
+
+    const std::span<const u8> file_data(file.data, file.size_bytes);
+
+    SUBCASE("Lookup")
+    {
+        ShaderPackView view;
+        REQUIRE(get_shader_pack_view(file_data, view));
+        REQUIRE_EQ(view.entries.size(), sources.size());
+
+        for (u32 i = 0; i < sources.size(); i++)
+        {
+            const std::span<const u32> code = find_shader_pack_code(view, sources[i].name);
+
+            REQUIRE_EQ(code.size(), i + 1);
+            CHECK_EQ(code.front(), i);
+            CHECK_EQ(code.back(), i);
+
+            // Modules are read in place
+            CHECK_EQ(reinterpret_cast<uintptr_t>(code.data()) % ShaderPackAlignment, 0);
+
+            const u32 entry_index = find_shader_pack_entry_index(view, sources[i].name);
+            REQUIRE_NE(entry_index, ShaderPackInvalidEntryIndex);
+            CHECK_EQ(get_shader_pack_entry_name(view, entry_index), sources[i].name);
+            CHECK_EQ(get_shader_pack_entry_code(view, entry_index).data(), code.data());
+        }
+
+        CHECK(find_shader_pack_code(view, "missing.comp.spv").empty());
+        CHECK_EQ(find_shader_pack_entry_index(view, "missing.comp.spv"), ShaderPackInvalidEntryIndex);
+        CHECK(find_shader_pack_code(view, "").empty());
+    }
+
+    SUBCASE("Older version")
+    {
+        std::vector<u8> data(file_data.begin(), file_data.end());
+        reinterpret_cast<ShaderPackFileHeader*>(data.data())->version = ShaderPackVersion - 1;
+
+        ShaderPackView view;
+        CHECK_FALSE(get_shader_pack_view(data, view));
+    }
+
+    SUBCASE("Truncated")
+    {
+        ShaderPackView view;
+        CHECK_FALSE(get_shader_pack_view(file_data.first(file_data.size() - 1), view));
+        CHECK_FALSE(get_shader_pack_view(file_data.first(sizeof(ShaderPackFileHeader) - 1), view));
+    }
+
+    unmap_file(file);
+    std::filesystem::remove(file_path);
+
+    SUBCASE("Empty pack")
+    {
+        REQUIRE(write_shader_pack_file(file_path, {}));
+
+        MappedFile empty_file;
+        REQUIRE(map_file(file_path, empty_file));
+
+        ShaderPackView view;
+        REQUIRE(get_shader_pack_view(std::span(empty_file.data, empty_file.size_bytes), view));
+        CHECK(find_shader_pack_code(view, "shader.comp.spv").empty());
+
+        unmap_file(empty_file);
+        std::filesystem::remove(file_path);
+    }
+}
@@ -0,0 +1,94 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include <doctest/doctest.h>
+
+#include "renderer/texture/TextureResidency.h"
+
+#include "renderer/test/texture_test_helpers.h"
+
+#include <vector>
+
+using namespace Reaper;
+
+namespace
+{
+TextureResidency create_test_residency(u32 size)
+{
+    return create_texture_residency(create_test_decoded_texture(size));
+}
+
+constexpr u32 NotSampled = 0xFFFFFFFF;
+} // namespace
+
+TEST_CASE("Texture residency")
+{
+    SUBCASE("Mip tail")
+    {
+        const TextureResidency residency = create_test_residency(1024);
+
+        CHECK_EQ(residency.mip_count, 11);
+        CHECK_EQ(residency.tail_mip_offset, 3);
+        CHECK_EQ(residency.desired_mip_offset, 3);
+        CHECK_EQ(texture_residency_size_bytes(residency, 10), 4);
+
+        // Small textures are all tail
+        CHECK_EQ(create_test_residency(64).tail_mip_offset, 0);
+    }
+
+    SUBCASE("Feedback")
+    {
+        constexpr u64    eviction_delay = 10;
+        TextureResidency residency = create_test_residency(1024);
+
+        update_texture_residency_feedback(residency, 1, 1, eviction_delay);
+        CHECK_EQ(residency.desired_mip_offset, 1);
+
+        // Coarser mips don't evict anything right away
+        update_texture_residency_feedback(residency, 2, 2, eviction_delay);
+        update_texture_residency_feedback(residency, NotSampled, 5, eviction_delay);
+        CHECK_EQ(residency.desired_mip_offset, 1);
+
+        update_texture_residency_feedback(residency, NotSampled, 11, eviction_delay);
+        CHECK_EQ(residency.desired_mip_offset, 3);
+
+        update_texture_residency_feedback(residency, 0, 12, eviction_delay);
+        CHECK_EQ(residency.desired_mip_offset, 0);
+    }
+
+    SUBCASE("Budget")
+    {
+        std::vector<TextureResidency> residencies = {create_test_residency(1024), create_test_residency(512)};
+
+        residencies[0].desired_mip_offset = 0;
+        residencies[1].desired_mip_offset = 0;
+        residencies[0].last_requested_frame = 5;
+        residencies[1].last_requested_frame = 4;
+
+        compute_texture_residency_targets(residencies, UINT64_MAX);
+        CHECK_EQ(residencies[0].target_mip_offset, 0);
+        CHECK_EQ(residencies[1].target_mip_offset, 0);
+
+        // The 1024 top mip goes first, then both 512 mips tie and the least recently requested one goes
+        const u64 budget_bytes =
+            texture_residency_size_bytes(residencies[0], 1) + texture_residency_size_bytes(residencies[1], 1);
+
+        compute_texture_residency_targets(residencies, budget_bytes);
+        CHECK_EQ(residencies[0].target_mip_offset, 1);
+        CHECK_EQ(residencies[1].target_mip_offset, 1);
+
+        // Largest top mip first again
+        compute_texture_residency_targets(residencies, budget_bytes - 1);
+        CHECK_EQ(residencies[0].target_mip_offset, 2);
+        CHECK_EQ(residencies[1].target_mip_offset, 1);
+
+        // Tails stay no matter what
+        compute_texture_residency_targets(residencies, 0);
+        CHECK_EQ(residencies[0].target_mip_offset, residencies[0].tail_mip_offset);
+        CHECK_EQ(residencies[1].target_mip_offset, residencies[1].tail_mip_offset);
+    }
+}
@@ -0,0 +1,127 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include <doctest/doctest.h>
+
+#include "renderer/texture/TextureStreaming.h"
+
+#include "renderer/test/texture_test_helpers.h"
+
+#include <vector>
+
+using namespace Reaper;
+
+namespace
+{
+TextureStreamingRequest create_test_request(u32 texture_index, u32 size)
+{
+    DecodedTexture decoded_texture = create_test_decoded_texture(size);
+
+    sort_decoded_texture_mips_tail_first(decoded_texture);
+
+    return TextureStreamingRequest{
+        .texture_index = texture_index,
+        .mips = decoded_texture.mips,
+        .uploaded_mip_count = 0,
+    };
+}
+} // namespace
+
+TEST_CASE("Texture streaming")
+{
+    constexpr TextureStreamingBudget budget = {
+        .max_bytes_per_frame = 1024 * 1024,
+        .staging_alignment = 16,
+    };
+
+    SUBCASE("Mip tail first")
+    {
+        TextureStreamingRequest request = create_test_request(0, 16);
+
+        const std::vector<DecodedTextureMip>& mips = request.mips;
+
+        REQUIRE_EQ(mips.size(), 5);
+        CHECK_EQ(mips.front().mip_index, 4);
+        CHECK_EQ(mips.back().mip_index, 0);
+    }
+
+    SUBCASE("Round-robin")
+    {
+        std::vector<TextureStreamingRequest> requests = {create_test_request(0, 16), create_test_request(1, 4)};
+        RingAllocator                        ring = create_ring_allocator(64 * 1024);
+        std::vector<TextureMipUpload>        uploads;
+
+        schedule_texture_uploads(requests, ring, budget, uploads);
+
+        REQUIRE_EQ(uploads.size(), 5 + 3);
+
+        // Both tails go first
+        CHECK_EQ(uploads[0].request_index, 0);
+        CHECK_EQ(uploads[1].request_index, 1);
+        CHECK_EQ(uploads[0].mip, 0);
+        CHECK_EQ(uploads[1].mip, 0);
+
+        for (const TextureMipUpload& upload : uploads)
+            CHECK_EQ(upload.staging_offset_bytes % budget.staging_alignment, 0);
+
+        CHECK(is_texture_streaming_request_done(requests[0]));
+        CHECK(is_texture_streaming_request_done(requests[1]));
+    }
+
+    SUBCASE("Frame budget")
+    {
+        std::vector<TextureStreamingRequest> requests = {create_test_request(0, 256)};
+        RingAllocator                        ring = create_ring_allocator(1024 * 1024);
+        std::vector<TextureMipUpload>        uploads;
+
+        const TextureStreamingBudget small_budget = {
+            .max_bytes_per_frame = 64 * 64 * 4,
+            .staging_alignment = 16,
+        };
+
+        schedule_texture_uploads(requests, ring, small_budget, uploads);
+
+        // Mips up to 32x32 fit, 64x64 would go over
+        CHECK_EQ(uploads.size(), 6);
+        CHECK_FALSE(is_texture_streaming_request_done(requests[0]));
+
+        // A mip larger than the budget still goes through on its own
+        uploads.clear();
+        schedule_texture_uploads(requests, ring, small_budget, uploads);
+        CHECK_EQ(uploads.size(), 1);
+
+        uploads.clear();
+        schedule_texture_uploads(requests, ring, small_budget, uploads);
+        CHECK_EQ(uploads.size(), 1);
+        CHECK_EQ(requests[0].mips[uploads[0].mip].mip_index, 1);
+    }
+
+    SUBCASE("Back-pressure")
+    {
+        std::vector<TextureStreamingRequest> requests = {create_test_request(0, 64)};
+        RingAllocator                        ring = create_ring_allocator(64 * 64 * 4);
+        std::vector<TextureMipUpload>        uploads;
+
+        schedule_texture_uploads(requests, ring, budget, uploads);
+
+        // The top mip doesn't fit with the others, it has to wait for them to retire
+        CHECK_EQ(uploads.size(), 6);
+        CHECK_EQ(requests[0].uploaded_mip_count, 6);
+
+        ring_close_batch(ring, 1);
+
+        uploads.clear();
+        schedule_texture_uploads(requests, ring, budget, uploads);
+        CHECK(uploads.empty());
+
+        ring_release(ring, 1);
+
+        schedule_texture_uploads(requests, ring, budget, uploads);
+        CHECK_EQ(uploads.size(), 1);
+        CHECK(is_texture_streaming_request_done(requests[0]));
+    }
+}
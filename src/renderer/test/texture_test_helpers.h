@@ -0,0 +1,46 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "renderer/texture/TextureStreaming.h"
+
+namespace Reaper
+{
+// Square RGBA8 texture with a full mip chain, no actual texel data.
+// Mips are in natural order, with tightly packed offsets.
+inline DecodedTexture create_test_decoded_texture(u32 size)
+{
+    DecodedTexture decoded_texture = {};
+    decoded_texture.properties.width = size;
+    decoded_texture.properties.height = size;
+    decoded_texture.properties.mip_count = 0;
+
+    u64 offset_bytes = 0;
+
+    for (u32 mip_index = 0; (size >> mip_index) > 0; mip_index++)
+    {
+        const u32 mip_size = size >> mip_index;
+        const u64 size_bytes = mip_size * mip_size * 4;
+
+        decoded_texture.mips.push_back(DecodedTextureMip{
+            .mip_index = mip_index,
+            .layer_index = 0,
+            .width = mip_size,
+            .height = mip_size,
+            .depth = 1,
+            .offset_bytes = offset_bytes,
+            .size_bytes = size_bytes,
+        });
+
+        offset_bytes += size_bytes;
+        decoded_texture.properties.mip_count += 1;
+    }
+
+    return decoded_texture;
+}
+} // namespace Reaper
@@ -0,0 +1,126 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include "TextureResidency.h"
+
+#include <core/Assert.h>
+#include <profiling/Scope.h>
+
+#include <algorithm>
+
+namespace Reaper
+{
+TextureResidency create_texture_residency(const DecodedTexture& decoded_texture)
+{
+    const GPUTextureProperties& properties = decoded_texture.properties;
+
+    Assert(properties.mip_count > 0);
+    Assert(properties.mip_count <= MaxTextureMipCount);
+
+    TextureResidency residency = {
+        .mip_count = properties.mip_count,
+        .tail_mip_offset = properties.mip_count - 1,
+        .desired_mip_offset = 0,
+        .last_requested_frame = 0,
+        .target_mip_offset = 0,
+        .mip_size_bytes = {},
+    };
+
+    for (u32 mip_index = 0; mip_index < properties.mip_count; mip_index++)
+    {
+        const u32 mip_size = std::max(std::max(properties.width, properties.height) >> mip_index, 1u);
+
+        if (mip_size <= TextureResidencyTailSize)
+        {
+            residency.tail_mip_offset = mip_index;
+            break;
+        }
+    }
+
+    for (const DecodedTextureMip& mip : decoded_texture.mips)
+    {
+        Assert(mip.mip_index < properties.mip_count);
+        residency.mip_size_bytes[mip.mip_index] += mip.size_bytes;
+    }
+
+    // Nothing was sampled yet
+    residency.desired_mip_offset = residency.tail_mip_offset;
+    residency.target_mip_offset = residency.tail_mip_offset;
+
+    return residency;
+}
+
+u64 texture_residency_size_bytes(const TextureResidency& residency, u32 mip_offset)
+{
+    u64 size_bytes = 0;
+
+    for (u32 mip_index = mip_offset; mip_index < residency.mip_count; mip_index++)
+        size_bytes += residency.mip_size_bytes[mip_index];
+
+    return size_bytes;
+}
+
+void update_texture_residency_feedback(TextureResidency& residency, u32 feedback_mip, u64 frame_index,
+                                       u64 eviction_delay_frames)
+{
+    const u32 requested_mip_offset = std::min(feedback_mip, residency.tail_mip_offset);
+
+    // Hysteresis so that a texture on the edge between two mips doesn't stream the top one in and out
+    if (requested_mip_offset <= residency.desired_mip_offset
+        || frame_index >= residency.last_requested_frame + eviction_delay_frames)
+    {
+        residency.desired_mip_offset = requested_mip_offset;
+        residency.last_requested_frame = frame_index;
+    }
+}
+
+void compute_texture_residency_targets(std::span<TextureResidency> residencies, u64 budget_bytes)
+{
+    REAPER_PROFILE_SCOPE_FUNC();
+
+    u64 total_size_bytes = 0;
+
+    for (TextureResidency& residency : residencies)
+    {
+        residency.target_mip_offset = std::min(residency.desired_mip_offset, residency.tail_mip_offset);
+        total_size_bytes += texture_residency_size_bytes(residency, residency.target_mip_offset);
+    }
+
+    while (total_size_bytes > budget_bytes)
+    {
+        TextureResidency* victim = nullptr;
+
+        for (TextureResidency& residency : residencies)
+        {
+            if (residency.target_mip_offset >= residency.tail_mip_offset)
+                continue;
+
+            if (victim == nullptr)
+            {
+                victim = &residency;
+                continue;
+            }
+
+            const u64 size_bytes = residency.mip_size_bytes[residency.target_mip_offset];
+            const u64 victim_size_bytes = victim->mip_size_bytes[victim->target_mip_offset];
+
+            if (size_bytes > victim_size_bytes
+                || (size_bytes == victim_size_bytes && residency.last_requested_frame < victim->last_requested_frame))
+            {
+                victim = &residency;
+            }
+        }
+
+        // Only mip tails are left
+        if (victim == nullptr)
+            break;
+
+        total_size_bytes -= victim->mip_size_bytes[victim->target_mip_offset];
+        victim->target_mip_offset += 1;
+    }
+}
+} // namespace Reaper
@@ -0,0 +1,49 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "renderer/RendererExport.h"
+#include "renderer/texture/TextureStreaming.h"
+
+#include <array>
+#include <span>
+
+namespace Reaper
+{
+constexpr u32 MaxTextureMipCount = 16;
+
+// Mips at or below this size never get evicted
+constexpr u32 TextureResidencyTailSize = 128;
+
+// Which mips of a texture should be on the GPU.
+// Mip offsets use the numbering of the full mip chain, everything from the offset to the last mip is resident.
+struct TextureResidency
+{
+    u32                                 mip_count;
+    u32                                 tail_mip_offset;
+    u32                                 desired_mip_offset; // From the GPU feedback
+    u64                                 last_requested_frame;
+    u32                                 target_mip_offset; // Desired offset once the budget is applied
+    std::array<u64, MaxTextureMipCount> mip_size_bytes;
+};
+
+REAPER_RENDERER_API TextureResidency create_texture_residency(const DecodedTexture& decoded_texture);
+
+// Size of the mips from mip_offset to the end of the chain
+REAPER_RENDERER_API u64 texture_residency_size_bytes(const TextureResidency& residency, u32 mip_offset);
+
+// feedback_mip is the finest mip sampled last frame, anything past the end of the chain means it wasn't sampled.
+// Finer mips are requested right away, coarser ones only once the finer mips went unused for eviction_delay_frames.
+REAPER_RENDERER_API void update_texture_residency_feedback(TextureResidency& residency, u32 feedback_mip,
+                                                           u64 frame_index, u64 eviction_delay_frames);
+
+// Fills target_mip_offset so that the total size stays within the budget when possible.
+// Over budget, textures give up their top mip one at a time, largest first then least recently requested first.
+// Mip tails always stay resident, even when they alone go over the budget.
+REAPER_RENDERER_API void compute_texture_residency_targets(std::span<TextureResidency> residencies, u64 budget_bytes);
+} // namespace Reaper
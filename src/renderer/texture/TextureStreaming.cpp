@@ -0,0 +1,69 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include "TextureStreaming.h"
+
+#include <core/Assert.h>
+#include <profiling/Scope.h>
+
+#include <algorithm>
+
+namespace Reaper
+{
+void sort_decoded_texture_mips_tail_first(DecodedTexture& decoded_texture)
+{
+    std::ranges::stable_sort(decoded_texture.mips, [](const DecodedTextureMip& a, const DecodedTextureMip& b) {
+        return a.mip_index > b.mip_index;
+    });
+}
+
+void schedule_texture_uploads(std::span<TextureStreamingRequest> requests, RingAllocator& ring,
+                              const TextureStreamingBudget& budget, std::vector<TextureMipUpload>& output_uploads)
+{
+    REAPER_PROFILE_SCOPE_FUNC();
+
+    u64  scheduled_bytes = 0;
+    bool has_pending_mips = true;
+
+    while (has_pending_mips)
+    {
+        has_pending_mips = false;
+
+        for (u32 request_index = 0; request_index < requests.size(); request_index++)
+        {
+            TextureStreamingRequest& request = requests[request_index];
+
+            if (is_texture_streaming_request_done(request))
+                continue;
+
+            const DecodedTextureMip& mip = request.mips[request.uploaded_mip_count];
+
+            Assert(mip.size_bytes <= ring.size_bytes, "mip doesn't fit in the staging ring");
+
+            if (scheduled_bytes > 0 && scheduled_bytes + mip.size_bytes > budget.max_bytes_per_frame)
+                return;
+
+            const u64 staging_offset_bytes = ring_allocate(ring, mip.size_bytes, budget.staging_alignment);
+
+            // Back-pressure, wait for older uploads to retire
+            if (staging_offset_bytes == InvalidRingOffset)
+                return;
+
+            output_uploads.push_back(TextureMipUpload{
+                .request_index = request_index,
+                .mip = request.uploaded_mip_count,
+                .staging_offset_bytes = staging_offset_bytes,
+            });
+
+            scheduled_bytes += mip.size_bytes;
+            request.uploaded_mip_count += 1;
+
+            has_pending_mips |= !is_texture_streaming_request_done(request);
+        }
+    }
+}
+} // namespace Reaper
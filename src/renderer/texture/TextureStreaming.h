@@ -0,0 +1,75 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "renderer/RendererExport.h"
+#include "renderer/texture/GPUTextureProperties.h"
+
+#include "core/memory/RingAllocator.h"
+
+#include <span>
+#include <vector>
+
+namespace Reaper
+{
+struct DecodedTextureMip
+{
+    u32 mip_index;
+    u32 layer_index;
+    u32 width;
+    u32 height;
+    u32 depth;
+    u64 offset_bytes; // In DecodedTexture::data
+    u64 size_bytes;
+};
+
+// CPU copy of a texture file, ready to be copied to a staging buffer.
+// Mips are sorted from the smallest to the largest, so the tail always gets uploaded first.
+struct DecodedTexture
+{
+    GPUTextureProperties           properties;
+    std::vector<DecodedTextureMip> mips;
+    std::vector<u8>                data;
+};
+
+REAPER_RENDERER_API void sort_decoded_texture_mips_tail_first(DecodedTexture& decoded_texture);
+
+// Mips of a texture that still need to reach the GPU, the pixel data stays in the owner's DecodedTexture.
+struct TextureStreamingRequest
+{
+    u32                            texture_index;
+    std::vector<DecodedTextureMip> mips;
+    u32                            uploaded_mip_count; // Mips are consumed in order
+};
+
+struct TextureMipUpload
+{
+    u32 request_index;
+    u32 mip; // Index in TextureStreamingRequest::mips
+    u64 staging_offset_bytes;
+};
+
+struct TextureStreamingBudget
+{
+    u64 max_bytes_per_frame;
+    u64 staging_alignment;
+};
+
+// Hands out staging memory to the requests one mip at a time in a round-robin fashion, so every texture gets its
+// mip tail before any of them gets its top mips.
+// Stops at the frame budget or as soon as the ring is full, the remaining mips are left for the next calls.
+// At least one mip goes through when the ring has room for it, so a single large mip can't stall the queue.
+REAPER_RENDERER_API void schedule_texture_uploads(std::span<TextureStreamingRequest> requests, RingAllocator& ring,
+                                                  const TextureStreamingBudget& budget,
+                                                  std::vector<TextureMipUpload>& output_uploads);
+
+inline bool is_texture_streaming_request_done(const TextureStreamingRequest& request)
+{
+    return request.uploaded_mip_count == request.mips.size();
+}
+} // namespace Reaper
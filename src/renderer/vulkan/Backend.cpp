@@ -18,7 +18,6 @@
 #include "Debug.h"
 #include "DebugMessageCallback.h"
 #include "Display.h"
-#include "Semaphore.h"
 #include "Swapchain.h"
 
 #include <cstring>
@@ -133,9 +132,32 @@ namespace
             });
         }
 
+        if (backend.physical_device.compute_queue_family_index != UINT32_MAX)
+        {
+            queue_create_infos.push_back(VkDeviceQueueCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = VK_FLAGS_NONE,
+                .queueFamilyIndex = backend.physical_device.compute_queue_family_index,
+                .queueCount = static_cast<uint32_t>(queue_priorities.size()),
+                .pQueuePriorities = queue_priorities.data(),
+            });
+        }
+
+        if (backend.physical_device.transfer_queue_family_index != UINT32_MAX)
+        {
+            queue_create_infos.push_back(VkDeviceQueueCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = VK_FLAGS_NONE,
+                .queueFamilyIndex = backend.physical_device.transfer_queue_family_index,
+                .queueCount = static_cast<uint32_t>(queue_priorities.size()),
+                .pQueuePriorities = queue_priorities.data(),
+            });
+        }
+
         Assert(!queue_create_infos.empty());
         Assert(!queue_priorities.empty());
-        Assert(queue_priorities.size() == queue_create_infos.size());
 
         uint32_t queueCreateCount = static_cast<uint32_t>(queue_create_infos.size());
 
@@ -210,6 +232,22 @@ namespace
         vkGetDeviceQueue(backend.device, backend.physical_device.graphics_queue_family_index, 0,
                          &backend.graphics_queue);
         vkGetDeviceQueue(backend.device, backend.physical_device.present_queue_family_index, 0, &backend.present_queue);
+
+        backend.compute_queue = VK_NULL_HANDLE;
+
+        if (backend.physical_device.compute_queue_family_index != UINT32_MAX)
+        {
+            vkGetDeviceQueue(backend.device, backend.physical_device.compute_queue_family_index, 0,
+                             &backend.compute_queue);
+        }
+
+        backend.transfer_queue = VK_NULL_HANDLE;
+
+        if (backend.physical_device.transfer_queue_family_index != UINT32_MAX)
+        {
+            vkGetDeviceQueue(backend.device, backend.physical_device.transfer_queue_family_index, 0,
+                             &backend.transfer_queue);
+        }
     }
 
     void vulkan_check_physical_device_supported_extensions(
@@ -340,6 +378,16 @@ namespace
         log_debug(root, "- subgroup min size = {}", physical_device.properties_vk_1_3.minSubgroupSize);
         log_debug(root, "- subgroup max size = {}", physical_device.properties_vk_1_3.maxSubgroupSize);
 
+        if (physical_device.compute_queue_family_index != UINT32_MAX)
+            log_debug(root, "- async compute queue family = {}", physical_device.compute_queue_family_index);
+        else
+            log_debug(root, "- no async compute queue family");
+
+        if (physical_device.transfer_queue_family_index != UINT32_MAX)
+            log_debug(root, "- transfer queue family = {}", physical_device.transfer_queue_family_index);
+        else
+            log_debug(root, "- no transfer queue family");
+
         std::span<const VkMemoryHeap> memory_heaps(physical_device.memory_properties.memoryHeaps,
                                                    physical_device.memory_properties.memoryHeapCount);
 
@@ -561,15 +609,6 @@ void create_vulkan_renderer_backend(ReaperRoot& root, VulkanBackend& backend)
 
     // create_vulkan_display_swapchain(root, backend);
 
-    VkSemaphoreCreateInfo semaphore_create_info = {
-        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
-        .pNext = nullptr,
-        .flags = VK_FLAGS_NONE,
-    };
-
-    backend.semaphore_swapchain_image_available =
-        create_semaphore(backend, semaphore_create_info, "Semaphore image available");
-
     ImGui::CreateContext();
 
     ImGui_ImplVulkan_InitInfo imgui_vulkan_init_info = {
@@ -604,8 +643,6 @@ void destroy_vulkan_renderer_backend(ReaperRoot& root, VulkanBackend& backend)
 
     ImGui_ImplVulkan_Shutdown();
 
-    vkDestroySemaphore(backend.device, backend.semaphore_swapchain_image_available, nullptr);
-
     destroy_vulkan_wm_swapchain(root, backend, backend.presentInfo);
 
     log_debug(root, "vulkan: destroy gpu memory allocator");
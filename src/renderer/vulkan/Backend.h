@@ -64,6 +64,8 @@ struct REAPER_RENDERER_API VulkanBackend
     // NOTE: These can point to the same object!
     VkQueue graphics_queue = VK_NULL_HANDLE;
     VkQueue present_queue = VK_NULL_HANDLE;
+    VkQueue compute_queue = VK_NULL_HANDLE;  // Only set when the device has a dedicated compute family
+    VkQueue transfer_queue = VK_NULL_HANDLE; // Only set when the device has a dedicated transfer family
 
     VkDescriptorPool global_descriptor_pool = VK_NULL_HANDLE;
 
@@ -73,9 +75,6 @@ struct REAPER_RENDERER_API VulkanBackend
 
     VkExtent2D render_extent;
 
-    // Timeline semaphores aren't supported for present operations at the time AFAIK.
-    VkSemaphore semaphore_swapchain_image_available = VK_NULL_HANDLE;
-
     VkDebugUtilsMessengerEXT debugMessenger = VK_NULL_HANDLE;
 
     VkExtent2D new_swapchain_extent = {0, 0};
@@ -87,6 +86,12 @@ struct REAPER_RENDERER_API VulkanBackend
         bool freeze_meshlet_culling = false; // FIXME using the framegraph we can't have persistent resources yet
         bool enable_debug_tile_lighting = true;
         bool enable_msaa_visibility = false;
+        bool enable_framegraph_memory_aliasing = true;
+        bool enable_async_compute = true; // Ignored if the device has no dedicated compute queue
+        bool enable_mesh_cache_defragmentation = false;
+        bool enable_quantized_vertices = false; // Read once when creating the backend resources
+        u32  texture_vram_budget_mib = 512; // Only the top mips of material textures get evicted to fit
+        u32  frames_in_flight = 2;          // Read once when creating the backend resources
     } options;
 
     BackendResources* resources = nullptr;
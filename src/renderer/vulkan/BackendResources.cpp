@@ -8,56 +8,266 @@
 #include "BackendResources.h"
 
 #include "Backend.h"
+#include "Semaphore.h"
 #include "api/AssertHelper.h"
 #include "profiling/Scope.h"
 
 #include "common/Log.h"
 
+#include <core/Assert.h>
 #include <core/Literals.h>
+#include <core/jobs/JobSystem.h>
+
+#include <array>
+#include <span>
+#include <vector>
 
 namespace Reaper
 {
+namespace
+{
+    VkCommandPool create_command_pool(VulkanBackend& backend, u32 queue_family_index)
+    {
+        const VkCommandPoolCreateInfo pool_create_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = VK_FLAGS_NONE,
+            .queueFamilyIndex = queue_family_index,
+        };
+
+        VkCommandPool pool = VK_NULL_HANDLE;
+        AssertVk(vkCreateCommandPool(backend.device, &pool_create_info, nullptr, &pool));
+
+        return pool;
+    }
+
+    void allocate_command_buffers(VulkanBackend& backend, VkCommandPool pool, VkCommandBufferLevel level,
+                                  std::span<CommandBuffer> command_buffers)
+    {
+        std::vector<VkCommandBuffer> handles(command_buffers.size());
+
+        const VkCommandBufferAllocateInfo cmdBufferAllocInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .pNext = nullptr,
+            .commandPool = pool,
+            .level = level,
+            .commandBufferCount = static_cast<u32>(handles.size()),
+        };
+
+        AssertVk(vkAllocateCommandBuffers(backend.device, &cmdBufferAllocInfo, handles.data()));
+
+        for (u32 i = 0; i < command_buffers.size(); i++)
+        {
+            command_buffers[i] = {};
+            command_buffers[i].handle = handles[i];
+        }
+    }
+
+    void free_command_buffers(VulkanBackend& backend, VkCommandPool pool,
+                              std::span<const CommandBuffer> command_buffers)
+    {
+        for (const CommandBuffer& command_buffer : command_buffers)
+        {
+            vkFreeCommandBuffers(backend.device, pool, 1, &command_buffer.handle);
+        }
+    }
+
+    // Sets of a frame are allocated every time it gets recorded and freed all at once when the context is recycled.
+    // Each type gets the whole budget of its kind, so whatever mix the passes use fits as long as the budget does.
+    VkDescriptorPool create_frame_descriptor_pool(VulkanBackend& backend)
+    {
+        const std::array<VkDescriptorPoolSize, 6> descriptor_pool_sizes = {
+            VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_SAMPLER, MaxFrameImageDescriptorCount},
+            VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, MaxFrameImageDescriptorCount},
+            VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, MaxFrameBufferDescriptorCount},
+            VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, MaxFrameBufferDescriptorCount},
+            VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, MaxFrameImageDescriptorCount},
+            VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MaxFrameImageDescriptorCount},
+        };
+
+        const VkDescriptorPoolCreateInfo pool_info = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = VK_FLAGS_NONE,
+            .maxSets = MaxFrameDescriptorSetCount,
+            .poolSizeCount = static_cast<u32>(descriptor_pool_sizes.size()),
+            .pPoolSizes = descriptor_pool_sizes.data(),
+        };
+
+        VkDescriptorPool pool = VK_NULL_HANDLE;
+        AssertVk(vkCreateDescriptorPool(backend.device, &pool_info, nullptr, &pool));
+
+        return pool;
+    }
+
+    FrameContext create_frame_context(VulkanBackend& backend, u32 recording_thread_count)
+    {
+        using namespace FrameGraph;
+
+        FrameContext context = {};
+
+        context.gfx_command_pool =
+            create_command_pool(backend, backend.physical_device.graphics_queue_family_index);
+
+        allocate_command_buffers(backend, context.gfx_command_pool, VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                                 context.batch_cmd_buffers[QueueType::Graphics]);
+
+        context.compute_command_pool = VK_NULL_HANDLE;
+
+        if (backend.compute_queue != VK_NULL_HANDLE)
+        {
+            context.compute_command_pool =
+                create_command_pool(backend, backend.physical_device.compute_queue_family_index);
+
+            allocate_command_buffers(backend, context.compute_command_pool, VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                                     context.batch_cmd_buffers[QueueType::AsyncCompute]);
+        }
+
+        context.thread_cmd_buffers.resize(recording_thread_count);
+
+        for (ThreadCommandBuffers& thread_cmd_buffers : context.thread_cmd_buffers)
+        {
+            thread_cmd_buffers.command_pools[QueueType::Graphics] =
+                create_command_pool(backend, backend.physical_device.graphics_queue_family_index);
+
+            thread_cmd_buffers.command_pools[QueueType::AsyncCompute] =
+                backend.compute_queue != VK_NULL_HANDLE
+                    ? create_command_pool(backend, backend.physical_device.compute_queue_family_index)
+                    : VK_NULL_HANDLE;
+
+            thread_cmd_buffers.used_secondary_counts = {};
+        }
+
+        context.storage_allocator = create_storage_buffer_allocator(backend, "Frame Storage Buffer Allocator", 1_MiB);
+        context.descriptor_pool = create_frame_descriptor_pool(backend);
+
+        const VkSemaphoreCreateInfo semaphore_create_info = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = VK_FLAGS_NONE,
+        };
+
+        context.semaphore_swapchain_image_available =
+            create_semaphore(backend, semaphore_create_info, "Semaphore image available");
+
+        context.frame_index = 0;
+
+        return context;
+    }
+
+    void destroy_frame_context(VulkanBackend& backend, FrameContext& context)
+    {
+        using namespace FrameGraph;
+
+        vkDestroySemaphore(backend.device, context.semaphore_swapchain_image_available, nullptr);
+        vkDestroyDescriptorPool(backend.device, context.descriptor_pool, nullptr);
+        destroy_storage_buffer_allocator(backend, context.storage_allocator);
+
+        for (ThreadCommandBuffers& thread_cmd_buffers : context.thread_cmd_buffers)
+        {
+            for (u32 queue_type = 0; queue_type < QueueType::Count; queue_type++)
+            {
+                const VkCommandPool pool = thread_cmd_buffers.command_pools[queue_type];
+
+                if (pool == VK_NULL_HANDLE)
+                    continue;
+
+                free_command_buffers(backend, pool, thread_cmd_buffers.secondary_cmd_buffers[queue_type]);
+                vkDestroyCommandPool(backend.device, pool, nullptr);
+            }
+        }
+
+        if (context.compute_command_pool != VK_NULL_HANDLE)
+        {
+            free_command_buffers(backend, context.compute_command_pool,
+                                 context.batch_cmd_buffers[QueueType::AsyncCompute]);
+            vkDestroyCommandPool(backend.device, context.compute_command_pool, nullptr);
+        }
+
+        free_command_buffers(backend, context.gfx_command_pool, context.batch_cmd_buffers[QueueType::Graphics]);
+        vkDestroyCommandPool(backend.device, context.gfx_command_pool, nullptr);
+    }
+
+#if defined(REAPER_USE_TRACY)
+    // Tracy only needs the command buffer to calibrate its timestamps when creating the context
+    tracy::VkCtx* create_queue_tracy_context(VulkanBackend& backend, VkQueue queue, u32 queue_family_index)
+    {
+        const VkCommandPool pool = create_command_pool(backend, queue_family_index);
+
+        CommandBuffer calibration_cmd_buffer;
+        allocate_command_buffers(backend, pool, VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                                 std::span(&calibration_cmd_buffer, 1));
+
+        tracy::VkCtx* tracy_ctx = TracyVkContextCalibrated(
+            backend.physical_device.handle, backend.device, queue, calibration_cmd_buffer.handle,
+            vkGetPhysicalDeviceCalibrateableTimeDomainsEXT, vkGetCalibratedTimestampsEXT);
+
+        vkDestroyCommandPool(backend.device, pool, nullptr);
+
+        return tracy_ctx;
+    }
+#endif
+} // namespace
+
 void create_backend_resources(ReaperRoot& root, VulkanBackend& backend)
 {
     backend.resources = new BackendResources;
 
     BackendResources& resources = *backend.resources;
 
-    // Create command buffer
-    const VkCommandPoolCreateInfo poolCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
-        .pNext = nullptr,
-        .flags = VK_FLAGS_NONE,
-        .queueFamilyIndex = backend.physical_device.graphics_queue_family_index,
-    };
+    Assert(backend.options.frames_in_flight > 0 && backend.options.frames_in_flight <= MaxFramesInFlight,
+           "invalid frames in flight count");
 
-    AssertVk(vkCreateCommandPool(backend.device, &poolCreateInfo, nullptr, &resources.gfxCommandPool));
-    log_debug(root, "vulkan: created command pool with handle: {}", static_cast<void*>(resources.gfxCommandPool));
+    resources.frames_in_flight = backend.options.frames_in_flight;
+    resources.recording_thread_count = get_worker_thread_count(*root.job_system) + 1;
 
-    const VkCommandBufferAllocateInfo cmdBufferAllocInfo = {
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-        .pNext = nullptr,
-        .commandPool = resources.gfxCommandPool,
-        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-        .commandBufferCount = 1,
-    };
+    for (u32 context_index = 0; context_index < resources.frames_in_flight; context_index++)
+    {
+        resources.frame_contexts[context_index] = create_frame_context(backend, resources.recording_thread_count);
+    }
 
-    AssertVk(vkAllocateCommandBuffers(backend.device, &cmdBufferAllocInfo, &resources.gfxCmdBuffer.handle));
-    log_debug(root, "vulkan: created command buffer with handle: {}",
-              static_cast<void*>(resources.gfxCmdBuffer.handle));
+    log_debug(root, "vulkan: created {} frame contexts for {} recording threads", resources.frames_in_flight,
+              resources.recording_thread_count);
 
 #if defined(REAPER_USE_TRACY)
-    resources.gfxCmdBuffer.tracy_ctx = TracyVkContextCalibrated(
-        backend.physical_device.handle, backend.device, backend.graphics_queue, resources.gfxCmdBuffer.handle,
-        vkGetPhysicalDeviceCalibrateableTimeDomainsEXT, vkGetCalibratedTimestampsEXT);
-    // TracyVkContextName(resources.gfxCmdBuffer.tracy_ctx, name, size);
+    {
+        using namespace FrameGraph;
+
+        // Every thread gets a profiling context per queue, shared across all frame contexts
+        resources.thread_tracy_ctx.resize(resources.recording_thread_count);
+
+        for (auto& queue_tracy_ctx : resources.thread_tracy_ctx)
+        {
+            queue_tracy_ctx = {};
+            queue_tracy_ctx[QueueType::Graphics] = create_queue_tracy_context(
+                backend, backend.graphics_queue, backend.physical_device.graphics_queue_family_index);
+
+            if (backend.compute_queue != VK_NULL_HANDLE)
+            {
+                queue_tracy_ctx[QueueType::AsyncCompute] = create_queue_tracy_context(
+                    backend, backend.compute_queue, backend.physical_device.compute_queue_family_index);
+            }
+        }
+
+        // Batch command buffers are only recorded by the main thread
+        for (u32 context_index = 0; context_index < resources.frames_in_flight; context_index++)
+        {
+            FrameContext& context = resources.frame_contexts[context_index];
+
+            for (u32 queue_type = 0; queue_type < QueueType::Count; queue_type++)
+            {
+                for (CommandBuffer& command_buffer : context.batch_cmd_buffers[queue_type])
+                {
+                    command_buffer.tracy_ctx = resources.thread_tracy_ctx[0][queue_type];
+                }
+            }
+        }
+    }
 #endif
 
     create_shader_modules(resources.shader_modules, root);
     resources.pipeline_factory = create_pipeline_factory(backend);
     resources.samplers_resources = create_sampler_resources(backend);
-    resources.frame_storage_allocator =
-        create_storage_buffer_allocator(backend, "Frame Storage Buffer Allocator", 1_MiB);
     resources.debug_geometry_resources = create_debug_geometry_pass_resources(backend, resources.pipeline_factory);
     resources.framegraph_resources = create_framegraph_resources(backend);
     resources.audio_resources = create_audio_resources(backend, resources.pipeline_factory);
@@ -83,10 +293,10 @@ void destroy_backend_resources(VulkanBackend& backend)
 {
     BackendResources& resources = *backend.resources;
 
-    destroy_shader_modules(resources.shader_modules);
+    // Pipeline rebuilds still running read the shader modules
     destroy_pipeline_factory(backend, resources.pipeline_factory);
+    destroy_shader_modules(resources.shader_modules);
     destroy_sampler_resources(backend, resources.samplers_resources);
-    destroy_storage_buffer_allocator(backend, resources.frame_storage_allocator);
     destroy_debug_geometry_pass_resources(backend, resources.debug_geometry_resources);
     destroy_framegraph_resources(backend, resources.framegraph_resources);
     destroy_audio_resources(backend, resources.audio_resources);
@@ -108,13 +318,98 @@ void destroy_backend_resources(VulkanBackend& backend)
     destroy_swapchain_pass_resources(backend, resources.swapchain_pass_resources);
 
 #if defined(REAPER_USE_TRACY)
-    TracyVkDestroy(resources.gfxCmdBuffer.tracy_ctx);
+    for (const auto& queue_tracy_ctx : resources.thread_tracy_ctx)
+    {
+        for (tracy::VkCtx* tracy_ctx : queue_tracy_ctx)
+        {
+            if (tracy_ctx != nullptr)
+                TracyVkDestroy(tracy_ctx);
+        }
+    }
 #endif
 
-    vkFreeCommandBuffers(backend.device, resources.gfxCommandPool, 1, &resources.gfxCmdBuffer.handle);
-    vkDestroyCommandPool(backend.device, resources.gfxCommandPool, nullptr);
+    for (u32 context_index = 0; context_index < resources.frames_in_flight; context_index++)
+    {
+        destroy_frame_context(backend, resources.frame_contexts[context_index]);
+    }
 
     delete backend.resources;
     backend.resources = nullptr;
 }
+
+void reset_frame_context(VulkanBackend& backend, FrameContext& frame_context)
+{
+    AssertVk(vkResetCommandPool(backend.device, frame_context.gfx_command_pool, VK_FLAGS_NONE));
+
+    if (frame_context.compute_command_pool != VK_NULL_HANDLE)
+    {
+        AssertVk(vkResetCommandPool(backend.device, frame_context.compute_command_pool, VK_FLAGS_NONE));
+    }
+
+    // Secondary command buffers stay allocated, they get recorded again from scratch
+    for (ThreadCommandBuffers& thread_cmd_buffers : frame_context.thread_cmd_buffers)
+    {
+        for (VkCommandPool pool : thread_cmd_buffers.command_pools)
+        {
+            if (pool != VK_NULL_HANDLE)
+                AssertVk(vkResetCommandPool(backend.device, pool, VK_FLAGS_NONE));
+        }
+
+        thread_cmd_buffers.used_secondary_counts = {};
+    }
+
+    AssertVk(vkResetDescriptorPool(backend.device, frame_context.descriptor_pool, VK_FLAGS_NONE));
+}
+
+CommandBuffer begin_thread_secondary_command_buffer(VulkanBackend& backend, BackendResources& resources,
+                                                    FrameContext& frame_context, u32 thread_index, u32 queue_type)
+{
+    Assert(thread_index < frame_context.thread_cmd_buffers.size());
+
+    ThreadCommandBuffers&       thread_cmd_buffers = frame_context.thread_cmd_buffers[thread_index];
+    std::vector<CommandBuffer>& secondary_cmd_buffers = thread_cmd_buffers.secondary_cmd_buffers[queue_type];
+    u32&                        used_count = thread_cmd_buffers.used_secondary_counts[queue_type];
+
+    Assert(thread_cmd_buffers.command_pools[queue_type] != VK_NULL_HANDLE);
+
+    if (used_count == secondary_cmd_buffers.size())
+    {
+        CommandBuffer& new_cmd_buffer = secondary_cmd_buffers.emplace_back();
+
+        allocate_command_buffers(backend, thread_cmd_buffers.command_pools[queue_type],
+                                 VK_COMMAND_BUFFER_LEVEL_SECONDARY, std::span(&new_cmd_buffer, 1));
+
+#if defined(REAPER_USE_TRACY)
+        new_cmd_buffer.tracy_ctx = resources.thread_tracy_ctx[thread_index][queue_type];
+#else
+        static_cast<void>(resources);
+#endif
+    }
+
+    CommandBuffer& cmd_buffer = secondary_cmd_buffers[used_count];
+    used_count += 1;
+
+    // Passes begin their own rendering scope when they need one
+    const VkCommandBufferInheritanceInfo inheritance_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+        .pNext = nullptr,
+        .renderPass = VK_NULL_HANDLE,
+        .subpass = 0,
+        .framebuffer = VK_NULL_HANDLE,
+        .occlusionQueryEnable = VK_FALSE,
+        .queryFlags = VK_FLAGS_NONE,
+        .pipelineStatistics = VK_FLAGS_NONE,
+    };
+
+    const VkCommandBufferBeginInfo begin_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = nullptr,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = &inheritance_info,
+    };
+
+    AssertVk(vkBeginCommandBuffer(cmd_buffer.handle, &begin_info));
+
+    return cmd_buffer;
+}
 } // namespace Reaper
@@ -35,15 +35,55 @@
 
 #include <vulkan_loader/Vulkan.h>
 
+#include <array>
+#include <vector>
+
 namespace Reaper
 {
+// The frame graph can split the work of a queue in several submits, each one needs its own command buffer.
+static constexpr u32 MaxSubmitBatchCountPerQueue = 8;
+
+// Descriptor budget of a single frame, shared by the descriptor pool of each frame context and the helper that
+// fills it. A frame allocates ~33 sets today, most image descriptors are the partially bound material arrays.
+// Running out asserts in DescriptorWriteHelper, bump these when adding passes.
+static constexpr u32 MaxFrameDescriptorSetCount = 64;
+static constexpr u32 MaxFrameImageDescriptorCount = 256;
+static constexpr u32 MaxFrameBufferDescriptorCount = 256;
+
+// Passes are recorded into secondary command buffers from any job system thread.
+// Command pools can't be used by several threads at once, so every thread gets its own.
+struct ThreadCommandBuffers
+{
+    std::array<VkCommandPool, FrameGraph::QueueType::Count>              command_pools; // VK_NULL_HANDLE if no queue
+    std::array<std::vector<CommandBuffer>, FrameGraph::QueueType::Count> secondary_cmd_buffers; // Grows on demand
+    std::array<u32, FrameGraph::QueueType::Count>                        used_secondary_counts;
+};
+
+// Everything the CPU writes while recording a frame. A context gets recycled once the GPU is done with the frame that
+// last used it, so the CPU can record the next frames in the other contexts meanwhile.
+struct FrameContext
+{
+    VkCommandPool gfx_command_pool;
+    VkCommandPool compute_command_pool; // VK_NULL_HANDLE without a dedicated compute queue
+
+    // Indexed by queue type then by submit batch.
+    // The first graphics command buffer is the main one, command buffers of the same queue share a profiling context.
+    std::array<std::array<CommandBuffer, MaxSubmitBatchCountPerQueue>, FrameGraph::QueueType::Count> batch_cmd_buffers;
+
+    std::vector<ThreadCommandBuffers> thread_cmd_buffers; // Indexed by job system thread
+
+    StorageBufferAllocator storage_allocator;
+    VkDescriptorPool       descriptor_pool;
+    VkSemaphore            semaphore_swapchain_image_available;
+    u64                    frame_index; // Last frame recorded with this context
+};
+
 struct BackendResources
 {
     // TODO remove *_resources suffix
     PipelineFactory               pipeline_factory;
     ShaderModules                 shader_modules;
     SamplerResources              samplers_resources;
-    StorageBufferAllocator        frame_storage_allocator;
     DebugGeometryPassResources    debug_geometry_resources;
     FrameGraphResources           framegraph_resources;
     MeshCache                     mesh_cache;
@@ -64,11 +104,32 @@ struct BackendResources
     FrameSyncResources            frame_sync_resources;
     AudioResources                audio_resources;
 
-    // FIXME wrap this
-    VkCommandPool gfxCommandPool;
-    CommandBuffer gfxCmdBuffer;
+    u32                                         frames_in_flight;
+    std::array<FrameContext, MaxFramesInFlight> frame_contexts; // Only the first frames_in_flight ones are valid
+
+    u32 recording_thread_count; // Worker threads of the job system plus the main thread
+
+#if defined(REAPER_USE_TRACY)
+    // Indexed by job system thread then by queue type, a profiling context can't be shared between threads.
+    // The main thread uses the contexts of the batch command buffers.
+    std::vector<std::array<tracy::VkCtx*, FrameGraph::QueueType::Count>> thread_tracy_ctx;
+#endif
 };
 
 void create_backend_resources(ReaperRoot& root, VulkanBackend& backend);
 void destroy_backend_resources(VulkanBackend& backend);
+
+// Secondary command buffers and descriptor sets of the context can be reused once the GPU is done with its last frame
+void reset_frame_context(VulkanBackend& backend, FrameContext& frame_context);
+
+// Begins a secondary command buffer owned by the calling job system thread, it stays valid until the frame context
+// gets reset. Passes record complete rendering scopes in there, nothing is inherited from the primary.
+CommandBuffer begin_thread_secondary_command_buffer(VulkanBackend& backend, BackendResources& resources,
+                                                    FrameContext& frame_context, u32 thread_index, u32 queue_type);
+
+// Context to record the given frame with
+inline FrameContext& get_frame_context(BackendResources& resources, u64 frame_index)
+{
+    return resources.frame_contexts[frame_index % resources.frames_in_flight];
+}
 } // namespace Reaper
@@ -13,7 +13,11 @@
 #include "common/Log.h"
 #include "common/ReaperRoot.h"
 
+#include <core/jobs/JobSystem.h>
+#include <profiling/Scope.h>
+
 #include <algorithm>
+#include <cstring>
 
 namespace Reaper
 {
@@ -35,39 +39,58 @@ namespace
 
         return flags;
     }
-} // namespace
-
-GPUBuffer create_buffer(VkDevice device, const char* debug_string, const GPUBufferProperties& input_properties,
-                        VmaAllocator& allocator, MemUsage mem_usage)
-{
-    GPUBufferProperties properties = input_properties;
 
-    // Uniform buffers require extra care on the CPU side.
-    // There's a minimum buffer offset we need to take into account.
-    // That means there's potentially extra padding between elements regardless
-    // of the initial element size.
-    if (properties.usage_flags & GPUBufferUsage::UniformBuffer)
+    GPUBufferProperties get_buffer_properties_with_stride(const GPUBufferProperties& input_properties)
     {
-        // const u64 minUniformBufferOffsetAlignment =
-        // backend.physicalDeviceProperties.limits.minUniformBufferOffsetAlignment;
-        const u32 minUniformBufferOffsetAlignment = 0x40; // FIXME
-        const u32 stride = std::max(properties.element_size_bytes, minUniformBufferOffsetAlignment);
+        GPUBufferProperties properties = input_properties;
 
-        properties.stride = stride;
+        // Uniform buffers require extra care on the CPU side.
+        // There's a minimum buffer offset we need to take into account.
+        // That means there's potentially extra padding between elements regardless
+        // of the initial element size.
+        if (properties.usage_flags & GPUBufferUsage::UniformBuffer)
+        {
+            // const u64 minUniformBufferOffsetAlignment =
+            // backend.physicalDeviceProperties.limits.minUniformBufferOffsetAlignment;
+            const u32 minUniformBufferOffsetAlignment = 0x40; // FIXME
+            const u32 stride = std::max(properties.element_size_bytes, minUniformBufferOffsetAlignment);
+
+            properties.stride = stride;
+        }
+        else
+        {
+            properties.stride = properties.element_size_bytes;
+        }
+
+        return properties;
     }
-    else
+
+    VkBufferCreateInfo get_vk_buffer_create_info(const GPUBufferProperties& properties,
+                                                 std::span<const u32>       concurrent_queue_families = {})
     {
-        properties.stride = properties.element_size_bytes;
+        const bool is_concurrent = concurrent_queue_families.size() > 1;
+
+        return VkBufferCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = VK_FLAGS_NONE,
+            .size = properties.element_count * properties.stride,
+            .usage = BufferUsageToVulkan(properties.usage_flags),
+            .sharingMode = is_concurrent ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+            .queueFamilyIndexCount = is_concurrent ? static_cast<u32>(concurrent_queue_families.size()) : 0,
+            .pQueueFamilyIndices = is_concurrent ? concurrent_queue_families.data() : nullptr,
+        };
     }
 
-    const VkBufferCreateInfo bufferInfo = {.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-                                           .pNext = nullptr,
-                                           .flags = VK_FLAGS_NONE,
-                                           .size = properties.element_count * properties.stride,
-                                           .usage = BufferUsageToVulkan(properties.usage_flags),
-                                           .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-                                           .queueFamilyIndexCount = 0,
-                                           .pQueueFamilyIndices = nullptr};
+    // Below that, waking up the workers costs more than the copy itself
+    constexpr u64 ParallelCopyChunkSizeBytes = 4 * 1024 * 1024;
+} // namespace
+
+GPUBuffer create_buffer(VkDevice device, const char* debug_string, const GPUBufferProperties& input_properties,
+                        VmaAllocator& allocator, MemUsage mem_usage, std::span<const u32> concurrent_queue_families)
+{
+    const GPUBufferProperties properties = get_buffer_properties_with_stride(input_properties);
+    const VkBufferCreateInfo  bufferInfo = get_vk_buffer_create_info(properties, concurrent_queue_families);
 
     VmaAllocationCreateInfo allocInfo = {};
 
@@ -90,6 +113,9 @@ GPUBuffer create_buffer(VkDevice device, const char* debug_string, const GPUBuff
         break;
     }
 
+    if (mem_usage != MemUsage::GPU_Only)
+        allocInfo.flags |= VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
     VkBuffer      buffer;
     VmaAllocation allocation;
     AssertVk(vmaCreateBuffer(allocator, &bufferInfo, &allocInfo, &buffer, &allocation, nullptr));
@@ -103,45 +129,149 @@ GPUBuffer create_buffer(VkDevice device, const char* debug_string, const GPUBuff
     };
 }
 
-void upload_buffer_data(VkDevice device, const VmaAllocator& allocator, const GPUBuffer& buffer,
-                        const GPUBufferProperties& buffer_properties, const void* data, std::size_t size,
-                        u32 offset_elements)
+GPUBuffer create_buffer_placed(VkDevice device, const char* debug_string, const GPUBufferProperties& input_properties,
+                               VmaAllocator& allocator, VmaAllocation heap_allocation, u64 offset_bytes)
 {
-    u8* writePtr = nullptr;
+    const GPUBufferProperties properties = get_buffer_properties_with_stride(input_properties);
+    const VkBufferCreateInfo  bufferInfo = get_vk_buffer_create_info(properties);
 
-    Assert(size > 0, "Don't call this function with zero size");
+    VkBuffer buffer;
+    AssertVk(vmaCreateAliasingBuffer2(allocator, heap_allocation, offset_bytes, &bufferInfo, &buffer));
+
+    VulkanSetDebugName(device, buffer, debug_string);
+
+    // The memory belongs to the heap, don't free it with the buffer
+    return GPUBuffer{
+        .handle = buffer,
+        .allocation = VK_NULL_HANDLE,
+        .properties_deprecated = properties,
+    };
+}
+
+VkMemoryRequirements get_buffer_memory_requirements(VkDevice device, const GPUBufferProperties& input_properties)
+{
+    const GPUBufferProperties properties = get_buffer_properties_with_stride(input_properties);
+    const VkBufferCreateInfo  bufferInfo = get_vk_buffer_create_info(properties);
+
+    const VkDeviceBufferMemoryRequirements requirements_info = {
+        .sType = VK_STRUCTURE_TYPE_DEVICE_BUFFER_MEMORY_REQUIREMENTS,
+        .pNext = nullptr,
+        .pCreateInfo = &bufferInfo,
+    };
+
+    VkMemoryRequirements2 requirements = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2,
+        .pNext = nullptr,
+        .memoryRequirements = {},
+    };
+
+    vkGetDeviceBufferMemoryRequirements(device, &requirements_info, &requirements);
+
+    return requirements.memoryRequirements;
+}
+
+MappedBufferView get_mapped_buffer_view(const VmaAllocator& allocator, const GPUBuffer& buffer)
+{
+    Assert(buffer.allocation != VK_NULL_HANDLE, "placed buffers can't be mapped");
 
     VmaAllocationInfo allocation_info;
     vmaGetAllocationInfo(allocator, buffer.allocation, &allocation_info);
 
-    const u64 offset_bytes = buffer_properties.stride * offset_elements;
+    Assert(allocation_info.pMappedData != nullptr, "buffer is not host visible");
+
+    return MappedBufferView{
+        .allocation = buffer.allocation,
+        .data = static_cast<u8*>(allocation_info.pMappedData),
+        .size_bytes = allocation_info.size,
+    };
+}
+
+void flush_mapped_buffer_range(const VmaAllocator& allocator, const MappedBufferView& view, u64 offset_bytes,
+                               u64 size_bytes)
+{
+    Assert(offset_bytes + size_bytes <= view.size_bytes);
 
-    AssertVk(vkMapMemory(device, allocation_info.deviceMemory, allocation_info.offset + offset_bytes, size,
-                         VK_FLAGS_NONE, reinterpret_cast<void**>(&writePtr)));
+    AssertVk(vmaFlushAllocation(allocator, view.allocation, offset_bytes, size_bytes));
+}
 
-    Assert(size <= allocation_info.size,
-           fmt::format("copy src of size {} on dst of size {}", size, allocation_info.size));
+void invalidate_mapped_buffer_range(const VmaAllocator& allocator, const MappedBufferView& view, u64 offset_bytes,
+                                    u64 size_bytes)
+{
+    Assert(offset_bytes + size_bytes <= view.size_bytes);
+
+    AssertVk(vmaInvalidateAllocation(allocator, view.allocation, offset_bytes, size_bytes));
+}
+
+void write_mapped_buffer_range(const VmaAllocator& allocator, const MappedBufferView& view, u64 offset_bytes,
+                               const void* data, u64 size_bytes, JobSystem* job_system)
+{
+    REAPER_PROFILE_SCOPE_FUNC();
+
+    Assert(offset_bytes + size_bytes <= view.size_bytes,
+           fmt::format("copy src of size {} at offset {} on dst of size {}", size_bytes, offset_bytes,
+                       view.size_bytes));
+
+    u8*       dst = view.data + offset_bytes;
+    const u8* src = static_cast<const u8*>(data);
+
+    const u64 chunk_count = (size_bytes + ParallelCopyChunkSizeBytes - 1) / ParallelCopyChunkSizeBytes;
+
+    if (job_system != nullptr && chunk_count > 1)
+    {
+        parallel_for(*job_system, static_cast<u32>(chunk_count), [dst, src, size_bytes](u32 chunk_index) {
+            const u64 chunk_offset = chunk_index * ParallelCopyChunkSizeBytes;
+            const u64 chunk_size = std::min(ParallelCopyChunkSizeBytes, size_bytes - chunk_offset);
+
+            memcpy(dst + chunk_offset, src + chunk_offset, chunk_size);
+        });
+    }
+    else
+    {
+        memcpy(dst, src, size_bytes);
+    }
+
+    flush_mapped_buffer_range(allocator, view, offset_bytes, size_bytes);
+}
+
+void upload_buffer_data(const VmaAllocator& allocator, const GPUBuffer& buffer,
+                        const GPUBufferProperties& buffer_properties, const void* data, std::size_t size,
+                        u32 offset_elements, JobSystem* job_system)
+{
+    Assert(size > 0, "Don't call this function with zero size");
+
+    const MappedBufferView view = get_mapped_buffer_view(allocator, buffer);
+    const u64              offset_bytes = buffer_properties.stride * offset_elements;
 
     if (buffer_properties.element_size_bytes == buffer_properties.stride)
     {
-        memcpy(writePtr, data, size);
+        write_mapped_buffer_range(allocator, view, offset_bytes, data, size, job_system);
     }
     else
     {
-        for (u32 i = 0; i < buffer_properties.element_count; i++)
+        Assert(size % buffer_properties.element_size_bytes == 0);
+
+        const u64 element_count = size / buffer_properties.element_size_bytes;
+        const u64 size_bytes = element_count * buffer_properties.stride;
+
+        Assert(offset_bytes + size_bytes <= view.size_bytes,
+               fmt::format("copy src of size {} at offset {} on dst of size {}", size_bytes, offset_bytes,
+                           view.size_bytes));
+
+        const u8* data_bytes = static_cast<const u8*>(data);
+
+        for (u64 i = 0; i < element_count; i++)
         {
-            const char* data_char = static_cast<const char*>(data);
-            memcpy(writePtr + i * buffer_properties.stride, data_char + i * buffer_properties.element_size_bytes,
-                   buffer_properties.element_size_bytes);
+            memcpy(view.data + offset_bytes + i * buffer_properties.stride,
+                   data_bytes + i * buffer_properties.element_size_bytes, buffer_properties.element_size_bytes);
         }
-    }
 
-    vkUnmapMemory(device, allocation_info.deviceMemory);
+        flush_mapped_buffer_range(allocator, view, offset_bytes, size_bytes);
+    }
 }
 
-void upload_buffer_data_deprecated(VkDevice device, const VmaAllocator& allocator, const GPUBuffer& buffer,
-                                   const void* data, std::size_t size, u32 offset_elements)
+void upload_buffer_data_deprecated(const VmaAllocator& allocator, const GPUBuffer& buffer, const void* data,
+                                   std::size_t size, u32 offset_elements)
 {
-    return upload_buffer_data(device, allocator, buffer, buffer.properties_deprecated, data, size, offset_elements);
+    return upload_buffer_data(allocator, buffer, buffer.properties_deprecated, data, size, offset_elements);
 }
 } // namespace Reaper
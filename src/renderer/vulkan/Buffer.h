@@ -15,8 +15,12 @@
 
 #include <core/Assert.h>
 
+#include <span>
+
 namespace Reaper
 {
+struct JobSystem;
+
 struct GPUBuffer
 {
     VkBuffer            handle;
@@ -32,13 +36,44 @@ enum class MemUsage
     CPU_Only, // FIXME
 };
 
+// Buffers are owned by a single queue family unless more than one family is passed in concurrent_queue_families.
+// Host visible buffers (anything but GPU_Only) stay mapped for their whole lifetime, see get_mapped_buffer_view().
 GPUBuffer create_buffer(VkDevice device, const char* debug_string, const GPUBufferProperties& properties,
-                        VmaAllocator& allocator, MemUsage mem_usage = MemUsage::GPU_Only);
+                        VmaAllocator& allocator, MemUsage mem_usage = MemUsage::GPU_Only,
+                        std::span<const u32> concurrent_queue_families = {});
+
+// Binds the buffer at an offset of an existing allocation, the buffer doesn't own any memory.
+GPUBuffer create_buffer_placed(VkDevice device, const char* debug_string, const GPUBufferProperties& properties,
+                               VmaAllocator& allocator, VmaAllocation heap_allocation, u64 offset_bytes);
+
+VkMemoryRequirements get_buffer_memory_requirements(VkDevice device, const GPUBufferProperties& properties);
+
+// CPU pointer to the persistent mapping of a host visible buffer.
+// The memory might not be coherent: flush after writing and invalidate before reading.
+struct MappedBufferView
+{
+    VmaAllocation allocation;
+    u8*           data;
+    u64           size_bytes;
+};
+
+MappedBufferView get_mapped_buffer_view(const VmaAllocator& allocator, const GPUBuffer& buffer);
+
+// Ranges are rounded to nonCoherentAtomSize by VMA, this is a no-op for coherent memory.
+void flush_mapped_buffer_range(const VmaAllocator& allocator, const MappedBufferView& view, u64 offset_bytes,
+                               u64 size_bytes);
+void invalidate_mapped_buffer_range(const VmaAllocator& allocator, const MappedBufferView& view, u64 offset_bytes,
+                                    u64 size_bytes);
+
+// Copies and flushes the range. Large copies are split across the job system when one is given.
+void write_mapped_buffer_range(const VmaAllocator& allocator, const MappedBufferView& view, u64 offset_bytes,
+                               const void* data, u64 size_bytes, JobSystem* job_system = nullptr);
 
-void upload_buffer_data(VkDevice device, const VmaAllocator& allocator, const GPUBuffer& buffer,
+// Writes size bytes of tightly packed elements, the stride of the buffer is applied on the fly.
+void upload_buffer_data(const VmaAllocator& allocator, const GPUBuffer& buffer,
                         const GPUBufferProperties& buffer_properties, const void* data, std::size_t size,
-                        u32 offset_elements = 0);
+                        u32 offset_elements = 0, JobSystem* job_system = nullptr);
 
-void upload_buffer_data_deprecated(VkDevice device, const VmaAllocator& allocator, const GPUBuffer& buffer,
-                                   const void* data, std::size_t size, u32 offset_elements = 0);
+void upload_buffer_data_deprecated(const VmaAllocator& allocator, const GPUBuffer& buffer, const void* data,
+                                   std::size_t size, u32 offset_elements = 0);
 } // namespace Reaper
@@ -9,6 +9,11 @@
 
 #include "Buffer.h"
 #include "Image.h"
+#include "Pipeline.h"
+
+#include "api/AssertHelper.h"
+
+#include <core/Assert.h>
 
 namespace Reaper
 {
@@ -114,8 +119,11 @@ VkWriteDescriptorSet create_texel_buffer_view_descriptor_write(VkDescriptorSet d
                                                      std::span(texel_buffer_view, 1));
 }
 
-DescriptorWriteHelper::DescriptorWriteHelper(u32 image_descriptor_count, u32 buffer_descriptor_count,
+DescriptorWriteHelper::DescriptorWriteHelper(VkDevice device, VkDescriptorPool descriptor_pool,
+                                             u32 image_descriptor_count, u32 buffer_descriptor_count,
                                              u32 texel_buffer_descriptor_count)
+    : pool_device(device)
+    , frame_descriptor_pool(descriptor_pool)
 {
     image_infos = std::span(new VkDescriptorImageInfo[image_descriptor_count], image_descriptor_count);
     buffer_infos = std::span(new VkDescriptorBufferInfo[buffer_descriptor_count], buffer_descriptor_count);
@@ -135,8 +143,39 @@ DescriptorWriteHelper::~DescriptorWriteHelper()
     Assert(writes.empty());
 }
 
+VkDescriptorSet DescriptorWriteHelper::allocate_descriptor_set(VkDescriptorSetLayout set_layout)
+{
+    VkDescriptorSet descriptor_set;
+
+    allocate_descriptor_sets(set_layout, std::span(&descriptor_set, 1));
+
+    return descriptor_set;
+}
+
+void DescriptorWriteHelper::allocate_descriptor_sets(VkDescriptorSetLayout      set_layout,
+                                                     std::span<VkDescriptorSet> output_descriptor_sets)
+{
+    std::vector<VkDescriptorSetLayout> layouts(output_descriptor_sets.size(), set_layout);
+
+    const VkDescriptorSetAllocateInfo allocate_info = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .pNext = nullptr,
+        .descriptorPool = frame_descriptor_pool,
+        .descriptorSetCount = static_cast<u32>(layouts.size()),
+        .pSetLayouts = layouts.data(),
+    };
+
+    const VkResult result = vkAllocateDescriptorSets(pool_device, &allocate_info, output_descriptor_sets.data());
+
+    Assert(result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL,
+           "Frame descriptor pool is exhausted, raise the frame descriptor budget");
+    AssertVk(result);
+}
+
 VkDescriptorImageInfo& DescriptorWriteHelper::new_image_info(VkDescriptorImageInfo image_info)
 {
+    Assert(image_info_size < image_infos.size(), "Frame image descriptor budget is exhausted");
+
     VkDescriptorImageInfo& new_element = image_infos[image_info_size];
 
     new_element = image_info;
@@ -147,6 +186,8 @@ VkDescriptorImageInfo& DescriptorWriteHelper::new_image_info(VkDescriptorImageIn
 
 std::span<VkDescriptorImageInfo> DescriptorWriteHelper::new_image_infos(u32 count)
 {
+    Assert(image_info_size + count <= image_infos.size(), "Frame image descriptor budget is exhausted");
+
     auto span = std::span<VkDescriptorImageInfo>(image_infos.data() + image_info_size, count);
 
     image_info_size += count;
@@ -156,6 +197,8 @@ std::span<VkDescriptorImageInfo> DescriptorWriteHelper::new_image_infos(u32 coun
 
 VkDescriptorBufferInfo& DescriptorWriteHelper::new_buffer_info(VkDescriptorBufferInfo buffer_info)
 {
+    Assert(buffer_info_size < buffer_infos.size(), "Frame buffer descriptor budget is exhausted");
+
     VkDescriptorBufferInfo& new_element = buffer_infos[buffer_info_size];
 
     new_element = buffer_info;
@@ -166,6 +209,8 @@ VkDescriptorBufferInfo& DescriptorWriteHelper::new_buffer_info(VkDescriptorBuffe
 
 VkBufferView& DescriptorWriteHelper::new_texel_buffer_view(VkBufferView texel_buffer_view)
 {
+    Assert(texel_buffer_view_size < texel_buffer_views.size(), "Frame texel buffer descriptor budget is exhausted");
+
     VkBufferView& new_element = texel_buffer_views[texel_buffer_view_size];
 
     new_element = texel_buffer_view;
@@ -56,13 +56,18 @@ void fill_layout_bindings(std::span<VkDescriptorSetLayoutBinding> descriptor_set
 
 // Vulkan needs a few structures to be chained with pointers to fill descriptor sets.
 // This is quite tedious, so this helper's job is to hold the memory for these.
+// It also hands out the descriptor sets of the frame, since the GPU can still be reading the ones of previous frames.
 class DescriptorWriteHelper
 {
 public:
-    DescriptorWriteHelper(u32 image_descriptor_count, u32 buffer_descriptor_count,
-                          u32 texel_buffer_descriptor_count = 1);
+    DescriptorWriteHelper(VkDevice device, VkDescriptorPool descriptor_pool, u32 image_descriptor_count,
+                          u32 buffer_descriptor_count, u32 texel_buffer_descriptor_count = 1);
     ~DescriptorWriteHelper();
 
+    // These sets are freed all at once when the frame context they belong to gets recycled.
+    VkDescriptorSet allocate_descriptor_set(VkDescriptorSetLayout set_layout);
+    void allocate_descriptor_sets(VkDescriptorSetLayout set_layout, std::span<VkDescriptorSet> output_descriptor_sets);
+
     VkDescriptorImageInfo&           new_image_info(VkDescriptorImageInfo image_info);
     std::span<VkDescriptorImageInfo> new_image_infos(u32 count);
     VkDescriptorBufferInfo&          new_buffer_info(VkDescriptorBufferInfo buffer_info);
@@ -89,6 +94,9 @@ public:
     void flush_descriptor_write_helper(VkDevice device);
 
 private:
+    VkDevice         pool_device;
+    VkDescriptorPool frame_descriptor_pool;
+
     std::span<VkDescriptorImageInfo>  image_infos;
     std::span<VkDescriptorBufferInfo> buffer_infos;
     std::span<VkBufferView>           texel_buffer_views;
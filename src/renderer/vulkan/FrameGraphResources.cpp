@@ -13,15 +13,200 @@
 #include "common/ReaperRoot.h"
 #include <profiling/Scope.h>
 
+#include <algorithm>
+
 namespace Reaper
 {
 namespace
 {
-    void swap_resources(FrameGraphResources& resources)
+    bool is_same_texture_view(const GPUTextureView& a, const GPUTextureView& b)
+    {
+        return a.type == b.type && a.format == b.format && a.subresource.aspect == b.subresource.aspect
+               && a.subresource.mip_offset == b.subresource.mip_offset
+               && a.subresource.mip_count == b.subresource.mip_count
+               && a.subresource.layer_offset == b.subresource.layer_offset
+               && a.subresource.layer_count == b.subresource.layer_count;
+    }
+
+    // Views are cached along with the pooled texture since frame graphs tend to ask for the same ones every frame
+    VkImageView get_or_create_pooled_texture_view(VulkanBackend& backend, FrameGraphPooledResource& pooled_resource,
+                                                  const GPUTextureView& view)
+    {
+        for (const FrameGraphPooledTextureView& pooled_view : pooled_resource.additional_views)
+        {
+            if (is_same_texture_view(pooled_view.view, view))
+                return pooled_view.handle;
+        }
+
+        const VkImageView view_handle = create_image_view(backend.device, pooled_resource.texture.handle, view);
+
+        pooled_resource.additional_views.push_back(FrameGraphPooledTextureView{
+            .view = view,
+            .handle = view_handle,
+        });
+
+        return view_handle;
+    }
+
+    void create_pooled_resource(VulkanBackend& backend, const FrameGraphResources& resources,
+                                FrameGraphPooledResource& pooled_resource, const FrameGraph::Resource& resource,
+                                bool is_texture, u64 placement_offset)
+    {
+        pooled_resource = {};
+
+        const bool is_placed = placement_offset != FrameGraph::DedicatedPlacement;
+
+        if (is_texture)
+        {
+            if (is_placed)
+            {
+                pooled_resource.texture =
+                    create_image_placed(backend.device, resource.debug_name, resource.properties.texture,
+                                        backend.vma_instance, resources.texture_heap.allocation, placement_offset);
+            }
+            else
+            {
+                pooled_resource.texture = create_image(backend.device, resource.debug_name,
+                                                       resource.properties.texture, backend.vma_instance);
+            }
+
+            pooled_resource.default_view_handle =
+                create_image_view(backend.device, pooled_resource.texture.handle, resource.default_view.texture);
+        }
+        else
+        {
+            if (is_placed)
+            {
+                pooled_resource.buffer =
+                    create_buffer_placed(backend.device, resource.debug_name, resource.properties.buffer,
+                                         backend.vma_instance, resources.buffer_heap.allocation, placement_offset);
+            }
+            else
+            {
+                pooled_resource.buffer = create_buffer(backend.device, resource.debug_name,
+                                                       resource.properties.buffer, backend.vma_instance);
+            }
+        }
+    }
+
+    void destroy_pooled_resource(VulkanBackend& backend, FrameGraphPooledResource& pooled_resource)
     {
-        std::swap(resources.textures, resources.textures_b);
-        std::swap(resources.default_texture_views, resources.default_texture_views_b);
-        std::swap(resources.additional_texture_views, resources.additional_texture_views_b);
+        for (const FrameGraphPooledTextureView& pooled_view : pooled_resource.additional_views)
+        {
+            vkDestroyImageView(backend.device, pooled_view.handle, nullptr);
+        }
+
+        vkDestroyImageView(backend.device, pooled_resource.default_view_handle, nullptr);
+        vmaDestroyImage(backend.vma_instance, pooled_resource.texture.handle, pooled_resource.texture.allocation);
+        vmaDestroyBuffer(backend.vma_instance, pooled_resource.buffer.handle, pooled_resource.buffer.allocation);
+
+        pooled_resource = {};
+    }
+
+    void destroy_transient_heap(VulkanBackend& backend, FrameGraphTransientHeap& heap)
+    {
+        if (heap.allocation != VK_NULL_HANDLE)
+        {
+            vmaFreeMemory(backend.vma_instance, heap.allocation);
+        }
+
+        heap = {};
+    }
+
+    // Packs all used resources of one type in the transient heap.
+    // The heap only grows, when it does every resource placed in the old one is destroyed.
+    void place_transient_resources(VulkanBackend& backend, FrameGraphResources& resources,
+                                   const FrameGraph::FrameGraph& framegraph, bool is_texture,
+                                   std::span<const FrameGraph::ResourceLifetime> lifetimes,
+                                   std::vector<u64>&                             placements)
+    {
+        using namespace FrameGraph;
+
+        const std::vector<Resource>& framegraph_resources =
+            is_texture ? framegraph.TextureResources : framegraph.BufferResources;
+        FrameGraphTransientHeap& heap = is_texture ? resources.texture_heap : resources.buffer_heap;
+        TransientHeapLayout&     layout = is_texture ? resources.texture_heap_layout : resources.buffer_heap_layout;
+
+        std::vector<TransientResource> transient_resources;
+        u32                            memory_type_bits = 0xFFFFFFFF;
+        u64                            heap_alignment = 1;
+
+        for (u32 index = 0; index < framegraph_resources.size(); index++)
+        {
+            const Resource& resource = framegraph_resources[index];
+
+            if (!resource.is_used)
+                continue;
+
+            // Linear images have different alignment rules, don't bother and keep them dedicated
+            if (is_texture && (resource.properties.texture.misc_flags & GPUTextureMisc::LinearTiling))
+                continue;
+
+            const VkMemoryRequirements requirements =
+                is_texture ? get_image_memory_requirements(backend.device, resource.properties.texture)
+                           : get_buffer_memory_requirements(backend.device, resource.properties.buffer);
+
+            // Leave this one out if it would make the heap impossible to allocate
+            if ((memory_type_bits & requirements.memoryTypeBits) == 0)
+                continue;
+
+            memory_type_bits &= requirements.memoryTypeBits;
+            heap_alignment = std::max<u64>(heap_alignment, requirements.alignment);
+
+            transient_resources.push_back(TransientResource{
+                .resource_handle = ResourceHandle{.index = index, .is_texture = is_texture},
+                .size_bytes = requirements.size,
+                .alignment = requirements.alignment,
+                .lifetime = lifetimes[index],
+            });
+        }
+
+        compute_transient_heap_layout(transient_resources, layout);
+
+        if (transient_resources.empty())
+            return;
+
+        const bool is_heap_compatible = heap.allocation != VK_NULL_HANDLE && heap.size_bytes >= layout.heap_size_bytes
+                                        && (memory_type_bits & bit(heap.memory_type_index)) != 0;
+
+        if (!is_heap_compatible)
+        {
+            // Frames in flight might still be using the old heap. Growing is rare enough to stall for it.
+            AssertVk(vkDeviceWaitIdle(backend.device));
+
+            std::vector<u32> evicted_entries;
+            resource_pool_evict_placed(resources.pool, is_texture, evicted_entries);
+
+            for (u32 entry_index : evicted_entries)
+            {
+                destroy_pooled_resource(backend, resources.pooled_resources[entry_index]);
+            }
+
+            destroy_transient_heap(backend, heap);
+
+            const VkMemoryRequirements heap_requirements = {
+                .size = layout.heap_size_bytes,
+                .alignment = heap_alignment,
+                .memoryTypeBits = memory_type_bits,
+            };
+
+            VmaAllocationCreateInfo allocation_create_info = {};
+            allocation_create_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+            VmaAllocationInfo allocation_info;
+            AssertVk(vmaAllocateMemory(backend.vma_instance, &heap_requirements, &allocation_create_info,
+                                       &heap.allocation, &allocation_info));
+
+            heap.size_bytes = layout.heap_size_bytes;
+            heap.memory_type_index = allocation_info.memoryType;
+        }
+
+        for (u32 i = 0; i < transient_resources.size(); i++)
+        {
+            placements[transient_resources[i].resource_handle.index] = layout.offsets[i];
+        }
+
+        resources.aliases.insert(resources.aliases.end(), layout.aliases.begin(), layout.aliases.end());
     }
 } // namespace
 
@@ -40,13 +225,29 @@ FrameGraphResources create_framegraph_resources(VulkanBackend& backend)
         AssertVk(vkCreateEvent(backend.device, &event_info, nullptr, &event));
     }
 
+    resources.queue_family_indices[FrameGraph::QueueType::Graphics] =
+        backend.physical_device.graphics_queue_family_index;
+    resources.queue_family_indices[FrameGraph::QueueType::AsyncCompute] =
+        backend.physical_device.compute_queue_family_index;
+
+    resources.pool = FrameGraph::create_resource_pool(FrameGraphResourcePoolMaxUnusedFrames);
+
     // Volatile stuff is created later
     return resources;
 }
 
 void destroy_framegraph_resources(VulkanBackend& backend, FrameGraphResources& resources)
 {
-    destroy_framegraph_volatile_resources(backend, resources);
+    std::vector<u32> evicted_entries;
+    FrameGraph::resource_pool_clear(resources.pool, evicted_entries);
+
+    for (u32 entry_index : evicted_entries)
+    {
+        destroy_pooled_resource(backend, resources.pooled_resources[entry_index]);
+    }
+
+    destroy_transient_heap(backend, resources.texture_heap);
+    destroy_transient_heap(backend, resources.buffer_heap);
 
     for (auto& event : resources.events)
     {
@@ -55,26 +256,68 @@ void destroy_framegraph_resources(VulkanBackend& backend, FrameGraphResources& r
 }
 
 void allocate_framegraph_volatile_resources(VulkanBackend& backend, FrameGraphResources& resources,
-                                            const FrameGraph::FrameGraph& framegraph)
+                                            const FrameGraph::FrameGraph&         framegraph,
+                                            const FrameGraph::FrameGraphSchedule& schedule)
 {
     REAPER_PROFILE_SCOPE_FUNC();
 
-    destroy_framegraph_volatile_resources(backend, resources); // FIXME Reuse previous resources here instead
-    swap_resources(resources);
-
     using namespace FrameGraph;
 
+    // NOTE: Frames in flight start on the GPU only once the previous one is done, so reusing pooled resources right
+    // away is safe. Evictions are delayed past the frames in flight, and growing a transient heap waits for the GPU.
+    std::vector<u64> texture_placements;
+    std::vector<u64> buffer_placements;
+
+    resources.texture_heap_layout = {};
+    resources.buffer_heap_layout = {};
+    resources.aliases.clear();
+
+    if (backend.options.enable_framegraph_memory_aliasing)
+    {
+        std::vector<ResourceLifetime> texture_lifetimes;
+        std::vector<ResourceLifetime> buffer_lifetimes;
+
+        compute_resource_lifetimes(framegraph, schedule, texture_lifetimes, buffer_lifetimes);
+
+        texture_placements.assign(framegraph.TextureResources.size(), DedicatedPlacement);
+        buffer_placements.assign(framegraph.BufferResources.size(), DedicatedPlacement);
+
+        place_transient_resources(backend, resources, framegraph, true, texture_lifetimes, texture_placements);
+        place_transient_resources(backend, resources, framegraph, false, buffer_lifetimes, buffer_placements);
+    }
+
+    ResourcePoolFrameAllocation& allocation = resources.pool_allocation;
+    resource_pool_acquire(resources.pool, framegraph, backend.frame_index, texture_placements, buffer_placements,
+                          allocation);
+
+    resources.pooled_resources.resize(resources.pool.entries.size());
+
+    for (u32 entry_index : allocation.evicted_entries)
+    {
+        destroy_pooled_resource(backend, resources.pooled_resources[entry_index]);
+    }
+
     // Create buffers
     resources.buffers.resize(framegraph.BufferResources.size());
 
     for (u32 index = 0; index < framegraph.BufferResources.size(); index++)
     {
         const Resource& resource = framegraph.BufferResources[index];
+        const u32       entry_index = allocation.buffer_entries[index];
 
         if (resource.is_used)
         {
-            resources.buffers[index] =
-                create_buffer(backend.device, resource.debug_name, resource.properties.buffer, backend.vma_instance);
+            Assert(entry_index != InvalidResourcePoolEntry);
+            FrameGraphPooledResource& pooled_resource = resources.pooled_resources[entry_index];
+
+            // Freshly created entries are still empty here
+            if (pooled_resource.buffer.handle == VK_NULL_HANDLE)
+            {
+                create_pooled_resource(backend, resources, pooled_resource, resource, false,
+                                       resources.pool.entries[entry_index].placement_offset);
+            }
+
+            resources.buffers[index] = pooled_resource.buffer;
         }
         else
         {
@@ -89,15 +332,22 @@ void allocate_framegraph_volatile_resources(VulkanBackend& backend, FrameGraphRe
     for (u32 index = 0; index < framegraph.TextureResources.size(); index++)
     {
         const Resource& resource = framegraph.TextureResources[index];
+        const u32       entry_index = allocation.texture_entries[index];
 
         if (resource.is_used)
         {
-            GPUTexture& new_texture = resources.textures[index];
-            new_texture =
-                create_image(backend.device, resource.debug_name, resource.properties.texture, backend.vma_instance);
+            Assert(entry_index != InvalidResourcePoolEntry);
+            FrameGraphPooledResource& pooled_resource = resources.pooled_resources[entry_index];
+
+            // Freshly created entries are still empty here
+            if (pooled_resource.texture.handle == VK_NULL_HANDLE)
+            {
+                create_pooled_resource(backend, resources, pooled_resource, resource, true,
+                                       resources.pool.entries[entry_index].placement_offset);
+            }
 
-            resources.default_texture_views[index] =
-                create_image_view(backend.device, new_texture.handle, resource.default_view.texture);
+            resources.textures[index] = pooled_resource.texture;
+            resources.default_texture_views[index] = pooled_resource.default_view_handle;
         }
         else
         {
@@ -106,7 +356,7 @@ void allocate_framegraph_volatile_resources(VulkanBackend& backend, FrameGraphRe
         }
     }
 
-    // Create additional texture views
+    // Gather additional texture views
     resources.additional_texture_views.resize(framegraph.TextureViews.size());
 
     for (u32 index = 0; index < framegraph.ResourceUsages.size(); index++)
@@ -123,11 +373,12 @@ void allocate_framegraph_volatile_resources(VulkanBackend& backend, FrameGraphRe
 
         if (resource_handle.is_texture && usage.is_used)
         {
-            const GPUTexture& texture = resources.textures[usage.resource_handle.index];
+            const u32                 entry_index = allocation.texture_entries[resource_handle.index];
+            FrameGraphPooledResource& pooled_resource = resources.pooled_resources[entry_index];
 
             for (u32 i = 0; i < texture_views.size(); i++)
             {
-                texture_views[i] = create_image_view(backend.device, texture.handle, texture_views_info[i]);
+                texture_views[i] = get_or_create_pooled_texture_view(backend, pooled_resource, texture_views_info[i]);
             }
         }
         else
@@ -140,33 +391,6 @@ void allocate_framegraph_volatile_resources(VulkanBackend& backend, FrameGraphRe
     }
 }
 
-void destroy_framegraph_volatile_resources(VulkanBackend& backend, FrameGraphResources& resources)
-{
-    for (GPUBuffer& buffer : resources.buffers)
-    {
-        vmaDestroyBuffer(backend.vma_instance, buffer.handle, buffer.allocation);
-        buffer = {};
-    }
-
-    for (GPUTexture& texture : resources.textures)
-    {
-        vmaDestroyImage(backend.vma_instance, texture.handle, texture.allocation);
-        texture = {};
-    }
-
-    for (VkImageView& view : resources.default_texture_views)
-    {
-        vkDestroyImageView(backend.device, view, nullptr);
-        view = VK_NULL_HANDLE;
-    }
-
-    for (VkImageView& view : resources.additional_texture_views)
-    {
-        vkDestroyImageView(backend.device, view, nullptr);
-        view = VK_NULL_HANDLE;
-    }
-}
-
 VkImage get_frame_graph_texture_handle(const FrameGraphResources& resources, FrameGraph::ResourceHandle resource_handle)
 {
     Assert(resource_handle.is_texture, "Wrong handle");
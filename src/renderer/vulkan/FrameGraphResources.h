@@ -8,8 +8,12 @@
 #pragma once
 
 #include "Buffer.h"
+#include "FrameSync.h"
 #include "Image.h"
+#include "renderer/graph/CompileCache.h"
 #include "renderer/graph/FrameGraph.h"
+#include "renderer/graph/MemoryAliasing.h"
+#include "renderer/graph/ResourcePool.h"
 
 #include <array>
 #include <vector>
@@ -18,6 +22,36 @@ namespace Reaper
 {
 struct VulkanBackend;
 
+// Pooled resources are destroyed after being unused for that many frames
+static constexpr u32 FrameGraphResourcePoolMaxUnusedFrames = 8;
+
+static_assert(FrameGraphResourcePoolMaxUnusedFrames > MaxFramesInFlight,
+              "Evicted resources could still be in use by a frame in flight");
+
+struct FrameGraphPooledTextureView
+{
+    GPUTextureView view;
+    VkImageView    handle;
+};
+
+// Backend objects backing an entry of the resource pool
+struct FrameGraphPooledResource
+{
+    GPUBuffer buffer;
+
+    GPUTexture                               texture;
+    VkImageView                              default_view_handle;
+    std::vector<FrameGraphPooledTextureView> additional_views;
+};
+
+// Memory shared by transient resources that are never alive at the same time
+struct FrameGraphTransientHeap
+{
+    VmaAllocation allocation;
+    u64           size_bytes;
+    u32           memory_type_index;
+};
+
 struct FrameGraphTexture
 {
     GPUTextureProperties properties;
@@ -45,25 +79,44 @@ struct FrameGraphResources
     // For the first implem we can just have as many events as barriers.
     std::array<VkEvent, EventCount> events;
 
+    // Indexed by queue type, used for ownership transfers between queues
+    std::array<u32, FrameGraph::QueueType::Count> queue_family_indices;
+
+    // Result of the last frame graph compilation, the schedule used every frame lives here
+    FrameGraph::CompileCache compile_cache;
+
+    // Indexed by pool entry
+    FrameGraph::ResourcePool              pool;
+    std::vector<FrameGraphPooledResource> pooled_resources;
+
+    // Images and buffers don't share heaps, that way we don't have to care about bufferImageGranularity
+    FrameGraphTransientHeap texture_heap;
+    FrameGraphTransientHeap buffer_heap;
+
     // Volatile
-    std::vector<GPUBuffer> buffers;
+    FrameGraph::TransientHeapLayout        texture_heap_layout;
+    FrameGraph::TransientHeapLayout        buffer_heap_layout;
+    std::vector<FrameGraph::ResourceAlias> aliases;
 
-    std::vector<GPUTexture> textures;
-    std::vector<GPUTexture> textures_b;
+    // Indexed by frame graph handles, these don't own anything and point to pooled resources.
+    FrameGraph::ResourcePoolFrameAllocation pool_allocation;
 
-    std::vector<VkImageView> default_texture_views;
-    std::vector<VkImageView> default_texture_views_b;
+    std::vector<GPUBuffer> buffers;
 
+    std::vector<GPUTexture>  textures;
+    std::vector<VkImageView> default_texture_views;
     std::vector<VkImageView> additional_texture_views;
-    std::vector<VkImageView> additional_texture_views_b;
 };
 
 FrameGraphResources create_framegraph_resources(VulkanBackend& backend);
 void                destroy_framegraph_resources(VulkanBackend& backend, FrameGraphResources& resources);
 
+// Resources are taken from the pool when possible, only new ones are created.
+// When memory aliasing is enabled, the schedule order is used to place resources in the transient heaps.
+// The resulting aliases need to be given to the barrier placement afterwards.
 void allocate_framegraph_volatile_resources(VulkanBackend& backend, FrameGraphResources& resources,
-                                            const FrameGraph::FrameGraph& framegraph);
-void destroy_framegraph_volatile_resources(VulkanBackend& backend, FrameGraphResources& resources);
+                                            const FrameGraph::FrameGraph&         framegraph,
+                                            const FrameGraph::FrameGraphSchedule& schedule);
 
 VkImage           get_frame_graph_texture_handle(const FrameGraphResources& resources,
                                                  FrameGraph::ResourceHandle resource_handle);
@@ -37,11 +37,32 @@ FrameSyncResources create_frame_sync_resources(VulkanBackend& backend)
 
     resources.timeline_semaphore = timeline_semaphore;
 
+    const std::array<const char*, FrameGraph::QueueType::Count> queue_semaphore_names = {
+        "Graphics queue timeline semaphore",
+        "Async compute queue timeline semaphore",
+    };
+
+    for (u32 queue_type = 0; queue_type < FrameGraph::QueueType::Count; queue_type++)
+    {
+        VkSemaphore& queue_semaphore = resources.queue_timeline_semaphores[queue_type];
+
+        AssertVk(vkCreateSemaphore(backend.device, &timeline_semaphore_create_info, nullptr, &queue_semaphore));
+
+        VulkanSetDebugName(backend.device, queue_semaphore, queue_semaphore_names[queue_type]);
+
+        resources.queue_timeline_values[queue_type] = 0;
+    }
+
     return resources;
 }
 
 void destroy_frame_sync_resources(VulkanBackend& backend, const FrameSyncResources& resources)
 {
     vkDestroySemaphore(backend.device, resources.timeline_semaphore, nullptr);
+
+    for (VkSemaphore queue_semaphore : resources.queue_timeline_semaphores)
+    {
+        vkDestroySemaphore(backend.device, queue_semaphore, nullptr);
+    }
 }
 } // namespace Reaper
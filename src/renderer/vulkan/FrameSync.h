@@ -7,13 +7,24 @@
 
 #pragma once
 
+#include "renderer/graph/FrameGraphBasicTypes.h"
+
 #include <vulkan_loader/Vulkan.h>
 
+#include <array>
+
 namespace Reaper
 {
+// The CPU can record up to that many frames ahead of the GPU, see Backend::Options::frames_in_flight.
+static constexpr u32 MaxFramesInFlight = 3;
+
 struct FrameSyncResources
 {
-    VkSemaphore timeline_semaphore;
+    VkSemaphore timeline_semaphore; // Signaled with the frame index once the GPU is done with a frame
+
+    // Signaled after each submit batch of the frame graph, values keep increasing across frames.
+    std::array<VkSemaphore, FrameGraph::QueueType::Count> queue_timeline_semaphores;
+    std::array<u64, FrameGraph::QueueType::Count>         queue_timeline_values;
 };
 
 struct VulkanBackend;
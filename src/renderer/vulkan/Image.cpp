@@ -344,6 +344,36 @@ namespace
         AssertUnreachable();
         return VK_IMAGE_VIEW_TYPE_1D;
     }
+
+    VkImageCreateInfo get_vk_image_create_info(const GPUTextureProperties& properties)
+    {
+        const VkExtent3D extent = {properties.width, properties.height, properties.depth};
+
+        const bool has_linear_tiling = properties.misc_flags & GPUTextureMisc::LinearTiling;
+
+        Assert(!((properties.height > 1 || properties.depth > 1) && properties.type == GPUTextureType::Tex1D));
+        Assert(!(properties.depth > 1 && properties.type == GPUTextureType::Tex2D));
+
+        const VkImageTiling tiling_mode = has_linear_tiling ? VK_IMAGE_TILING_LINEAR : VK_IMAGE_TILING_OPTIMAL;
+
+        return VkImageCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = GetVulkanCreateFlags(properties),
+            .imageType = texture_type_to_vulkan_image_type(properties.type),
+            .format = PixelFormatToVulkan(properties.format),
+            .extent = extent,
+            .mipLevels = properties.mip_count,
+            .arrayLayers = properties.layer_count,
+            .samples = SampleCountToVulkan(properties.sample_count),
+            .tiling = tiling_mode,
+            .usage = GetVulkanUsageFlags(properties.usage_flags),
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            .queueFamilyIndexCount = 0,
+            .pQueueFamilyIndices = nullptr,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        };
+    }
 } // namespace
 
 VkFormat PixelFormatToVulkan(PixelFormat format)
@@ -723,32 +753,7 @@ VkImageSubresourceLayers get_vk_image_subresource_layers(const GPUTextureSubreso
 GPUTexture create_image(VkDevice device, const char* debug_string, const GPUTextureProperties& properties,
                         VmaAllocator& allocator)
 {
-    const VkExtent3D extent = {properties.width, properties.height, properties.depth};
-
-    const bool has_linear_tiling = properties.misc_flags & GPUTextureMisc::LinearTiling;
-
-    Assert(!((properties.height > 1 || properties.depth > 1) && properties.type == GPUTextureType::Tex1D));
-    Assert(!(properties.depth > 1 && properties.type == GPUTextureType::Tex2D));
-
-    const VkImageTiling tiling_mode = has_linear_tiling ? VK_IMAGE_TILING_LINEAR : VK_IMAGE_TILING_OPTIMAL;
-
-    const VkImageCreateInfo imageInfo = {
-        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
-        .pNext = nullptr,
-        .flags = GetVulkanCreateFlags(properties),
-        .imageType = texture_type_to_vulkan_image_type(properties.type),
-        .format = PixelFormatToVulkan(properties.format),
-        .extent = extent,
-        .mipLevels = properties.mip_count,
-        .arrayLayers = properties.layer_count,
-        .samples = SampleCountToVulkan(properties.sample_count),
-        .tiling = tiling_mode,
-        .usage = GetVulkanUsageFlags(properties.usage_flags),
-        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-        .queueFamilyIndexCount = 0,
-        .pQueueFamilyIndices = nullptr,
-        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-    };
+    const VkImageCreateInfo imageInfo = get_vk_image_create_info(properties);
 
     VmaAllocationCreateInfo allocInfo = {};
     allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
@@ -765,6 +770,45 @@ GPUTexture create_image(VkDevice device, const char* debug_string, const GPUText
     };
 }
 
+GPUTexture create_image_placed(VkDevice device, const char* debug_string, const GPUTextureProperties& properties,
+                               VmaAllocator& allocator, VmaAllocation heap_allocation, u64 offset_bytes)
+{
+    const VkImageCreateInfo imageInfo = get_vk_image_create_info(properties);
+
+    VkImage image;
+    AssertVk(vmaCreateAliasingImage2(allocator, heap_allocation, offset_bytes, &imageInfo, &image));
+
+    VulkanSetDebugName(device, image, debug_string);
+
+    // The memory belongs to the heap, don't free it with the image
+    return GPUTexture{
+        .handle = image,
+        .allocation = VK_NULL_HANDLE,
+    };
+}
+
+VkMemoryRequirements get_image_memory_requirements(VkDevice device, const GPUTextureProperties& properties)
+{
+    const VkImageCreateInfo imageInfo = get_vk_image_create_info(properties);
+
+    const VkDeviceImageMemoryRequirements requirements_info = {
+        .sType = VK_STRUCTURE_TYPE_DEVICE_IMAGE_MEMORY_REQUIREMENTS,
+        .pNext = nullptr,
+        .pCreateInfo = &imageInfo,
+        .planeAspect = VK_IMAGE_ASPECT_NONE,
+    };
+
+    VkMemoryRequirements2 requirements = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2,
+        .pNext = nullptr,
+        .memoryRequirements = {},
+    };
+
+    vkGetDeviceImageMemoryRequirements(device, &requirements_info, &requirements);
+
+    return requirements.memoryRequirements;
+}
+
 VkImageView create_image_view(VkDevice device, VkImage image, const GPUTextureView& view)
 {
     Assert(view.subresource.mip_count > 0);
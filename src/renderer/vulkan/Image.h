@@ -39,6 +39,12 @@ GPUTexture  create_image(VkDevice device, const char* debug_string, const GPUTex
                          VmaAllocator& allocator);
 VkImageView create_image_view(VkDevice device, VkImage image, const GPUTextureView& view);
 
+// Binds the image at an offset of an existing allocation, the image doesn't own any memory.
+GPUTexture create_image_placed(VkDevice device, const char* debug_string, const GPUTextureProperties& properties,
+                               VmaAllocator& allocator, VmaAllocation heap_allocation, u64 offset_bytes);
+
+VkMemoryRequirements get_image_memory_requirements(VkDevice device, const GPUTextureProperties& properties);
+
 struct ReaperRoot;
 
 void print_properties_debug(ReaperRoot& root, const GPUTextureProperties& properties);
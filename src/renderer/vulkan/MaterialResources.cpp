@@ -18,27 +18,127 @@
 
 #include <core/Assert.h>
 #include <core/Literals.h>
+#include <core/jobs/JobSystem.h>
+#include <profiling/Scope.h>
 
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
 #include <span>
 
+#include "renderer/shader/mesh_instance.share.hlsl"
+
 namespace Reaper
 {
 namespace
 {
-    void flush_pending_staging_commands(CommandBuffer& cmdBuffer, const ResourceStagingArea& staging,
-                                        const StagingEntry& entry)
+    constexpr u64 StagingRingSizeBytes = 128_MiB;
+    constexpr u64 UploadBudgetBytesPerFrame = 32_MiB;
+
+    // Buffer offsets of copies to images have to be a multiple of the texel block size
+    constexpr u64 StagingAlignment = 16;
+
+    // Top mips stay around for a bit after they're last sampled, so a quick look back doesn't stream them again
+    constexpr u64 TextureEvictionDelayFrames = 120;
+
+    constexpr u64 TextureFeedbackSizeBytes = MaterialTextureMaxCount * sizeof(u32);
+
+    const GPUTextureAccess TextureShaderReadAccess = {VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT
+                                                          | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                                                      VK_ACCESS_2_SHADER_READ_BIT, VK_IMAGE_LAYOUT_READ_ONLY_OPTIMAL};
+
+    const GPUTextureAccess TextureTransferDstAccess = {VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                                                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL};
+
+    GPUTextureProperties get_image_properties(const GPUTextureProperties& properties, u32 image_mip_offset)
     {
-        const GPUTextureAccess src = {VK_PIPELINE_STAGE_2_HOST_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_UNDEFINED};
-        const GPUTextureAccess dst = {VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
-                                      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL};
+        GPUTextureProperties image_properties = properties;
+        image_properties.width = std::max(properties.width >> image_mip_offset, 1u);
+        image_properties.height = std::max(properties.height >> image_mip_offset, 1u);
+        image_properties.depth = std::max(properties.depth >> image_mip_offset, 1u);
+        image_properties.mip_count = properties.mip_count - image_mip_offset;
+
+        return image_properties;
+    }
+
+    void record_image_swap(CommandBuffer& cmdBuffer, const TextureImageSwap& swap)
+    {
+        std::vector<VkImageMemoryBarrier2> barriers;
+
+        // Mips that don't get copied wait in the transfer layout for their staging copies
+        const GPUTextureAccess undefined_access = {VK_PIPELINE_STAGE_2_HOST_BIT, VK_ACCESS_2_NONE,
+                                                   VK_IMAGE_LAYOUT_UNDEFINED};
+
+        barriers.push_back(get_vk_image_barrier(swap.dst, default_texture_subresource(swap.dst_properties),
+                                                undefined_access, TextureTransferDstAccess));
+
+        if (swap.copy_mip_count == 0)
+        {
+            const VkDependencyInfo dependencies = get_vk_image_barrier_depency_info(barriers);
+
+            vkCmdPipelineBarrier2(cmdBuffer.handle, &dependencies);
+            return;
+        }
+
+        Assert(swap.src != VK_NULL_HANDLE);
+
+        GPUTextureSubresource src_subresource = default_texture_subresource(swap.dst_properties);
+        src_subresource.mip_offset = swap.src_mip_offset;
+        src_subresource.mip_count = swap.copy_mip_count;
+
+        const GPUTextureAccess transfer_src_access = {VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT,
+                                                      VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL};
 
-        const GPUTextureSubresource default_subresource = default_texture_subresource(entry.texture_properties);
-        const VkImageMemoryBarrier2 barrier = get_vk_image_barrier(entry.target, default_subresource, src, dst);
+        // The old image is retired after this frame, it doesn't need to go back to the read-only layout
+        barriers.push_back(
+            get_vk_image_barrier(swap.src, src_subresource, TextureShaderReadAccess, transfer_src_access));
 
-        const VkDependencyInfo dependencies = get_vk_image_barrier_depency_info(std::span(&barrier, 1));
+        const VkDependencyInfo dependencies = get_vk_image_barrier_depency_info(barriers);
 
         vkCmdPipelineBarrier2(cmdBuffer.handle, &dependencies);
 
+        std::vector<VkImageCopy2> regions;
+
+        for (u32 i = 0; i < swap.copy_mip_count; i++)
+        {
+            const u32 dst_mip_index = swap.dst_mip_offset + i;
+
+            regions.push_back(VkImageCopy2{
+                .sType = VK_STRUCTURE_TYPE_IMAGE_COPY_2,
+                .pNext = nullptr,
+                .srcSubresource = get_vk_image_subresource_layers(
+                    default_texture_subresource_one_color_mip(swap.src_mip_offset + i, 0)),
+                .srcOffset = {.x = 0, .y = 0, .z = 0},
+                .dstSubresource =
+                    get_vk_image_subresource_layers(default_texture_subresource_one_color_mip(dst_mip_index, 0)),
+                .dstOffset = {.x = 0, .y = 0, .z = 0},
+                .extent =
+                    {
+                        .width = std::max(swap.dst_properties.width >> dst_mip_index, 1u),
+                        .height = std::max(swap.dst_properties.height >> dst_mip_index, 1u),
+                        .depth = std::max(swap.dst_properties.depth >> dst_mip_index, 1u),
+                    },
+            });
+        }
+
+        const VkCopyImageInfo2 copy = {
+            .sType = VK_STRUCTURE_TYPE_COPY_IMAGE_INFO_2,
+            .pNext = nullptr,
+            .srcImage = swap.src,
+            .srcImageLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            .dstImage = swap.dst,
+            .dstImageLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .regionCount = static_cast<u32>(regions.size()),
+            .pRegions = regions.data(),
+        };
+
+        vkCmdCopyImage2(cmdBuffer.handle, &copy);
+    }
+
+    void flush_pending_staging_commands(CommandBuffer& cmdBuffer, const ResourceStagingArea& staging,
+                                        const StagingEntry& entry)
+    {
         std::span<const VkBufferImageCopy2> copy_regions(&staging.bufferCopyRegions[entry.copy_command_offset],
                                                          entry.copy_command_count);
 
@@ -58,65 +158,352 @@ namespace
 
     void flush_staging_area_state(ResourceStagingArea& staging)
     {
-        staging.offset_bytes = 0;
         staging.bufferCopyRegions.clear();
+        staging.image_swaps.clear();
         staging.staging_queue.clear();
     }
 
-    TextureResource create_texture_resource(VulkanBackend& backend, MaterialResources& resources,
-                                            const char* debug_name, StagingEntry& staging_entry)
+    void record_texture_feedback_readback(CommandBuffer& cmdBuffer, TextureFeedback& feedback, u64 frame_index)
+    {
+        REAPER_GPU_SCOPE(cmdBuffer, "Texture Feedback");
+
+        {
+            const GPUMemoryAccess src = {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT};
+            const GPUMemoryAccess dst = {VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                                         VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT};
+
+            const VkMemoryBarrier2 barrier = get_vk_memory_barrier(src, dst);
+            const VkDependencyInfo dependencies = get_vk_memory_barrier_depency_info(std::span(&barrier, 1));
+
+            vkCmdPipelineBarrier2(cmdBuffer.handle, &dependencies);
+        }
+
+        // Nothing to read back before the first clear
+        if (feedback.is_cleared)
+        {
+            const u32 readback_index = static_cast<u32>(frame_index % MaxFramesInFlight);
+
+            const VkBufferCopy2 region = {
+                .sType = VK_STRUCTURE_TYPE_BUFFER_COPY_2,
+                .pNext = nullptr,
+                .srcOffset = 0,
+                .dstOffset = 0,
+                .size = TextureFeedbackSizeBytes,
+            };
+
+            const VkCopyBufferInfo2 copy = {
+                .sType = VK_STRUCTURE_TYPE_COPY_BUFFER_INFO_2,
+                .pNext = nullptr,
+                .srcBuffer = feedback.buffer.handle,
+                .dstBuffer = feedback.readback_buffers[readback_index].handle,
+                .regionCount = 1,
+                .pRegions = &region,
+            };
+
+            vkCmdCopyBuffer2(cmdBuffer.handle, &copy);
+
+            feedback.readback_frame_indices[readback_index] = frame_index;
+        }
+
+        vkCmdFillBuffer(cmdBuffer.handle, feedback.buffer.handle, 0, TextureFeedbackSizeBytes,
+                        TextureFeedbackNotSampled);
+
+        {
+            const GPUMemoryAccess src = {VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT};
+            const GPUMemoryAccess dst = {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_HOST_BIT,
+                                         VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT
+                                             | VK_ACCESS_2_HOST_READ_BIT};
+
+            const VkMemoryBarrier2 barrier = get_vk_memory_barrier(src, dst);
+            const VkDependencyInfo dependencies = get_vk_memory_barrier_depency_info(std::span(&barrier, 1));
+
+            vkCmdPipelineBarrier2(cmdBuffer.handle, &dependencies);
+        }
+
+        feedback.is_cleared = true;
+    }
+
+    VkImageView create_resident_mips_view(VulkanBackend& backend, const TextureResource& texture_resource)
+    {
+        const GPUTextureProperties image_properties =
+            get_image_properties(texture_resource.properties, texture_resource.image_mip_offset);
+
+        GPUTextureView view = default_texture_view(image_properties);
+        view.subresource.mip_offset = texture_resource.resident_mip_offset - texture_resource.image_mip_offset;
+        view.subresource.mip_count = texture_resource.properties.mip_count - texture_resource.resident_mip_offset;
+
+        return create_image_view(backend.device, texture_resource.texture.handle, view);
+    }
+
+    bool has_resident_mips(const TextureResource& texture_resource)
+    {
+        return texture_resource.resident_mip_offset < texture_resource.properties.mip_count;
+    }
+
+    void push_staging_copy(ResourceStagingArea& staging, const DecodedTextureMip& mip, u32 image_mip_offset,
+                           u64 staging_offset_bytes)
+    {
+        const GPUTextureSubresource subresource =
+            default_texture_subresource_one_color_mip(mip.mip_index - image_mip_offset, mip.layer_index);
+
+        // Setup a buffer image copy structure for the current mip level
+        staging.bufferCopyRegions.emplace_back(VkBufferImageCopy2{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_IMAGE_COPY_2,
+            .pNext = nullptr,
+            .bufferOffset = staging_offset_bytes,
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource = get_vk_image_subresource_layers(subresource),
+            .imageOffset = {.x = 0, .y = 0, .z = 0},
+            .imageExtent = {.width = mip.width, .height = mip.height, .depth = mip.depth}});
+    }
+
+    // Mips from mip_begin to mip_end, the tail first
+    void queue_texture_streaming_request(MaterialResources& resources, u32 texture_index, u32 mip_begin, u32 mip_end)
+    {
+        TextureStreamingRequest request = {
+            .texture_index = texture_index,
+            .mips = {},
+            .uploaded_mip_count = 0,
+        };
+
+        for (const DecodedTextureMip& mip : resources.textures[texture_index].source.mips)
+        {
+            if (mip.mip_index >= mip_begin && mip.mip_index < mip_end)
+                request.mips.push_back(mip);
+        }
+
+        resources.streaming_requests.push_back(std::move(request));
+    }
+
+    // Mid grey, shown by textures that don't have any resident mip yet
+    TextureResource create_fallback_texture(VulkanBackend& backend, ResourceStagingArea& staging)
     {
-        GPUTexture image_info =
-            create_image(backend.device, debug_name, staging_entry.texture_properties, backend.vma_instance);
+        const GPUTextureProperties properties = default_texture_properties(
+            1, 1, PixelFormat::R8G8B8A8_UNORM, GPUTextureUsage::TransferDst | GPUTextureUsage::Sampled);
 
-        staging_entry.target = image_info.handle;
-        resources.staging.staging_queue.push_back(staging_entry);
+        const GPUTexture texture = create_image(backend.device, "Fallback texture", properties, backend.vma_instance);
 
-        const GPUTextureView view = default_texture_view(staging_entry.texture_properties);
+        const std::array<u8, 4> texel = {0x80, 0x80, 0x80, 0xFF};
 
-        return {
-            .texture = image_info,
-            .default_view = create_image_view(backend.device, image_info.handle, view),
+        const DecodedTextureMip mip = {
+            .mip_index = 0,
+            .layer_index = 0,
+            .width = 1,
+            .height = 1,
+            .depth = 1,
+            .offset_bytes = 0,
+            .size_bytes = texel.size(),
         };
+
+        // The ring is empty at this point
+        const u64 staging_offset_bytes = ring_allocate(staging.staging_ring, mip.size_bytes, StagingAlignment);
+        Assert(staging_offset_bytes != InvalidRingOffset);
+
+        write_mapped_buffer_range(backend.vma_instance, staging.staging_view, staging_offset_bytes, texel.data(),
+                                  texel.size());
+
+        // Goes out with the first frame, before anything can sample it
+        staging.image_swaps.push_back(TextureImageSwap{
+            .src = VK_NULL_HANDLE,
+            .dst = texture.handle,
+            .dst_properties = properties,
+            .src_mip_offset = 0,
+            .dst_mip_offset = 0,
+            .copy_mip_count = 0,
+        });
+
+        staging.staging_queue.push_back(StagingEntry{
+            .copy_command_offset = static_cast<u32>(staging.bufferCopyRegions.size()),
+            .copy_command_count = 1,
+            .target = texture.handle,
+            .uploaded_subresource = default_texture_subresource(properties),
+        });
+
+        push_staging_copy(staging, mip, 0, staging_offset_bytes);
+
+        TextureResource fallback_texture = {
+            .texture = texture,
+            .default_view = VK_NULL_HANDLE,
+            .properties = properties,
+            .image_mip_offset = 0,
+            .resident_mip_offset = 0,
+            .residency = {},
+            .source = {},
+        };
+
+        fallback_texture.default_view = create_resident_mips_view(backend, fallback_texture);
+
+        return fallback_texture;
     }
 
-    TextureResource load_texture_to_staging_dds(VulkanBackend& backend, MaterialResources& resources,
-                                                const char* filename)
+    void queue_decoded_textures(VulkanBackend& backend, MaterialResources& resources,
+                                std::span<std::string> texture_filenames, HandleSpan<TextureHandle> handle_span,
+                                std::span<DecodedTexture> decoded_textures)
     {
-        StagingEntry staging_entry = copy_texture_to_staging_area_dds(backend, resources.staging, filename);
+        for (u32 i = 0; i < decoded_textures.size(); i++)
+        {
+            const TextureHandle   handle = TextureHandle(handle_span.offset + i);
+            DecodedTexture&       decoded_texture = decoded_textures[i];
+            GPUTextureProperties& properties = decoded_texture.properties;
+
+            // Residency is tracked per mip, layers can't be uploaded separately
+            Assert(properties.layer_count == 1);
+
+            for (const DecodedTextureMip& mip : decoded_texture.mips)
+            {
+                Assert(mip.size_bytes <= StagingRingSizeBytes,
+                       fmt::format("{}: mip {} doesn't fit in the staging ring", texture_filenames[i], mip.mip_index));
+            }
+
+            // Resident mips get copied over when the image is resized
+            properties.usage_flags |= GPUTextureUsage::TransferSrc;
+
+            const TextureResidency     residency = create_texture_residency(decoded_texture);
+            const u32                  image_mip_offset = residency.tail_mip_offset;
+            const GPUTextureProperties image_properties = get_image_properties(properties, image_mip_offset);
+
+            const GPUTexture texture =
+                create_image(backend.device, texture_filenames[i].c_str(), image_properties, backend.vma_instance);
+
+            resources.staging.image_swaps.push_back(TextureImageSwap{
+                .src = VK_NULL_HANDLE,
+                .dst = texture.handle,
+                .dst_properties = image_properties,
+                .src_mip_offset = 0,
+                .dst_mip_offset = 0,
+                .copy_mip_count = 0,
+            });
+
+            resources.textures[handle] = TextureResource{
+                .texture = texture,
+                .default_view = resources.fallback_texture.default_view,
+                .properties = properties,
+                .image_mip_offset = image_mip_offset,
+                .resident_mip_offset = properties.mip_count,
+                .residency = residency,
+                .source = std::move(decoded_texture),
+            };
+
+            // Only the mip tail to begin with, the feedback decides for the rest
+            queue_texture_streaming_request(resources, handle, image_mip_offset, properties.mip_count);
+        }
+    }
 
-        return create_texture_resource(backend, resources, filename, staging_entry);
+    // Copies what's resident to a new image, and streams in what's missing
+    void resize_texture_image(VulkanBackend& backend, MaterialResources& resources, u32 texture_index,
+                              u32 image_mip_offset)
+    {
+        TextureResource& texture_resource = resources.textures[texture_index];
+
+        Assert(texture_resource.resident_mip_offset == texture_resource.image_mip_offset);
+
+        const GPUTextureProperties image_properties =
+            get_image_properties(texture_resource.properties, image_mip_offset);
+        const GPUTexture texture =
+            create_image(backend.device, "Streamed texture", image_properties, backend.vma_instance);
+
+        const u32 copy_mip_offset = std::max(image_mip_offset, texture_resource.image_mip_offset);
+
+        resources.staging.image_swaps.push_back(TextureImageSwap{
+            .src = texture_resource.texture.handle,
+            .dst = texture.handle,
+            .dst_properties = image_properties,
+            .src_mip_offset = copy_mip_offset - texture_resource.image_mip_offset,
+            .dst_mip_offset = copy_mip_offset - image_mip_offset,
+            .copy_mip_count = texture_resource.properties.mip_count - copy_mip_offset,
+        });
+
+        // Frames in flight might still sample the old image
+        resources.retired_textures.push_back(RetiredTexture{
+            .texture = texture_resource.texture,
+            .view = texture_resource.default_view,
+            .frame_index = backend.frame_index,
+        });
+
+        if (image_mip_offset < texture_resource.image_mip_offset)
+            queue_texture_streaming_request(resources, texture_index, image_mip_offset,
+                                            texture_resource.image_mip_offset);
+
+        texture_resource.texture = texture;
+        texture_resource.image_mip_offset = image_mip_offset;
+        texture_resource.resident_mip_offset = copy_mip_offset;
+        texture_resource.default_view = create_resident_mips_view(backend, texture_resource);
     }
 
-    TextureResource load_texture_to_staging_png(VulkanBackend& backend, MaterialResources& resources,
-                                                const char* filename, bool is_srgb)
+    template <typename DecodeFunction>
+    std::vector<DecodedTexture> decode_textures(std::span<std::string> texture_filenames, JobSystem* job_system,
+                                                DecodeFunction decode_function)
     {
-        StagingEntry staging_entry = copy_texture_to_staging_area_png(backend, resources.staging, filename, is_srgb);
+        std::vector<DecodedTexture> decoded_textures(texture_filenames.size());
+
+        const auto decode_job = [&](u32 index) { decoded_textures[index] = decode_function(index); };
 
-        return create_texture_resource(backend, resources, filename, staging_entry);
+        if (job_system != nullptr)
+        {
+            parallel_for(*job_system, static_cast<u32>(texture_filenames.size()), decode_job);
+        }
+        else
+        {
+            for (u32 i = 0; i < texture_filenames.size(); i++)
+                decode_job(i);
+        }
+
+        return decoded_textures;
     }
 } // namespace
 
 MaterialResources create_material_resources(VulkanBackend& backend)
 {
-    constexpr u32 StagingBufferSizeBytes = static_cast<u32>(512_MiB);
-
     const GPUBufferProperties properties =
-        DefaultGPUBufferProperties(StagingBufferSizeBytes, sizeof(u8), GPUBufferUsage::TransferSrc);
+        DefaultGPUBufferProperties(StagingRingSizeBytes, sizeof(u8), GPUBufferUsage::TransferSrc);
 
     GPUBuffer staging_buffer =
         create_buffer(backend.device, "Texture Staging Buffer", properties, backend.vma_instance, MemUsage::CPU_Only);
 
+    ResourceStagingArea staging = {
+        .staging_buffer = staging_buffer,
+        .staging_view = get_mapped_buffer_view(backend.vma_instance, staging_buffer),
+        .staging_ring = create_ring_allocator(StagingRingSizeBytes),
+        .bufferCopyRegions = {},
+        .image_swaps = {},
+        .staging_queue = {},
+    };
+
+    const TextureResource fallback_texture = create_fallback_texture(backend, staging);
+
+    const GPUBufferProperties feedback_properties =
+        DefaultGPUBufferProperties(MaterialTextureMaxCount, sizeof(u32),
+                                   GPUBufferUsage::StorageBuffer | GPUBufferUsage::TransferSrc
+                                       | GPUBufferUsage::TransferDst);
+    const GPUBufferProperties feedback_readback_properties =
+        DefaultGPUBufferProperties(MaterialTextureMaxCount, sizeof(u32), GPUBufferUsage::TransferDst);
+
+    TextureFeedback feedback = {
+        .buffer = create_buffer(backend.device, "Texture Feedback", feedback_properties, backend.vma_instance),
+        .readback_buffers = {},
+        .readback_views = {},
+        .readback_frame_indices = {},
+        .last_read_frame_index = 0,
+        .is_cleared = false,
+    };
+
+    for (u32 readback_index = 0; readback_index < MaxFramesInFlight; readback_index++)
+    {
+        feedback.readback_buffers[readback_index] =
+            create_buffer(backend.device, "Texture Feedback Readback", feedback_readback_properties,
+                          backend.vma_instance, MemUsage::GPU_To_CPU);
+        feedback.readback_views[readback_index] =
+            get_mapped_buffer_view(backend.vma_instance, feedback.readback_buffers[readback_index]);
+    }
+
     return MaterialResources{
-        .staging =
-            ResourceStagingArea{
-                .offset_bytes = 0,
-                .buffer_properties = properties,
-                .staging_buffer = staging_buffer,
-                .bufferCopyRegions = {},
-                .staging_queue = {},
-            },
+        .staging = std::move(staging),
         .textures = {},
+        .fallback_texture = fallback_texture,
+        .streaming_requests = {},
+        .retired_textures = {},
+        .feedback = feedback,
     };
 }
 
@@ -124,50 +511,240 @@ void destroy_material_resources(VulkanBackend& backend, MaterialResources& resou
 {
     for (const auto& texture : resources.textures)
     {
-        vkDestroyImageView(backend.device, texture.default_view, nullptr);
+        if (has_resident_mips(texture))
+            vkDestroyImageView(backend.device, texture.default_view, nullptr);
+
         vmaDestroyImage(backend.vma_instance, texture.texture.handle, texture.texture.allocation);
     }
     resources.textures.clear();
+    resources.streaming_requests.clear();
+
+    release_material_resources_memory(backend, resources, UINT64_MAX);
+
+    vkDestroyImageView(backend.device, resources.fallback_texture.default_view, nullptr);
+    vmaDestroyImage(backend.vma_instance, resources.fallback_texture.texture.handle,
+                    resources.fallback_texture.texture.allocation);
+
+    vmaDestroyBuffer(backend.vma_instance, resources.feedback.buffer.handle, resources.feedback.buffer.allocation);
+
+    for (const GPUBuffer& readback_buffer : resources.feedback.readback_buffers)
+        vmaDestroyBuffer(backend.vma_instance, readback_buffer.handle, readback_buffer.allocation);
 
     vmaDestroyBuffer(backend.vma_instance, resources.staging.staging_buffer.handle,
                      resources.staging.staging_buffer.allocation);
 }
 
 void load_dds_textures_to_staging(VulkanBackend& backend, MaterialResources& resources,
-                                  std::span<std::string> texture_filenames, HandleSpan<TextureHandle> handle_span)
+                                  std::span<std::string> texture_filenames, HandleSpan<TextureHandle> handle_span,
+                                  JobSystem* job_system)
 {
+    REAPER_PROFILE_SCOPE_FUNC();
+
     Assert(handle_span.count == texture_filenames.size());
 
-    for (u32 i = 0; i < texture_filenames.size(); i++)
-    {
-        const TextureHandle handle = TextureHandle(handle_span.offset + i);
+    std::vector<DecodedTexture> decoded_textures = decode_textures(
+        texture_filenames, job_system, [&](u32 index) { return decode_texture_dds(texture_filenames[index].c_str()); });
 
-        resources.textures[handle] = load_texture_to_staging_dds(backend, resources, texture_filenames[i].c_str());
-    }
+    queue_decoded_textures(backend, resources, texture_filenames, handle_span, decoded_textures);
 }
 
 void load_png_textures_to_staging(VulkanBackend& backend, MaterialResources& resources,
                                   std::span<std::string> texture_filenames, HandleSpan<TextureHandle> handle_span,
-                                  std::span<u32> is_srgb)
+                                  std::span<u32> is_srgb, JobSystem* job_system)
 {
+    REAPER_PROFILE_SCOPE_FUNC();
+
     Assert(handle_span.count == texture_filenames.size());
 
-    for (u32 i = 0; i < texture_filenames.size(); i++)
+    std::vector<DecodedTexture> decoded_textures = decode_textures(texture_filenames, job_system, [&](u32 index) {
+        return decode_texture_png(texture_filenames[index].c_str(), is_srgb[index] != 0);
+    });
+
+    queue_decoded_textures(backend, resources, texture_filenames, handle_span, decoded_textures);
+}
+
+void update_material_texture_residency(VulkanBackend& backend, MaterialResources& resources,
+                                       u64 completed_frame_index)
+{
+    REAPER_PROFILE_SCOPE_FUNC();
+
+    Assert(resources.textures.size() <= MaterialTextureMaxCount);
+
+    TextureFeedback& feedback = resources.feedback;
+
+    // Pick the newest copy done by a frame the GPU completed
+    u32 readback_index = MaxFramesInFlight;
+
+    for (u32 index = 0; index < MaxFramesInFlight; index++)
     {
-        const TextureHandle handle = TextureHandle(handle_span.offset + i);
+        const u64 readback_frame_index = feedback.readback_frame_indices[index];
 
-        resources.textures[handle] =
-            load_texture_to_staging_png(backend, resources, texture_filenames[i].c_str(), is_srgb[i] != 0);
+        if (readback_frame_index > feedback.last_read_frame_index && readback_frame_index <= completed_frame_index)
+        {
+            feedback.last_read_frame_index = readback_frame_index;
+            readback_index = index;
+        }
+    }
+
+    if (readback_index < MaxFramesInFlight)
+    {
+        const MappedBufferView& readback_view = feedback.readback_views[readback_index];
+
+        invalidate_mapped_buffer_range(backend.vma_instance, readback_view, 0, TextureFeedbackSizeBytes);
+
+        const u32* feedback_mips = reinterpret_cast<const u32*>(readback_view.data);
+
+        for (u32 texture_index = 0; texture_index < resources.textures.size(); texture_index++)
+        {
+            update_texture_residency_feedback(resources.textures[texture_index].residency, feedback_mips[texture_index],
+                                              backend.frame_index, TextureEvictionDelayFrames);
+        }
+    }
+
+    std::vector<TextureResidency> residencies;
+
+    for (const TextureResource& texture_resource : resources.textures)
+        residencies.push_back(texture_resource.residency);
+
+    const u64 budget_bytes = static_cast<u64>(backend.options.texture_vram_budget_mib) * 1_MiB;
+
+    compute_texture_residency_targets(residencies, budget_bytes);
+
+    for (u32 texture_index = 0; texture_index < resources.textures.size(); texture_index++)
+    {
+        TextureResource& texture_resource = resources.textures[texture_index];
+        const u32        target_mip_offset = residencies[texture_index].target_mip_offset;
+
+        texture_resource.residency.target_mip_offset = target_mip_offset;
+
+        // Still streaming
+        if (texture_resource.resident_mip_offset != texture_resource.image_mip_offset)
+            continue;
+
+        if (target_mip_offset != texture_resource.image_mip_offset)
+            resize_texture_image(backend, resources, texture_index, target_mip_offset);
     }
 }
 
-void record_material_upload_command_buffer(ResourceStagingArea& staging, CommandBuffer& cmdBuffer)
+void stream_material_textures(VulkanBackend& backend, MaterialResources& resources)
 {
-    if (staging.staging_queue.empty())
-        return;
+    REAPER_PROFILE_SCOPE_FUNC();
+
+    ResourceStagingArea& staging = resources.staging;
+
+    std::vector<TextureMipUpload> uploads;
+
+    schedule_texture_uploads(resources.streaming_requests, staging.staging_ring,
+                             TextureStreamingBudget{
+                                 .max_bytes_per_frame = UploadBudgetBytesPerFrame,
+                                 .staging_alignment = StagingAlignment,
+                             },
+                             uploads);
+
+    // Group the mips of each texture together so they share their barriers
+    std::ranges::stable_sort(uploads, [](const TextureMipUpload& a, const TextureMipUpload& b) {
+        return a.request_index < b.request_index;
+    });
+
+    for (u32 upload_index = 0; upload_index < uploads.size();)
+    {
+        const u32                      request_index = uploads[upload_index].request_index;
+        const TextureStreamingRequest& request = resources.streaming_requests[request_index];
+        TextureResource&               texture_resource = resources.textures[request.texture_index];
+        const DecodedTexture&          source = texture_resource.source;
+
+        StagingEntry staging_entry = {
+            .copy_command_offset = static_cast<u32>(staging.bufferCopyRegions.size()),
+            .copy_command_count = 0,
+            .target = texture_resource.texture.handle,
+            .uploaded_subresource = {},
+        };
+
+        u32 resident_mip_offset = texture_resource.resident_mip_offset;
+
+        for (; upload_index < uploads.size() && uploads[upload_index].request_index == request_index; upload_index++)
+        {
+            const TextureMipUpload&  upload = uploads[upload_index];
+            const DecodedTextureMip& mip = request.mips[upload.mip];
+
+            write_mapped_buffer_range(backend.vma_instance, staging.staging_view, upload.staging_offset_bytes,
+                                      source.data.data() + mip.offset_bytes, mip.size_bytes);
+
+            push_staging_copy(staging, mip, texture_resource.image_mip_offset, upload.staging_offset_bytes);
+
+            staging_entry.copy_command_count += 1;
+            resident_mip_offset = mip.mip_index;
+        }
+
+        staging_entry.uploaded_subresource = default_texture_subresource(texture_resource.properties);
+        staging_entry.uploaded_subresource.mip_offset = resident_mip_offset - texture_resource.image_mip_offset;
+        staging_entry.uploaded_subresource.mip_count = texture_resource.resident_mip_offset - resident_mip_offset;
+
+        staging.staging_queue.push_back(staging_entry);
+
+        // Descriptors written from now on see the new mips, frames in flight might still use the old view.
+        if (has_resident_mips(texture_resource))
+        {
+            resources.retired_textures.push_back(RetiredTexture{
+                .texture = {},
+                .view = texture_resource.default_view,
+                .frame_index = backend.frame_index,
+            });
+        }
+
+        texture_resource.resident_mip_offset = resident_mip_offset;
+        texture_resource.default_view = create_resident_mips_view(backend, texture_resource);
+    }
+
+    // Copies are recorded in the command buffer of this frame
+    ring_close_batch(staging.staging_ring, backend.frame_index);
+
+    std::erase_if(resources.streaming_requests, is_texture_streaming_request_done);
+}
+
+void release_material_resources_memory(VulkanBackend& backend, MaterialResources& resources,
+                                       u64 completed_frame_index)
+{
+    ring_release(resources.staging.staging_ring, completed_frame_index);
+
+    std::erase_if(resources.retired_textures, [&backend, completed_frame_index](const RetiredTexture& retired) {
+        if (retired.frame_index > completed_frame_index)
+            return false;
+
+        vkDestroyImageView(backend.device, retired.view, nullptr);
+
+        if (retired.texture.handle != VK_NULL_HANDLE)
+            vmaDestroyImage(backend.vma_instance, retired.texture.handle, retired.texture.allocation);
+
+        return true;
+    });
+}
+
+u32 get_texture_view_mip_offset(const TextureResource& texture_resource)
+{
+    // The 1x1 fallback texture stands in for the last mip
+    if (!has_resident_mips(texture_resource))
+        return texture_resource.properties.mip_count - 1;
+
+    return texture_resource.resident_mip_offset;
+}
+
+void record_material_upload_command_buffer(MaterialResources& resources, CommandBuffer& cmdBuffer, u64 frame_index)
+{
+    ResourceStagingArea& staging = resources.staging;
 
     REAPER_GPU_SCOPE(cmdBuffer, "Material Upload");
 
+    record_texture_feedback_readback(cmdBuffer, resources.feedback, frame_index);
+
+    if (staging.image_swaps.empty() && staging.staging_queue.empty())
+        return;
+
+    for (const auto& swap : staging.image_swaps)
+    {
+        record_image_swap(cmdBuffer, swap);
+    }
+
     for (const auto& entry : staging.staging_queue)
     {
         flush_pending_staging_commands(cmdBuffer, staging, entry);
@@ -178,18 +755,23 @@ void record_material_upload_command_buffer(ResourceStagingArea& staging, Command
 
         std::vector<VkImageMemoryBarrier2> prerender_barriers;
 
-        for (const auto& entry : staging.staging_queue)
+        for (const auto& swap : staging.image_swaps)
         {
-            const GPUTextureAccess src = {VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
-                                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL};
-            const GPUTextureAccess dst = {VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT
-                                              | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
-                                          VK_ACCESS_2_SHADER_READ_BIT, VK_IMAGE_LAYOUT_READ_ONLY_OPTIMAL};
+            if (swap.copy_mip_count == 0)
+                continue;
+
+            GPUTextureSubresource copied_subresource = default_texture_subresource(swap.dst_properties);
+            copied_subresource.mip_offset = swap.dst_mip_offset;
+            copied_subresource.mip_count = swap.copy_mip_count;
 
-            const GPUTextureSubresource default_subresource = default_texture_subresource(entry.texture_properties);
-            const VkImageMemoryBarrier2 barrier = get_vk_image_barrier(entry.target, default_subresource, src, dst);
+            prerender_barriers.emplace_back(get_vk_image_barrier(swap.dst, copied_subresource,
+                                                                 TextureTransferDstAccess, TextureShaderReadAccess));
+        }
 
-            prerender_barriers.emplace_back(barrier);
+        for (const auto& entry : staging.staging_queue)
+        {
+            prerender_barriers.emplace_back(get_vk_image_barrier(entry.target, entry.uploaded_subresource,
+                                                                 TextureTransferDstAccess, TextureShaderReadAccess));
         }
 
         const VkDependencyInfo dependencies = get_vk_image_barrier_depency_info(prerender_barriers);
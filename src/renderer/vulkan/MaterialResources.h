@@ -8,11 +8,17 @@
 #pragma once
 
 #include "renderer/ResourceHandle.h"
+#include "renderer/texture/TextureResidency.h"
+#include "renderer/texture/TextureStreaming.h"
 #include "renderer/vulkan/Buffer.h"
+#include "renderer/vulkan/FrameSync.h"
 #include "renderer/vulkan/Image.h"
 
+#include <core/memory/RingAllocator.h>
+
 #include <vulkan_loader/Vulkan.h>
 
+#include <array>
 #include <span>
 #include <vector>
 
@@ -20,27 +26,68 @@ namespace Reaper
 {
 struct StagingEntry
 {
-    GPUTextureProperties texture_properties;
-    u32                  copy_command_offset;
-    u32                  copy_command_count;
-    VkImage              target;
+    u32                   copy_command_offset;
+    u32                   copy_command_count;
+    VkImage               target;
+    GPUTextureSubresource uploaded_subresource; // Can be sampled once the copies are done
+};
+
+// Moves the resident mips of a texture to a newly created image holding more or fewer mips.
+// Mip offsets are in the numbering of each image.
+struct TextureImageSwap
+{
+    VkImage              src; // VK_NULL_HANDLE for new textures, nothing gets copied
+    VkImage              dst;
+    GPUTextureProperties dst_properties;
+    u32                  src_mip_offset;
+    u32                  dst_mip_offset;
+    u32                  copy_mip_count;
 };
 
+// Textures are copied through a persistently mapped ring, its memory is reused once the frame that read it is done.
 struct ResourceStagingArea
 {
-    u32                 offset_bytes; // FIXME u32 enough?
-    GPUBufferProperties buffer_properties;
-    GPUBuffer           staging_buffer;
+    GPUBuffer        staging_buffer;
+    MappedBufferView staging_view;
+    RingAllocator    staging_ring;
     // Setup buffer copy regions for each mip level
     std::vector<VkBufferImageCopy2> bufferCopyRegions;
 
-    std::vector<StagingEntry> staging_queue;
+    std::vector<TextureImageSwap> image_swaps; // Recorded before the staging copies
+    std::vector<StagingEntry>     staging_queue;
 };
 
+// Mip offsets use the numbering of the full mip chain.
+// The image only holds the mips from image_mip_offset, the view only covers the resident ones.
 struct TextureResource
 {
-    GPUTexture  texture;
-    VkImageView default_view;
+    GPUTexture           texture;
+    VkImageView          default_view; // Points to the fallback texture until the mip tail is resident
+    GPUTextureProperties properties;   // Of the full mip chain
+    u32                  image_mip_offset;
+    u32                  resident_mip_offset; // Equal to the mip count when no mip is resident
+    TextureResidency     residency;
+    DecodedTexture       source; // Evicted mips get streamed in again from there
+};
+
+// Freed once the GPU is done with the frame that last used it
+struct RetiredTexture
+{
+    GPUTexture  texture; // Null handle when only the view got replaced
+    VkImageView view;
+    u64         frame_index;
+};
+
+// The shaders write the finest mip they sampled for each texture, the CPU reads it back a couple of frames later.
+// Each frame in flight copies to its own readback buffer so the CPU never reads one the GPU is writing to.
+struct TextureFeedback
+{
+    GPUBuffer                                       buffer;
+    std::array<GPUBuffer, MaxFramesInFlight>        readback_buffers;
+    std::array<MappedBufferView, MaxFramesInFlight> readback_views;
+    std::array<u64, MaxFramesInFlight>              readback_frame_indices; // 0 when never written
+    u64                                             last_read_frame_index;
+    bool                                            is_cleared; // The buffer starts uninitialized
 };
 
 struct MaterialResources
@@ -48,6 +95,11 @@ struct MaterialResources
     ResourceStagingArea staging;
 
     std::vector<TextureResource> textures;
+
+    TextureResource                      fallback_texture;
+    std::vector<TextureStreamingRequest> streaming_requests;
+    std::vector<RetiredTexture>          retired_textures;
+    TextureFeedback                      feedback;
 };
 
 struct VulkanBackend;
@@ -67,15 +119,42 @@ inline HandleSpan<TextureHandle> alloc_material_textures(MaterialResources& reso
     };
 }
 
+struct JobSystem;
+
+// Files are decoded on the job system when there is one, then their mip tails are queued for streaming.
+// Textures can be bound right away, they show the fallback texture until their first mips are uploaded.
+// The decoded files stay in memory, top mips come and go with update_material_texture_residency().
 REAPER_RENDERER_API void load_dds_textures_to_staging(VulkanBackend& backend, MaterialResources& resources,
                                                       std::span<std::string>    texture_filenames,
-                                                      HandleSpan<TextureHandle> handle_span);
+                                                      HandleSpan<TextureHandle> handle_span,
+                                                      JobSystem*                job_system = nullptr);
 
 REAPER_RENDERER_API void load_png_textures_to_staging(VulkanBackend& backend, MaterialResources& resources,
                                                       std::span<std::string>    texture_filenames,
-                                                      HandleSpan<TextureHandle> handle_span, std::span<u32> is_srgb);
+                                                      HandleSpan<TextureHandle> handle_span, std::span<u32> is_srgb,
+                                                      JobSystem* job_system = nullptr);
+
+// Reads back the newest texture feedback the GPU is done with and resizes the textures to the mips the shaders asked
+// for, within the VRAM budget of the backend options.
+// Textures that are still streaming keep their current mips until they are done.
+void update_material_texture_residency(VulkanBackend& backend, MaterialResources& resources,
+                                       u64 completed_frame_index);
+
+// Copies the next mips of the queued textures to the staging ring, within the per-frame budget.
+// When the ring is full the remaining mips wait for the next frames instead.
+// Call once per frame before the descriptors are written, the views of the textures might change.
+void stream_material_textures(VulkanBackend& backend, MaterialResources& resources);
+
+// Gives back the staging memory and the images the GPU is done with.
+void release_material_resources_memory(VulkanBackend& backend, MaterialResources& resources,
+                                       u64 completed_frame_index);
+
+// First mip covered by the texture's view, in the numbering of the full mip chain.
+// Lets the shaders compute the mip they would like from the size of the view they sample.
+u32 get_texture_view_mip_offset(const TextureResource& texture_resource);
 
 struct CommandBuffer;
 
-void record_material_upload_command_buffer(ResourceStagingArea& staging, CommandBuffer& cmdBuffer);
+// Has to run before anything samples the textures or writes the feedback in this frame
+void record_material_upload_command_buffer(MaterialResources& resources, CommandBuffer& cmdBuffer, u64 frame_index);
 } // namespace Reaper
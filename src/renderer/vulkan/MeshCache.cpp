@@ -10,226 +10,670 @@
 #include <vulkan_loader/Vulkan.h>
 
 #include "renderer/vulkan/Backend.h"
+#include "renderer/vulkan/Debug.h"
+#include "renderer/vulkan/Semaphore.h"
+#include "renderer/vulkan/api/AssertHelper.h"
 
+#include "renderer/CookedMesh.h"
+#include "renderer/MeshQuantization.h"
+#include "renderer/MeshletBuilder.h"
+
+#include "core/Literals.h"
+#include "core/fs/MappedFile.h"
 #include "mesh/Mesh.h"
+#include "profiling/Scope.h"
 
-#include <meshoptimizer.h>
+#include <algorithm>
+#include <cstring>
 
 #include "renderer/shader/meshlet/meshlet.share.hlsl"
 
 namespace Reaper
 {
+namespace
+{
+    constexpr u64 MeshStagingBufferSizeBytes = 64_MiB;
+    constexpr u64 MeshStagingAlignment = 16;
+
+    MeshUploadQueue create_mesh_upload_queue(VulkanBackend& backend)
+    {
+        const VkBufferCreateInfo buffer_create_info = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = VK_FLAGS_NONE,
+            .size = MeshStagingBufferSizeBytes,
+            .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            .queueFamilyIndexCount = 0,
+            .pQueueFamilyIndices = nullptr,
+        };
+
+        // NOTE: Persistently mapped like the storage buffer allocator, the CPU only ever writes to it.
+        const VmaAllocationCreateInfo allocation_create_info = {
+            .flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT
+                     | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+            .usage = VMA_MEMORY_USAGE_AUTO,
+            .requiredFlags = 0,
+            .preferredFlags = 0,
+            .memoryTypeBits = 0,
+            .pool = nullptr,
+            .pUserData = nullptr,
+            .priority = 0.f,
+        };
+
+        VkBuffer          buffer;
+        VmaAllocation     allocation;
+        VmaAllocationInfo allocation_info;
+        AssertVk(vmaCreateBuffer(backend.vma_instance, &buffer_create_info, &allocation_create_info, &buffer,
+                                 &allocation, &allocation_info));
+
+        VulkanSetDebugName(backend.device, buffer, "Mesh staging buffer");
+
+        MeshUploadQueue uploads = {};
+
+        uploads.staging_buffer = GPUBuffer{
+            .handle = buffer,
+            .allocation = allocation,
+            .properties_deprecated =
+                DefaultGPUBufferProperties(MeshStagingBufferSizeBytes, sizeof(u8), GPUBufferUsage::TransferSrc),
+        };
+        uploads.staging_mapped_ptr = static_cast<u8*>(allocation_info.pMappedData);
+        uploads.staging_ring = create_ring_allocator(MeshStagingBufferSizeBytes);
+
+        // Prefer a queue that doesn't do graphics work
+        u32 queue_family_index = backend.physical_device.graphics_queue_family_index;
+        uploads.queue = backend.graphics_queue;
+
+        if (backend.transfer_queue != VK_NULL_HANDLE)
+        {
+            queue_family_index = backend.physical_device.transfer_queue_family_index;
+            uploads.queue = backend.transfer_queue;
+        }
+        else if (backend.compute_queue != VK_NULL_HANDLE)
+        {
+            queue_family_index = backend.physical_device.compute_queue_family_index;
+            uploads.queue = backend.compute_queue;
+        }
+
+        const VkCommandPoolCreateInfo command_pool_create_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+            .queueFamilyIndex = queue_family_index,
+        };
+
+        for (u32 batch_index = 0; batch_index < MeshUploadQueue::MaxBatchesInFlight; batch_index++)
+        {
+            VkCommandPool& command_pool = uploads.command_pools[batch_index];
+
+            AssertVk(vkCreateCommandPool(backend.device, &command_pool_create_info, nullptr, &command_pool));
+
+            const VkCommandBufferAllocateInfo command_buffer_alloc_info = {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                .pNext = nullptr,
+                .commandPool = command_pool,
+                .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                .commandBufferCount = 1,
+            };
+
+            AssertVk(vkAllocateCommandBuffers(backend.device, &command_buffer_alloc_info,
+                                              &uploads.command_buffers[batch_index]));
+        }
+
+        const VkSemaphoreTypeCreateInfo semaphore_type_create_info = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR,
+            .pNext = nullptr,
+            .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR,
+            .initialValue = 0,
+        };
+
+        uploads.timeline_semaphore = create_semaphore(backend,
+                                                      VkSemaphoreCreateInfo{
+                                                          .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+                                                          .pNext = &semaphore_type_create_info,
+                                                          .flags = VK_FLAGS_NONE,
+                                                      },
+                                                      "Mesh upload timeline semaphore");
+        uploads.submitted_batch_count = 0;
+
+        return uploads;
+    }
+
+    void destroy_mesh_upload_queue(VulkanBackend& backend, const MeshUploadQueue& uploads)
+    {
+        for (VkCommandPool command_pool : uploads.command_pools)
+        {
+            vkDestroyCommandPool(backend.device, command_pool, nullptr);
+        }
+
+        vkDestroySemaphore(backend.device, uploads.timeline_semaphore, nullptr);
+
+        vmaDestroyBuffer(backend.vma_instance, uploads.staging_buffer.handle, uploads.staging_buffer.allocation);
+    }
+
+    void wait_for_mesh_upload_batch(VulkanBackend& backend, const MeshUploadQueue& uploads, u64 batch_value)
+    {
+        REAPER_PROFILE_SCOPE_FUNC();
+
+        const VkSemaphoreWaitInfo wait_info = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .pNext = nullptr,
+            .flags = VK_FLAGS_NONE,
+            .semaphoreCount = 1,
+            .pSemaphores = &uploads.timeline_semaphore,
+            .pValues = &batch_value,
+        };
+
+        AssertVk(vkWaitSemaphores(backend.device, &wait_info, UINT64_MAX));
+    }
+
+    GPUBuffer create_mesh_cache_buffer(VulkanBackend& backend, const char* debug_string,
+                                       const GPUBufferProperties& properties)
+    {
+        // Graphics, async compute and transfer queues all touch these, avoid ownership transfers.
+        std::vector<u32> queue_families = {backend.physical_device.graphics_queue_family_index};
+
+        for (u32 queue_family_index : {backend.physical_device.compute_queue_family_index,
+                                       backend.physical_device.transfer_queue_family_index})
+        {
+            if (queue_family_index != UINT32_MAX)
+                queue_families.push_back(queue_family_index);
+        }
+
+        return create_buffer(backend.device, debug_string, properties, backend.vma_instance, MemUsage::GPU_Only,
+                             queue_families);
+    }
+} // namespace
+
 MeshCache create_mesh_cache(VulkanBackend& backend)
 {
     MeshCache cache;
 
-    cache.indexBuffer = create_buffer(
-        backend.device, "Index buffer",
-        DefaultGPUBufferProperties(MeshCache::MAX_INDEX_COUNT, sizeof(int), GPUBufferUsage::StorageBuffer),
-        backend.vma_instance, MemUsage::CPU_To_GPU);
+    constexpr u32 usage_flags = GPUBufferUsage::StorageBuffer | GPUBufferUsage::TransferDst;
 
-    cache.vertexBufferPosition = create_buffer(
-        backend.device, "Position buffer",
-        DefaultGPUBufferProperties(MeshCache::MAX_VERTEX_COUNT, 3 * sizeof(float), GPUBufferUsage::StorageBuffer),
-        backend.vma_instance, MemUsage::CPU_To_GPU);
+    cache.indexBuffer = create_mesh_cache_buffer(
+        backend, "Index buffer", DefaultGPUBufferProperties(MeshCache::MAX_INDEX_COUNT, sizeof(int), usage_flags));
 
-    cache.vertexAttributesBuffer =
-        create_buffer(backend.device, "Vertex attributes",
-                      DefaultGPUBufferProperties(MeshCache::MAX_VERTEX_COUNT, sizeof(VertexAttributes),
-                                                 GPUBufferUsage::StorageBuffer),
-                      backend.vma_instance, MemUsage::CPU_To_GPU);
+    cache.vertexBufferPosition = create_mesh_cache_buffer(
+        backend, "Position buffer",
+        DefaultGPUBufferProperties(MeshCache::MAX_VERTEX_COUNT, 3 * sizeof(float), usage_flags));
 
-    cache.meshletBuffer = create_buffer(
-        backend.device, "Meshlet buffer",
-        DefaultGPUBufferProperties(MeshCache::MAX_MESHLET_COUNT, sizeof(Meshlet), GPUBufferUsage::StorageBuffer),
-        backend.vma_instance, MemUsage::CPU_To_GPU);
+    cache.vertexAttributesBuffer = create_mesh_cache_buffer(
+        backend, "Vertex attributes",
+        DefaultGPUBufferProperties(MeshCache::MAX_VERTEX_COUNT, sizeof(VertexAttributes), usage_flags));
 
-    clear_meshes(cache);
+    cache.meshletBuffer = create_mesh_cache_buffer(
+        backend, "Meshlet buffer",
+        DefaultGPUBufferProperties(MeshCache::MAX_MESHLET_COUNT, sizeof(Meshlet), usage_flags));
+
+    cache.has_quantized_vertices = backend.options.enable_quantized_vertices;
+    cache.vertexBufferPositionQuantized = {};
+    cache.vertexAttributesBufferQuantized = {};
+
+    if (cache.has_quantized_vertices)
+    {
+        cache.vertexBufferPositionQuantized = create_mesh_cache_buffer(
+            backend, "Quantized position buffer",
+            DefaultGPUBufferProperties(MeshCache::MAX_VERTEX_COUNT, sizeof(QuantizedPosition), usage_flags));
+
+        cache.vertexAttributesBufferQuantized = create_mesh_cache_buffer(
+            backend, "Quantized vertex attributes",
+            DefaultGPUBufferProperties(MeshCache::MAX_VERTEX_COUNT, sizeof(QuantizedVertexAttributes), usage_flags));
+    }
+
+    cache.allocator =
+        create_mesh_allocator(MeshCache::MAX_INDEX_COUNT, MeshCache::MAX_VERTEX_COUNT, MeshCache::MAX_MESHLET_COUNT);
+
+    cache.uploads = create_mesh_upload_queue(backend);
 
     return cache;
 }
 
 void destroy_mesh_cache(VulkanBackend& backend, const MeshCache& mesh_cache)
 {
+    wait_for_mesh_upload_batch(backend, mesh_cache.uploads, mesh_cache.uploads.submitted_batch_count);
+
+    destroy_mesh_upload_queue(backend, mesh_cache.uploads);
+
     vmaDestroyBuffer(backend.vma_instance, mesh_cache.indexBuffer.handle, mesh_cache.indexBuffer.allocation);
     vmaDestroyBuffer(backend.vma_instance, mesh_cache.vertexBufferPosition.handle,
                      mesh_cache.vertexBufferPosition.allocation);
     vmaDestroyBuffer(backend.vma_instance, mesh_cache.vertexAttributesBuffer.handle,
                      mesh_cache.vertexAttributesBuffer.allocation);
     vmaDestroyBuffer(backend.vma_instance, mesh_cache.meshletBuffer.handle, mesh_cache.meshletBuffer.allocation);
+
+    if (mesh_cache.has_quantized_vertices)
+    {
+        vmaDestroyBuffer(backend.vma_instance, mesh_cache.vertexBufferPositionQuantized.handle,
+                         mesh_cache.vertexBufferPositionQuantized.allocation);
+        vmaDestroyBuffer(backend.vma_instance, mesh_cache.vertexAttributesBufferQuantized.handle,
+                         mesh_cache.vertexAttributesBufferQuantized.allocation);
+    }
 }
 
-void clear_meshes(MeshCache& mesh_cache)
+void clear_meshes(VulkanBackend& backend, MeshCache& mesh_cache)
 {
-    mesh_cache.mesh2_instances.clear();
+    const MeshAllocator& allocator = mesh_cache.allocator;
 
-    mesh_cache.current_index_offset = 0;
-    mesh_cache.current_position_offset = 0;
-    mesh_cache.current_attributes_offset = 0;
-    mesh_cache.current_meshlet_offset = 0;
+    std::vector<MeshHandle> live_handles;
+
+    for (u32 mesh_index = 0; mesh_index < allocator.mesh2_instances.size(); mesh_index++)
+    {
+        const MeshHandle handle = make_mesh_handle(mesh_index, allocator.mesh_generations[mesh_index]);
+
+        if (is_mesh_handle_valid(allocator, handle))
+            live_handles.push_back(handle);
+    }
+
+    unload_meshes(backend, mesh_cache, live_handles);
 }
 
 namespace
 {
-    MeshAlloc mesh_cache_allocate_mesh(MeshCache& mesh_cache, const Mesh& mesh, std::span<const Meshlet> meshlets)
+    VkBuffer get_mesh_cache_buffer(const MeshCache& mesh_cache, MeshCacheBuffer::Type buffer_type)
+    {
+        switch (buffer_type)
+        {
+        case MeshCacheBuffer::Index:
+            return mesh_cache.indexBuffer.handle;
+        case MeshCacheBuffer::Position:
+            return mesh_cache.vertexBufferPosition.handle;
+        case MeshCacheBuffer::Attributes:
+            return mesh_cache.vertexAttributesBuffer.handle;
+        case MeshCacheBuffer::QuantizedPosition:
+            return mesh_cache.vertexBufferPositionQuantized.handle;
+        case MeshCacheBuffer::QuantizedAttributes:
+            return mesh_cache.vertexAttributesBufferQuantized.handle;
+        case MeshCacheBuffer::Meshlet:
+            return mesh_cache.meshletBuffer.handle;
+        default:
+            AssertUnreachable();
+            return VK_NULL_HANDLE;
+        }
+    }
+
+    u64 get_mesh_cache_element_size(MeshCacheBuffer::Type buffer_type)
+    {
+        switch (buffer_type)
+        {
+        case MeshCacheBuffer::Index:
+            return sizeof(u32);
+        case MeshCacheBuffer::Position:
+            return sizeof(glm::fvec3);
+        case MeshCacheBuffer::Attributes:
+            return sizeof(VertexAttributes);
+        case MeshCacheBuffer::QuantizedPosition:
+            return sizeof(QuantizedPosition);
+        case MeshCacheBuffer::QuantizedAttributes:
+            return sizeof(QuantizedVertexAttributes);
+        case MeshCacheBuffer::Meshlet:
+            return sizeof(Meshlet);
+        default:
+            AssertUnreachable();
+            return 0;
+        }
+    }
+
+    void record_copy_to_copy_barrier(VkCommandBuffer command_buffer)
     {
-        MeshAlloc alloc = {};
+        const VkMemoryBarrier2 copy_barrier = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+            .pNext = nullptr,
+            .srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+            .srcAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            .dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+            .dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT,
+        };
+
+        const VkDependencyInfo dependencies = {
+            .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+            .pNext = nullptr,
+            .dependencyFlags = VK_FLAGS_NONE,
+            .memoryBarrierCount = 1,
+            .pMemoryBarriers = &copy_barrier,
+            .bufferMemoryBarrierCount = 0,
+            .pBufferMemoryBarriers = nullptr,
+            .imageMemoryBarrierCount = 0,
+            .pImageMemoryBarriers = nullptr,
+        };
+
+        vkCmdPipelineBarrier2(command_buffer, &dependencies);
+    }
+
+    template <typename T>
+    void stage_mesh_cache_copy(VulkanBackend& backend, MeshCache& mesh_cache, MeshCacheBuffer::Type buffer_type,
+                               std::span<const T> data, u32 offset_elements)
+    {
+        MeshUploadQueue& uploads = mesh_cache.uploads;
+        const u64        size_bytes = data.size_bytes();
+
+        u64 staging_offset = ring_allocate(uploads.staging_ring, size_bytes, MeshStagingAlignment);
+
+        if (staging_offset == InvalidRingOffset)
+        {
+            // The ring is full, flush what we have so far and block until enough older copies are done.
+            submit_mesh_cache_uploads(backend, mesh_cache);
+
+            do
+            {
+                Assert(!uploads.staging_ring.pending_batches.empty());
+
+                const u64 batch_value = uploads.staging_ring.pending_batches.front().fence_value;
 
-        const u32 index_count = static_cast<u32>(mesh.indexes.size());
-        const u32 position_count = static_cast<u32>(mesh.positions.size());
-        const u32 attributes_count = static_cast<u32>(mesh.attributes.size());
-        const u32 meshlet_count = static_cast<u32>(meshlets.size());
+                wait_for_mesh_upload_batch(backend, uploads, batch_value);
+                ring_release(uploads.staging_ring, batch_value);
 
-        Assert(index_count > 0);
-        Assert(position_count > 0);
-        Assert(position_count == attributes_count);
-        Assert(meshlet_count > 0);
+                staging_offset = ring_allocate(uploads.staging_ring, size_bytes, MeshStagingAlignment);
+            } while (staging_offset == InvalidRingOffset);
+        }
+
+        memcpy(uploads.staging_mapped_ptr + staging_offset, data.data(), size_bytes);
+
+        Assert(get_mesh_cache_element_size(buffer_type) == sizeof(T));
+
+        uploads.pending_copies[buffer_type].push_back(VkBufferCopy2{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_COPY_2,
+            .pNext = nullptr,
+            .srcOffset = staging_offset,
+            .dstOffset = static_cast<u64>(offset_elements) * sizeof(T),
+            .size = size_bytes,
+        });
+    }
 
-        alloc.index_count = index_count;
-        alloc.vertex_count = position_count;
-        alloc.meshlet_count = meshlet_count;
+    // Positions are quantized in the mesh AABB, so every LOD of a mesh shares the instance dequantization params.
+    void upload_quantized_vertices(MeshCache& mesh_cache, const MeshletLodView& lod, const MeshAlloc& mesh_alloc,
+                                   const Mesh2& mesh2, VulkanBackend& backend)
+    {
+        REAPER_PROFILE_SCOPE_FUNC();
 
-        alloc.index_offset = mesh_cache.current_index_offset;
-        alloc.position_offset = mesh_cache.current_position_offset;
-        alloc.attributes_offset = mesh_cache.current_attributes_offset;
-        alloc.meshlet_offset = mesh_cache.current_meshlet_offset;
+        std::vector<QuantizedPosition>         positions(lod.positions.size());
+        std::vector<QuantizedVertexAttributes> attributes(lod.attributes.size());
 
-        mesh_cache.current_index_offset += index_count;
-        mesh_cache.current_position_offset += position_count;
-        mesh_cache.current_attributes_offset += position_count;
-        mesh_cache.current_meshlet_offset += meshlet_count;
+        for (u32 i = 0; i < lod.positions.size(); i++)
+        {
+            positions[i] = quantize_position(lod.positions[i], mesh2.aabb_min_ms, mesh2.aabb_max_ms);
+            attributes[i] = quantize_vertex_attributes(lod.attributes[i]);
+        }
 
-        Assert(mesh_cache.current_index_offset < MeshCache::MAX_INDEX_COUNT);
-        Assert(mesh_cache.current_position_offset < MeshCache::MAX_VERTEX_COUNT);
-        Assert(mesh_cache.current_attributes_offset < MeshCache::MAX_VERTEX_COUNT);
-        Assert(mesh_cache.current_meshlet_offset < MeshCache::MAX_MESHLET_COUNT);
+        stage_mesh_cache_copy(backend, mesh_cache, MeshCacheBuffer::QuantizedPosition,
+                              std::span<const QuantizedPosition>(positions), mesh_alloc.vertex_offset);
+        stage_mesh_cache_copy(backend, mesh_cache, MeshCacheBuffer::QuantizedAttributes,
+                              std::span<const QuantizedVertexAttributes>(attributes), mesh_alloc.vertex_offset);
+    }
 
-        return alloc;
+    void upload_mesh_to_mesh_cache(MeshCache& mesh_cache, const MeshletLodView& lod, const MeshAlloc& mesh_alloc,
+                                   const Mesh2& mesh2, VulkanBackend& backend)
+    {
+        stage_mesh_cache_copy(backend, mesh_cache, MeshCacheBuffer::Index, lod.indexes, mesh_alloc.index_offset);
+        stage_mesh_cache_copy(backend, mesh_cache, MeshCacheBuffer::Position, lod.positions, mesh_alloc.vertex_offset);
+        stage_mesh_cache_copy(backend, mesh_cache, MeshCacheBuffer::Attributes, lod.attributes,
+                              mesh_alloc.vertex_offset);
+        stage_mesh_cache_copy(backend, mesh_cache, MeshCacheBuffer::Meshlet, lod.meshlets, mesh_alloc.meshlet_offset);
+
+        if (mesh_cache.has_quantized_vertices)
+            upload_quantized_vertices(mesh_cache, lod, mesh_alloc, mesh2, backend);
     }
 
-    void upload_mesh_to_mesh_cache(MeshCache& mesh_cache, const Mesh& mesh, const MeshAlloc& mesh_alloc,
-                                   std::span<const Meshlet> meshlets, VulkanBackend& backend)
+    // Allocation and staging are serial and follow the input order, so the result doesn't depend on threading.
+    void load_meshlet_meshes(VulkanBackend& backend, MeshCache& mesh_cache, std::span<const MeshletMeshView> meshes,
+                             std::span<MeshHandle> output_handles)
     {
-        upload_buffer_data_deprecated(backend.device, backend.vma_instance, mesh_cache.indexBuffer, mesh.indexes.data(),
-                                      mesh.indexes.size() * sizeof(mesh.indexes[0]), mesh_alloc.index_offset);
-        upload_buffer_data_deprecated(backend.device, backend.vma_instance, mesh_cache.vertexBufferPosition,
-                                      mesh.positions.data(), mesh.positions.size() * sizeof(mesh.positions[0]),
-                                      mesh_alloc.position_offset);
-        upload_buffer_data_deprecated(backend.device, backend.vma_instance, mesh_cache.vertexAttributesBuffer,
-                                      mesh.attributes.data(), mesh.attributes.size() * sizeof(mesh.attributes[0]),
-                                      mesh_alloc.attributes_offset);
+        Assert(output_handles.size() >= meshes.size());
+
+        for (u32 mesh_index = 0; mesh_index < meshes.size(); mesh_index++)
+        {
+            const MeshletMeshView& mesh = meshes[mesh_index];
+
+            Assert(mesh.lod_count > 0 && mesh.lod_count <= Mesh2::MAX_MESH_LODS);
+
+            Mesh2 mesh2 = {};
+
+            for (u32 lod_index = 0; lod_index < mesh.lod_count; lod_index++)
+            {
+                const MeshletLodView& lod = mesh.lods[lod_index];
+
+                Assert(!lod.indexes.empty());
+                Assert(lod.positions.size() == lod.attributes.size());
+                Assert(!lod.meshlets.empty());
+
+                MeshAlloc  mesh_alloc;
+                const bool has_space =
+                    allocate_mesh_ranges(mesh_cache.allocator, static_cast<u32>(lod.indexes.size()),
+                                         static_cast<u32>(lod.positions.size()),
+                                         static_cast<u32>(lod.meshlets.size()), mesh_alloc);
+
+                Assert(has_space, "mesh cache is full");
 
-        upload_buffer_data_deprecated(backend.device, backend.vma_instance, mesh_cache.meshletBuffer, meshlets.data(),
-                                      meshlets.size() * sizeof(meshlets[0]), mesh_alloc.meshlet_offset);
+                if (lod_index == 0)
+                    mesh2 = create_mesh2(mesh_alloc, mesh.aabb_min_ms, mesh.aabb_max_ms);
+                else
+                    add_mesh2_lod(mesh2, mesh_alloc, lod.error_ms);
+
+                upload_mesh_to_mesh_cache(mesh_cache, lod, mesh_alloc, mesh2, backend);
+            }
+
+            output_handles[mesh_index] = insert_mesh2(mesh_cache.allocator, mesh2);
+        }
     }
 } // namespace
 
 void load_meshes(VulkanBackend& backend, MeshCache& mesh_cache, std::span<const Mesh> meshes,
-                 std::span<MeshHandle> output_handles)
+                 std::span<MeshHandle> output_handles, JobSystem* job_system)
+{
+    REAPER_PROFILE_SCOPE_FUNC();
+
+    // CPU work first, it doesn't touch the mesh cache so it can run on any thread
+    std::vector<MeshletMesh> meshlet_meshes(meshes.size());
+
+    build_meshlet_meshes(meshes, meshlet_meshes, job_system);
+
+    std::vector<MeshletMeshView> meshlet_mesh_views;
+
+    for (const MeshletMesh& meshlet_mesh : meshlet_meshes)
+        meshlet_mesh_views.push_back(get_meshlet_mesh_view(meshlet_mesh));
+
+    load_meshlet_meshes(backend, mesh_cache, meshlet_mesh_views, output_handles);
+}
+
+bool load_cooked_meshes(VulkanBackend& backend, MeshCache& mesh_cache, const std::string& cooked_file_path,
+                        u64 source_hash, std::vector<MeshHandle>& output_handles)
 {
-    Assert(output_handles.size() >= meshes.size());
+    REAPER_PROFILE_SCOPE_FUNC();
+
+    MappedFile cooked_file;
+
+    if (!map_file(cooked_file_path, cooked_file))
+        return false;
 
-    for (u32 mesh_index = 0; mesh_index < meshes.size(); mesh_index++)
+    std::vector<MeshletMeshView> meshlet_mesh_views;
+
+    const bool is_valid = get_cooked_mesh_views(std::span(cooked_file.data, cooked_file.size_bytes), source_hash,
+                                                meshlet_mesh_views);
+
+    if (is_valid)
     {
-        // NOTE: Deep copy to keep the input immutable
-        Mesh mesh = meshes[mesh_index];
+        const size_t handle_offset = output_handles.size();
+        output_handles.resize(handle_offset + meshlet_mesh_views.size());
 
-        Assert(mesh.attributes.size() == mesh.positions.size());
+        // Data is copied straight from the mapping to the staging ring, we don't need the file after that.
+        load_meshlet_meshes(backend, mesh_cache, meshlet_mesh_views, std::span(output_handles).subspan(handle_offset));
+    }
 
-        const size_t max_vertices = MeshletMaxTriangleCount * 3;
-        const size_t max_triangles = MeshletMaxTriangleCount;
-        const float  cone_weight = 0.5f; // FIXME fold in a constant
+    unmap_file(cooked_file);
 
-        Assert(max_vertices < 256); // NOTE: u8 indices
+    return is_valid;
+}
 
-        size_t max_meshlets = meshopt_buildMeshletsBound(mesh.indexes.size(), max_vertices, max_triangles);
+void unload_meshes(VulkanBackend& backend, MeshCache& mesh_cache, std::span<const MeshHandle> handles)
+{
+    // The last submitted frame might still be using these
+    for (MeshHandle handle : handles)
+    {
+        remove_mesh2(mesh_cache.allocator, handle, backend.frame_index);
+    }
+}
 
-        std::vector<meshopt_Meshlet> meshlets(max_meshlets);
-        std::vector<u32>             meshlet_vertices(max_meshlets * max_vertices);
-        std::vector<u8>              meshlet_indices(max_meshlets * max_triangles * 3);
+void release_mesh_cache_memory(MeshCache& mesh_cache, u64 completed_frame_index)
+{
+    release_retired_mesh_ranges(mesh_cache.allocator, completed_frame_index);
+}
 
-        size_t meshlet_count =
-            meshopt_buildMeshlets(meshlets.data(), meshlet_vertices.data(), meshlet_indices.data(), mesh.indexes.data(),
-                                  mesh.indexes.size(), &mesh.positions[0].x, mesh.positions.size(),
-                                  sizeof(mesh.positions[0]), max_vertices, max_triangles, cone_weight);
+void defragment_mesh_cache(VulkanBackend& backend, MeshCache& mesh_cache, u32 max_mesh_count)
+{
+    std::vector<MeshRangeMove> moves;
 
-        const meshopt_Meshlet& last = meshlets[meshlet_count - 1];
+    // The frame being recorded waits for the copies, and it might be the last one to read the source ranges.
+    defragment_mesh_allocator(mesh_cache.allocator, max_mesh_count, backend.frame_index, moves);
 
-        meshlet_vertices.resize(last.vertex_offset + last.vertex_count);
-        meshlet_indices.resize(last.triangle_offset + last.triangle_count * 3);
-        meshlets.resize(meshlet_count);
+    for (const MeshRangeMove& move : moves)
+    {
+        if (get_mesh_cache_buffer(mesh_cache, move.buffer) == VK_NULL_HANDLE)
+            continue; // Quantized streams are optional
+
+        const u64 element_size = get_mesh_cache_element_size(move.buffer);
+
+        mesh_cache.uploads.pending_moves[move.buffer].push_back(VkBufferCopy2{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_COPY_2,
+            .pNext = nullptr,
+            .srcOffset = move.src_offset * element_size,
+            .dstOffset = move.dst_offset * element_size,
+            .size = move.count * element_size,
+        });
+    }
+}
 
-        const u32 meshlet_vertex_count = static_cast<u32>(meshlet_vertices.size());
-        const u32 total_mesh_index_count = static_cast<u32>(meshlet_indices.size());
+void submit_mesh_cache_uploads(VulkanBackend& backend, MeshCache& mesh_cache)
+{
+    REAPER_PROFILE_SCOPE_FUNC();
 
-        std::vector<u32>              optimized_index_buffer(total_mesh_index_count);
-        std::vector<glm::fvec3>       optimized_position_buffer(meshlet_vertex_count);
-        std::vector<VertexAttributes> optimized_attributes_buffer(meshlet_vertex_count);
-        std::vector<Meshlet>          optimized_meshlets(meshlet_count);
+    MeshUploadQueue& uploads = mesh_cache.uploads;
 
-        for (u32 i = 0; i < meshlet_vertex_count; i++)
-        {
-            const u32 index = meshlet_vertices[i];
+    u64 current_batch_value;
+    AssertVk(vkGetSemaphoreCounterValue(backend.device, uploads.timeline_semaphore, &current_batch_value));
 
-            optimized_position_buffer[i] = mesh.positions[index];
-            optimized_attributes_buffer[i] = mesh.attributes[index];
-        }
+    ring_release(uploads.staging_ring, current_batch_value);
 
-        u32 index_output_offset = 0;
+    const auto has_regions = [](const std::vector<VkBufferCopy2>& regions) { return !regions.empty(); };
+    const bool has_copies = std::ranges::any_of(uploads.pending_copies, has_regions);
+    const bool has_moves = std::ranges::any_of(uploads.pending_moves, has_regions);
 
-        // We also do index buffer compaction in the same pass
-        for (u32 meshlet_index = 0; meshlet_index < meshlets.size(); meshlet_index++)
-        {
-            const meshopt_Meshlet& meshlet = meshlets[meshlet_index];
-            const meshopt_Bounds boundsMeshlet = meshopt_computeMeshletBounds(&meshlet_vertices[meshlet.vertex_offset],
-                                                                              &meshlet_indices[meshlet.triangle_offset],
-                                                                              meshlet.triangle_count,
-                                                                              &mesh.positions[0].x,
-                                                                              mesh.positions.size(),
-                                                                              sizeof(mesh.positions[0]));
-
-            const u32 meshlet_index_count = meshlet.triangle_count * 3;
-
-            Meshlet& meshlet_instance = optimized_meshlets[meshlet_index];
-            meshlet_instance.vertex_offset = meshlet.vertex_offset;
-            meshlet_instance.vertex_count = meshlet.vertex_count;
-            meshlet_instance.index_offset = index_output_offset;
-            meshlet_instance.index_count = meshlet_index_count;
-            meshlet_instance.center_ms =
-                glm::fvec3(boundsMeshlet.center[0], boundsMeshlet.center[1], boundsMeshlet.center[2]);
-            meshlet_instance.radius = boundsMeshlet.radius;
-            meshlet_instance.cone_axis_ms =
-                glm::fvec3(boundsMeshlet.cone_axis[0], boundsMeshlet.cone_axis[1], boundsMeshlet.cone_axis[2]);
-            meshlet_instance.cone_cutoff = boundsMeshlet.cone_cutoff;
-            meshlet_instance.cone_apex_ms =
-                glm::fvec3(boundsMeshlet.cone_apex[0], boundsMeshlet.cone_apex[1], boundsMeshlet.cone_apex[2]);
-
-            // Copy index buffer
-            for (u32 index = 0; index < meshlet_index_count; index++)
-            {
-                const u32 index_input_offset = meshlet.triangle_offset + index;
+    if (!has_copies && !has_moves)
+        return;
 
-                optimized_index_buffer[index_output_offset + index] =
-                    static_cast<u32>(meshlet_indices[index_input_offset]);
-            }
+    const u64 batch_value = uploads.submitted_batch_count + 1;
+    const u32 batch_slot = static_cast<u32>(batch_value % MeshUploadQueue::MaxBatchesInFlight);
 
-            index_output_offset += meshlet_index_count;
-        }
+    // Recycle the command buffer of an older batch, this should almost never block.
+    if (batch_value > MeshUploadQueue::MaxBatchesInFlight)
+    {
+        wait_for_mesh_upload_batch(backend, uploads, batch_value - MeshUploadQueue::MaxBatchesInFlight);
+    }
+
+    AssertVk(vkResetCommandPool(backend.device, uploads.command_pools[batch_slot], VK_FLAGS_NONE));
+
+    const VkCommandBuffer command_buffer = uploads.command_buffers[batch_slot];
+
+    const VkCommandBufferBeginInfo command_buffer_begin_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = nullptr,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = nullptr,
+    };
+
+    AssertVk(vkBeginCommandBuffer(command_buffer, &command_buffer_begin_info));
+
+    // Ranges can be reused while older batches on this queue still touch them
+    record_copy_to_copy_barrier(command_buffer);
+
+    for (u32 buffer_type = 0; buffer_type < MeshCacheBuffer::Count; buffer_type++)
+    {
+        std::vector<VkBufferCopy2>& copy_regions = uploads.pending_copies[buffer_type];
+
+        if (copy_regions.empty())
+            continue;
 
-        optimized_index_buffer.resize(index_output_offset); // Trim excess
+        const VkCopyBufferInfo2 copy_info = {
+            .sType = VK_STRUCTURE_TYPE_COPY_BUFFER_INFO_2,
+            .pNext = nullptr,
+            .srcBuffer = uploads.staging_buffer.handle,
+            .dstBuffer = get_mesh_cache_buffer(mesh_cache, static_cast<MeshCacheBuffer::Type>(buffer_type)),
+            .regionCount = static_cast<u32>(copy_regions.size()),
+            .pRegions = copy_regions.data(),
+        };
 
-        std::swap(mesh.indexes, optimized_index_buffer);
-        std::swap(mesh.positions, optimized_position_buffer);
-        std::swap(mesh.attributes, optimized_attributes_buffer);
+        vkCmdCopyBuffer2(command_buffer, &copy_info);
 
-        const MeshHandle new_handle = static_cast<MeshHandle>(mesh_cache.mesh2_instances.size());
-        Mesh2&           mesh2 = mesh_cache.mesh2_instances.emplace_back();
+        copy_regions.clear();
+    }
+
+    if (has_moves)
+    {
+        // Moved data might come from a copy of this batch
+        record_copy_to_copy_barrier(command_buffer);
+
+        // Source and destination ranges never overlap, so the copies can stay within the same buffer.
+        for (u32 buffer_type = 0; buffer_type < MeshCacheBuffer::Count; buffer_type++)
+        {
+            std::vector<VkBufferCopy2>& move_regions = uploads.pending_moves[buffer_type];
 
-        mesh2 = create_mesh2(mesh_cache_allocate_mesh(mesh_cache, mesh, optimized_meshlets));
+            if (move_regions.empty())
+                continue;
 
-        upload_mesh_to_mesh_cache(mesh_cache, mesh, mesh2.lods_allocs[0], optimized_meshlets, backend);
+            const VkBuffer buffer = get_mesh_cache_buffer(mesh_cache, static_cast<MeshCacheBuffer::Type>(buffer_type));
 
-        output_handles[mesh_index] = new_handle;
+            const VkCopyBufferInfo2 copy_info = {
+                .sType = VK_STRUCTURE_TYPE_COPY_BUFFER_INFO_2,
+                .pNext = nullptr,
+                .srcBuffer = buffer,
+                .dstBuffer = buffer,
+                .regionCount = static_cast<u32>(move_regions.size()),
+                .pRegions = move_regions.data(),
+            };
+
+            vkCmdCopyBuffer2(command_buffer, &copy_info);
+
+            move_regions.clear();
+        }
     }
+
+    AssertVk(vkEndCommandBuffer(command_buffer));
+
+    // NOTE: No-op on host coherent memory
+    AssertVk(vmaFlushAllocation(backend.vma_instance, uploads.staging_buffer.allocation, 0, VK_WHOLE_SIZE));
+
+    // The semaphore signal makes the copies available to any queue that waits on it, no barrier needed.
+    const VkSemaphoreSubmitInfo signal_semaphore_info = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+        .pNext = nullptr,
+        .semaphore = uploads.timeline_semaphore,
+        .value = batch_value,
+        .stageMask = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+        .deviceIndex = 0, // NOTE: Set to zero when not using device groups
+    };
+
+    const VkCommandBufferSubmitInfo command_buffer_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+        .pNext = nullptr,
+        .commandBuffer = command_buffer,
+        .deviceMask = 0, // NOTE: Set to zero when not using device groups
+    };
+
+    const VkSubmitInfo2 submit_info_2 = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+        .pNext = nullptr,
+        .flags = VK_FLAGS_NONE,
+        .waitSemaphoreInfoCount = 0,
+        .pWaitSemaphoreInfos = nullptr,
+        .commandBufferInfoCount = 1,
+        .pCommandBufferInfos = &command_buffer_info,
+        .signalSemaphoreInfoCount = 1,
+        .pSignalSemaphoreInfos = &signal_semaphore_info,
+    };
+
+    AssertVk(vkQueueSubmit2(uploads.queue, 1, &submit_info_2, VK_NULL_HANDLE));
+
+    ring_close_batch(uploads.staging_ring, batch_value);
+
+    uploads.submitted_batch_count = batch_value;
 }
 } // namespace Reaper
@@ -9,15 +9,42 @@
 
 #include "Buffer.h"
 
+#include <array>
 #include <span>
+#include <string>
 #include <vector>
 
+#include "core/memory/RingAllocator.h"
+
 #include "renderer/Mesh2.h"
+#include "renderer/MeshAllocator.h"
 #include "renderer/RendererExport.h"
 #include "renderer/ResourceHandle.h"
 
 namespace Reaper
 {
+// Mesh data is written to a persistently mapped staging ring, then copied to the device local buffers with one
+// submit per frame. The copies go to the transfer queue when the device has one, so they don't stall graphics work.
+struct MeshUploadQueue
+{
+    static constexpr u32 MaxBatchesInFlight = 3;
+
+    GPUBuffer     staging_buffer;
+    u8*           staging_mapped_ptr;
+    RingAllocator staging_ring;
+
+    std::array<std::vector<VkBufferCopy2>, MeshCacheBuffer::Count> pending_copies;
+    std::array<std::vector<VkBufferCopy2>, MeshCacheBuffer::Count> pending_moves; // Defragmentation, in place
+
+    VkQueue                                         queue;
+    std::array<VkCommandPool, MaxBatchesInFlight>   command_pools;
+    std::array<VkCommandBuffer, MaxBatchesInFlight> command_buffers;
+
+    // Reaches the batch count once the copies of each batch are done.
+    VkSemaphore timeline_semaphore;
+    u64         submitted_batch_count;
+};
+
 struct Mesh;
 struct MeshCache
 {
@@ -30,22 +57,65 @@ struct MeshCache
     GPUBuffer vertexAttributesBuffer;
     GPUBuffer meshletBuffer;
 
-    u32 current_index_offset;
-    u32 current_position_offset;
-    u32 current_attributes_offset;
-    u32 current_meshlet_offset;
+    // Same vertex ranges as the float streams, see renderer/MeshQuantization.h.
+    // Only created when Backend::Options::enable_quantized_vertices is set, culling keeps reading the float positions.
+    bool      has_quantized_vertices;
+    GPUBuffer vertexBufferPositionQuantized;
+    GPUBuffer vertexAttributesBufferQuantized;
 
-    std::vector<Mesh2> mesh2_instances;
+    MeshAllocator   allocator;
+    MeshUploadQueue uploads;
 };
 
 struct VulkanBackend;
+struct JobSystem;
 
 MeshCache create_mesh_cache(VulkanBackend& backend);
 void      destroy_mesh_cache(VulkanBackend& backend, const MeshCache& mesh_cache);
 
+inline const Mesh2& get_mesh2(const MeshCache& mesh_cache, MeshHandle handle)
+{
+    return get_mesh2(mesh_cache.allocator, handle);
+}
+
+// Vertex streams of the vis-buffer and shadow passes, their pipelines follow the same option.
+inline const GPUBuffer& get_vertex_position_buffer(const MeshCache& mesh_cache)
+{
+    return mesh_cache.has_quantized_vertices ? mesh_cache.vertexBufferPositionQuantized
+                                             : mesh_cache.vertexBufferPosition;
+}
+
+inline const GPUBuffer& get_vertex_attributes_buffer(const MeshCache& mesh_cache)
+{
+    return mesh_cache.has_quantized_vertices ? mesh_cache.vertexAttributesBufferQuantized
+                                             : mesh_cache.vertexAttributesBuffer;
+}
+
 // This invalidates all current handles
-REAPER_RENDERER_API void clear_meshes(MeshCache& mesh_cache);
+REAPER_RENDERER_API void clear_meshes(VulkanBackend& backend, MeshCache& mesh_cache);
 
+// Meshes are only staged here, the data reaches the GPU with the next submit_mesh_cache_uploads().
+// Meshlets are built on the job system when there is one, handles and GPU data are the same either way.
 REAPER_RENDERER_API void load_meshes(VulkanBackend& backend, MeshCache& mesh_cache, std::span<const Mesh> meshes,
-                                     std::span<MeshHandle> output_handles);
+                                     std::span<MeshHandle> output_handles, JobSystem* job_system = nullptr);
+
+// Loads every mesh of a file written by the mesh cooker, see renderer/CookedMesh.h.
+// Returns false without loading anything when the file is missing or doesn't match source_hash.
+REAPER_RENDERER_API bool load_cooked_meshes(VulkanBackend& backend, MeshCache& mesh_cache,
+                                            const std::string& cooked_file_path, u64 source_hash,
+                                            std::vector<MeshHandle>& output_handles);
+
+// Handles are invalid right away, but the memory is only reused once the frames in flight are done with it.
+REAPER_RENDERER_API void unload_meshes(VulkanBackend& backend, MeshCache& mesh_cache,
+                                       std::span<const MeshHandle> handles);
+
+// Gives back the memory of unloaded meshes once the GPU is done with it.
+void release_mesh_cache_memory(MeshCache& mesh_cache, u64 completed_frame_index);
+
+// Compacts the ranges of up to max_mesh_count meshes, the copies go with the next submit_mesh_cache_uploads().
+void defragment_mesh_cache(VulkanBackend& backend, MeshCache& mesh_cache, u32 max_mesh_count);
+
+// Submits the copies staged since the last call, meant to be called once per frame.
+// Work that reads the mesh cache should wait for uploads.timeline_semaphore to reach uploads.submitted_batch_count.
+void submit_mesh_cache_uploads(VulkanBackend& backend, MeshCache& mesh_cache);
 } // namespace Reaper
@@ -78,6 +78,8 @@ namespace
 
         physical_device.graphics_queue_family_index = UINT32_MAX;
         physical_device.present_queue_family_index = UINT32_MAX;
+        physical_device.compute_queue_family_index = UINT32_MAX;
+        physical_device.transfer_queue_family_index = UINT32_MAX;
 
         uint32_t queue_families_count = 0;
         vkGetPhysicalDeviceQueueFamilyProperties(handle, &queue_families_count, nullptr);
@@ -93,6 +95,34 @@ namespace
 
         vkGetPhysicalDeviceQueueFamilyProperties(handle, &queue_families_count, &queue_family_properties[0]);
 
+        // Async compute only makes sense on a family that doesn't do graphics, otherwise it's likely the same hardware
+        // queue. We also want timestamps to be able to profile it.
+        for (uint32_t i = 0; i < queue_families_count; ++i)
+        {
+            const VkQueueFamilyProperties& properties = queue_family_properties[i];
+
+            if (properties.queueCount > 0 && (properties.queueFlags & VK_QUEUE_COMPUTE_BIT)
+                && !(properties.queueFlags & VK_QUEUE_GRAPHICS_BIT) && properties.timestampValidBits > 0)
+            {
+                physical_device.compute_queue_family_index = i;
+                break;
+            }
+        }
+
+        // Transfer-only families usually map to the copy engines, which let uploads run next to rendering.
+        for (uint32_t i = 0; i < queue_families_count; ++i)
+        {
+            const VkQueueFlags             excluded_queue_flags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT;
+            const VkQueueFamilyProperties& properties = queue_family_properties[i];
+
+            if (properties.queueCount > 0 && (properties.queueFlags & VK_QUEUE_TRANSFER_BIT)
+                && !(properties.queueFlags & excluded_queue_flags))
+            {
+                physical_device.transfer_queue_family_index = i;
+                break;
+            }
+        }
+
         for (uint32_t i = 0; i < queue_families_count; ++i)
         {
             AssertVk(vkGetPhysicalDeviceSurfaceSupportKHR(handle, i, presentationSurface, &queue_present_support[i]));
@@ -35,6 +35,8 @@ struct PhysicalDeviceInfo
     // These can point to the same object!
     uint32_t graphics_queue_family_index;
     uint32_t present_queue_family_index;
+    uint32_t compute_queue_family_index;  // Dedicated async compute family, UINT32_MAX if there's none
+    uint32_t transfer_queue_family_index; // Dedicated transfer family, UINT32_MAX if there's none
 
     struct MacroFeatures
     {
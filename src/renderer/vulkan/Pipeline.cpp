@@ -113,7 +113,7 @@ const char* default_entry_point()
     return "main";
 }
 
-VkPipeline create_compute_pipeline(VkDevice device, VkPipelineLayout pipeline_layout,
+VkPipeline create_compute_pipeline(VkDevice device, VkPipelineCache pipeline_cache, VkPipelineLayout pipeline_layout,
                                    const VkPipelineShaderStageCreateInfo& shader_stage_create_info)
 {
     VkComputePipelineCreateInfo pipelineCreateInfo = {
@@ -126,10 +126,9 @@ VkPipeline create_compute_pipeline(VkDevice device, VkPipelineLayout pipeline_la
         .basePipelineIndex = 0,
     };
 
-    VkPipeline      pipeline = VK_NULL_HANDLE;
-    VkPipelineCache cache = VK_NULL_HANDLE;
+    VkPipeline pipeline = VK_NULL_HANDLE;
 
-    AssertVk(vkCreateComputePipelines(device, cache, 1, &pipelineCreateInfo, nullptr, &pipeline));
+    AssertVk(vkCreateComputePipelines(device, pipeline_cache, 1, &pipelineCreateInfo, nullptr, &pipeline));
 
     return pipeline;
 }
@@ -317,7 +316,7 @@ create_pipeline_dynamic_state_create_info(std::span<const VkDynamicState> dynami
     };
 }
 
-VkPipeline create_graphics_pipeline(VkDevice device,
+VkPipeline create_graphics_pipeline(VkDevice device, VkPipelineCache pipeline_cache,
                                     std::span<const VkPipelineShaderStageCreateInfo>
                                                                       shader_stages,
                                     const GraphicsPipelineProperties& properties,
@@ -346,10 +345,9 @@ VkPipeline create_graphics_pipeline(VkDevice device,
                                                 .basePipelineHandle = VK_NULL_HANDLE,
                                                 .basePipelineIndex = -1};
 
-    VkPipeline      pipeline = VK_NULL_HANDLE;
-    VkPipelineCache cache = VK_NULL_HANDLE;
+    VkPipeline pipeline = VK_NULL_HANDLE;
 
-    AssertVk(vkCreateGraphicsPipelines(device, cache, 1, &create_info, nullptr, &pipeline));
+    AssertVk(vkCreateGraphicsPipelines(device, pipeline_cache, 1, &create_info, nullptr, &pipeline));
 
     return pipeline;
 } // namespace Reaper
@@ -38,7 +38,8 @@ VkPipelineLayout create_pipeline_layout(
     VkDevice device, std::span<const VkDescriptorSetLayout> descriptor_set_layouts,
     std::span<const VkPushConstantRange> push_constant_ranges = std::span<const VkPushConstantRange>());
 
-VkPipeline create_compute_pipeline(VkDevice device, VkPipelineLayout pipeline_layout,
+// pipeline_cache can be VK_NULL_HANDLE
+VkPipeline create_compute_pipeline(VkDevice device, VkPipelineCache pipeline_cache, VkPipelineLayout pipeline_layout,
                                    const VkPipelineShaderStageCreateInfo& shader_stage_create_info);
 
 VkShaderModuleCreateInfo shader_module_create_info(std::span<const u32> shader_spirv);
@@ -80,7 +81,7 @@ struct GraphicsPipelineProperties
 
 GraphicsPipelineProperties default_graphics_pipeline_properties(void* pNext = nullptr);
 
-VkPipeline create_graphics_pipeline(VkDevice device,
+VkPipeline create_graphics_pipeline(VkDevice device, VkPipelineCache pipeline_cache,
                                     std::span<const VkPipelineShaderStageCreateInfo>
                                                                       shader_stages,
                                     const GraphicsPipelineProperties& properties,
@@ -8,29 +8,137 @@
 #include "PipelineFactory.h"
 
 #include "Backend.h"
+#include "ShaderModules.h"
+#include "api/AssertHelper.h"
+#include "profiling/Scope.h"
+#include "renderer/PipelineCacheFile.h"
+
+#include "common/Log.h"
+#include "common/ReaperRoot.h"
+
 #include "core/Assert.h"
+#include "core/jobs/JobSystem.h"
+
+#include <algorithm>
+#include <cstring>
 
 namespace Reaper
 {
+static_assert(sizeof(PipelineCacheHeaderVersionOne) == sizeof(VkPipelineCacheHeaderVersionOne));
+static_assert(PipelineCacheUUIDSize == VK_UUID_SIZE);
+static_assert(PipelineCacheHeaderVersionOneValue == VK_PIPELINE_CACHE_HEADER_VERSION_ONE);
+
+struct PipelineRebuild
+{
+    JobSystem*           job_system;
+    VkDevice             device;
+    VkPipelineCache      pipeline_cache;
+    const ShaderModules* shader_modules;
+
+    std::vector<u32>             tracker_indices;
+    std::vector<PipelineCreator> creators; // Copied, trackers can get registered while the jobs run
+    std::vector<VkPipeline>      pipelines;
+
+    std::vector<Job> jobs;
+    JobCounter       counter;
+};
+
+namespace
+{
+    // Relative to the working directory, like the shader pack
+    constexpr const char* PipelineCachePath = "build/pipeline_cache.bin";
+
+    PipelineCacheDeviceInfo get_pipeline_cache_device_info(const VulkanBackend& backend)
+    {
+        const VkPhysicalDeviceProperties& properties = backend.physical_device.properties;
+
+        PipelineCacheDeviceInfo device_info = {
+            .vendor_id = properties.vendorID,
+            .device_id = properties.deviceID,
+            .driver_version = properties.driverVersion,
+            .pipeline_cache_uuid = {},
+        };
+
+        memcpy(device_info.pipeline_cache_uuid, properties.pipelineCacheUUID, VK_UUID_SIZE);
+
+        return device_info;
+    }
+} // namespace
+
 PipelineFactory create_pipeline_factory(VulkanBackend& backend)
 {
-    static_cast<void>(backend);
+    REAPER_PROFILE_SCOPE_FUNC();
+
+    // An unusable file is not an error, the cache just starts empty
+    std::vector<u8> initial_data;
+    read_pipeline_cache_file(PipelineCachePath, get_pipeline_cache_device_info(backend), initial_data);
+
+    const VkPipelineCacheCreateInfo create_info = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = VK_FLAGS_NONE,
+        .initialDataSize = initial_data.size(),
+        .pInitialData = initial_data.data(),
+    };
+
+    VkPipelineCache pipeline_cache = VK_NULL_HANDLE;
+    AssertVk(vkCreatePipelineCache(backend.device, &create_info, nullptr, &pipeline_cache));
 
     return {
         .trackers = {},
         .pipelines = {},
+        .pipeline_cache = pipeline_cache,
         .dirty = true,
+        .shader_module_trackers = {},
+        .rebuild = nullptr,
+        .retired_pipelines = {},
     };
 }
 
 void destroy_pipeline_factory(VulkanBackend& backend, PipelineFactory& pipeline_factory)
 {
+    REAPER_PROFILE_SCOPE_FUNC();
+
+    if (PipelineRebuild* rebuild = pipeline_factory.rebuild)
+    {
+        wait_for_counter(*rebuild->job_system, rebuild->counter);
+
+        for (auto pipeline : rebuild->pipelines)
+        {
+            vkDestroyPipeline(backend.device, pipeline, nullptr);
+        }
+
+        delete rebuild;
+        pipeline_factory.rebuild = nullptr;
+    }
+
     for (auto pipeline : pipeline_factory.pipelines)
     {
         vkDestroyPipeline(backend.device, pipeline, nullptr);
     }
 
     pipeline_factory.pipelines.clear();
+
+    for (const RetiredPipeline& retired_pipeline : pipeline_factory.retired_pipelines)
+    {
+        vkDestroyPipeline(backend.device, retired_pipeline.pipeline, nullptr);
+    }
+
+    pipeline_factory.retired_pipelines.clear();
+
+    size_t cache_size_bytes = 0;
+    AssertVk(vkGetPipelineCacheData(backend.device, pipeline_factory.pipeline_cache, &cache_size_bytes, nullptr));
+
+    std::vector<u8> cache_data(cache_size_bytes);
+    AssertVk(
+        vkGetPipelineCacheData(backend.device, pipeline_factory.pipeline_cache, &cache_size_bytes, cache_data.data()));
+    cache_data.resize(cache_size_bytes);
+
+    // Failing to save only costs compile time on the next run
+    write_pipeline_cache_file(PipelineCachePath, get_pipeline_cache_device_info(backend), cache_data);
+
+    vkDestroyPipelineCache(backend.device, pipeline_factory.pipeline_cache, nullptr);
+    pipeline_factory.pipeline_cache = VK_NULL_HANDLE;
 }
 
 u32 register_pipeline_creator(PipelineFactory& factory, const PipelineCreator& creator)
@@ -48,35 +156,195 @@ u32 register_pipeline_creator(PipelineFactory& factory, const PipelineCreator& c
 
 namespace
 {
-    VkPipeline create_new_pipeline_from_tracker(VkDevice device, PipelineTracker& tracker,
-                                                ShaderModules& shader_modules)
+    VkPipeline create_new_pipeline_from_tracker(VkDevice device, VkPipelineCache pipeline_cache,
+                                                PipelineTracker& tracker, const ShaderModules& shader_modules)
     {
-        // tracker
-        VkPipeline pipeline =
-            tracker.creator.pipeline_creation_function(device, shader_modules, tracker.creator.pipeline_layout);
+        VkPipeline pipeline = tracker.creator.pipeline_creation_function(device, pipeline_cache, shader_modules,
+                                                                         tracker.creator.pipeline_layout);
 
         tracker.loaded_version += 1;
 
         return pipeline;
     }
+
+    void rebuild_pipeline_job(void* user_data, u32 job_index)
+    {
+        REAPER_PROFILE_SCOPE("rebuild_pipeline");
+
+        PipelineRebuild&       rebuild = *static_cast<PipelineRebuild*>(user_data);
+        const PipelineCreator& creator = rebuild.creators[job_index];
+
+        rebuild.pipelines[job_index] = creator.pipeline_creation_function(rebuild.device, rebuild.pipeline_cache,
+                                                                          *rebuild.shader_modules,
+                                                                          creator.pipeline_layout);
+    }
+
+    void start_pipeline_rebuild(ReaperRoot& root, VulkanBackend& backend, PipelineFactory& pipeline_factory,
+                                const ShaderModules& shader_modules, std::span<const u32> reloaded_module_indices)
+    {
+        std::vector<u32> tracker_indices;
+
+        for (u32 module_index : reloaded_module_indices)
+        {
+            if (module_index < pipeline_factory.shader_module_trackers.size())
+            {
+                const std::vector<u32>& module_trackers = pipeline_factory.shader_module_trackers[module_index];
+                tracker_indices.insert(tracker_indices.end(), module_trackers.begin(), module_trackers.end());
+            }
+        }
+
+        // Pipelines often read more than one of the reloaded modules
+        std::sort(tracker_indices.begin(), tracker_indices.end());
+        tracker_indices.erase(std::unique(tracker_indices.begin(), tracker_indices.end()), tracker_indices.end());
+
+        if (tracker_indices.empty())
+            return;
+
+        log_info(root, "pipeline: rebuilding {} pipelines", tracker_indices.size());
+
+        PipelineRebuild* rebuild = new PipelineRebuild{
+            .job_system = root.job_system,
+            .device = backend.device,
+            .pipeline_cache = pipeline_factory.pipeline_cache,
+            .shader_modules = &shader_modules,
+            .tracker_indices = std::move(tracker_indices),
+            .creators = {},
+            .pipelines = {},
+            .jobs = {},
+            .counter = {},
+        };
+
+        const u32 pipeline_count = static_cast<u32>(rebuild->tracker_indices.size());
+
+        rebuild->pipelines.resize(pipeline_count, VK_NULL_HANDLE);
+
+        for (u32 index = 0; index < pipeline_count; index++)
+        {
+            rebuild->creators.push_back(pipeline_factory.trackers[rebuild->tracker_indices[index]].creator);
+            rebuild->jobs.push_back(Job{
+                .function = &rebuild_pipeline_job,
+                .user_data = rebuild,
+                .job_index = index,
+                .counter = nullptr,
+            });
+        }
+
+        pipeline_factory.rebuild = rebuild;
+
+        // Compiles can take longer than a frame, keep them away from the frame thread
+        submit_background_jobs(*root.job_system, rebuild->jobs, rebuild->counter);
+    }
+
+    void finish_pipeline_rebuild(VulkanBackend& backend, PipelineFactory& pipeline_factory)
+    {
+        PipelineRebuild& rebuild = *pipeline_factory.rebuild;
+
+        for (u32 index = 0; index < rebuild.tracker_indices.size(); index++)
+        {
+            PipelineTracker& tracker = pipeline_factory.trackers[rebuild.tracker_indices[index]];
+            VkPipeline&      pipeline = pipeline_factory.pipelines[tracker.pipeline_index];
+
+            // The last recorded frame can still be using the old version
+            pipeline_factory.retired_pipelines.push_back(RetiredPipeline{
+                .pipeline = pipeline,
+                .frame_index = backend.frame_index,
+            });
+
+            pipeline = rebuild.pipelines[index];
+            tracker.loaded_version += 1;
+        }
+
+        delete pipeline_factory.rebuild;
+        pipeline_factory.rebuild = nullptr;
+    }
+
+    void destroy_retired_pipelines(VulkanBackend& backend, PipelineFactory& pipeline_factory, u64 completed_frame_index)
+    {
+        std::erase_if(pipeline_factory.retired_pipelines, [&](const RetiredPipeline& retired_pipeline) {
+            if (retired_pipeline.frame_index > completed_frame_index)
+                return false;
+
+            vkDestroyPipeline(backend.device, retired_pipeline.pipeline, nullptr);
+            return true;
+        });
+    }
 } // namespace
 
-void pipeline_factory_update(VulkanBackend& backend, PipelineFactory& pipeline_factory, ShaderModules& shader_modules)
+void pipeline_factory_update(ReaperRoot& root, VulkanBackend& backend, PipelineFactory& pipeline_factory,
+                             ShaderModules& shader_modules, u64 completed_frame_index)
 {
+    REAPER_PROFILE_SCOPE_FUNC();
+
+    destroy_retired_pipelines(backend, pipeline_factory, completed_frame_index);
+
+    // Rebuild jobs read the modules, they can only be swapped while none is running.
+    // Files changed in the meantime stay queued in the watcher.
+    if (pipeline_factory.rebuild == nullptr)
+    {
+        std::vector<u32> reloaded_module_indices;
+        reload_shader_modules(root, shader_modules, reloaded_module_indices);
+
+        start_pipeline_rebuild(root, backend, pipeline_factory, shader_modules, reloaded_module_indices);
+    }
+
+    // Without job workers the rebuild already ran inline and gets swapped in right away
+    if (pipeline_factory.rebuild != nullptr
+        && pipeline_factory.rebuild->counter.pending_job_count.load(std::memory_order_acquire) == 0)
+    {
+        finish_pipeline_rebuild(backend, pipeline_factory);
+    }
+
     if (pipeline_factory.dirty)
     {
-        for (auto& tracker : pipeline_factory.trackers)
+        REAPER_PROFILE_SCOPE("create_new_pipelines");
+
+        // Slots are handed out up front so every job writes to its own tracker and pipeline
+        std::vector<u32> new_tracker_indices;
+
+        for (u32 tracker_index = 0; tracker_index < pipeline_factory.trackers.size(); tracker_index++)
         {
+            PipelineTracker& tracker = pipeline_factory.trackers[tracker_index];
+
             if (tracker.loaded_version == 0)
             {
-                VkPipeline pipeline = create_new_pipeline_from_tracker(backend.device, tracker, shader_modules);
-
-                tracker.pipeline_index = static_cast<u32>(pipeline_factory.pipelines.size());
+                tracker.pipeline_index =
+                    static_cast<u32>(pipeline_factory.pipelines.size() + new_tracker_indices.size());
 
-                pipeline_factory.pipelines.push_back(pipeline);
+                new_tracker_indices.push_back(tracker_index);
             }
         }
 
+        pipeline_factory.pipelines.resize(pipeline_factory.pipelines.size() + new_tracker_indices.size());
+
+        std::vector<std::vector<u32>> new_tracker_module_indices(new_tracker_indices.size());
+
+        // Driver compiles are expensive enough to schedule one pipeline per job
+        parallel_for(*root.job_system, static_cast<u32>(new_tracker_indices.size()), [&](u32 job_index) {
+            REAPER_PROFILE_SCOPE("create_pipeline");
+
+            PipelineTracker& tracker = pipeline_factory.trackers[new_tracker_indices[job_index]];
+
+            begin_shader_module_dependency_recording(new_tracker_module_indices[job_index]);
+
+            pipeline_factory.pipelines[tracker.pipeline_index] = create_new_pipeline_from_tracker(
+                backend.device, pipeline_factory.pipeline_cache, tracker, shader_modules);
+
+            end_shader_module_dependency_recording();
+        });
+
+        pipeline_factory.shader_module_trackers.resize(shader_modules.pack.entries.size());
+
+        for (u32 index = 0; index < new_tracker_indices.size(); index++)
+        {
+            std::vector<u32>& module_indices = new_tracker_module_indices[index];
+
+            std::sort(module_indices.begin(), module_indices.end());
+            module_indices.erase(std::unique(module_indices.begin(), module_indices.end()), module_indices.end());
+
+            for (u32 module_index : module_indices)
+                pipeline_factory.shader_module_trackers[module_index].push_back(new_tracker_indices[index]);
+        }
+
         pipeline_factory.dirty = false;
     }
 }
@@ -13,10 +13,12 @@
 
 namespace Reaper
 {
+struct ReaperRoot;
 struct ShaderModules;
 
-using PipelineFunctor = VkPipeline (*)(VkDevice device, const ShaderModules& shader_modules,
-                                       VkPipelineLayout pipeline_layout);
+// Called from worker threads, possibly several at once.
+using PipelineFunctor = VkPipeline (*)(VkDevice device, VkPipelineCache pipeline_cache,
+                                       const ShaderModules& shader_modules, VkPipelineLayout pipeline_layout);
 
 struct PipelineCreator
 {
@@ -27,27 +29,49 @@ struct PipelineCreator
 struct PipelineTracker
 {
     PipelineCreator creator;
-    u32             loaded_version;
+    u32             loaded_version; // Bumped every time the pipeline gets rebuilt
     u32             pipeline_index;
 
     static constexpr u32 InvalidIndex = 0xffffffff;
 };
 
+// Replaced pipelines stay alive until the last frame that could use them is done on the GPU.
+struct RetiredPipeline
+{
+    VkPipeline pipeline;
+    u64        frame_index;
+};
+
+struct PipelineRebuild;
+
 struct PipelineFactory
 {
     std::vector<PipelineTracker> trackers;
     std::vector<VkPipeline>      pipelines;
+    VkPipelineCache              pipeline_cache; // Shared by every pipeline, Vulkan synchronizes it internally
     bool                         dirty;
+
+    // Indexed by shader module, trackers whose pipeline reads it
+    std::vector<std::vector<u32>> shader_module_trackers;
+
+    PipelineRebuild*             rebuild; // Pipelines being rebuilt after a shader reload, nullptr when idle
+    std::vector<RetiredPipeline> retired_pipelines;
 };
 
 struct VulkanBackend;
+// The pipeline cache is loaded from disk when it was written by the same device and driver, and saved back on destroy.
 PipelineFactory create_pipeline_factory(VulkanBackend& backend);
 void            destroy_pipeline_factory(VulkanBackend& backend, PipelineFactory& pipeline_factory);
 
 // Returns a tracker index
 u32 register_pipeline_creator(PipelineFactory& factory, const PipelineCreator& creator);
 
-void pipeline_factory_update(VulkanBackend& backend, PipelineFactory& pipeline_factory, ShaderModules& shader_modules);
+// Creates the pipelines of new trackers in parallel, the call returns once they are ready.
+// Pipelines that read a reloaded shader module get rebuilt as background jobs, the new versions are swapped in by a
+// later call once they are all done. Without job workers the rebuild runs inline in the call that starts it.
+// completed_frame_index is the last frame known to be done on the GPU.
+void pipeline_factory_update(ReaperRoot& root, VulkanBackend& backend, PipelineFactory& pipeline_factory,
+                             ShaderModules& shader_modules, u64 completed_frame_index);
 
 VkPipeline get_pipeline(const PipelineFactory& pipeline_factory, u32 pipeline_tracker_index);
 } // namespace Reaper
@@ -11,50 +11,167 @@
 #include <common/ReaperRoot.h>
 
 #include <core/Assert.h>
-#include <core/fs/FileLoading.h>
+#include <core/fs/FileWatcher.h>
 
-#include <filesystem>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <string>
 
 namespace Reaper
 {
-void create_shader_modules(ShaderModules& shader_modules, ReaperRoot& root)
+namespace
 {
-    std::filesystem::path shader_folder("build/shader/");
+    // Written by the reaper_shader_pack build target
+    constexpr const char* ShaderPackPath = "build/shader/shaders.rspv";
+
+    // Where the shader compiler writes the loose modules, pack entries are named relative to it
+    constexpr std::string_view ShaderBinaryDirectory = "build/shader";
+
+    constexpr u32 SpirvMagic = 0x07230203;
 
-    for (const auto& entry : std::filesystem::recursive_directory_iterator(shader_folder))
+    thread_local std::vector<u32>* tls_recorded_module_indices = nullptr;
+
+    bool read_spirv_file(const std::string& file_path, std::vector<u32>& output)
     {
-        if (entry.is_regular_file() && entry.path().extension() == ".spv")
+        std::ifstream input(file_path, std::ios::in | std::ios::binary | std::ios::ate);
+
+        if (!input.is_open())
+            return false;
+
+        const std::streamoff size_bytes = input.tellg();
+
+        if (size_bytes <= 0 || size_bytes % sizeof(u32) != 0)
+            return false;
+
+        std::vector<u32> code(static_cast<size_t>(size_bytes) / sizeof(u32));
+
+        input.seekg(0, std::ios::beg);
+
+        if (!input.read(reinterpret_cast<char*>(code.data()), size_bytes) || code[0] != SpirvMagic)
+            return false;
+
+        output = std::move(code);
+
+        return true;
+    }
+
+    void watch_shader_directories(ReaperRoot& root, ShaderModules& shader_modules)
+    {
+        // Watches don't recurse, every folder holding modules gets its own
+        std::set<std::string> directories;
+
+        for (u32 entry_index = 0; entry_index < shader_modules.pack.entries.size(); entry_index++)
         {
-            std::string       file_path = entry.path().string();
-            std::string       file_name = std::filesystem::relative(entry.path(), shader_folder).generic_string();
-            std::vector<char> file_contents = readWholeFile(file_path);
+            const std::string_view name = get_shader_pack_entry_name(shader_modules.pack, entry_index);
+            const size_t           separator_position = name.rfind('/');
 
-            std::size_t offset_bytes = shader_modules.code.size();
-            std::size_t size_bytes = file_contents.size();
+            std::string directory(ShaderBinaryDirectory);
 
-            Assert(size_bytes % 4 == 0);
+            if (separator_position != std::string_view::npos)
+                directory += "/" + std::string(name.substr(0, separator_position));
 
-            shader_modules.code.insert(shader_modules.code.end(), file_contents.begin(), file_contents.end());
-            shader_modules.code_map[file_name] = ShaderModules::CodeSpan{offset_bytes, size_bytes};
+            directories.insert(directory);
+        }
 
-            log_debug(root, "shader: loaded SPIR-V file '{}' ({} bytes)", file_name, size_bytes);
+        for (const std::string& directory : directories)
+        {
+            if (!add_file_watch_directory(*shader_modules.file_watcher, directory))
+                log_debug(root, "shader: can't watch '{}', its modules won't be reloaded", directory);
         }
     }
+} // namespace
+
+void create_shader_modules(ShaderModules& shader_modules, ReaperRoot& root)
+{
+    Assert(map_file(ShaderPackPath, shader_modules.pack_file), fmt::format("could not open {}", ShaderPackPath));
+
+    const std::span<const u8> file_data(shader_modules.pack_file.data, shader_modules.pack_file.size_bytes);
+
+    Assert(get_shader_pack_view(file_data, shader_modules.pack),
+           fmt::format("{} is invalid or was written by an older packer", ShaderPackPath));
+
+    log_debug(root, "shader: mapped '{}' ({} SPIR-V modules, {} bytes)", ShaderPackPath,
+              shader_modules.pack.entries.size(), file_data.size());
+
+    shader_modules.file_watcher = create_file_watcher();
+    shader_modules.reloaded_code.resize(shader_modules.pack.entries.size());
+
+    watch_shader_directories(root, shader_modules);
 }
 
 void destroy_shader_modules(ShaderModules& shader_modules)
 {
+    destroy_file_watcher(shader_modules.file_watcher);
+    unmap_file(shader_modules.pack_file);
+
     shader_modules = {};
 }
 
 std::span<const u32> get_spirv_shader_module(const ShaderModules& shader_modules, const char* file_name)
 {
-    auto it = shader_modules.code_map.find(file_name);
-    Assert(it != shader_modules.code_map.end());
+    const u32 module_index = find_shader_pack_entry_index(shader_modules.pack, file_name);
+    Assert(module_index != ShaderPackInvalidEntryIndex, fmt::format("shader pack has no module named '{}'", file_name));
+
+    if (tls_recorded_module_indices)
+        tls_recorded_module_indices->push_back(module_index);
+
+    const std::vector<u32>& reloaded_code = shader_modules.reloaded_code[module_index];
+
+    if (!reloaded_code.empty())
+        return reloaded_code;
+
+    return get_shader_pack_entry_code(shader_modules.pack, module_index);
+}
+
+void reload_shader_modules(ReaperRoot& root, ShaderModules& shader_modules, std::vector<u32>& output_module_indices)
+{
+    std::vector<std::string> file_paths;
+    poll_file_watcher(*shader_modules.file_watcher, file_paths);
+
+    // Compilers can write the same file more than once
+    std::sort(file_paths.begin(), file_paths.end());
+    file_paths.erase(std::unique(file_paths.begin(), file_paths.end()), file_paths.end());
+
+    for (const std::string& file_path : file_paths)
+    {
+        if (!file_path.ends_with(".spv"))
+            continue;
 
-    const ShaderModules::CodeSpan& span = it->second;
-    const u32*                     ptr = reinterpret_cast<const u32*>(shader_modules.code.data() + span.offset_bytes);
+        const std::string_view name = std::string_view(file_path).substr(ShaderBinaryDirectory.size() + 1);
+        const u32              module_index = find_shader_pack_entry_index(shader_modules.pack, name);
+
+        if (module_index == ShaderPackInvalidEntryIndex)
+        {
+            log_debug(root, "shader: '{}' is not in the pack, restart to use it", name);
+            continue;
+        }
+
+        if (!read_spirv_file(file_path, shader_modules.reloaded_code[module_index]))
+        {
+            log_warning(root, "shader: could not reload '{}', keeping the previous version", file_path);
+            continue;
+        }
+
+        log_info(root, "shader: reloaded '{}'", name);
+
+        output_module_indices.push_back(module_index);
+    }
+}
+
+void begin_shader_module_dependency_recording(std::vector<u32>& output_module_indices)
+{
+    Assert(tls_recorded_module_indices == nullptr);
+
+    tls_recorded_module_indices = &output_module_indices;
+}
+
+void end_shader_module_dependency_recording()
+{
+    Assert(tls_recorded_module_indices != nullptr);
 
-    return std::span<const u32>(ptr, span.size_bytes / sizeof(u32));
+    tls_recorded_module_indices = nullptr;
 }
 } // namespace Reaper
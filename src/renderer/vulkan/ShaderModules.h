@@ -7,26 +7,28 @@
 
 #pragma once
 
-#include <unordered_map>
-#include <vulkan_loader/Vulkan.h>
+#include "renderer/ShaderPack.h"
+
+#include <core/fs/MappedFile.h>
 
 #include <span>
-#include <unordered_map>
 #include <vector>
 
 namespace Reaper
 {
+struct FileWatcher;
+
+// All SPIR-V modules come from the shader pack written at build time, see ShaderPack.h.
+// The pack stays mapped, modules are handed out in place.
+// The loose .spv files the pack was built from are watched, rebuilding a shader replaces its module without
+// touching the pack.
 struct ShaderModules
 {
-    struct CodeSpan
-    {
-        std::size_t offset_bytes;
-        std::size_t size_bytes;
-    };
-
-    // All spans refer to this vector
-    std::vector<char>                         code;
-    std::unordered_map<std::string, CodeSpan> code_map;
+    MappedFile     pack_file;
+    ShaderPackView pack;
+
+    FileWatcher*                  file_watcher;
+    std::vector<std::vector<u32>> reloaded_code; // Indexed like pack.entries, empty until the module gets reloaded
 };
 
 struct ReaperRoot;
@@ -35,4 +37,13 @@ void create_shader_modules(ShaderModules& shader_modules, ReaperRoot& root);
 void destroy_shader_modules(ShaderModules& shader_modules);
 
 std::span<const u32> get_spirv_shader_module(const ShaderModules& shader_modules, const char* file_name);
+
+// Picks up the modules that were rebuilt since the last call and appends their indices.
+// Spans returned before are invalidated, nothing should be reading modules on other threads.
+void reload_shader_modules(ReaperRoot& root, ShaderModules& shader_modules, std::vector<u32>& output_module_indices);
+
+// Pipeline creation functions only know modules by name, this records which ones get read on the calling thread
+// so that the pipelines can be rebuilt when one of them is reloaded.
+void begin_shader_module_dependency_recording(std::vector<u32>& output_module_indices);
+void end_shader_module_dependency_recording();
 } // namespace Reaper
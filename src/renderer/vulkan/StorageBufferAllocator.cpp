@@ -11,18 +11,27 @@
 #include "Debug.h"
 #include "api/AssertHelper.h"
 
+#include <core/memory/Allocator.h>
+
+#include <algorithm>
+
 namespace Reaper
 {
 StorageBufferAllocator create_storage_buffer_allocator(VulkanBackend& backend, const char* debug_name, u64 size_bytes)
 {
     // NOTE: We rely on passing 1 byte as the element size to simplify math.
-    GPUBufferProperties properties = DefaultGPUBufferProperties(size_bytes, 1, GPUBufferUsage::StorageBuffer);
+    GPUBufferProperties properties =
+        DefaultGPUBufferProperties(size_bytes, 1,
+                                   GPUBufferUsage::StorageBuffer | GPUBufferUsage::UniformBuffer
+                                       | GPUBufferUsage::TransferSrc);
 
     const VkBufferCreateInfo buffer_create_info = {.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
                                                    .pNext = nullptr,
                                                    .flags = VK_FLAGS_NONE,
                                                    .size = size_bytes,
-                                                   .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                                   .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+                                                            | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT
+                                                            | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
                                                    .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
                                                    .queueFamilyIndexCount = 0,
                                                    .pQueueFamilyIndices = nullptr};
@@ -50,6 +59,8 @@ StorageBufferAllocator create_storage_buffer_allocator(VulkanBackend& backend, c
 
     VulkanSetDebugName(backend.device, buffer, debug_name);
 
+    const VkPhysicalDeviceLimits& limits = backend.physical_device.properties.limits;
+
     return StorageBufferAllocator{
         .buffer =
             {
@@ -58,6 +69,7 @@ StorageBufferAllocator create_storage_buffer_allocator(VulkanBackend& backend, c
                 .properties_deprecated = properties,
             },
         .properties = properties,
+        .alignment_bytes = std::max(limits.minStorageBufferOffsetAlignment, limits.minUniformBufferOffsetAlignment),
         .current_offset_bytes = 0,
         .mapped_ptr = allocation_info.pMappedData,
     };
@@ -70,8 +82,8 @@ void destroy_storage_buffer_allocator(VulkanBackend& backend, StorageBufferAlloc
 
 StorageBufferAlloc allocate_storage(StorageBufferAllocator& allocator, u64 size_bytes)
 {
-    const u64 current_offset = allocator.current_offset_bytes;
-    allocator.current_offset_bytes += size_bytes;
+    const u64 current_offset = alignOffset(allocator.current_offset_bytes, allocator.alignment_bytes);
+    allocator.current_offset_bytes = current_offset + size_bytes;
 
     Assert(allocator.current_offset_bytes
            < allocator.properties.element_count * allocator.properties.element_size_bytes); // OOM
@@ -95,18 +107,12 @@ void upload_storage_buffer(const StorageBufferAllocator& storage_allocator,
 
 void storage_allocator_commit_to_gpu(VulkanBackend& backend, StorageBufferAllocator& storage_allocator)
 {
-    VmaAllocationInfo allocation_info;
-    vmaGetAllocationInfo(backend.vma_instance, storage_allocator.buffer.allocation, &allocation_info);
-
-    const VkMappedMemoryRange range = {
-        .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
-        .pNext = nullptr,
-        .memory = allocation_info.deviceMemory,
-        .offset = allocation_info.offset,
-        .size = VK_WHOLE_SIZE,
-    };
-
-    vkInvalidateMappedMemoryRanges(backend.device, 1, &range);
+    // CPU writes have to be flushed, not invalidated
+    if (storage_allocator.current_offset_bytes > 0)
+    {
+        AssertVk(vmaFlushAllocation(backend.vma_instance, storage_allocator.buffer.allocation, 0,
+                                    storage_allocator.current_offset_bytes));
+    }
 
     // Clear allocator offset
     storage_allocator.current_offset_bytes = 0;
@@ -11,10 +11,13 @@
 
 namespace Reaper
 {
+// Linear allocator for data the CPU writes every frame.
+// Allocations can be bound as storage or uniform buffers, or used as a copy source.
 struct StorageBufferAllocator
 {
     GPUBuffer           buffer;
     GPUBufferProperties properties;
+    u64                 alignment_bytes;
     u64                 current_offset_bytes;
     void*               mapped_ptr;
 };
@@ -31,8 +34,6 @@ struct StorageBufferAlloc
     u64      size_bytes;
 };
 
-// FIXME Alignment is not handled at all at this time
-// You should get a validation error when we need to properly support this
 StorageBufferAlloc allocate_storage(StorageBufferAllocator& allocator, u64 size_bytes);
 
 void upload_storage_buffer(const StorageBufferAllocator& storage_allocator,
@@ -7,11 +7,8 @@
 
 #include "TextureLoadingDDS.h"
 
-#include "Backend.h"
-#include "Image.h"
-#include "MaterialResources.h"
-
 #include <core/Assert.h>
+#include <profiling/Scope.h>
 
 #define TINYDDSLOADER_IMPLEMENTATION
 #include <tinyddsloader.h>
@@ -62,11 +59,10 @@ namespace
 
 } // namespace
 
-// Opens a texture file on the CPU, copies all regions to a single staging buffer and record the copy commands for
-// the next steps.
-StagingEntry copy_texture_to_staging_area_dds(VulkanBackend& backend, ResourceStagingArea& staging,
-                                              const char* file_path)
+DecodedTexture decode_texture_dds(const char* file_path)
 {
+    REAPER_PROFILE_SCOPE_FUNC();
+
     tinyddsloader::DDSFile dds;
 
     auto ret = dds.Load(file_path);
@@ -82,14 +78,12 @@ StagingEntry copy_texture_to_staging_area_dds(VulkanBackend& backend, ResourceSt
 
     const PixelFormat pixel_format = get_dds_pixel_format(dds.GetFormat());
 
-    GPUTextureProperties properties = default_texture_properties(
-        dds.GetWidth(), dds.GetHeight(), pixel_format, GPUTextureUsage::TransferDst | GPUTextureUsage::Sampled);
-    properties.depth = dds.GetDepth();
-    properties.mip_count = mip_count;
-    properties.layer_count = layer_count;
-
-    const u32 copy_count = mip_count * layer_count;
-    const u32 command_offset = static_cast<u32>(staging.bufferCopyRegions.size());
+    DecodedTexture decoded_texture = {};
+    decoded_texture.properties = default_texture_properties(dds.GetWidth(), dds.GetHeight(), pixel_format,
+                                                            GPUTextureUsage::TransferDst | GPUTextureUsage::Sampled);
+    decoded_texture.properties.depth = dds.GetDepth();
+    decoded_texture.properties.mip_count = mip_count;
+    decoded_texture.properties.layer_count = layer_count;
 
     for (uint32_t arrayIdx = 0; arrayIdx < layer_count; arrayIdx++)
     {
@@ -97,38 +91,25 @@ StagingEntry copy_texture_to_staging_area_dds(VulkanBackend& backend, ResourceSt
         {
             const auto* imageData = dds.GetImageData(mipIdx, arrayIdx);
 
-            const void* input_data_ptr = imageData->m_mem;
-            const u32   size_bytes = imageData->m_memSlicePitch;
-
-            upload_buffer_data(backend.device, backend.vma_instance, staging.staging_buffer, staging.buffer_properties,
-                               input_data_ptr, size_bytes, staging.offset_bytes);
+            const u8* input_data_ptr = static_cast<const u8*>(imageData->m_mem);
+            const u32 size_bytes = imageData->m_memSlicePitch;
 
-            const GPUTextureSubresource subresource = default_texture_subresource_one_color_mip(mipIdx, arrayIdx);
+            decoded_texture.mips.push_back(DecodedTextureMip{
+                .mip_index = mipIdx,
+                .layer_index = arrayIdx,
+                .width = imageData->m_width,
+                .height = imageData->m_height,
+                .depth = imageData->m_depth,
+                .offset_bytes = decoded_texture.data.size(),
+                .size_bytes = size_bytes,
+            });
 
-            // Setup a buffer image copy structure for the current mip level
-            staging.bufferCopyRegions.emplace_back(VkBufferImageCopy2{
-                .sType = VK_STRUCTURE_TYPE_BUFFER_IMAGE_COPY_2,
-                .pNext = nullptr,
-                .bufferOffset = staging.offset_bytes,
-                .bufferRowLength = 0,
-                .bufferImageHeight = 0,
-                .imageSubresource = get_vk_image_subresource_layers(subresource),
-                .imageOffset = {.x = 0, .y = 0, .z = 0},
-                .imageExtent = {
-                    .width = imageData->m_width, .height = imageData->m_height, .depth = imageData->m_depth}});
-
-            // Keep track of offset
-            staging.offset_bytes += size_bytes;
-
-            Assert(staging.offset_bytes < staging.buffer_properties.element_count, "OOB");
+            decoded_texture.data.insert(decoded_texture.data.end(), input_data_ptr, input_data_ptr + size_bytes);
         }
     }
 
-    return StagingEntry{
-        .texture_properties = properties,
-        .copy_command_offset = command_offset,
-        .copy_command_count = copy_count,
-        .target = VK_NULL_HANDLE, // FIXME
-    };
+    sort_decoded_texture_mips_tail_first(decoded_texture);
+
+    return decoded_texture;
 }
 } // namespace Reaper
@@ -7,10 +7,10 @@
 
 #pragma once
 
-#include "MaterialResources.h"
+#include "renderer/texture/TextureStreaming.h"
 
 namespace Reaper
 {
-StagingEntry copy_texture_to_staging_area_dds(VulkanBackend& backend, ResourceStagingArea& staging,
-                                              const char* file_path);
+// Doesn't touch any GPU state, safe to call from worker threads.
+DecodedTexture decode_texture_dds(const char* file_path);
 }
@@ -7,11 +7,8 @@
 
 #include "TextureLoadingPNG.h"
 
-#include "Backend.h"
-#include "Image.h"
-#include "MaterialResources.h"
-
 #include <core/Assert.h>
+#include <profiling/Scope.h>
 
 #include <fmt/format.h>
 #include <lodepng.h>
@@ -24,11 +21,10 @@ enum class PNGMode
     RGBA,
 };
 
-// Opens a texture file on the CPU, copies all regions to a single staging buffer and record the copy commands for
-// the next steps.
-StagingEntry copy_texture_to_staging_area_png(VulkanBackend& backend, ResourceStagingArea& staging,
-                                              const char* file_path, bool is_srgb)
+DecodedTexture decode_texture_png(const char* file_path, bool is_srgb)
 {
+    REAPER_PROFILE_SCOPE_FUNC();
+
     u32         error = 0;
     u8*         png_image_ptr = 0;
     u32         width = 0;
@@ -55,40 +51,25 @@ StagingEntry copy_texture_to_staging_area_png(VulkanBackend& backend, ResourceSt
 
     Assert(!error, fmt::format("error {}: {}", error, lodepng_error_text(error)));
 
-    GPUTextureProperties properties = default_texture_properties(
-        width, height, pixel_format, GPUTextureUsage::TransferDst | GPUTextureUsage::Sampled);
-    properties.misc_flags = GPUTextureMisc::LinearTiling;
-
-    upload_buffer_data(backend.device, backend.vma_instance, staging.staging_buffer, staging.buffer_properties,
-                       png_image_ptr, size_bytes, staging.offset_bytes);
-
-    const GPUTextureSubresource subresource = default_texture_subresource_one_color_mip();
-
-    const u32 command_offset = static_cast<u32>(staging.bufferCopyRegions.size());
-
-    // Setup a buffer image copy structure for the current mip level
-    staging.bufferCopyRegions.emplace_back(
-        VkBufferImageCopy2{.sType = VK_STRUCTURE_TYPE_BUFFER_IMAGE_COPY_2,
-                           .pNext = nullptr,
-                           .bufferOffset = staging.offset_bytes,
-                           .bufferRowLength = 0,
-                           .bufferImageHeight = 0,
-                           .imageSubresource = get_vk_image_subresource_layers(subresource),
-                           .imageOffset = {.x = 0, .y = 0, .z = 0},
-                           .imageExtent = {.width = width, .height = height, .depth = 1}});
+    DecodedTexture decoded_texture = {};
+    decoded_texture.properties = default_texture_properties(width, height, pixel_format,
+                                                            GPUTextureUsage::TransferDst | GPUTextureUsage::Sampled);
+    decoded_texture.properties.misc_flags = GPUTextureMisc::LinearTiling;
 
-    // Keep track of offset
-    staging.offset_bytes += size_bytes;
+    decoded_texture.mips.push_back(DecodedTextureMip{
+        .mip_index = 0,
+        .layer_index = 0,
+        .width = width,
+        .height = height,
+        .depth = 1,
+        .offset_bytes = 0,
+        .size_bytes = size_bytes,
+    });
 
-    Assert(staging.offset_bytes < staging.buffer_properties.element_count, "OOB");
+    decoded_texture.data.assign(png_image_ptr, png_image_ptr + size_bytes);
 
     free(png_image_ptr);
 
-    return StagingEntry{
-        .texture_properties = properties,
-        .copy_command_offset = command_offset,
-        .copy_command_count = 1,
-        .target = VK_NULL_HANDLE, // FIXME
-    };
+    return decoded_texture;
 }
 } // namespace Reaper
@@ -20,6 +20,7 @@
 #include "renderer/vulkan/Pipeline.h"
 #include "renderer/vulkan/PipelineFactory.h"
 #include "renderer/vulkan/ShaderModules.h"
+#include "renderer/vulkan/StorageBufferAllocator.h"
 #include "renderer/vulkan/api/AssertHelper.h"
 
 #include "renderer/graph/FrameGraphBuilder.h"
@@ -37,8 +38,8 @@ namespace Reaper
 {
 namespace
 {
-    VkPipeline create_audio_pipeline(VkDevice device, const ShaderModules& shader_modules,
-                                     VkPipelineLayout pipeline_layout)
+    VkPipeline create_audio_pipeline(VkDevice device, VkPipelineCache pipeline_cache,
+                                     const ShaderModules& shader_modules, VkPipelineLayout pipeline_layout)
     {
         const VkShaderModuleCreateInfo module_create_info =
             shader_module_create_info(get_spirv_shader_module(shader_modules, "sound/oscillator.comp.spv"));
@@ -46,7 +47,7 @@ namespace
         const VkPipelineShaderStageCreateInfo shader_stage =
             default_pipeline_shader_stage_create_info(VK_SHADER_STAGE_COMPUTE_BIT, &module_create_info);
 
-        return create_compute_pipeline(device, pipeline_layout, shader_stage);
+        return create_compute_pipeline(device, pipeline_cache, pipeline_layout, shader_stage);
     }
 } // namespace
 
@@ -77,17 +78,18 @@ AudioResources create_audio_resources(VulkanBackend& backend, PipelineFactory& p
                                                              });
     }
 
-    resources.instance_buffer = create_buffer(
-        backend.device, "Audio instance constant buffer",
-        DefaultGPUBufferProperties(OscillatorCount, sizeof(OscillatorInstance), GPUBufferUsage::StorageBuffer),
-        backend.vma_instance, MemUsage::CPU_To_GPU);
-
     resources.audio_staging_properties = DefaultGPUBufferProperties(FrameCountPerGroup * FrameCountPerDispatch,
                                                                     sizeof(RawSample), GPUBufferUsage::TransferDst);
 
-    resources.audio_staging_buffer =
-        create_buffer(backend.device, "Output sample buffer staging", resources.audio_staging_properties,
-                      backend.vma_instance, MemUsage::GPU_To_CPU);
+    for (u32 staging_index = 0; staging_index < MaxFramesInFlight; staging_index++)
+    {
+        resources.audio_staging_buffers[staging_index] =
+            create_buffer(backend.device, "Output sample buffer staging", resources.audio_staging_properties,
+                          backend.vma_instance, MemUsage::GPU_To_CPU);
+    }
+
+    resources.audio_staging_frame_indices = {};
+    resources.last_read_frame_index = 0;
 
     Assert(SampleSizeInBytes == sizeof(RawSample));
 
@@ -106,9 +108,6 @@ AudioResources create_audio_resources(VulkanBackend& backend, PipelineFactory& p
 
     vkCreateSemaphore(backend.device, &createInfo, NULL, &resources.semaphore);
 
-    allocate_descriptor_sets(backend.device, backend.global_descriptor_pool, std::span(&resources.descSetLayout, 1),
-                             std::span(&resources.descriptor_set, 1));
-
     resources.current_frame = 0;
 
     return resources;
@@ -116,9 +115,8 @@ AudioResources create_audio_resources(VulkanBackend& backend, PipelineFactory& p
 
 void destroy_audio_resources(VulkanBackend& backend, AudioResources& resources)
 {
-    vmaDestroyBuffer(backend.vma_instance, resources.instance_buffer.handle, resources.instance_buffer.allocation);
-    vmaDestroyBuffer(backend.vma_instance, resources.audio_staging_buffer.handle,
-                     resources.audio_staging_buffer.allocation);
+    for (const GPUBuffer& staging_buffer : resources.audio_staging_buffers)
+        vmaDestroyBuffer(backend.vma_instance, staging_buffer.handle, staging_buffer.allocation);
 
     vkDestroyPipelineLayout(backend.device, resources.pipelineLayout, nullptr);
     vkDestroyDescriptorSetLayout(backend.device, resources.descSetLayout, nullptr);
@@ -152,22 +150,26 @@ AudioFrameGraphRecord create_audio_frame_graph_record(FrameGraph::Builder& build
     };
 }
 
-void update_audio_render_resources(VulkanBackend& backend, const FrameGraph::FrameGraph& frame_graph,
-                                   const FrameGraphResources&   frame_graph_resources,
+void update_audio_render_resources(const FrameGraph::FrameGraph& frame_graph,
+                                   const FrameGraphResources&    frame_graph_resources,
                                    const AudioFrameGraphRecord& record, DescriptorWriteHelper& write_helper,
-                                   const PreparedData& prepared, const AudioResources& resources)
+                                   StorageBufferAllocator& frame_storage_allocator, const PreparedData& prepared,
+                                   AudioResources& resources)
 {
     REAPER_PROFILE_SCOPE_FUNC();
 
-    upload_buffer_data_deprecated(backend.device, backend.vma_instance, resources.instance_buffer,
-                                  prepared.audio_instance_params.data(),
-                                  prepared.audio_instance_params.size() * sizeof(OscillatorInstance));
+    const StorageBufferAlloc instance_alloc = allocate_storage(
+        frame_storage_allocator, prepared.audio_instance_params.size() * sizeof(OscillatorInstance));
+
+    upload_storage_buffer(frame_storage_allocator, instance_alloc, prepared.audio_instance_params.data());
 
     const FrameGraphBuffer audio_buffer =
         get_frame_graph_buffer(frame_graph_resources, frame_graph, record.render.audio_buffer);
 
-    write_helper.append(resources.descriptor_set, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                        resources.instance_buffer.handle);
+    resources.descriptor_set = write_helper.allocate_descriptor_set(resources.descSetLayout);
+
+    write_helper.append(resources.descriptor_set, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, instance_alloc.buffer,
+                        instance_alloc.offset_bytes, instance_alloc.size_bytes);
     write_helper.append(resources.descriptor_set, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, audio_buffer.handle);
 }
 
@@ -190,24 +192,12 @@ void record_audio_render_command_buffer(const FrameGraphHelper&              fra
                        sizeof(SoundPushConstants), &prepared.audio_push_constants);
 
     vkCmdDispatch(cmdBuffer.handle, FrameCountPerDispatch, 1, 1);
-
-    {
-        const GPUBufferAccess src = {VK_PIPELINE_STAGE_2_HOST_BIT, VK_ACCESS_2_HOST_READ_BIT};
-        const GPUBufferAccess dst = {VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT};
-        const GPUBufferView   view = default_buffer_view(resources.audio_staging_properties);
-
-        const VkBufferMemoryBarrier2 buffer_barrier =
-            get_vk_buffer_barrier(resources.audio_staging_buffer.handle, view, src, dst);
-
-        const VkDependencyInfo dependencies = get_vk_buffer_barrier_depency_info(std::span(&buffer_barrier, 1));
-
-        vkCmdPipelineBarrier2(cmdBuffer.handle, &dependencies);
-    }
 }
 
 void record_audio_copy_command_buffer(const FrameGraphHelper&                   frame_graph_helper,
                                       const AudioFrameGraphRecord::StagingCopy& pass_record,
                                       CommandBuffer&                            cmdBuffer,
+                                      u64                                       frame_index,
                                       AudioResources&                           resources)
 {
     REAPER_GPU_SCOPE(cmdBuffer, "Audio Staging Copy");
@@ -217,6 +207,22 @@ void record_audio_copy_command_buffer(const FrameGraphHelper&
     const FrameGraphBuffer audio_buffer =
         get_frame_graph_buffer(frame_graph_helper.resources, frame_graph_helper.frame_graph, pass_record.audio_buffer);
 
+    const u32           staging_index = static_cast<u32>(frame_index % MaxFramesInFlight);
+    const GPUBuffer&    staging_buffer = resources.audio_staging_buffers[staging_index];
+    const GPUBufferView staging_view = default_buffer_view(resources.audio_staging_properties);
+
+    {
+        const GPUBufferAccess src = {VK_PIPELINE_STAGE_2_HOST_BIT, VK_ACCESS_2_HOST_READ_BIT};
+        const GPUBufferAccess dst = {VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT};
+
+        const VkBufferMemoryBarrier2 buffer_barrier =
+            get_vk_buffer_barrier(staging_buffer.handle, staging_view, src, dst);
+
+        const VkDependencyInfo dependencies = get_vk_buffer_barrier_depency_info(std::span(&buffer_barrier, 1));
+
+        vkCmdPipelineBarrier2(cmdBuffer.handle, &dependencies);
+    }
+
     const VkBufferCopy2 region = {
         .sType = VK_STRUCTURE_TYPE_BUFFER_COPY_2,
         .pNext = nullptr,
@@ -229,20 +235,21 @@ void record_audio_copy_command_buffer(const FrameGraphHelper&
         .sType = VK_STRUCTURE_TYPE_COPY_BUFFER_INFO_2,
         .pNext = nullptr,
         .srcBuffer = audio_buffer.handle,
-        .dstBuffer = resources.audio_staging_buffer.handle,
+        .dstBuffer = staging_buffer.handle,
         .regionCount = 1,
         .pRegions = &region,
     };
 
     vkCmdCopyBuffer2(cmdBuffer.handle, &copy);
 
+    resources.audio_staging_frame_indices[staging_index] = frame_index;
+
     {
         const GPUBufferAccess src = {VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT};
         const GPUBufferAccess dst = {VK_PIPELINE_STAGE_2_HOST_BIT, VK_ACCESS_2_HOST_READ_BIT};
-        const GPUBufferView   view = default_buffer_view(resources.audio_staging_properties);
 
         const VkBufferMemoryBarrier2 buffer_barrier =
-            get_vk_buffer_barrier(resources.audio_staging_buffer.handle, view, src, dst);
+            get_vk_buffer_barrier(staging_buffer.handle, staging_view, src, dst);
 
         const VkDependencyInfo dependencies = get_vk_buffer_barrier_depency_info(std::span(&buffer_barrier, 1));
 
@@ -250,7 +257,7 @@ void record_audio_copy_command_buffer(const FrameGraphHelper&
     }
 }
 
-void read_gpu_audio_data(VulkanBackend& backend, AudioResources& resources)
+void read_gpu_audio_data(VulkanBackend& backend, AudioResources& resources, u64 completed_frame_index)
 {
     // u64                 wait_value = 1;
     // VkSemaphoreWaitInfo wait_semaphore = {VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
@@ -264,33 +271,31 @@ void read_gpu_audio_data(VulkanBackend& backend, AudioResources& resources)
     // VkResult result = vkWaitSemaphores(backend.device, &wait_semaphore, timeout_us);
     // Assert(result == VK_SUCCESS);
 
-    VmaAllocationInfo allocation_info;
-    vmaGetAllocationInfo(backend.vma_instance, resources.audio_staging_buffer.allocation, &allocation_info);
+    // Pick the newest copy done by a frame the GPU completed
+    u32 staging_index = MaxFramesInFlight;
 
-    const u32 audio_buffer_offset = static_cast<u32>(allocation_info.offset);
-    const u32 audio_buffer_size = FrameCountPerGroup * FrameCountPerDispatch * sizeof(RawSample);
-    void*     mapped_data_ptr = nullptr;
+    for (u32 index = 0; index < MaxFramesInFlight; index++)
+    {
+        const u64 staging_frame_index = resources.audio_staging_frame_indices[index];
 
-    Assert(audio_buffer_offset % backend.physical_device.properties.limits.nonCoherentAtomSize == 0);
-    Assert(audio_buffer_size % backend.physical_device.properties.limits.nonCoherentAtomSize == 0);
-    AssertVk(vkMapMemory(backend.device, allocation_info.deviceMemory, audio_buffer_offset, audio_buffer_size, 0,
-                         &mapped_data_ptr));
+        if (staging_frame_index > resources.last_read_frame_index && staging_frame_index <= completed_frame_index)
+        {
+            resources.last_read_frame_index = staging_frame_index;
+            staging_index = index;
+        }
+    }
 
-    const VkMappedMemoryRange staging_range = {
-        .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
-        .pNext = nullptr,
-        .memory = allocation_info.deviceMemory,
-        .offset = allocation_info.offset,
-        .size = allocation_info.size,
-    };
+    resources.frame_audio_data.clear();
 
-    vkInvalidateMappedMemoryRanges(backend.device, 1, &staging_range);
+    if (staging_index == MaxFramesInFlight)
+        return;
+
+    const MappedBufferView audio_staging =
+        get_mapped_buffer_view(backend.vma_instance, resources.audio_staging_buffers[staging_index]);
+    const u32 audio_buffer_size = FrameCountPerGroup * FrameCountPerDispatch * sizeof(RawSample);
 
-    Assert(mapped_data_ptr);
-    std::vector<u8> mapped_data_vector(static_cast<u8*>(mapped_data_ptr),
-                                       static_cast<u8*>(mapped_data_ptr) + audio_buffer_size);
-    resources.frame_audio_data = mapped_data_vector; // Deep copy
+    invalidate_mapped_buffer_range(backend.vma_instance, audio_staging, 0, audio_buffer_size);
 
-    vkUnmapMemory(backend.device, allocation_info.deviceMemory);
+    resources.frame_audio_data.assign(audio_staging.data, audio_staging.data + audio_buffer_size); // Deep copy
 }
 } // namespace Reaper
@@ -9,8 +9,10 @@
 
 #include "renderer/graph/FrameGraphBasicTypes.h"
 #include "renderer/vulkan/Buffer.h"
+#include "renderer/vulkan/FrameSync.h"
 #include <vulkan_loader/Vulkan.h>
 
+#include <array>
 #include <vector>
 
 namespace Reaper
@@ -21,9 +23,11 @@ struct AudioResources
     VkPipelineLayout      pipelineLayout;
     VkDescriptorSetLayout descSetLayout;
 
-    GPUBuffer           instance_buffer;
-    GPUBuffer           audio_staging_buffer;
-    GPUBufferProperties audio_staging_properties;
+    // Each frame in flight copies to its own staging buffer so the CPU never reads one the GPU is writing to
+    std::array<GPUBuffer, MaxFramesInFlight> audio_staging_buffers;
+    std::array<u64, MaxFramesInFlight>       audio_staging_frame_indices; // 0 when never written
+    u64                                      last_read_frame_index;
+    GPUBufferProperties                      audio_staging_properties;
 
     VkDescriptorSet descriptor_set;
 
@@ -79,11 +83,13 @@ AudioFrameGraphRecord create_audio_frame_graph_record(FrameGraph::Builder& build
 class DescriptorWriteHelper;
 struct FrameGraphResources;
 struct PreparedData;
+struct StorageBufferAllocator;
 
-void update_audio_render_resources(VulkanBackend& backend, const FrameGraph::FrameGraph& frame_graph,
-                                   const FrameGraphResources&   frame_graph_resources,
+void update_audio_render_resources(const FrameGraph::FrameGraph& frame_graph,
+                                   const FrameGraphResources&    frame_graph_resources,
                                    const AudioFrameGraphRecord& record, DescriptorWriteHelper& write_helper,
-                                   const PreparedData& prepared, const AudioResources& resources);
+                                   StorageBufferAllocator& frame_storage_allocator, const PreparedData& prepared,
+                                   AudioResources& resources);
 
 struct CommandBuffer;
 struct FrameGraphHelper;
@@ -96,7 +102,9 @@ void record_audio_render_command_buffer(const FrameGraphHelper&              fra
 void record_audio_copy_command_buffer(const FrameGraphHelper&                   frame_graph_helper,
                                       const AudioFrameGraphRecord::StagingCopy& pass_record,
                                       CommandBuffer&                            cmdBuffer,
+                                      u64                                       frame_index,
                                       AudioResources&                           resources);
 
-void read_gpu_audio_data(VulkanBackend& backend, AudioResources& resources);
+// Reads the samples of the newest frame the GPU completed, frame_audio_data is left empty when there's none.
+void read_gpu_audio_data(VulkanBackend& backend, AudioResources& resources, u64 completed_frame_index);
 } // namespace Reaper
@@ -25,6 +25,7 @@
 #include "renderer/vulkan/RenderPassHelpers.h"
 #include "renderer/vulkan/SamplerResources.h"
 #include "renderer/vulkan/ShaderModules.h"
+#include "renderer/vulkan/StorageBufferAllocator.h"
 
 #include "renderer/PrepareBuckets.h"
 
@@ -46,8 +47,8 @@ constexpr u32 MaxVertexCount = MaxIndexCount * 3;
 
 namespace
 {
-    VkPipeline create_build_cmds_pipeline(VkDevice device, const ShaderModules& shader_modules,
-                                          VkPipelineLayout pipeline_layout)
+    VkPipeline create_build_cmds_pipeline(VkDevice device, VkPipelineCache pipeline_cache,
+                                          const ShaderModules& shader_modules, VkPipelineLayout pipeline_layout)
     {
         const VkShaderModuleCreateInfo module_create_info =
             shader_module_create_info(get_spirv_shader_module(shader_modules, "debug_geometry/build_cmds.comp.spv"));
@@ -55,11 +56,11 @@ namespace
         VkPipelineShaderStageCreateInfo shader_stage =
             default_pipeline_shader_stage_create_info(VK_SHADER_STAGE_COMPUTE_BIT, &module_create_info);
 
-        return create_compute_pipeline(device, pipeline_layout, shader_stage);
+        return create_compute_pipeline(device, pipeline_cache, pipeline_layout, shader_stage);
     }
 
-    VkPipeline create_draw_pipeline(VkDevice device, const ShaderModules& shader_modules,
-                                    VkPipelineLayout pipeline_layout)
+    VkPipeline create_draw_pipeline(VkDevice device, VkPipelineCache pipeline_cache,
+                                    const ShaderModules& shader_modules, VkPipelineLayout pipeline_layout)
     {
         const VkShaderModuleCreateInfo module_create_info_vert =
             shader_module_create_info(get_spirv_shader_module(shader_modules, "debug_geometry/draw.vert.spv"));
@@ -92,7 +93,7 @@ namespace
 
         std::vector<VkDynamicState> dynamic_states = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
 
-        return create_graphics_pipeline(device, shader_stages, pipeline_properties, dynamic_states);
+        return create_graphics_pipeline(device, pipeline_cache, shader_stages, pipeline_properties, dynamic_states);
     }
 
     void upload_debug_meshes(VulkanBackend& backend, DebugGeometryPassResources& resources,
@@ -113,11 +114,11 @@ namespace
             resources.vertex_buffer_offset += debug_mesh_alloc.vertex_count;
             resources.index_buffer_offset += debug_mesh_alloc.index_count;
 
-            upload_buffer_data(backend.device, backend.vma_instance, resources.index_buffer,
-                               resources.index_buffer_properties, mesh.indexes.data(),
-                               mesh.indexes.size() * sizeof(mesh.indexes[0]), debug_mesh_alloc.index_offset);
+            upload_buffer_data(backend.vma_instance, resources.index_buffer, resources.index_buffer_properties,
+                               mesh.indexes.data(), mesh.indexes.size() * sizeof(mesh.indexes[0]),
+                               debug_mesh_alloc.index_offset);
 
-            upload_buffer_data(backend.device, backend.vma_instance, resources.vertex_buffer_position,
+            upload_buffer_data(backend.vma_instance, resources.vertex_buffer_position,
                                resources.vertex_buffer_properties, mesh.positions.data(),
                                mesh.positions.size() * sizeof(mesh.positions.data()[0]),
                                debug_mesh_alloc.vertex_offset);
@@ -174,26 +175,6 @@ DebugGeometryPassResources create_debug_geometry_pass_resources(VulkanBackend&
                                       });
     }
 
-    std::vector<VkDescriptorSetLayout> dset_layouts = {resources.build_cmds.descriptor_set_layout,
-                                                       resources.draw.descriptor_set_layout};
-    std::vector<VkDescriptorSet>       dsets(dset_layouts.size());
-
-    allocate_descriptor_sets(backend.device, backend.global_descriptor_pool, dset_layouts, dsets);
-
-    resources.build_cmds_descriptor_set = dsets[0];
-    resources.draw_descriptor_set = dsets[1];
-
-    resources.cpu_commands_staging_buffer =
-        create_buffer(backend.device, "Debug CPU Command Buffer",
-                      DefaultGPUBufferProperties(MaxCPUDebugCommandCount, sizeof(DebugGeometryUserCommand),
-                                                 GPUBufferUsage::TransferSrc),
-                      backend.vma_instance, MemUsage::CPU_To_GPU);
-
-    resources.build_cmds_constants = create_buffer(
-        backend.device, "Debug Build Cmds Uniform Buffer",
-        DefaultGPUBufferProperties(1, sizeof(DebugGeometryBuildCmdsPassConstants), GPUBufferUsage::UniformBuffer),
-        backend.vma_instance, MemUsage::CPU_To_GPU);
-
     {
         resources.index_buffer_offset = 0;
         resources.index_buffer_properties = DefaultGPUBufferProperties(
@@ -227,10 +208,6 @@ void destroy_debug_geometry_pass_resources(VulkanBackend& backend, DebugGeometry
     vmaDestroyBuffer(backend.vma_instance, resources.vertex_buffer_position.handle,
                      resources.vertex_buffer_position.allocation);
     vmaDestroyBuffer(backend.vma_instance, resources.index_buffer.handle, resources.index_buffer.allocation);
-    vmaDestroyBuffer(backend.vma_instance, resources.build_cmds_constants.handle,
-                     resources.build_cmds_constants.allocation);
-    vmaDestroyBuffer(backend.vma_instance, resources.cpu_commands_staging_buffer.handle,
-                     resources.cpu_commands_staging_buffer.allocation);
 
     vkDestroyPipelineLayout(backend.device, resources.draw.pipeline_layout, nullptr);
     vkDestroyDescriptorSetLayout(backend.device, resources.draw.descriptor_set_layout, nullptr);
@@ -333,25 +310,34 @@ create_debug_geometry_draw_pass_record(FrameGraph::Builder&
     return record;
 }
 
-void update_debug_geometry_start_resources(VulkanBackend& backend, const PreparedData& prepared,
-                                           const DebugGeometryPassResources& resources)
+void update_debug_geometry_start_resources(StorageBufferAllocator& frame_storage_allocator,
+                                           const PreparedData& prepared, DebugGeometryPassResources& resources)
 {
     const u32 cpu_command_count = static_cast<u32>(prepared.debug_draw_commands.size());
 
+    Assert(cpu_command_count <= MaxCPUDebugCommandCount);
+
     if (cpu_command_count > 0)
     {
-        upload_buffer_data_deprecated(backend.device, backend.vma_instance, resources.cpu_commands_staging_buffer,
-                                      prepared.debug_draw_commands.data(),
-                                      cpu_command_count * sizeof(prepared.debug_draw_commands[0]));
+        resources.cpu_commands_staging_alloc =
+            allocate_storage(frame_storage_allocator, cpu_command_count * sizeof(prepared.debug_draw_commands[0]));
+
+        upload_storage_buffer(frame_storage_allocator, resources.cpu_commands_staging_alloc,
+                              prepared.debug_draw_commands.data());
     }
 }
 
-void update_debug_geometry_build_cmds_pass_resources(VulkanBackend& backend, const FrameGraph::FrameGraph& frame_graph,
+void update_debug_geometry_build_cmds_pass_resources(const FrameGraph::FrameGraph&               frame_graph,
                                                      const FrameGraphResources&                  frame_graph_resources,
                                                      const DebugGeometryComputeFrameGraphRecord& record,
-                                                     DescriptorWriteHelper& write_helper, const PreparedData& prepared,
-                                                     const DebugGeometryPassResources& resources)
+                                                     DescriptorWriteHelper& write_helper,
+                                                     StorageBufferAllocator& frame_storage_allocator,
+                                                     const PreparedData&         prepared,
+                                                     DebugGeometryPassResources& resources)
 {
+    resources.build_cmds_descriptor_set =
+        write_helper.allocate_descriptor_set(resources.build_cmds.descriptor_set_layout);
+
     DebugGeometryBuildCmdsPassConstants constants;
     constants.main_camera_ws_to_cs = prepared.forward_pass_constants.ws_to_cs_matrix;
 
@@ -367,8 +353,9 @@ void update_debug_geometry_build_cmds_pass_resources(VulkanBackend& backend, con
         out_alloc.vertex_offset = in_alloc.vertex_offset;
     }
 
-    upload_buffer_data_deprecated(backend.device, backend.vma_instance, resources.build_cmds_constants, &constants,
-                                  sizeof(constants));
+    const StorageBufferAlloc constants_alloc = allocate_storage(frame_storage_allocator, sizeof(constants));
+
+    upload_storage_buffer(frame_storage_allocator, constants_alloc, &constants);
 
     const FrameGraphBuffer draw_counter =
         get_frame_graph_buffer(frame_graph_resources, frame_graph, record.draw_counter);
@@ -380,7 +367,7 @@ void update_debug_geometry_build_cmds_pass_resources(VulkanBackend& backend, con
         get_frame_graph_buffer(frame_graph_resources, frame_graph, record.instance_buffer);
 
     write_helper.append(resources.build_cmds_descriptor_set, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-                        resources.build_cmds_constants.handle);
+                        constants_alloc.buffer, constants_alloc.offset_bytes, constants_alloc.size_bytes);
     write_helper.append(resources.build_cmds_descriptor_set, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, draw_counter.handle);
     write_helper.append(resources.build_cmds_descriptor_set, 2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
                         user_commands.handle);
@@ -394,8 +381,10 @@ void update_debug_geometry_draw_pass_descriptor_sets(const FrameGraph::FrameGrap
                                                      const FrameGraphResources&               frame_graph_resources,
                                                      const DebugGeometryDrawFrameGraphRecord& record,
                                                      DescriptorWriteHelper&                   write_helper,
-                                                     const DebugGeometryPassResources&        resources)
+                                                     DebugGeometryPassResources&              resources)
 {
+    resources.draw_descriptor_set = write_helper.allocate_descriptor_set(resources.draw.descriptor_set_layout);
+
     const FrameGraphBuffer instance_buffer =
         get_frame_graph_buffer(frame_graph_resources, frame_graph, record.instance_buffer);
 
@@ -430,15 +419,15 @@ void record_debug_geometry_start_command_buffer(const FrameGraphHelper&
         const VkBufferCopy2 region = {
             .sType = VK_STRUCTURE_TYPE_BUFFER_COPY_2,
             .pNext = nullptr,
-            .srcOffset = 0,
+            .srcOffset = resources.cpu_commands_staging_alloc.offset_bytes,
             .dstOffset = 0,
-            .size = cpu_command_count * resources.cpu_commands_staging_buffer.properties_deprecated.element_size_bytes,
+            .size = resources.cpu_commands_staging_alloc.size_bytes,
         };
 
         const VkCopyBufferInfo2 copy = {
             .sType = VK_STRUCTURE_TYPE_COPY_BUFFER_INFO_2,
             .pNext = nullptr,
-            .srcBuffer = resources.cpu_commands_staging_buffer.handle,
+            .srcBuffer = resources.cpu_commands_staging_alloc.buffer,
             .dstBuffer = user_commands_buffer.handle,
             .regionCount = 1,
             .pRegions = &region,
@@ -9,6 +9,7 @@
 
 #include "renderer/graph/FrameGraphBasicTypes.h"
 #include "renderer/vulkan/Buffer.h"
+#include "renderer/vulkan/StorageBufferAllocator.h"
 
 #include <vector>
 
@@ -44,8 +45,7 @@ struct DebugGeometryPassResources
 
     VkDescriptorSet draw_descriptor_set;
 
-    GPUBuffer cpu_commands_staging_buffer;
-    GPUBuffer build_cmds_constants;
+    StorageBufferAlloc cpu_commands_staging_alloc; // Valid for the current frame only
 
     std::vector<DebugMeshAlloc> proxy_mesh_allocs;
     u32                         index_buffer_offset;
@@ -113,20 +113,22 @@ class DescriptorWriteHelper;
 struct FrameGraphResources;
 struct PreparedData;
 
-void update_debug_geometry_start_resources(VulkanBackend& backend, const PreparedData& prepared,
-                                           const DebugGeometryPassResources& resources);
+void update_debug_geometry_start_resources(StorageBufferAllocator& frame_storage_allocator,
+                                           const PreparedData& prepared, DebugGeometryPassResources& resources);
 
-void update_debug_geometry_build_cmds_pass_resources(VulkanBackend& backend, const FrameGraph::FrameGraph& frame_graph,
+void update_debug_geometry_build_cmds_pass_resources(const FrameGraph::FrameGraph&               frame_graph,
                                                      const FrameGraphResources&                  frame_graph_resources,
                                                      const DebugGeometryComputeFrameGraphRecord& record,
-                                                     DescriptorWriteHelper& write_helper, const PreparedData& prepared,
-                                                     const DebugGeometryPassResources& resources);
+                                                     DescriptorWriteHelper& write_helper,
+                                                     StorageBufferAllocator& frame_storage_allocator,
+                                                     const PreparedData&         prepared,
+                                                     DebugGeometryPassResources& resources);
 
 void update_debug_geometry_draw_pass_descriptor_sets(const FrameGraph::FrameGraph&            frame_graph,
                                                      const FrameGraphResources&               frame_graph_resources,
                                                      const DebugGeometryDrawFrameGraphRecord& record,
                                                      DescriptorWriteHelper&                   write_helper,
-                                                     const DebugGeometryPassResources&        resources);
+                                                     DebugGeometryPassResources&              resources);
 
 struct CommandBuffer;
 struct FrameGraphHelper;
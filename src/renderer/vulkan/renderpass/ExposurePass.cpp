@@ -34,8 +34,8 @@ namespace Reaper
 {
 namespace
 {
-    VkPipeline create_exposure_reduce_pipeline(VkDevice device, const ShaderModules& shader_modules,
-                                               VkPipelineLayout pipeline_layout)
+    VkPipeline create_exposure_reduce_pipeline(VkDevice device, VkPipelineCache pipeline_cache,
+                                               const ShaderModules& shader_modules, VkPipelineLayout pipeline_layout)
     {
         const VkShaderModuleCreateInfo module_create_info_cs =
             shader_module_create_info(get_spirv_shader_module(shader_modules, "reduce_exposure.comp.spv"));
@@ -45,10 +45,11 @@ namespace
             default_pipeline_shader_stage_create_info(VK_SHADER_STAGE_COMPUTE_BIT, &module_create_info_cs, nullptr,
                                                       VK_PIPELINE_SHADER_STAGE_CREATE_ALLOW_VARYING_SUBGROUP_SIZE_BIT);
 
-        return create_compute_pipeline(device, pipeline_layout, shader_stage);
+        return create_compute_pipeline(device, pipeline_cache, pipeline_layout, shader_stage);
     }
 
-    VkPipeline create_exposure_reduce_tail_pipeline(VkDevice device, const ShaderModules& shader_modules,
+    VkPipeline create_exposure_reduce_tail_pipeline(VkDevice device, VkPipelineCache pipeline_cache,
+                                                    const ShaderModules& shader_modules,
                                                     VkPipelineLayout pipeline_layout)
     {
         const VkShaderModuleCreateInfo module_create_info_cs =
@@ -58,7 +59,7 @@ namespace
             default_pipeline_shader_stage_create_info(VK_SHADER_STAGE_COMPUTE_BIT, &module_create_info_cs, nullptr,
                                                       VK_PIPELINE_SHADER_STAGE_CREATE_ALLOW_VARYING_SUBGROUP_SIZE_BIT);
 
-        return create_compute_pipeline(device, pipeline_layout, shader_stage);
+        return create_compute_pipeline(device, pipeline_cache, pipeline_layout, shader_stage);
     }
 } // namespace
 
@@ -118,14 +119,6 @@ ExposurePassResources create_exposure_pass_resources(VulkanBackend& backend, Pip
                                       });
     }
 
-    allocate_descriptor_sets(backend.device, backend.global_descriptor_pool,
-                             std::span(&resources.reduce.descriptor_set_layout, 1),
-                             std::span(&resources.reduce.descriptor_set, 1));
-
-    allocate_descriptor_sets(backend.device, backend.global_descriptor_pool,
-                             std::span(&resources.reduce_tail.descriptor_set_layout, 1),
-                             std::span(&resources.reduce_tail.descriptor_set, 1));
-
     return resources;
 }
 
@@ -150,7 +143,7 @@ ExposureFrameGraphRecord create_exposure_pass_record(FrameGraph::Builder&
     {
         ExposureFrameGraphRecord::Reduce& reduce = exposure.reduce;
 
-        reduce.pass_handle = builder.create_render_pass("Exposure");
+        reduce.pass_handle = builder.create_render_pass("Exposure", false, FrameGraph::QueueType::AsyncCompute);
 
         reduce.scene_hdr =
             builder.read_texture(reduce.pass_handle, scene_hdr_usage_handle,
@@ -177,7 +170,8 @@ ExposureFrameGraphRecord create_exposure_pass_record(FrameGraph::Builder&
     {
         ExposureFrameGraphRecord::ReduceTail& reduce_tail = exposure.reduce_tail;
 
-        reduce_tail.pass_handle = builder.create_render_pass("Exposure Reduce Tail");
+        reduce_tail.pass_handle =
+            builder.create_render_pass("Exposure Reduce Tail", false, FrameGraph::QueueType::AsyncCompute);
 
         reduce_tail.exposure_texture =
             builder.read_texture(reduce_tail.pass_handle, exposure.reduce.exposure_texture,
@@ -215,9 +209,13 @@ ExposureFrameGraphRecord create_exposure_pass_record(FrameGraph::Builder&
 void update_exposure_pass_descriptor_set(const FrameGraph::FrameGraph&   frame_graph,
                                          const FrameGraphResources&      frame_graph_resources,
                                          const ExposureFrameGraphRecord& record, DescriptorWriteHelper& write_helper,
-                                         const ExposurePassResources& resources,
-                                         const SamplerResources&      sampler_resources)
+                                         ExposurePassResources& resources,
+                                         const SamplerResources& sampler_resources)
 {
+    resources.reduce.descriptor_set = write_helper.allocate_descriptor_set(resources.reduce.descriptor_set_layout);
+    resources.reduce_tail.descriptor_set =
+        write_helper.allocate_descriptor_set(resources.reduce_tail.descriptor_set_layout);
+
     {
         const FrameGraphTexture scene_hdr =
             get_frame_graph_texture(frame_graph_resources, frame_graph, record.reduce.scene_hdr);
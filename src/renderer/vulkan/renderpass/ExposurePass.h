@@ -76,8 +76,8 @@ struct FrameGraphResources;
 void update_exposure_pass_descriptor_set(const FrameGraph::FrameGraph&   frame_graph,
                                          const FrameGraphResources&      frame_graph_resources,
                                          const ExposureFrameGraphRecord& record, DescriptorWriteHelper& write_helper,
-                                         const ExposurePassResources& resources,
-                                         const SamplerResources&      sampler_resources);
+                                         ExposurePassResources& resources,
+                                         const SamplerResources& sampler_resources);
 
 struct CommandBuffer;
 struct FrameGraphHelper;
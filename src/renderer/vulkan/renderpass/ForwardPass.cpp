@@ -96,8 +96,8 @@ constexpr u32 MeshInstanceCountMax = 512;
 
 namespace
 {
-    VkPipeline create_forward_pipeline(VkDevice device, const ShaderModules& shader_modules,
-                                       VkPipelineLayout pipeline_layout)
+    VkPipeline create_forward_pipeline(VkDevice device, VkPipelineCache pipeline_cache,
+                                       const ShaderModules& shader_modules, VkPipelineLayout pipeline_layout)
     {
         const VkShaderModuleCreateInfo module_create_info_vert =
             shader_module_create_info(get_spirv_shader_module(shader_modules, "forward.vert.spv"));
@@ -129,7 +129,8 @@ namespace
 
         std::vector<VkDynamicState> dynamic_states = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
 
-        VkPipeline pipeline = create_graphics_pipeline(device, shader_stages, pipeline_properties, dynamic_states);
+        VkPipeline pipeline =
+            create_graphics_pipeline(device, pipeline_cache, shader_stages, pipeline_properties, dynamic_states);
 
         return pipeline;
     }
@@ -169,23 +170,6 @@ ForwardPassResources create_forward_pass_resources(VulkanBackend& backend, Pipel
                                       .pipeline_creation_function = &create_forward_pipeline,
                                   });
 
-    resources.pass_constant_buffer =
-        create_buffer(backend.device, "Forward Pass Constant buffer",
-                      DefaultGPUBufferProperties(1, sizeof(ForwardPassParams), GPUBufferUsage::UniformBuffer),
-                      backend.vma_instance, MemUsage::CPU_To_GPU);
-
-    resources.instance_buffer = create_buffer(
-        backend.device, "Forward Instance buffer",
-        DefaultGPUBufferProperties(MeshInstanceCountMax, sizeof(MeshInstance), GPUBufferUsage::StorageBuffer),
-        backend.vma_instance, MemUsage::CPU_To_GPU);
-
-    std::vector<VkDescriptorSet> dsets(descriptorSetLayouts.size());
-
-    allocate_descriptor_sets(backend.device, backend.global_descriptor_pool, descriptorSetLayouts, dsets);
-
-    resources.descriptor_set = dsets[0];
-    resources.material_descriptor_set = dsets[1];
-
     return resources;
 }
 
@@ -194,10 +178,6 @@ void destroy_forward_pass_resources(VulkanBackend& backend, ForwardPassResources
     vkDestroyPipelineLayout(backend.device, resources.pipe.pipeline_layout, nullptr);
     vkDestroyDescriptorSetLayout(backend.device, resources.pipe.desc_set_layout, nullptr);
     vkDestroyDescriptorSetLayout(backend.device, resources.pipe.desc_set_layout_material, nullptr);
-
-    vmaDestroyBuffer(backend.vma_instance, resources.pass_constant_buffer.handle,
-                     resources.pass_constant_buffer.allocation);
-    vmaDestroyBuffer(backend.vma_instance, resources.instance_buffer.handle, resources.instance_buffer.allocation);
 }
 
 ForwardFrameGraphRecord create_forward_pass_record(FrameGraph::Builder&                builder,
@@ -248,21 +228,24 @@ ForwardFrameGraphRecord create_forward_pass_record(FrameGraph::Builder&
     return forward;
 }
 
-void update_forward_pass_descriptor_sets(VulkanBackend& backend, const FrameGraph::FrameGraph& frame_graph,
+void update_forward_pass_descriptor_sets(const FrameGraph::FrameGraph&  frame_graph,
                                          const FrameGraphResources&     frame_graph_resources,
                                          const ForwardFrameGraphRecord& record, DescriptorWriteHelper& write_helper,
                                          StorageBufferAllocator& frame_storage_allocator, const PreparedData& prepared,
-                                         const ForwardPassResources& resources,
-                                         const SamplerResources&     sampler_resources,
+                                         ForwardPassResources& resources, const SamplerResources& sampler_resources,
                                          const MaterialResources& material_resources, const MeshCache& mesh_cache,
                                          const LightingPassResources& lighting_resources)
 {
     REAPER_PROFILE_SCOPE_FUNC();
 
+    resources.descriptor_set = write_helper.allocate_descriptor_set(resources.pipe.desc_set_layout);
+    resources.material_descriptor_set = write_helper.allocate_descriptor_set(resources.pipe.desc_set_layout_material);
+
     if (prepared.mesh_instances.empty())
         return;
 
     Assert(!prepared.mesh_instances.empty());
+    Assert(prepared.mesh_instances.size() <= MeshInstanceCountMax);
     Assert(!prepared.mesh_materials.empty());
 
     StorageBufferAlloc mesh_material_alloc =
@@ -270,20 +253,24 @@ void update_forward_pass_descriptor_sets(VulkanBackend& backend, const FrameGrap
 
     upload_storage_buffer(frame_storage_allocator, mesh_material_alloc, prepared.mesh_materials.data());
 
-    upload_buffer_data_deprecated(backend.device, backend.vma_instance, resources.pass_constant_buffer,
-                                  &prepared.forward_pass_constants, sizeof(ForwardPassParams));
+    const StorageBufferAlloc pass_params_alloc = allocate_storage(frame_storage_allocator, sizeof(ForwardPassParams));
+
+    upload_storage_buffer(frame_storage_allocator, pass_params_alloc, &prepared.forward_pass_constants);
+
+    const StorageBufferAlloc mesh_instance_alloc =
+        allocate_storage(frame_storage_allocator, prepared.mesh_instances.size() * sizeof(MeshInstance));
 
-    upload_buffer_data_deprecated(backend.device, backend.vma_instance, resources.instance_buffer,
-                                  prepared.mesh_instances.data(),
-                                  prepared.mesh_instances.size() * sizeof(MeshInstance));
+    upload_storage_buffer(frame_storage_allocator, mesh_instance_alloc, prepared.mesh_instances.data());
 
     const FrameGraphBuffer visible_meshlet_buffer =
         get_frame_graph_buffer(frame_graph_resources, frame_graph, record.visible_meshlet_buffer);
 
     {
         using namespace Forward::zero;
-        write_helper.append(resources.descriptor_set, g_bindings[pass_params], resources.pass_constant_buffer.handle);
-        write_helper.append(resources.descriptor_set, g_bindings[instance_params], resources.instance_buffer.handle);
+        write_helper.append(resources.descriptor_set, g_bindings[pass_params], pass_params_alloc.buffer,
+                            pass_params_alloc.offset_bytes, pass_params_alloc.size_bytes);
+        write_helper.append(resources.descriptor_set, g_bindings[instance_params], mesh_instance_alloc.buffer,
+                            mesh_instance_alloc.offset_bytes, mesh_instance_alloc.size_bytes);
         write_helper.append(resources.descriptor_set, g_bindings[material_params], mesh_material_alloc.buffer,
                             mesh_material_alloc.offset_bytes, mesh_material_alloc.size_bytes);
         write_helper.append(resources.descriptor_set, g_bindings[visible_meshlets], visible_meshlet_buffer.handle);
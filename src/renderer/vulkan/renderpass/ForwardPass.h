@@ -28,9 +28,6 @@ struct ForwardPipelineInfo
 
 struct ForwardPassResources
 {
-    GPUBuffer pass_constant_buffer;
-    GPUBuffer instance_buffer;
-
     ForwardPipelineInfo pipe;
 
     VkDescriptorSet descriptor_set;
@@ -79,12 +76,11 @@ struct PreparedData;
 class DescriptorWriteHelper;
 struct SamplerResources;
 
-void update_forward_pass_descriptor_sets(VulkanBackend& backend, const FrameGraph::FrameGraph& frame_graph,
+void update_forward_pass_descriptor_sets(const FrameGraph::FrameGraph&  frame_graph,
                                          const FrameGraphResources&     frame_graph_resources,
                                          const ForwardFrameGraphRecord& record, DescriptorWriteHelper& write_helper,
                                          StorageBufferAllocator& frame_storage_allocator, const PreparedData& prepared,
-                                         const ForwardPassResources& resources,
-                                         const SamplerResources&     sampler_resources,
+                                         ForwardPassResources& resources, const SamplerResources& sampler_resources,
                                          const MaterialResources& material_resources, const MeshCache& mesh_cache,
                                          const LightingPassResources& lighting_resources);
 
@@ -32,6 +32,7 @@ void record_framegraph_barriers(CommandBuffer& cmdBuffer, const FrameGraph::Fram
         const u32     barrier_handle = barrier_event.barrier_handle;
         const Barrier barrier = schedule.barriers[barrier_handle];
 
+        std::vector<VkMemoryBarrier2>       memoryBarriers;
         std::vector<VkImageMemoryBarrier2>  imageBarriers;
         std::vector<VkBufferMemoryBarrier2> bufferBarriers;
 
@@ -39,34 +40,89 @@ void record_framegraph_barriers(CommandBuffer& cmdBuffer, const FrameGraph::Fram
         const ResourceHandle resource_handle = dst_usage.resource_handle;
         const Resource&      resource = GetResource(framegraph, resource_handle);
 
+        GPUResourceAccess src_access = barrier.src.access;
+        GPUResourceAccess dst_access = barrier.dst.access;
+        u32               src_queue_family_index = VK_QUEUE_FAMILY_IGNORED;
+        u32               dst_queue_family_index = VK_QUEUE_FAMILY_IGNORED;
+
+        if ((barrier_event.barrier_type & BarrierType::CrossQueue) != 0)
+        {
+            const u32 src_queue_type = schedule.render_pass_queues[barrier.src.last_render_pass];
+            const u32 dst_queue_type = schedule.render_pass_queues[barrier.dst.render_pass];
+            const u32 src_family = resources.queue_family_indices[src_queue_type];
+            const u32 dst_family = resources.queue_family_indices[dst_queue_type];
+
+            if (src_family != dst_family)
+            {
+                // Ownership transfer, both sides need the exact same barrier minus the access of the other queue
+                src_queue_family_index = src_family;
+                dst_queue_family_index = dst_family;
+
+                if (barrier_event.barrier_type == BarrierType::QueueRelease)
+                {
+                    dst_access.stage_mask = VK_PIPELINE_STAGE_2_NONE;
+                    dst_access.access_mask = VK_ACCESS_2_NONE;
+                }
+                else
+                {
+                    src_access.stage_mask = VK_PIPELINE_STAGE_2_NONE;
+                    src_access.access_mask = VK_ACCESS_2_NONE;
+                }
+            }
+            else
+            {
+                // Same family, the semaphore already made the memory available so the acquire only has to transition.
+                // The src stage chains with the semaphore wait.
+                if (barrier_event.barrier_type == BarrierType::QueueRelease)
+                    continue;
+
+                src_access.stage_mask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+                src_access.access_mask = VK_ACCESS_2_NONE;
+            }
+        }
+
         if (resource_handle.is_texture)
         {
             VkImage texture = get_frame_graph_texture_handle(resources, resource_handle);
-            imageBarriers.emplace_back(get_vk_image_barrier(texture, resource.default_view.texture.subresource,
-                                                            to_texture_access(barrier.src.access),
-                                                            to_texture_access(barrier.dst.access)));
+            imageBarriers.emplace_back(get_vk_image_barrier(
+                texture, resource.default_view.texture.subresource, to_texture_access(src_access),
+                to_texture_access(dst_access), src_queue_family_index, dst_queue_family_index));
         }
         else
         {
             VkBuffer buffer = get_frame_graph_buffer_handle(resources, resource_handle);
-            bufferBarriers.emplace_back(get_vk_buffer_barrier(buffer, resource.default_view.buffer,
-                                                              to_buffer_access(barrier.src.access),
-                                                              to_buffer_access(barrier.dst.access)));
+            bufferBarriers.emplace_back(get_vk_buffer_barrier(
+                buffer, resource.default_view.buffer, to_buffer_access(src_access), to_buffer_access(dst_access),
+                src_queue_family_index, dst_queue_family_index));
+        }
+
+        // The src access belongs to another resource that was using the same memory.
+        // Resource barriers only cover their own resource so we need a global one on top.
+        if (barrier.is_aliasing)
+        {
+            memoryBarriers.emplace_back(VkMemoryBarrier2{
+                .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+                .pNext = nullptr,
+                .srcStageMask = barrier.src.access.stage_mask,
+                .srcAccessMask = barrier.src.access.access_mask,
+                .dstStageMask = barrier.dst.access.stage_mask,
+                .dstAccessMask = barrier.dst.access.access_mask,
+            });
         }
 
         const VkDependencyInfo dependencies = {
             .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
             .pNext = nullptr,
             .dependencyFlags = VK_FLAGS_NONE,
-            .memoryBarrierCount = 0,
-            .pMemoryBarriers = nullptr,
+            .memoryBarrierCount = static_cast<u32>(memoryBarriers.size()),
+            .pMemoryBarriers = memoryBarriers.data(),
             .bufferMemoryBarrierCount = static_cast<u32>(bufferBarriers.size()),
             .pBufferMemoryBarriers = bufferBarriers.data(),
             .imageMemoryBarrierCount = static_cast<u32>(imageBarriers.size()),
             .pImageMemoryBarriers = imageBarriers.data(),
         };
 
-        if ((barrier_event.barrier_type & BarrierType::Immediate) != 0)
+        if ((barrier_event.barrier_type & (BarrierType::Immediate | BarrierType::CrossQueue)) != 0)
         {
             vkCmdPipelineBarrier2(cmdBuffer.handle, &dependencies);
         }
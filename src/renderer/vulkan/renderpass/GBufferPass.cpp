@@ -80,8 +80,8 @@ namespace
          .stage_mask = VK_SHADER_STAGE_FRAGMENT_BIT},
     };
 
-    VkPipeline create_gbuffer_pipeline(VkDevice device, const ShaderModules& shader_modules,
-                                       VkPipelineLayout pipeline_layout)
+    VkPipeline create_gbuffer_pipeline(VkDevice device, VkPipelineCache pipeline_cache,
+                                       const ShaderModules& shader_modules, VkPipelineLayout pipeline_layout)
     {
         const VkShaderModuleCreateInfo module_create_info_vert =
             shader_module_create_info(get_spirv_shader_module(shader_modules, "gbuffer/gbuffer_write_opaque.vert.spv"));
@@ -114,7 +114,8 @@ namespace
 
         std::vector<VkDynamicState> dynamic_states = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
 
-        VkPipeline pipeline = create_graphics_pipeline(device, shader_stages, pipeline_properties, dynamic_states);
+        VkPipeline pipeline =
+            create_graphics_pipeline(device, pipeline_cache, shader_stages, pipeline_properties, dynamic_states);
 
         return pipeline;
     }
@@ -146,17 +147,6 @@ GBufferPassResources create_gbuffer_pass_resources(VulkanBackend& backend, Pipel
                                       .pipeline_creation_function = &create_gbuffer_pipeline,
                                   });
 
-    resources.instance_buffer = create_buffer(
-        backend.device, "GBuffer Instance buffer",
-        DefaultGPUBufferProperties(GBufferInstanceCountMax, sizeof(MeshInstance), GPUBufferUsage::StorageBuffer),
-        backend.vma_instance, MemUsage::CPU_To_GPU);
-
-    std::vector<VkDescriptorSet> dsets(descriptorSetLayouts.size());
-
-    allocate_descriptor_sets(backend.device, backend.global_descriptor_pool, descriptorSetLayouts, dsets);
-
-    resources.descriptor_set = dsets[0];
-
     return resources;
 }
 
@@ -164,18 +154,24 @@ void destroy_gbuffer_pass_resources(VulkanBackend& backend, GBufferPassResources
 {
     vkDestroyPipelineLayout(backend.device, resources.pipe.pipelineLayout, nullptr);
     vkDestroyDescriptorSetLayout(backend.device, resources.pipe.desc_set_layout, nullptr);
-
-    vmaDestroyBuffer(backend.vma_instance, resources.instance_buffer.handle, resources.instance_buffer.allocation);
 }
 
 void update_gbuffer_pass_descriptor_sets(DescriptorWriteHelper&  write_helper,
                                          StorageBufferAllocator& frame_storage_allocator, const PreparedData& prepared,
-                                         const GBufferPassResources& resources,
-                                         const FrameGraphBuffer&     visible_meshlet_buffer,
-                                         const SamplerResources&     sampler_resources,
+                                         GBufferPassResources&   resources,
+                                         const FrameGraphBuffer& visible_meshlet_buffer,
+                                         const SamplerResources& sampler_resources,
                                          const MaterialResources& material_resources, const MeshCache& mesh_cache)
 {
+    resources.descriptor_set = write_helper.allocate_descriptor_set(resources.pipe.desc_set_layout);
+
     Assert(!prepared.mesh_materials.empty());
+    Assert(prepared.mesh_instances.size() <= GBufferInstanceCountMax);
+
+    const StorageBufferAlloc mesh_instance_alloc =
+        allocate_storage(frame_storage_allocator, prepared.mesh_instances.size() * sizeof(MeshInstance));
+
+    upload_storage_buffer(frame_storage_allocator, mesh_instance_alloc, prepared.mesh_instances.data());
 
     StorageBufferAlloc mesh_material_alloc =
         allocate_storage(frame_storage_allocator, prepared.mesh_materials.size() * sizeof(MeshMaterial));
@@ -183,7 +179,7 @@ void update_gbuffer_pass_descriptor_sets(DescriptorWriteHelper&  write_helper,
     upload_storage_buffer(frame_storage_allocator, mesh_material_alloc, prepared.mesh_materials.data());
 
     write_helper.append(resources.descriptor_set, Slot_instance_params, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                        resources.instance_buffer.handle);
+                        mesh_instance_alloc.buffer, mesh_instance_alloc.offset_bytes, mesh_instance_alloc.size_bytes);
     write_helper.append(resources.descriptor_set, Slot_visible_meshlets, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
                         visible_meshlet_buffer.handle);
     write_helper.append(resources.descriptor_set, Slot_buffer_position_ms, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
@@ -211,19 +207,6 @@ void update_gbuffer_pass_descriptor_sets(DescriptorWriteHelper&  write_helper,
     }
 }
 
-void upload_gbuffer_pass_frame_resources(VulkanBackend& backend, const PreparedData& prepared,
-                                         GBufferPassResources& pass_resources)
-{
-    REAPER_PROFILE_SCOPE_FUNC();
-
-    if (prepared.mesh_instances.empty())
-        return;
-
-    upload_buffer_data_deprecated(backend.device, backend.vma_instance, pass_resources.instance_buffer,
-                                  prepared.mesh_instances.data(),
-                                  prepared.mesh_instances.size() * sizeof(MeshInstance));
-}
-
 void record_gbuffer_pass_command_buffer(CommandBuffer& cmdBuffer, const PipelineFactory& pipeline_factory,
                                         const PreparedData& prepared, const GBufferPassResources& pass_resources,
                                         const FrameGraphBuffer&  meshlet_counters,
@@ -30,8 +30,6 @@ struct GBufferPipelineInfo
 
 struct GBufferPassResources
 {
-    GPUBuffer instance_buffer;
-
     GBufferPipelineInfo pipe;
 
     VkDescriptorSet descriptor_set;
@@ -54,14 +52,11 @@ struct FrameGraphTexture;
 
 void update_gbuffer_pass_descriptor_sets(DescriptorWriteHelper&  write_helper,
                                          StorageBufferAllocator& frame_storage_allocator, const PreparedData& prepared,
-                                         const GBufferPassResources& resources,
-                                         const FrameGraphBuffer&     visible_meshlet_buffer,
-                                         const SamplerResources&     sampler_resources,
+                                         GBufferPassResources&   resources,
+                                         const FrameGraphBuffer& visible_meshlet_buffer,
+                                         const SamplerResources& sampler_resources,
                                          const MaterialResources& material_resources, const MeshCache& mesh_cache);
 
-void upload_gbuffer_pass_frame_resources(VulkanBackend& backend, const PreparedData& prepared,
-                                         GBufferPassResources& pass_resources);
-
 struct CommandBuffer;
 
 void record_gbuffer_pass_command_buffer(CommandBuffer& cmdBuffer, const PipelineFactory& pipeline_factory,
@@ -28,7 +28,7 @@ namespace Reaper
 {
 namespace
 {
-    VkPipeline create_gui_pipeline(VkDevice device, const ShaderModules& shader_modules,
+    VkPipeline create_gui_pipeline(VkDevice device, VkPipelineCache pipeline_cache, const ShaderModules& shader_modules,
                                    VkPipelineLayout pipeline_layout)
     {
         const VkShaderModuleCreateInfo module_create_info_vert =
@@ -53,7 +53,7 @@ namespace
 
         std::vector<VkDynamicState> dynamic_states = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
 
-        return create_graphics_pipeline(device, shader_stages, pipeline_properties, dynamic_states);
+        return create_graphics_pipeline(device, pipeline_cache, shader_stages, pipeline_properties, dynamic_states);
     }
 
 } // namespace
@@ -49,7 +49,7 @@ namespace
          .stage_mask = VK_SHADER_STAGE_COMPUTE_BIT},
     };
 
-    VkPipeline create_hzb_pipeline(VkDevice device, const ShaderModules& shader_modules,
+    VkPipeline create_hzb_pipeline(VkDevice device, VkPipelineCache pipeline_cache, const ShaderModules& shader_modules,
                                    VkPipelineLayout pipeline_layout)
     {
         const VkShaderModuleCreateInfo module_create_info =
@@ -59,7 +59,7 @@ namespace
             default_pipeline_shader_stage_create_info(VK_SHADER_STAGE_COMPUTE_BIT, &module_create_info, nullptr,
                                                       VK_PIPELINE_SHADER_STAGE_CREATE_ALLOW_VARYING_SUBGROUP_SIZE_BIT);
 
-        return create_compute_pipeline(device, pipeline_layout, shader_stage);
+        return create_compute_pipeline(device, pipeline_cache, pipeline_layout, shader_stage);
     }
 } // namespace
 
@@ -88,10 +88,6 @@ HZBPassResources create_hzb_pass_resources(VulkanBackend& backend, PipelineFacto
                                       .pipeline_creation_function = &create_hzb_pipeline,
                                   });
 
-    allocate_descriptor_sets(backend.device, backend.global_descriptor_pool,
-                             std::span(&resources.hzb_pipe.desc_set_layout, 1),
-                             std::span(&resources.descriptor_set, 1));
-
     return resources;
 }
 
@@ -107,7 +103,7 @@ HZBReduceFrameGraphRecord create_hzb_pass_record(FrameGraph::Builder&
 {
     HZBReduceFrameGraphRecord record;
 
-    record.pass_handle = builder.create_render_pass("HZB Reduce");
+    record.pass_handle = builder.create_render_pass("HZB Reduce", false, FrameGraph::QueueType::AsyncCompute);
 
     record.depth =
         builder.read_texture(record.pass_handle, depth_buffer_usage_handle,
@@ -141,8 +137,10 @@ HZBReduceFrameGraphRecord create_hzb_pass_record(FrameGraph::Builder&
 void update_hzb_pass_descriptor_set(const FrameGraph::FrameGraph&    frame_graph,
                                     const FrameGraphResources&       frame_graph_resources,
                                     const HZBReduceFrameGraphRecord& record, DescriptorWriteHelper& write_helper,
-                                    const HZBPassResources& resources, const SamplerResources& sampler_resources)
+                                    HZBPassResources& resources, const SamplerResources& sampler_resources)
 {
+    resources.descriptor_set = write_helper.allocate_descriptor_set(resources.hzb_pipe.desc_set_layout);
+
     const FrameGraphTexture scene_depth = get_frame_graph_texture(frame_graph_resources, frame_graph, record.depth);
     const FrameGraphTexture hzb_texture =
         get_frame_graph_texture(frame_graph_resources, frame_graph, record.hzb_texture);
@@ -68,7 +68,7 @@ struct FrameGraphResources;
 void update_hzb_pass_descriptor_set(const FrameGraph::FrameGraph&    frame_graph,
                                     const FrameGraphResources&       frame_graph_resources,
                                     const HZBReduceFrameGraphRecord& record, DescriptorWriteHelper& write_helper,
-                                    const HZBPassResources& resources, const SamplerResources& sampler_resources);
+                                    HZBPassResources& resources, const SamplerResources& sampler_resources);
 
 struct FrameGraphHelper;
 struct CommandBuffer;
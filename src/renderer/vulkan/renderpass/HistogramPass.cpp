@@ -33,8 +33,8 @@ namespace Reaper
 {
 namespace
 {
-    VkPipeline create_histogram_pipeline(VkDevice device, const ShaderModules& shader_modules,
-                                         VkPipelineLayout pipeline_layout)
+    VkPipeline create_histogram_pipeline(VkDevice device, VkPipelineCache pipeline_cache,
+                                         const ShaderModules& shader_modules, VkPipelineLayout pipeline_layout)
     {
         const VkShaderModuleCreateInfo module_create_info =
             shader_module_create_info(get_spirv_shader_module(shader_modules, "histogram/reduce_histogram.comp.spv"));
@@ -42,7 +42,7 @@ namespace
         VkPipelineShaderStageCreateInfo shader_stage =
             default_pipeline_shader_stage_create_info(VK_SHADER_STAGE_COMPUTE_BIT, &module_create_info);
 
-        return create_compute_pipeline(device, pipeline_layout, shader_stage);
+        return create_compute_pipeline(device, pipeline_cache, pipeline_layout, shader_stage);
     }
 } // namespace
 
@@ -73,9 +73,6 @@ HistogramPassResources create_histogram_pass_resources(VulkanBackend& backend, P
                                       });
     }
 
-    allocate_descriptor_sets(backend.device, backend.global_descriptor_pool, std::span(&resources.descSetLayout, 1),
-                             std::span(&resources.descriptor_set, 1));
-
     return resources;
 }
 
@@ -88,7 +85,8 @@ void destroy_histogram_pass_resources(VulkanBackend& backend, const HistogramPas
 HistogramClearFrameGraphRecord create_histogram_clear_pass_record(FrameGraph::Builder& builder)
 {
     HistogramClearFrameGraphRecord histogram_clear;
-    histogram_clear.pass_handle = builder.create_render_pass("Histogram Clear");
+    histogram_clear.pass_handle =
+        builder.create_render_pass("Histogram Clear", false, FrameGraph::QueueType::AsyncCompute);
 
     const GPUBufferProperties histogram_buffer_properties = DefaultGPUBufferProperties(
         HistogramRes, sizeof(u32), GPUBufferUsage::StorageBuffer | GPUBufferUsage::TransferDst);
@@ -105,7 +103,7 @@ HistogramFrameGraphRecord create_histogram_pass_record(FrameGraph::Builder&
                                                        FrameGraph::ResourceUsageHandle       scene_hdr_usage_handle)
 {
     HistogramFrameGraphRecord histogram;
-    histogram.pass_handle = builder.create_render_pass("Histogram");
+    histogram.pass_handle = builder.create_render_pass("Histogram", false, FrameGraph::QueueType::AsyncCompute);
 
     histogram.scene_hdr =
         builder.read_texture(histogram.pass_handle, scene_hdr_usage_handle,
@@ -123,9 +121,11 @@ HistogramFrameGraphRecord create_histogram_pass_record(FrameGraph::Builder&
 void update_histogram_pass_descriptor_set(const FrameGraph::FrameGraph&    frame_graph,
                                           const FrameGraphResources&       frame_graph_resources,
                                           const HistogramFrameGraphRecord& record, DescriptorWriteHelper& write_helper,
-                                          const HistogramPassResources& resources,
-                                          const SamplerResources&       sampler_resources)
+                                          HistogramPassResources& resources,
+                                          const SamplerResources& sampler_resources)
 {
+    resources.descriptor_set = write_helper.allocate_descriptor_set(resources.descSetLayout);
+
     const FrameGraphTexture scene_hdr = get_frame_graph_texture(frame_graph_resources, frame_graph, record.scene_hdr);
     const FrameGraphBuffer  histogram_buffer =
         get_frame_graph_buffer(frame_graph_resources, frame_graph, record.histogram_buffer);
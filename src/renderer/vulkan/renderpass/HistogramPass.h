@@ -68,8 +68,8 @@ struct FrameGraphResources;
 void update_histogram_pass_descriptor_set(const FrameGraph::FrameGraph&    frame_graph,
                                           const FrameGraphResources&       frame_graph_resources,
                                           const HistogramFrameGraphRecord& record, DescriptorWriteHelper& write_helper,
-                                          const HistogramPassResources& resources,
-                                          const SamplerResources&       sampler_resources);
+                                          HistogramPassResources& resources,
+                                          const SamplerResources& sampler_resources);
 
 struct CommandBuffer;
 struct FrameGraphHelper;
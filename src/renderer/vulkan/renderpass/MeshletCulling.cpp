@@ -124,8 +124,8 @@ constexpr u32 MaxIndirectDrawCountPerPass = MaxVisibleMeshletsPerPass;
 
 namespace
 {
-    VkPipeline create_cull_meshlet_pipeline(VkDevice device, const ShaderModules& shader_modules,
-                                            VkPipelineLayout pipeline_layout)
+    VkPipeline create_cull_meshlet_pipeline(VkDevice device, VkPipelineCache pipeline_cache,
+                                            const ShaderModules& shader_modules, VkPipelineLayout pipeline_layout)
     {
         const VkShaderModuleCreateInfo module_create_info =
             shader_module_create_info(get_spirv_shader_module(shader_modules, "meshlet/cull_meshlet.comp.spv"));
@@ -133,10 +133,11 @@ namespace
         VkPipelineShaderStageCreateInfo shader_stage =
             default_pipeline_shader_stage_create_info(VK_SHADER_STAGE_COMPUTE_BIT, &module_create_info);
 
-        return create_compute_pipeline(device, pipeline_layout, shader_stage);
+        return create_compute_pipeline(device, pipeline_cache, pipeline_layout, shader_stage);
     }
 
-    VkPipeline create_cull_triangle_prepare_pipeline(VkDevice device, const ShaderModules& shader_modules,
+    VkPipeline create_cull_triangle_prepare_pipeline(VkDevice device, VkPipelineCache pipeline_cache,
+                                                     const ShaderModules& shader_modules,
                                                      VkPipelineLayout pipeline_layout)
     {
         const VkShaderModuleCreateInfo module_create_info = shader_module_create_info(
@@ -145,11 +146,11 @@ namespace
         VkPipelineShaderStageCreateInfo shader_stage =
             default_pipeline_shader_stage_create_info(VK_SHADER_STAGE_COMPUTE_BIT, &module_create_info);
 
-        return create_compute_pipeline(device, pipeline_layout, shader_stage);
+        return create_compute_pipeline(device, pipeline_cache, pipeline_layout, shader_stage);
     }
 
-    VkPipeline create_cull_triangle_pipeline(VkDevice device, const ShaderModules& shader_modules,
-                                             VkPipelineLayout pipeline_layout)
+    VkPipeline create_cull_triangle_pipeline(VkDevice device, VkPipelineCache pipeline_cache,
+                                             const ShaderModules& shader_modules, VkPipelineLayout pipeline_layout)
     {
         const VkShaderModuleCreateInfo module_create_info =
             shader_module_create_info(get_spirv_shader_module(shader_modules, "meshlet/cull_triangle_batch.comp.spv"));
@@ -157,7 +158,7 @@ namespace
         VkPipelineShaderStageCreateInfo shader_stage =
             default_pipeline_shader_stage_create_info(VK_SHADER_STAGE_COMPUTE_BIT, &module_create_info);
 
-        return create_compute_pipeline(device, pipeline_layout, shader_stage);
+        return create_compute_pipeline(device, pipeline_cache, pipeline_layout, shader_stage);
     }
 } // namespace
 
@@ -165,7 +166,7 @@ CullMeshletsFrameGraphRecord create_cull_meshlet_frame_graph_record(FrameGraph::
 {
     CullMeshletsFrameGraphRecord::Clear clear;
 
-    clear.pass_handle = builder.create_render_pass("Meshlet Culling Clear");
+    clear.pass_handle = builder.create_render_pass("Meshlet Culling Clear", false, FrameGraph::QueueType::AsyncCompute);
 
     clear.meshlet_counters = builder.create_buffer(
         clear.pass_handle, "Meshlet counters",
@@ -176,7 +177,7 @@ CullMeshletsFrameGraphRecord create_cull_meshlet_frame_graph_record(FrameGraph::
 
     CullMeshletsFrameGraphRecord::CullMeshlets cull_meshlets;
 
-    cull_meshlets.pass_handle = builder.create_render_pass("Cull Meshlets");
+    cull_meshlets.pass_handle = builder.create_render_pass("Cull Meshlets", false, FrameGraph::QueueType::AsyncCompute);
 
     cull_meshlets.meshlet_counters = builder.write_buffer(
         cull_meshlets.pass_handle, clear.meshlet_counters,
@@ -192,7 +193,8 @@ CullMeshletsFrameGraphRecord create_cull_meshlet_frame_graph_record(FrameGraph::
 
     CullMeshletsFrameGraphRecord::CullTrianglesPrepare cull_triangles_prepare;
 
-    cull_triangles_prepare.pass_handle = builder.create_render_pass("Cull Triangles Prepare");
+    cull_triangles_prepare.pass_handle =
+        builder.create_render_pass("Cull Triangles Prepare", false, FrameGraph::QueueType::AsyncCompute);
 
     cull_triangles_prepare.meshlet_counters =
         builder.read_buffer(cull_triangles_prepare.pass_handle, cull_meshlets.meshlet_counters,
@@ -207,7 +209,8 @@ CullMeshletsFrameGraphRecord create_cull_meshlet_frame_graph_record(FrameGraph::
 
     CullMeshletsFrameGraphRecord::CullTriangles cull_triangles;
 
-    cull_triangles.pass_handle = builder.create_render_pass("Cull Triangles");
+    cull_triangles.pass_handle =
+        builder.create_render_pass("Cull Triangles", false, FrameGraph::QueueType::AsyncCompute);
 
     cull_triangles.indirect_dispatch_buffer = builder.read_buffer(
         cull_triangles.pass_handle, cull_triangles_prepare.indirect_dispatch_buffer,
@@ -335,19 +338,18 @@ MeshletCullingResources create_meshlet_culling_resources(VulkanBackend& backend,
     resources.counters_cpu_properties = DefaultGPUBufferProperties(CountersCount * MaxMeshletCullingPassCount,
                                                                    sizeof(u32), GPUBufferUsage::TransferDst);
 
-    resources.counters_cpu_buffer =
-        create_buffer(backend.device, "Meshlet counters CPU", resources.counters_cpu_properties, backend.vma_instance,
-                      MemUsage::CPU_Only);
+    for (u32 readback_index = 0; readback_index < MaxFramesInFlight; readback_index++)
+    {
+        resources.counters_cpu_buffers[readback_index] =
+            create_buffer(backend.device, "Meshlet counters CPU", resources.counters_cpu_properties,
+                          backend.vma_instance, MemUsage::CPU_Only);
+    }
 
-    Assert(MaxIndirectDrawCountPerPass < backend.physical_device.properties.limits.maxDrawIndirectCount);
+    resources.counters_cpu_frame_indices = {};
+    resources.counters_cpu_pass_counts = {};
+    resources.counters_last_read_frame_index = 0;
 
-    allocate_descriptor_sets(backend.device, backend.global_descriptor_pool, resources.cull_meshlets_pipe.descSetLayout,
-                             resources.cull_meshlet_descriptor_sets);
-    allocate_descriptor_sets(backend.device, backend.global_descriptor_pool,
-                             std::span(&resources.cull_meshlets_prep_indirect_pipe.descSetLayout, 1),
-                             std::span(&resources.cull_prepare_descriptor_set, 1));
-    allocate_descriptor_sets(backend.device, backend.global_descriptor_pool,
-                             resources.cull_triangles_pipe.descSetLayout, resources.cull_triangles_descriptor_sets);
+    Assert(MaxIndirectDrawCountPerPass < backend.physical_device.properties.limits.maxDrawIndirectCount);
 
     const VkEventCreateInfo event_info = {
         .sType = VK_STRUCTURE_TYPE_EVENT_CREATE_INFO,
@@ -372,8 +374,8 @@ namespace
 
 void destroy_meshlet_culling_resources(VulkanBackend& backend, MeshletCullingResources& resources)
 {
-    vmaDestroyBuffer(backend.vma_instance, resources.counters_cpu_buffer.handle,
-                     resources.counters_cpu_buffer.allocation);
+    for (const GPUBuffer& counters_cpu_buffer : resources.counters_cpu_buffers)
+        vmaDestroyBuffer(backend.vma_instance, counters_cpu_buffer.handle, counters_cpu_buffer.allocation);
 
     destroy_simple_pipeline(backend.device, resources.cull_meshlets_pipe);
     destroy_simple_pipeline(backend.device, resources.cull_meshlets_prep_indirect_pipe);
@@ -509,6 +511,13 @@ void update_meshlet_culling_passes_resources(const FrameGraph::FrameGraph&
 {
     REAPER_PROFILE_SCOPE_FUNC();
 
+    write_helper.allocate_descriptor_sets(resources.cull_meshlets_pipe.descSetLayout,
+                                          resources.cull_meshlet_descriptor_sets);
+    resources.cull_prepare_descriptor_set =
+        write_helper.allocate_descriptor_set(resources.cull_meshlets_prep_indirect_pipe.descSetLayout);
+    write_helper.allocate_descriptor_sets(resources.cull_triangles_pipe.descSetLayout,
+                                          resources.cull_triangles_descriptor_sets);
+
     if (prepared.cull_mesh_instance_params.empty())
         return;
 
@@ -576,7 +585,7 @@ void record_meshlet_culling_command_buffer(ReaperRoot& root, const FrameGraphHel
             const u32 group_count_x = div_round_up(command.push_constants.meshlet_count, MeshletCullThreadCount);
             vkCmdDispatch(cmdBuffer.handle, group_count_x, command.instance_count, 1);
 
-            pass_meshlet_count += command.push_constants.meshlet_count;
+            pass_meshlet_count += command.push_constants.meshlet_count * command.instance_count;
         }
 
         total_meshlet_count += pass_meshlet_count;
@@ -651,6 +660,8 @@ void record_triangle_culling_command_buffer(const FrameGraphHelper&
 void record_meshlet_culling_debug_command_buffer(const FrameGraphHelper&                    frame_graph_helper,
                                                  const CullMeshletsFrameGraphRecord::Debug& pass_record,
                                                  CommandBuffer&                             cmdBuffer,
+                                                 const PreparedData&                        prepared,
+                                                 u64                                        frame_index,
                                                  MeshletCullingResources&                   resources)
 {
     REAPER_GPU_SCOPE(cmdBuffer, "Meshlet Debug");
@@ -660,6 +671,9 @@ void record_meshlet_culling_debug_command_buffer(const FrameGraphHelper&
     const FrameGraphBuffer meshlet_counters = get_frame_graph_buffer(
         frame_graph_helper.resources, frame_graph_helper.frame_graph, pass_record.meshlet_counters);
 
+    const u32        readback_index = static_cast<u32>(frame_index % MaxFramesInFlight);
+    const GPUBuffer& counters_cpu_buffer = resources.counters_cpu_buffers[readback_index];
+
     const VkBufferCopy2 region = {
         .sType = VK_STRUCTURE_TYPE_BUFFER_COPY_2,
         .pNext = nullptr,
@@ -672,18 +686,21 @@ void record_meshlet_culling_debug_command_buffer(const FrameGraphHelper&
         .sType = VK_STRUCTURE_TYPE_COPY_BUFFER_INFO_2,
         .pNext = nullptr,
         .srcBuffer = meshlet_counters.handle,
-        .dstBuffer = resources.counters_cpu_buffer.handle,
+        .dstBuffer = counters_cpu_buffer.handle,
         .regionCount = 1,
         .pRegions = &region,
     };
 
     vkCmdCopyBuffer2(cmdBuffer.handle, &copy);
 
+    resources.counters_cpu_frame_indices[readback_index] = frame_index;
+    resources.counters_cpu_pass_counts[readback_index] = static_cast<u32>(prepared.cull_passes.size());
+
     const GPUBufferAccess src = {VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT};
     const GPUBufferAccess dst = {VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_NONE};
     const GPUBufferView   view = default_buffer_view(resources.counters_cpu_properties);
 
-    VkBufferMemoryBarrier2 buffer_barrier = get_vk_buffer_barrier(resources.counters_cpu_buffer.handle, view, src, dst);
+    VkBufferMemoryBarrier2 buffer_barrier = get_vk_buffer_barrier(counters_cpu_buffer.handle, view, src, dst);
 
     const VkDependencyInfo dependencies = get_vk_buffer_barrier_depency_info(std::span(&buffer_barrier, 1));
 
@@ -692,45 +709,45 @@ void record_meshlet_culling_debug_command_buffer(const FrameGraphHelper&
     vkCmdResetEvent2(cmdBuffer.handle, resources.countersReadyEvent, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
 }
 
-std::vector<MeshletCullingStats> get_meshlet_culling_gpu_stats(VulkanBackend& backend, const PreparedData& prepared,
+std::vector<MeshletCullingStats> get_meshlet_culling_gpu_stats(VulkanBackend& backend, u64 completed_frame_index,
                                                                MeshletCullingResources& resources)
 {
-    VmaAllocationInfo allocation_info;
-    vmaGetAllocationInfo(backend.vma_instance, resources.counters_cpu_buffer.allocation, &allocation_info);
+    // Pick the newest copy done by a frame the GPU completed
+    u32 readback_index = MaxFramesInFlight;
 
-    void* mapped_data_ptr = nullptr;
-    u64   mappped_data_size_bytes =
-        alignOffset(allocation_info.size, backend.physical_device.properties.limits.nonCoherentAtomSize);
+    for (u32 index = 0; index < MaxFramesInFlight; index++)
+    {
+        const u64 readback_frame_index = resources.counters_cpu_frame_indices[index];
 
-    AssertVk(vkMapMemory(backend.device, allocation_info.deviceMemory, allocation_info.offset, mappped_data_size_bytes,
-                         0, &mapped_data_ptr));
+        if (readback_frame_index > resources.counters_last_read_frame_index
+            && readback_frame_index <= completed_frame_index)
+        {
+            resources.counters_last_read_frame_index = readback_frame_index;
+            readback_index = index;
+        }
+    }
 
-    const VkMappedMemoryRange staging_range = {
-        .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
-        .pNext = nullptr,
-        .memory = allocation_info.deviceMemory,
-        .offset = allocation_info.offset,
-        .size = mappped_data_size_bytes,
-    };
+    std::vector<MeshletCullingStats> stats;
 
-    vkInvalidateMappedMemoryRanges(backend.device, 1, &staging_range);
+    if (readback_index == MaxFramesInFlight)
+        return stats;
 
-    Assert(mapped_data_ptr);
+    const MappedBufferView counters =
+        get_mapped_buffer_view(backend.vma_instance, resources.counters_cpu_buffers[readback_index]);
 
-    std::vector<MeshletCullingStats> stats;
+    invalidate_mapped_buffer_range(backend.vma_instance, counters, 0, counters.size_bytes);
 
-    for (u32 i = 0; i < prepared.cull_passes.size(); i++)
+    const u32* counters_ptr = reinterpret_cast<const u32*>(counters.data);
+
+    for (u32 i = 0; i < resources.counters_cpu_pass_counts[readback_index]; i++)
     {
         MeshletCullingStats& s = stats.emplace_back();
         s.pass_index = i;
-        s.surviving_meshlet_count = static_cast<u32*>(mapped_data_ptr)[i * CountersCount + MeshletCounterOffset];
-        s.surviving_triangle_count = static_cast<u32*>(mapped_data_ptr)[i * CountersCount + TriangleCounterOffset];
-        s.indirect_draw_command_count =
-            static_cast<u32*>(mapped_data_ptr)[i * CountersCount + DrawCommandCounterOffset];
+        s.surviving_meshlet_count = counters_ptr[i * CountersCount + MeshletCounterOffset];
+        s.surviving_triangle_count = counters_ptr[i * CountersCount + TriangleCounterOffset];
+        s.indirect_draw_command_count = counters_ptr[i * CountersCount + DrawCommandCounterOffset];
     }
 
-    vkUnmapMemory(backend.device, allocation_info.deviceMemory);
-
     return stats;
 }
 
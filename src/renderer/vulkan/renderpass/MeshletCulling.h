@@ -10,6 +10,7 @@
 #include "renderer/buffer/GPUBufferView.h"
 #include "renderer/graph/FrameGraphBasicTypes.h"
 #include "renderer/vulkan/Buffer.h"
+#include "renderer/vulkan/FrameSync.h"
 
 #include <vulkan_loader/Vulkan.h>
 
@@ -36,8 +37,12 @@ struct MeshletCullingResources
     std::array<VkDescriptorSet, 4> cull_triangles_descriptor_sets;
     VkDescriptorSet                cull_prepare_descriptor_set;
 
-    GPUBuffer           counters_cpu_buffer;
-    GPUBufferProperties counters_cpu_properties;
+    // Each frame in flight copies its counters to its own buffer so the CPU never reads one the GPU is writing to
+    std::array<GPUBuffer, MaxFramesInFlight> counters_cpu_buffers;
+    std::array<u64, MaxFramesInFlight>       counters_cpu_frame_indices; // 0 when never written
+    std::array<u32, MaxFramesInFlight>       counters_cpu_pass_counts;
+    u64                                      counters_last_read_frame_index;
+    GPUBufferProperties                      counters_cpu_properties;
 
     VkEvent countersReadyEvent;
 };
@@ -141,6 +146,8 @@ void record_triangle_culling_command_buffer(const FrameGraphHelper&
 void record_meshlet_culling_debug_command_buffer(const FrameGraphHelper&                    frame_graph_helper,
                                                  const CullMeshletsFrameGraphRecord::Debug& pass_record,
                                                  CommandBuffer&                             cmdBuffer,
+                                                 const PreparedData&                        prepared,
+                                                 u64                                        frame_index,
                                                  MeshletCullingResources&                   resources);
 
 struct MeshletCullingStats
@@ -151,7 +158,8 @@ struct MeshletCullingStats
     u32 indirect_draw_command_count;
 };
 
-std::vector<MeshletCullingStats> get_meshlet_culling_gpu_stats(VulkanBackend& backend, const PreparedData& prepared,
+// Returns the stats of the newest frame the GPU completed, empty when there's none since the last call.
+std::vector<MeshletCullingStats> get_meshlet_culling_gpu_stats(VulkanBackend& backend, u64 completed_frame_index,
                                                                MeshletCullingResources& resources);
 
 struct MeshletDrawParams
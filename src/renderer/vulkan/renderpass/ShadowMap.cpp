@@ -36,12 +36,13 @@ namespace Reaper
 {
 namespace
 {
-    VkPipeline create_shadow_pipeline(VkDevice device, const ShaderModules& shader_modules,
-                                      VkPipelineLayout pipeline_layout)
+    VkPipeline create_shadow_pipeline(VkDevice device, VkPipelineCache pipeline_cache,
+                                      const ShaderModules& shader_modules, VkPipelineLayout pipeline_layout,
+                                      const char* vertex_shader_name)
 
     {
         const VkShaderModuleCreateInfo module_create_info_vert =
-            shader_module_create_info(get_spirv_shader_module(shader_modules, "shadow/render_shadow.vert.spv"));
+            shader_module_create_info(get_spirv_shader_module(shader_modules, vertex_shader_name));
 
         std::vector<VkPipelineShaderStageCreateInfo> shader_stages = {
             default_pipeline_shader_stage_create_info(VK_SHADER_STAGE_VERTEX_BIT, &module_create_info_vert)};
@@ -57,7 +58,21 @@ namespace
 
         std::vector<VkDynamicState> dynamic_states = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
 
-        return create_graphics_pipeline(device, shader_stages, pipeline_properties, dynamic_states);
+        return create_graphics_pipeline(device, pipeline_cache, shader_stages, pipeline_properties, dynamic_states);
+    }
+
+    VkPipeline create_shadow_pipeline_float(VkDevice device, VkPipelineCache pipeline_cache,
+                                            const ShaderModules& shader_modules, VkPipelineLayout pipeline_layout)
+    {
+        return create_shadow_pipeline(device, pipeline_cache, shader_modules, pipeline_layout,
+                                      "shadow/render_shadow.vert.spv");
+    }
+
+    VkPipeline create_shadow_pipeline_quantized(VkDevice device, VkPipelineCache pipeline_cache,
+                                                const ShaderModules& shader_modules, VkPipelineLayout pipeline_layout)
+    {
+        return create_shadow_pipeline(device, pipeline_cache, shader_modules, pipeline_layout,
+                                      "shadow/render_shadow_quantized.vert.spv");
     }
 } // namespace
 
@@ -72,17 +87,19 @@ ShadowMapResources create_shadow_map_resources(VulkanBackend& backend, PipelineF
 
     resources.desc_set_layout = create_descriptor_set_layout(backend.device, descriptorSetLayoutBinding);
     resources.pipeline_layout = create_pipeline_layout(backend.device, std::span(&resources.desc_set_layout, 1));
+    // Has to match the vertex streams of the mesh cache, see get_vertex_position_buffer()
+    const PipelineFunctor pipeline_creation_function = backend.options.enable_quantized_vertices
+                                                           ? &create_shadow_pipeline_quantized
+                                                           : &create_shadow_pipeline_float;
+
     resources.pipeline_index = register_pipeline_creator(pipeline_factory,
                                                          PipelineCreator{
                                                              .pipeline_layout = resources.pipeline_layout,
-                                                             .pipeline_creation_function = &create_shadow_pipeline,
+                                                             .pipeline_creation_function = pipeline_creation_function,
                                                          });
 
     resources.descriptor_sets.resize(3); // FIXME
 
-    allocate_descriptor_sets(backend.device, backend.global_descriptor_pool, resources.desc_set_layout,
-                             resources.descriptor_sets);
-
     return resources;
 }
 
@@ -128,10 +145,12 @@ ShadowFrameGraphRecord create_shadow_map_pass_record(FrameGraph::Builder&
 
 void update_shadow_map_resources(DescriptorWriteHelper& write_helper, StorageBufferAllocator& frame_storage_allocator,
                                  const PreparedData& prepared, ShadowMapResources& resources,
-                                 GPUBuffer& vertex_position_buffer)
+                                 const GPUBuffer& vertex_position_buffer)
 {
     REAPER_PROFILE_SCOPE_FUNC();
 
+    write_helper.allocate_descriptor_sets(resources.desc_set_layout, resources.descriptor_sets);
+
     if (prepared.shadow_instance_params.empty())
         return;
 
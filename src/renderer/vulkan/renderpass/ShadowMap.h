@@ -64,7 +64,7 @@ class DescriptorWriteHelper;
 
 void update_shadow_map_resources(DescriptorWriteHelper& write_helper, StorageBufferAllocator& frame_storage_allocator,
                                  const PreparedData& prepared, ShadowMapResources& resources,
-                                 GPUBuffer& vertex_position_buffer);
+                                 const GPUBuffer& vertex_position_buffer);
 
 struct FrameGraphHelper;
 struct CommandBuffer;
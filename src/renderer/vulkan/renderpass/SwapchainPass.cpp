@@ -133,8 +133,8 @@ namespace
 
         std::vector<VkDynamicState> dynamic_states = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
 
-        VkPipeline pipeline =
-            create_graphics_pipeline(backend.device, shader_stages, pipeline_properties, dynamic_states);
+        VkPipeline pipeline = create_graphics_pipeline(backend.device, VK_NULL_HANDLE, shader_stages,
+                                                       pipeline_properties, dynamic_states);
 
         Assert(backend.physical_device.graphics_queue_family_index
                == backend.physical_device.present_queue_family_index);
@@ -165,9 +165,6 @@ SwapchainPassResources create_swapchain_pass_resources(VulkanBackend& backend, c
                                                       std::span(&push_constant_range, 1));
     resources.pipeline = create_swapchain_pipeline(backend, shader_modules, resources.pipelineLayout);
 
-    allocate_descriptor_sets(backend.device, backend.global_descriptor_pool,
-                             std::span(&resources.descriptorSetLayout, 1), std::span(&resources.descriptor_set, 1));
-
     return resources;
 }
 
@@ -241,9 +238,11 @@ create_swapchain_pass_record(FrameGraph::Builder&            builder,
 void update_swapchain_pass_descriptor_set(const FrameGraph::FrameGraph&    frame_graph,
                                           const FrameGraphResources&       frame_graph_resources,
                                           const SwapchainFrameGraphRecord& record, DescriptorWriteHelper& write_helper,
-                                          const SwapchainPassResources& resources,
-                                          const SamplerResources&       sampler_resources)
+                                          SwapchainPassResources& resources,
+                                          const SamplerResources& sampler_resources)
 {
+    resources.descriptor_set = write_helper.allocate_descriptor_set(resources.descriptorSetLayout);
+
     const FrameGraphTexture hdr_scene_texture =
         get_frame_graph_texture(frame_graph_resources, frame_graph, record.scene_hdr);
     const FrameGraphTexture lighting_texture =
@@ -73,8 +73,8 @@ struct SamplerResources;
 void update_swapchain_pass_descriptor_set(const FrameGraph::FrameGraph&    frame_graph,
                                           const FrameGraphResources&       frame_graph_resources,
                                           const SwapchainFrameGraphRecord& record, DescriptorWriteHelper& write_helper,
-                                          const SwapchainPassResources& resources,
-                                          const SamplerResources&       sampler_resources);
+                                          SwapchainPassResources& resources,
+                                          const SamplerResources& sampler_resources);
 
 struct CommandBuffer;
 struct FrameGraphHelper;
@@ -7,6 +7,7 @@
 
 #include "TestGraphics.h"
 
+#include "renderer/graph/CompileCache.h"
 #include "renderer/graph/FrameGraphBuilder.h"
 #include "renderer/graph/GraphDebug.h"
 #include "renderer/vulkan/Backend.h"
@@ -28,9 +29,14 @@
 
 #include "profiling/Scope.h"
 
+#include <core/jobs/JobSystem.h>
+
 #include <vulkan_loader/Vulkan.h>
 
+#include <algorithm>
 #include <array>
+#include <span>
+#include <vector>
 
 #include <imgui.h>
 
@@ -38,6 +44,45 @@ namespace Reaper
 {
 namespace
 {
+    // Passes that get their own secondary command buffer, the order doesn't matter.
+    // They are recorded in parallel, then executed in frame graph schedule order by the command buffer of their submit
+    // batch. Frame graph barriers are recorded by the passes themselves, so they stay at the same boundaries as with a
+    // single command buffer.
+    namespace RecordedPass
+    {
+        enum type : u32
+        {
+            MeshletCullingClear,
+            CullMeshlets,
+            CullTrianglesPrepare,
+            CullTriangles,
+            MeshletCullingDebug,
+            DebugGeometryStart,
+            Shadow,
+            VisBuffer,
+            FillGBuffer,
+            LegacyDepthResolve,
+            HZBReduce,
+            TileDepthCopy,
+            LightClassify,
+            LightRaster,
+            TiledLighting,
+            TiledLightingDebug,
+            Forward,
+            GUI,
+            HistogramClear,
+            Histogram,
+            Exposure,
+            DebugGeometryBuildCmds,
+            DebugGeometryDraw,
+            ToneMap,
+            Swapchain,
+            AudioRender,
+            AudioCopy,
+            Count,
+        };
+    } // namespace RecordedPass
+
     void log_barriers(ReaperRoot& root, const FrameGraph::FrameGraph& framegraph,
                       const FrameGraph::FrameGraphSchedule& schedule)
     {
@@ -65,6 +110,17 @@ namespace
             }
         }
     }
+
+    void log_transient_memory(ReaperRoot& root, const FrameGraphResources& resources)
+    {
+        const FrameGraph::TransientHeapLayout& texture_layout = resources.texture_heap_layout;
+        const FrameGraph::TransientHeapLayout& buffer_layout = resources.buffer_heap_layout;
+
+        log_debug(root, "framegraph: texture heap uses {} bytes, saved {} bytes with aliasing",
+                  texture_layout.heap_size_bytes, texture_layout.total_size_bytes - texture_layout.heap_size_bytes);
+        log_debug(root, "framegraph: buffer heap uses {} bytes, saved {} bytes with aliasing",
+                  buffer_layout.heap_size_bytes, buffer_layout.total_size_bytes - buffer_layout.heap_size_bytes);
+    }
 } // namespace
 
 void resize_swapchain(ReaperRoot& root, VulkanBackend& backend)
@@ -108,6 +164,17 @@ void backend_debug_ui(VulkanBackend& backend)
         ImGui::Checkbox("Freeze culling [BROKEN]", &backend.options.freeze_meshlet_culling); // FIXME
         ImGui::Checkbox("Enable debug tile culling", &backend.options.enable_debug_tile_lighting);
         ImGui::Checkbox("Enable MSAA-based visibility", &backend.options.enable_msaa_visibility);
+        ImGui::Checkbox("Enable framegraph memory aliasing", &backend.options.enable_framegraph_memory_aliasing);
+        ImGui::BeginDisabled(backend.compute_queue == VK_NULL_HANDLE);
+        ImGui::Checkbox("Enable async compute", &backend.options.enable_async_compute);
+        ImGui::EndDisabled();
+        ImGui::Checkbox("Enable mesh cache defragmentation", &backend.options.enable_mesh_cache_defragmentation);
+        {
+            const u32 budget_min_mib = 16;
+            const u32 budget_max_mib = 4096;
+            ImGui::SliderScalar("Texture VRAM budget (MiB)", ImGuiDataType_U32,
+                                &backend.options.texture_vram_budget_mib, &budget_min_mib, &budget_max_mib);
+        }
         ImGui::SliderFloat("Tonemap min (nits)", &backend.presentInfo.tonemap_min_nits, 0.0001f, 1.f);
         ImGui::SliderFloat("Tonemap max (nits)", &backend.presentInfo.tonemap_max_nits, 80.f, 2000.f);
         ImGui::SliderFloat("SDR UI max brightness (nits)", &backend.presentInfo.sdr_ui_max_brightness_nits, 20.f,
@@ -119,11 +186,20 @@ void backend_debug_ui(VulkanBackend& backend)
     ImGui::End();
 }
 
-void backend_execute_frame(ReaperRoot& root, VulkanBackend& backend, CommandBuffer& cmdBuffer,
-                           const PreparedData& prepared, const TiledLightingFrame& tiled_lighting_frame,
-                           BackendResources& resources, ImDrawData* imgui_draw_data)
+void backend_execute_frame(ReaperRoot& root, VulkanBackend& backend, const PreparedData& prepared,
+                           const TiledLightingFrame& tiled_lighting_frame, BackendResources& resources,
+                           ImDrawData* imgui_draw_data)
 {
-    pipeline_factory_update(backend, resources.pipeline_factory, resources.shader_modules);
+    const u64 new_frame_index = backend.frame_index + 1;
+
+    // The context of the new frame was last used frames_in_flight frames ago, wait for the GPU to be done with it.
+    // Later frames can still be running.
+    const u64 completed_frame_index =
+        new_frame_index > resources.frames_in_flight ? new_frame_index - resources.frames_in_flight : 0;
+
+    FrameContext& frame_context = get_frame_context(resources, new_frame_index);
+
+    Assert(frame_context.frame_index <= completed_frame_index);
 
     {
         VkResult waitResult;
@@ -134,7 +210,7 @@ void backend_execute_frame(ReaperRoot& root, VulkanBackend& backend, CommandBuff
             REAPER_PROFILE_SCOPE_COLOR("Wait for timeline semaphore", Color::Red);
 
             const u64 waitTimeoutNs = 1 * 1000 * 1000 * 1000;
-            const u64 frame_index_to_wait = backend.frame_index;
+            const u64 frame_index_to_wait = completed_frame_index;
 
             const VkSemaphoreWaitInfo timeline_semaphore_wait_info = {
                 .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
@@ -163,7 +239,20 @@ void backend_execute_frame(ReaperRoot& root, VulkanBackend& backend, CommandBuff
 #endif
     }
 
-    backend.frame_index += 1;
+    // Memory used by the completed frames can be reused
+    release_mesh_cache_memory(resources.mesh_cache, completed_frame_index);
+    release_material_resources_memory(backend, resources.material_resources, completed_frame_index);
+
+    // Also swaps in pipelines rebuilt after a shader reload
+    pipeline_factory_update(root, backend, resources.pipeline_factory, resources.shader_modules, completed_frame_index);
+
+    backend.frame_index = new_frame_index;
+
+    log_debug(root, "vulkan: reset frame context");
+
+    reset_frame_context(backend, frame_context);
+
+    frame_context.frame_index = new_frame_index;
 
     VkResult acquireResult;
     u64      acquireTimeoutUs = 1000000000;
@@ -175,7 +264,7 @@ void backend_execute_frame(ReaperRoot& root, VulkanBackend& backend, CommandBuff
     {
         log_debug(root, "vulkan: acquiring frame try #{}", acquireTryCount);
         acquireResult = vkAcquireNextImageKHR(backend.device, backend.presentInfo.swapchain, acquireTimeoutUs,
-                                              backend.semaphore_swapchain_image_available, VK_NULL_HANDLE,
+                                              frame_context.semaphore_swapchain_image_available, VK_NULL_HANDLE,
                                               &current_swapchain_index);
 
         if (acquireResult != VK_NOT_READY)
@@ -263,46 +352,73 @@ void backend_execute_frame(ReaperRoot& root, VulkanBackend& backend, CommandBuff
 
     const AudioFrameGraphRecord audio_pass = create_audio_frame_graph_record(builder);
 
-    builder.build();
-    // DumpFrameGraph(framegraph);
+    // In steady state the graph is the same every frame, we only pay for the compilation when it changes.
+    FrameGraph::CompileCache& compile_cache = resources.framegraph_resources.compile_cache;
+
+    const bool is_culling_cached = build_cached(compile_cache, framegraph);
+
+    const bool use_async_compute = backend.options.enable_async_compute && backend.compute_queue != VK_NULL_HANDLE;
+
+    const bool is_order_cached = compute_schedule_order_cached(compile_cache, framegraph, use_async_compute);
 
-    allocate_framegraph_volatile_resources(backend, resources.framegraph_resources, framegraph);
+    const FrameGraph::FrameGraphSchedule& schedule = compile_cache.schedule;
+
+    allocate_framegraph_volatile_resources(backend, resources.framegraph_resources, framegraph, schedule);
+
+    const bool is_barriers_cached =
+        compute_schedule_barriers_cached(compile_cache, framegraph, resources.framegraph_resources.aliases);
+
+    log_debug(root, "framegraph: compilation cache culling = {}, order = {}, barriers = {}", is_culling_cached,
+              is_order_cached, is_barriers_cached);
+
+    log_transient_memory(root, resources.framegraph_resources);
+    // DumpFrameGraph(framegraph, std::array{resources.framegraph_resources.texture_heap_layout,
+    //                                       resources.framegraph_resources.buffer_heap_layout});
+
+    // Texture views can change here, so this has to come before the descriptor updates
+    update_material_texture_residency(backend, resources.material_resources, completed_frame_index);
+    stream_material_textures(backend, resources.material_resources);
+
+    StorageBufferAllocator& frame_storage_allocator = frame_context.storage_allocator;
 
     {
         REAPER_PROFILE_SCOPE("Update pass resources");
 
-        DescriptorWriteHelper descriptor_write_helper(200, 200);
+        DescriptorWriteHelper descriptor_write_helper(backend.device, frame_context.descriptor_pool,
+                                                      MaxFrameImageDescriptorCount, MaxFrameBufferDescriptorCount);
 
-        upload_lighting_pass_frame_resources(resources.frame_storage_allocator, prepared, resources.lighting_resources);
+        upload_lighting_pass_frame_resources(frame_storage_allocator, prepared, resources.lighting_resources);
 
-        update_shadow_map_resources(descriptor_write_helper, resources.frame_storage_allocator, prepared,
-                                    resources.shadow_map_resources, resources.mesh_cache.vertexBufferPosition);
+        update_shadow_map_resources(descriptor_write_helper, frame_storage_allocator, prepared,
+                                    resources.shadow_map_resources, get_vertex_position_buffer(resources.mesh_cache));
 
         update_vis_buffer_pass_resources(
             framegraph, resources.framegraph_resources, vis_buffer_record, descriptor_write_helper,
-            resources.frame_storage_allocator, resources.vis_buffer_pass_resources, prepared,
-            resources.samplers_resources, resources.material_resources, resources.mesh_cache,
-            backend.options.enable_msaa_visibility, backend.physical_device.macro_features.compute_stores_to_depth);
+            frame_storage_allocator, resources.vis_buffer_pass_resources, prepared, resources.samplers_resources,
+            resources.material_resources, resources.mesh_cache, backend.options.enable_msaa_visibility,
+            backend.physical_device.macro_features.compute_stores_to_depth);
 
         update_tiled_lighting_raster_pass_resources(framegraph, resources.framegraph_resources, light_raster_record,
-                                                    descriptor_write_helper, resources.frame_storage_allocator,
+                                                    descriptor_write_helper, frame_storage_allocator,
                                                     resources.tiled_raster_resources, tiled_lighting_frame);
 
         update_meshlet_culling_passes_resources(framegraph, resources.framegraph_resources, meshlet_pass,
-                                                descriptor_write_helper, resources.frame_storage_allocator, prepared,
+                                                descriptor_write_helper, frame_storage_allocator, prepared,
                                                 resources.meshlet_culling_resources, resources.mesh_cache);
 
         update_hzb_pass_descriptor_set(framegraph, resources.framegraph_resources, hzb_reduce, descriptor_write_helper,
                                        resources.hzb_pass_resources, resources.samplers_resources);
 
-        update_forward_pass_descriptor_sets(
-            backend, framegraph, resources.framegraph_resources, forward, descriptor_write_helper,
-            resources.frame_storage_allocator, prepared, resources.forward_pass_resources, resources.samplers_resources,
-            resources.material_resources, resources.mesh_cache, resources.lighting_resources);
+        update_forward_pass_descriptor_sets(framegraph, resources.framegraph_resources, forward,
+                                            descriptor_write_helper, frame_storage_allocator, prepared,
+                                            resources.forward_pass_resources, resources.samplers_resources,
+                                            resources.material_resources, resources.mesh_cache,
+                                            resources.lighting_resources);
 
-        update_tiled_lighting_pass_resources(backend, framegraph, resources.framegraph_resources, tiled_lighting,
-                                             descriptor_write_helper, prepared, resources.lighting_resources,
-                                             resources.tiled_lighting_resources, resources.samplers_resources);
+        update_tiled_lighting_pass_resources(framegraph, resources.framegraph_resources, tiled_lighting,
+                                             descriptor_write_helper, frame_storage_allocator, prepared,
+                                             resources.lighting_resources, resources.tiled_lighting_resources,
+                                             resources.samplers_resources);
 
         update_tiled_lighting_debug_pass_resources(framegraph, resources.framegraph_resources,
                                                    tiled_lighting_debug_record, descriptor_write_helper,
@@ -316,10 +432,11 @@ void backend_execute_frame(ReaperRoot& root, VulkanBackend& backend, CommandBuff
                                             descriptor_write_helper, resources.exposure_pass_resources,
                                             resources.samplers_resources);
 
-        update_debug_geometry_start_resources(backend, prepared, resources.debug_geometry_resources);
+        update_debug_geometry_start_resources(frame_storage_allocator, prepared, resources.debug_geometry_resources);
 
-        update_debug_geometry_build_cmds_pass_resources(backend, framegraph, resources.framegraph_resources,
-                                                        debug_geometry_build_cmds, descriptor_write_helper, prepared,
+        update_debug_geometry_build_cmds_pass_resources(framegraph, resources.framegraph_resources,
+                                                        debug_geometry_build_cmds, descriptor_write_helper,
+                                                        frame_storage_allocator, prepared,
                                                         resources.debug_geometry_resources);
 
         update_debug_geometry_draw_pass_descriptor_sets(framegraph, resources.framegraph_resources, debug_geometry_draw,
@@ -332,15 +449,13 @@ void backend_execute_frame(ReaperRoot& root, VulkanBackend& backend, CommandBuff
                                              descriptor_write_helper, resources.swapchain_pass_resources,
                                              resources.samplers_resources);
 
-        update_audio_render_resources(backend, framegraph, resources.framegraph_resources, audio_pass,
-                                      descriptor_write_helper, prepared, resources.audio_resources);
+        update_audio_render_resources(framegraph, resources.framegraph_resources, audio_pass, descriptor_write_helper,
+                                      frame_storage_allocator, prepared, resources.audio_resources);
 
         descriptor_write_helper.flush_descriptor_write_helper(backend.device);
     }
 
-    storage_allocator_commit_to_gpu(backend, resources.frame_storage_allocator);
-
-    const FrameGraph::FrameGraphSchedule schedule = compute_schedule(framegraph);
+    storage_allocator_commit_to_gpu(backend, frame_storage_allocator);
 
     log_barriers(root, framegraph, schedule);
 
@@ -362,8 +477,7 @@ void backend_execute_frame(ReaperRoot& root, VulkanBackend& backend, CommandBuff
                                                       .access_mask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
                                                       .image_layout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL};
 
-    log_debug(root, "vulkan: record command buffer");
-    AssertVk(vkResetCommandPool(backend.device, backend.resources->gfxCommandPool, VK_FLAGS_NONE));
+    log_debug(root, "vulkan: record command buffers");
 
     const VkCommandBufferBeginInfo cmdBufferBeginInfo = {
         .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
@@ -372,196 +486,351 @@ void backend_execute_frame(ReaperRoot& root, VulkanBackend& backend, CommandBuff
         .pInheritanceInfo = nullptr,
     };
 
-    AssertVk(vkBeginCommandBuffer(cmdBuffer.handle, &cmdBufferBeginInfo));
+    // Indexed like the submit batches of the schedule.
+    // The first batch is always on the graphics queue and uses the main command buffer.
+    std::vector<CommandBuffer> batch_cmd_buffers;
 
-    {
-        REAPER_GPU_SCOPE(cmdBuffer, "GPU Frame");
+    Assert(!schedule.submit_batches.empty());
+    Assert(schedule.submit_batches[0].queue_type == FrameGraph::QueueType::Graphics);
 
-        if (backend.presentInfo.queue_swapchain_transition)
-        {
-            REAPER_GPU_SCOPE(cmdBuffer, "Barrier");
+    for (const FrameGraph::SubmitBatch& batch : schedule.submit_batches)
+    {
+        Assert(batch.signal_value <= MaxSubmitBatchCountPerQueue, "Too many submit batches");
 
-            std::vector<VkImageMemoryBarrier2> imageBarriers;
+        const CommandBuffer& batch_cmd_buffer =
+            frame_context.batch_cmd_buffers[batch.queue_type][batch.signal_value - 1];
 
-            for (u32 swapchainImageIndex = 0; swapchainImageIndex < static_cast<u32>(backend.presentInfo.images.size());
-                 swapchainImageIndex++)
-            {
-                const GPUTextureAccess src = swapchain_access_initial;
-                const GPUTextureAccess dst = (swapchainImageIndex == current_swapchain_index)
-                                                 ? swapchain_access_render
-                                                 : swapchain_access_present;
+        AssertVk(vkBeginCommandBuffer(batch_cmd_buffer.handle, &cmdBufferBeginInfo));
 
-                const GPUTextureSubresource subresource = default_texture_subresource_one_color_mip();
+        batch_cmd_buffers.push_back(batch_cmd_buffer);
+    }
 
-                imageBarriers.emplace_back(
-                    get_vk_image_barrier(backend.presentInfo.images[swapchainImageIndex], subresource, src, dst));
-            }
+    CommandBuffer& cmdBuffer = batch_cmd_buffers[0];
 
-            const VkDependencyInfo dependencies = get_vk_image_barrier_depency_info(imageBarriers);
+    if (backend.presentInfo.queue_swapchain_transition)
+    {
+        REAPER_GPU_SCOPE(cmdBuffer, "Barrier");
 
-            vkCmdPipelineBarrier2(cmdBuffer.handle, &dependencies);
+        std::vector<VkImageMemoryBarrier2> imageBarriers;
 
-            backend.presentInfo.queue_swapchain_transition = false;
-        }
-        else
+        for (u32 swapchainImageIndex = 0; swapchainImageIndex < static_cast<u32>(backend.presentInfo.images.size());
+             swapchainImageIndex++)
         {
-            REAPER_GPU_SCOPE(cmdBuffer, "Barrier");
+            const GPUTextureAccess src = swapchain_access_initial;
+            const GPUTextureAccess dst = (swapchainImageIndex == current_swapchain_index) ? swapchain_access_render
+                                                                                           : swapchain_access_present;
 
-            const VkImageMemoryBarrier2 barrier = get_vk_image_barrier(
-                backend.presentInfo.images[current_swapchain_index], default_texture_subresource_one_color_mip(),
-                swapchain_access_present, swapchain_access_render);
-
-            const VkDependencyInfo dependencies = get_vk_image_barrier_depency_info(std::span(&barrier, 1));
+            const GPUTextureSubresource subresource = default_texture_subresource_one_color_mip();
 
-            vkCmdPipelineBarrier2(cmdBuffer.handle, &dependencies);
+            imageBarriers.emplace_back(
+                get_vk_image_barrier(backend.presentInfo.images[swapchainImageIndex], subresource, src, dst));
         }
 
-        record_material_upload_command_buffer(resources.material_resources.staging, cmdBuffer);
-
-        record_meshlet_culling_clear_command_buffer(frame_graph_helper, meshlet_pass.clear, cmdBuffer);
-
-        record_meshlet_culling_command_buffer(root, frame_graph_helper, meshlet_pass.cull_meshlets, cmdBuffer,
-                                              resources.pipeline_factory, prepared,
-                                              resources.meshlet_culling_resources);
+        const VkDependencyInfo dependencies = get_vk_image_barrier_depency_info(imageBarriers);
 
-        record_triangle_culling_prepare_command_buffer(frame_graph_helper, meshlet_pass.cull_triangles_prepare,
-                                                       cmdBuffer, resources.pipeline_factory, prepared,
-                                                       resources.meshlet_culling_resources);
+        vkCmdPipelineBarrier2(cmdBuffer.handle, &dependencies);
 
-        record_triangle_culling_command_buffer(frame_graph_helper, meshlet_pass.cull_triangles, cmdBuffer,
-                                               resources.pipeline_factory, prepared,
-                                               resources.meshlet_culling_resources);
-
-        record_meshlet_culling_debug_command_buffer(frame_graph_helper, meshlet_pass.debug, cmdBuffer,
-                                                    resources.meshlet_culling_resources);
-
-        record_debug_geometry_start_command_buffer(frame_graph_helper, debug_geometry_start, cmdBuffer, prepared,
-                                                   resources.debug_geometry_resources);
-
-        record_shadow_map_command_buffer(frame_graph_helper, shadow, cmdBuffer, resources.pipeline_factory, prepared,
-                                         resources.shadow_map_resources);
-
-        record_vis_buffer_pass_command_buffer(frame_graph_helper, vis_buffer_record.render, cmdBuffer,
-                                              resources.pipeline_factory, prepared, resources.vis_buffer_pass_resources,
-                                              backend.options.enable_msaa_visibility);
-
-        record_fill_gbuffer_pass_command_buffer(frame_graph_helper, vis_buffer_record.fill_gbuffer, cmdBuffer,
-                                                resources.pipeline_factory, resources.vis_buffer_pass_resources,
-                                                render_extent, backend.options.enable_msaa_visibility,
-                                                backend.physical_device.macro_features.compute_stores_to_depth);
-
-        record_legacy_depth_resolve_pass_command_buffer(
-            frame_graph_helper, vis_buffer_record.legacy_depth_resolve, cmdBuffer, resources.pipeline_factory,
-            resources.vis_buffer_pass_resources, backend.options.enable_msaa_visibility,
-            backend.physical_device.macro_features.compute_stores_to_depth);
-
-        record_hzb_command_buffer(
-            frame_graph_helper, hzb_reduce, cmdBuffer, resources.pipeline_factory, resources.hzb_pass_resources,
-            VkExtent2D{.width = vis_buffer_record.scene_depth_properties.width,
-                       .height = vis_buffer_record.scene_depth_properties.height},
-            VkExtent2D{.width = hzb_reduce.hzb_properties.width, .height = hzb_reduce.hzb_properties.height});
+        backend.presentInfo.queue_swapchain_transition = false;
+    }
+    else
+    {
+        REAPER_GPU_SCOPE(cmdBuffer, "Barrier");
 
-        record_depth_copy(frame_graph_helper, light_raster_record.tile_depth_copy, cmdBuffer,
-                          resources.pipeline_factory, resources.tiled_raster_resources);
+        const VkImageMemoryBarrier2 barrier =
+            get_vk_image_barrier(backend.presentInfo.images[current_swapchain_index],
+                                 default_texture_subresource_one_color_mip(), swapchain_access_present,
+                                 swapchain_access_render);
 
-        record_light_classify_command_buffer(frame_graph_helper, light_raster_record.light_classify, cmdBuffer,
-                                             resources.pipeline_factory, tiled_lighting_frame,
-                                             resources.tiled_raster_resources);
+        const VkDependencyInfo dependencies = get_vk_image_barrier_depency_info(std::span(&barrier, 1));
 
-        record_light_raster_command_buffer(frame_graph_helper, light_raster_record.light_raster, cmdBuffer,
-                                           resources.pipeline_factory, resources.tiled_raster_resources.light_raster);
+        vkCmdPipelineBarrier2(cmdBuffer.handle, &dependencies);
+    }
 
-        record_tiled_lighting_command_buffer(frame_graph_helper, tiled_lighting, cmdBuffer, resources.pipeline_factory,
-                                             resources.tiled_lighting_resources, render_extent,
-                                             VkExtent2D{light_raster_record.tile_depth_properties.width,
-                                                        light_raster_record.tile_depth_properties.height});
+    record_material_upload_command_buffer(resources.material_resources, cmdBuffer, backend.frame_index);
+
+    // Both exposure passes are recorded in one go
+    Assert(schedule.render_pass_batches[exposure.reduce.pass_handle]
+           == schedule.render_pass_batches[exposure.reduce_tail.pass_handle]);
+
+    std::array<FrameGraph::RenderPassHandle, RecordedPass::Count> recorded_pass_handles;
+    recorded_pass_handles[RecordedPass::MeshletCullingClear] = meshlet_pass.clear.pass_handle;
+    recorded_pass_handles[RecordedPass::CullMeshlets] = meshlet_pass.cull_meshlets.pass_handle;
+    recorded_pass_handles[RecordedPass::CullTrianglesPrepare] = meshlet_pass.cull_triangles_prepare.pass_handle;
+    recorded_pass_handles[RecordedPass::CullTriangles] = meshlet_pass.cull_triangles.pass_handle;
+    recorded_pass_handles[RecordedPass::MeshletCullingDebug] = meshlet_pass.debug.pass_handle;
+    recorded_pass_handles[RecordedPass::DebugGeometryStart] = debug_geometry_start.pass_handle;
+    recorded_pass_handles[RecordedPass::Shadow] = shadow.pass_handle;
+    recorded_pass_handles[RecordedPass::VisBuffer] = vis_buffer_record.render.pass_handle;
+    recorded_pass_handles[RecordedPass::FillGBuffer] = vis_buffer_record.fill_gbuffer.pass_handle;
+    recorded_pass_handles[RecordedPass::LegacyDepthResolve] = vis_buffer_record.legacy_depth_resolve.pass_handle;
+    recorded_pass_handles[RecordedPass::HZBReduce] = hzb_reduce.pass_handle;
+    recorded_pass_handles[RecordedPass::TileDepthCopy] = light_raster_record.tile_depth_copy.pass_handle;
+    recorded_pass_handles[RecordedPass::LightClassify] = light_raster_record.light_classify.pass_handle;
+    recorded_pass_handles[RecordedPass::LightRaster] = light_raster_record.light_raster.pass_handle;
+    recorded_pass_handles[RecordedPass::TiledLighting] = tiled_lighting.pass_handle;
+    recorded_pass_handles[RecordedPass::TiledLightingDebug] = tiled_lighting_debug_record.pass_handle;
+    recorded_pass_handles[RecordedPass::Forward] = forward.pass_handle;
+    recorded_pass_handles[RecordedPass::GUI] = gui.pass_handle;
+    recorded_pass_handles[RecordedPass::HistogramClear] = histogram_clear.pass_handle;
+    recorded_pass_handles[RecordedPass::Histogram] = histogram.pass_handle;
+    recorded_pass_handles[RecordedPass::Exposure] = exposure.reduce.pass_handle;
+    recorded_pass_handles[RecordedPass::DebugGeometryBuildCmds] = debug_geometry_build_cmds.pass_handle;
+    recorded_pass_handles[RecordedPass::DebugGeometryDraw] = debug_geometry_draw.pass_handle;
+    recorded_pass_handles[RecordedPass::ToneMap] = tone_map.pass_handle;
+    recorded_pass_handles[RecordedPass::Swapchain] = swapchain.pass_handle;
+    recorded_pass_handles[RecordedPass::AudioRender] = audio_pass.render.pass_handle;
+    recorded_pass_handles[RecordedPass::AudioCopy] = audio_pass.staging_copy.pass_handle;
+
+    // Every pass gets its own secondary command buffer, allocated from a pool owned by the recording thread
+    std::array<CommandBuffer, RecordedPass::Count> pass_cmd_buffers = {};
+
+    parallel_for(*root.job_system, RecordedPass::Count, [&](u32 pass_index) {
+        const u32 batch_index = schedule.render_pass_batches[recorded_pass_handles[pass_index]];
+
+        // Culled passes are neither recorded nor executed
+        if (batch_index == FrameGraph::InvalidSubmitBatch)
+            return;
+
+        REAPER_PROFILE_SCOPE("Record pass");
+
+        const u32      thread_index = get_current_thread_index(*root.job_system);
+        CommandBuffer& pass_cmd_buffer = pass_cmd_buffers[pass_index];
+
+        pass_cmd_buffer = begin_thread_secondary_command_buffer(backend, resources, frame_context, thread_index,
+                                                                schedule.submit_batches[batch_index].queue_type);
+
+        switch (pass_index)
+        {
+        case RecordedPass::MeshletCullingClear:
+            record_meshlet_culling_clear_command_buffer(frame_graph_helper, meshlet_pass.clear, pass_cmd_buffer);
+            break;
+        case RecordedPass::CullMeshlets:
+            record_meshlet_culling_command_buffer(root, frame_graph_helper, meshlet_pass.cull_meshlets,
+                                                  pass_cmd_buffer, resources.pipeline_factory, prepared,
+                                                  resources.meshlet_culling_resources);
+            break;
+        case RecordedPass::CullTrianglesPrepare:
+            record_triangle_culling_prepare_command_buffer(frame_graph_helper, meshlet_pass.cull_triangles_prepare,
+                                                           pass_cmd_buffer, resources.pipeline_factory, prepared,
+                                                           resources.meshlet_culling_resources);
+            break;
+        case RecordedPass::CullTriangles:
+            record_triangle_culling_command_buffer(frame_graph_helper, meshlet_pass.cull_triangles, pass_cmd_buffer,
+                                                   resources.pipeline_factory, prepared,
+                                                   resources.meshlet_culling_resources);
+            break;
+        case RecordedPass::MeshletCullingDebug:
+            record_meshlet_culling_debug_command_buffer(frame_graph_helper, meshlet_pass.debug, pass_cmd_buffer,
+                                                        prepared, backend.frame_index,
+                                                        resources.meshlet_culling_resources);
+            break;
+        case RecordedPass::DebugGeometryStart:
+            record_debug_geometry_start_command_buffer(frame_graph_helper, debug_geometry_start, pass_cmd_buffer,
+                                                       prepared, resources.debug_geometry_resources);
+            break;
+        case RecordedPass::Shadow:
+            record_shadow_map_command_buffer(frame_graph_helper, shadow, pass_cmd_buffer, resources.pipeline_factory,
+                                             prepared, resources.shadow_map_resources);
+            break;
+        case RecordedPass::VisBuffer:
+            record_vis_buffer_pass_command_buffer(frame_graph_helper, vis_buffer_record.render, pass_cmd_buffer,
+                                                  resources.pipeline_factory, prepared,
+                                                  resources.vis_buffer_pass_resources,
+                                                  backend.options.enable_msaa_visibility);
+            break;
+        case RecordedPass::FillGBuffer:
+            record_fill_gbuffer_pass_command_buffer(frame_graph_helper, vis_buffer_record.fill_gbuffer,
+                                                    pass_cmd_buffer, resources.pipeline_factory,
+                                                    resources.vis_buffer_pass_resources, render_extent,
+                                                    backend.options.enable_msaa_visibility,
+                                                    backend.physical_device.macro_features.compute_stores_to_depth);
+            break;
+        case RecordedPass::LegacyDepthResolve:
+            record_legacy_depth_resolve_pass_command_buffer(
+                frame_graph_helper, vis_buffer_record.legacy_depth_resolve, pass_cmd_buffer,
+                resources.pipeline_factory, resources.vis_buffer_pass_resources,
+                backend.options.enable_msaa_visibility,
+                backend.physical_device.macro_features.compute_stores_to_depth);
+            break;
+        case RecordedPass::HZBReduce:
+            record_hzb_command_buffer(
+                frame_graph_helper, hzb_reduce, pass_cmd_buffer, resources.pipeline_factory,
+                resources.hzb_pass_resources,
+                VkExtent2D{.width = vis_buffer_record.scene_depth_properties.width,
+                           .height = vis_buffer_record.scene_depth_properties.height},
+                VkExtent2D{.width = hzb_reduce.hzb_properties.width, .height = hzb_reduce.hzb_properties.height});
+            break;
+        case RecordedPass::TileDepthCopy:
+            record_depth_copy(frame_graph_helper, light_raster_record.tile_depth_copy, pass_cmd_buffer,
+                              resources.pipeline_factory, resources.tiled_raster_resources);
+            break;
+        case RecordedPass::LightClassify:
+            record_light_classify_command_buffer(frame_graph_helper, light_raster_record.light_classify,
+                                                 pass_cmd_buffer, resources.pipeline_factory, tiled_lighting_frame,
+                                                 resources.tiled_raster_resources);
+            break;
+        case RecordedPass::LightRaster:
+            record_light_raster_command_buffer(frame_graph_helper, light_raster_record.light_raster, pass_cmd_buffer,
+                                               resources.pipeline_factory,
+                                               resources.tiled_raster_resources.light_raster);
+            break;
+        case RecordedPass::TiledLighting:
+            record_tiled_lighting_command_buffer(frame_graph_helper, tiled_lighting, pass_cmd_buffer,
+                                                 resources.pipeline_factory, resources.tiled_lighting_resources,
+                                                 render_extent,
+                                                 VkExtent2D{light_raster_record.tile_depth_properties.width,
+                                                            light_raster_record.tile_depth_properties.height});
+            break;
+        case RecordedPass::TiledLightingDebug:
+            record_tiled_lighting_debug_command_buffer(frame_graph_helper, tiled_lighting_debug_record,
+                                                       pass_cmd_buffer, resources.pipeline_factory,
+                                                       resources.tiled_lighting_resources, render_extent,
+                                                       VkExtent2D{light_raster_record.tile_depth_properties.width,
+                                                                  light_raster_record.tile_depth_properties.height});
+            break;
+        case RecordedPass::Forward:
+            record_forward_pass_command_buffer(frame_graph_helper, forward, pass_cmd_buffer,
+                                               resources.pipeline_factory, prepared, resources.forward_pass_resources);
+            break;
+        case RecordedPass::GUI:
+            record_gui_command_buffer(frame_graph_helper, gui, pass_cmd_buffer, resources.pipeline_factory,
+                                      resources.gui_pass_resources, imgui_draw_data);
+            break;
+        case RecordedPass::HistogramClear:
+            record_histogram_clear_command_buffer(frame_graph_helper, histogram_clear, pass_cmd_buffer);
+            break;
+        case RecordedPass::Histogram:
+            record_histogram_command_buffer(frame_graph_helper, histogram, pass_cmd_buffer,
+                                            resources.pipeline_factory, resources.histogram_pass_resources,
+                                            render_extent);
+            break;
+        case RecordedPass::Exposure:
+            record_exposure_command_buffer(frame_graph_helper, exposure, pass_cmd_buffer, resources.pipeline_factory,
+                                           resources.exposure_pass_resources);
+            break;
+        case RecordedPass::DebugGeometryBuildCmds:
+            record_debug_geometry_build_cmds_command_buffer(frame_graph_helper, debug_geometry_build_cmds,
+                                                            pass_cmd_buffer, resources.pipeline_factory,
+                                                            resources.debug_geometry_resources);
+            break;
+        case RecordedPass::DebugGeometryDraw:
+            record_debug_geometry_draw_command_buffer(frame_graph_helper, debug_geometry_draw, pass_cmd_buffer,
+                                                      resources.pipeline_factory, resources.debug_geometry_resources);
+            break;
+        case RecordedPass::ToneMap:
+            record_tone_map_command_buffer(frame_graph_helper, tone_map, pass_cmd_buffer, resources.pipeline_factory,
+                                           resources.tone_map_pass_resources, backend.presentInfo.tonemap_min_nits,
+                                           backend.presentInfo.tonemap_max_nits);
+            break;
+        case RecordedPass::Swapchain:
+        {
+            record_swapchain_command_buffer(
+                frame_graph_helper, swapchain, pass_cmd_buffer, resources.swapchain_pass_resources,
+                backend.presentInfo.imageViews[current_swapchain_index], backend.presentInfo.surface_extent,
+                backend.presentInfo.exposure_compensation_stops, backend.presentInfo.tonemap_min_nits,
+                backend.presentInfo.tonemap_max_nits, backend.presentInfo.sdr_ui_max_brightness_nits,
+                backend.presentInfo.sdr_peak_brightness_nits);
 
-        record_tiled_lighting_debug_command_buffer(frame_graph_helper, tiled_lighting_debug_record, cmdBuffer,
-                                                   resources.pipeline_factory, resources.tiled_lighting_resources,
-                                                   render_extent,
-                                                   VkExtent2D{light_raster_record.tile_depth_properties.width,
-                                                              light_raster_record.tile_depth_properties.height});
+            REAPER_GPU_SCOPE(pass_cmd_buffer, "Barrier");
 
-        record_forward_pass_command_buffer(frame_graph_helper, forward, cmdBuffer, resources.pipeline_factory, prepared,
-                                           resources.forward_pass_resources);
+            const GPUTextureAccess src = swapchain_access_render;
+            const GPUTextureAccess dst = swapchain_access_present;
 
-        record_gui_command_buffer(frame_graph_helper, gui, cmdBuffer, resources.pipeline_factory,
-                                  resources.gui_pass_resources, imgui_draw_data);
+            const GPUTextureSubresource subresource = default_texture_subresource_one_color_mip();
 
-        record_histogram_clear_command_buffer(frame_graph_helper, histogram_clear, cmdBuffer);
+            const VkImageMemoryBarrier2 barrier =
+                get_vk_image_barrier(backend.presentInfo.images[current_swapchain_index], subresource, src, dst);
 
-        record_histogram_command_buffer(frame_graph_helper, histogram, cmdBuffer, resources.pipeline_factory,
-                                        resources.histogram_pass_resources, render_extent);
+            const VkDependencyInfo dependencies = get_vk_image_barrier_depency_info(std::span(&barrier, 1));
 
-        record_exposure_command_buffer(frame_graph_helper, exposure, cmdBuffer, resources.pipeline_factory,
-                                       resources.exposure_pass_resources);
+            vkCmdPipelineBarrier2(pass_cmd_buffer.handle, &dependencies);
+            break;
+        }
+        case RecordedPass::AudioRender:
+            record_audio_render_command_buffer(frame_graph_helper, audio_pass.render, pass_cmd_buffer,
+                                               resources.pipeline_factory, prepared, resources.audio_resources);
+            break;
+        case RecordedPass::AudioCopy:
+            record_audio_copy_command_buffer(frame_graph_helper, audio_pass.staging_copy, pass_cmd_buffer,
+                                             backend.frame_index, resources.audio_resources);
+            break;
+        default:
+            AssertUnreachable();
+            break;
+        }
 
-        record_debug_geometry_build_cmds_command_buffer(frame_graph_helper, debug_geometry_build_cmds, cmdBuffer,
-                                                        resources.pipeline_factory, resources.debug_geometry_resources);
+        AssertVk(vkEndCommandBuffer(pass_cmd_buffer.handle));
+    });
 
-        record_debug_geometry_draw_command_buffer(frame_graph_helper, debug_geometry_draw, cmdBuffer,
-                                                  resources.pipeline_factory, resources.debug_geometry_resources);
+    // The exposure tail has no command buffer of its own, it's recorded along with the reduce pass
+    std::vector<u32> render_pass_recorded_indices(framegraph.RenderPasses.size(), RecordedPass::Count);
 
-        record_tone_map_command_buffer(frame_graph_helper, tone_map, cmdBuffer, resources.pipeline_factory,
-                                       resources.tone_map_pass_resources, backend.presentInfo.tonemap_min_nits,
-                                       backend.presentInfo.tonemap_max_nits);
+    for (u32 pass_index = 0; pass_index < RecordedPass::Count; pass_index++)
+        render_pass_recorded_indices[recorded_pass_handles[pass_index]] = pass_index;
 
-        record_swapchain_command_buffer(
-            frame_graph_helper, swapchain, cmdBuffer, resources.swapchain_pass_resources,
-            backend.presentInfo.imageViews[current_swapchain_index], backend.presentInfo.surface_extent,
-            backend.presentInfo.exposure_compensation_stops, backend.presentInfo.tonemap_min_nits,
-            backend.presentInfo.tonemap_max_nits, backend.presentInfo.sdr_ui_max_brightness_nits,
-            backend.presentInfo.sdr_peak_brightness_nits);
+    for (u32 batch_index = 0; batch_index < schedule.submit_batches.size(); batch_index++)
+    {
+        const FrameGraph::SubmitBatch&                      batch = schedule.submit_batches[batch_index];
+        const std::span<const FrameGraph::RenderPassHandle> batch_render_passes =
+            get_queue_render_passes(schedule, batch.queue_type).subspan(batch.pass_offset, batch.pass_count);
 
+        for (u32 i = 0; i < batch_render_passes.size(); i++)
         {
-            REAPER_GPU_SCOPE(cmdBuffer, "Barrier");
-
-            const GPUTextureAccess src = swapchain_access_render;
-            const GPUTextureAccess dst = swapchain_access_present;
-
-            const GPUTextureSubresource subresource = default_texture_subresource_one_color_mip();
+            const u32 pass_index = render_pass_recorded_indices[batch_render_passes[i]];
 
-            const VkImageMemoryBarrier2 barrier =
-                get_vk_image_barrier(backend.presentInfo.images[current_swapchain_index], subresource, src, dst);
+            if (pass_index == RecordedPass::Count)
+            {
+                Assert(batch_render_passes[i] == exposure.reduce_tail.pass_handle);
+                Assert(i > 0 && batch_render_passes[i - 1] == exposure.reduce.pass_handle,
+                       "the exposure tail has to run right after the reduce pass");
+                continue;
+            }
 
-            const VkDependencyInfo dependencies = get_vk_image_barrier_depency_info(std::span(&barrier, 1));
+            Assert(pass_cmd_buffers[pass_index].handle != VK_NULL_HANDLE);
 
-            vkCmdPipelineBarrier2(cmdBuffer.handle, &dependencies);
+            vkCmdExecuteCommands(batch_cmd_buffers[batch_index].handle, 1, &pass_cmd_buffers[pass_index].handle);
         }
+    }
 
-        record_audio_render_command_buffer(frame_graph_helper, audio_pass.render, cmdBuffer, resources.pipeline_factory,
-                                           prepared, resources.audio_resources);
+    std::array<u32, FrameGraph::QueueType::Count> queue_batch_counts = {};
 
-        record_audio_copy_command_buffer(frame_graph_helper, audio_pass.staging_copy, cmdBuffer,
-                                         resources.audio_resources);
+    for (const FrameGraph::SubmitBatch& batch : schedule.submit_batches)
+    {
+        queue_batch_counts[batch.queue_type] = std::max(queue_batch_counts[batch.queue_type], batch.signal_value);
     }
 
+    // Stop recording
+    for (u32 batch_index = 0; batch_index < schedule.submit_batches.size(); batch_index++)
+    {
+        const FrameGraph::SubmitBatch& batch = schedule.submit_batches[batch_index];
+        CommandBuffer&                 batch_cmd_buffer = batch_cmd_buffers[batch_index];
+
 #if defined(REAPER_USE_TRACY)
-    TracyVkCollect(cmdBuffer.tracy_ctx, cmdBuffer.handle);
+        if (batch.signal_value == queue_batch_counts[batch.queue_type])
+        {
+            // Every recording thread has its own profiling contexts
+            for (const auto& queue_tracy_ctx : resources.thread_tracy_ctx)
+            {
+                TracyVkCollect(queue_tracy_ctx[batch.queue_type], batch_cmd_buffer.handle);
+            }
+        }
 #endif
 
-    // Stop recording
-    AssertVk(vkEndCommandBuffer(cmdBuffer.handle));
+        AssertVk(vkEndCommandBuffer(batch_cmd_buffer.handle));
+    }
 
     const VkSemaphoreSubmitInfo wait_semaphore_info = {
         .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
         .pNext = nullptr,
-        .semaphore = backend.semaphore_swapchain_image_available,
+        .semaphore = frame_context.semaphore_swapchain_image_available,
         .value = 0, // NOTE: Only for timeline semaphores
         .stageMask = swapchain_access_present.access_mask,
         .deviceIndex = 0, // NOTE: Set to zero when not using device groups
     };
 
-    const VkCommandBufferSubmitInfo command_buffer_info = {
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
-        .pNext = nullptr,
-        .commandBuffer = cmdBuffer.handle,
-        .deviceMask = 0, // NOTE: Set to zero when not using device groups
-    };
-
     // NOTE: VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT is used there
     // https://github.com/KhronosGroup/Vulkan-Docs/wiki/Synchronization-Examples
-    const std::array<VkSemaphoreSubmitInfo, 2> signal_semaphore_info = {
+    const std::array<VkSemaphoreSubmitInfo, 2> frame_end_signal_semaphore_info = {
         VkSemaphoreSubmitInfo{
             .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
             .pNext = nullptr,
@@ -579,20 +848,150 @@ void backend_execute_frame(ReaperRoot& root, VulkanBackend& backend, CommandBuff
             .deviceIndex = 0, // NOTE: Set to zero when not using device groups
         }};
 
-    const VkSubmitInfo2 submit_info_2 = {
-        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+    FrameSyncResources& frame_sync = resources.frame_sync_resources;
+
+    // Batch values are relative to the start of the frame
+    const std::array<u64, FrameGraph::QueueType::Count> queue_timeline_base_values = frame_sync.queue_timeline_values;
+
+    const auto get_queue_timeline_info = [&](u32 queue_type, u32 value) -> VkSemaphoreSubmitInfo {
+        return VkSemaphoreSubmitInfo{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+            .pNext = nullptr,
+            .semaphore = frame_sync.queue_timeline_semaphores[queue_type],
+            .value = queue_timeline_base_values[queue_type] + value,
+            .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            .deviceIndex = 0, // NOTE: Set to zero when not using device groups
+        };
+    };
+
+    const bool has_async_compute_batches = queue_batch_counts[FrameGraph::QueueType::AsyncCompute] > 0;
+
+    log_debug(root, "vulkan: submit mesh uploads");
+
+    if (backend.options.enable_mesh_cache_defragmentation)
+    {
+        constexpr u32 MaxDefragmentedMeshCountPerFrame = 16;
+        defragment_mesh_cache(backend, resources.mesh_cache, MaxDefragmentedMeshCountPerFrame);
+    }
+
+    // Copies run on their own queue, the first batch of each queue waits for them before touching mesh data.
+    submit_mesh_cache_uploads(backend, resources.mesh_cache);
+
+    const MeshUploadQueue& mesh_uploads = resources.mesh_cache.uploads;
+
+    const VkSemaphoreSubmitInfo mesh_upload_wait_info = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
         .pNext = nullptr,
-        .flags = VK_FLAGS_NONE,
-        .waitSemaphoreInfoCount = 1,
-        .pWaitSemaphoreInfos = &wait_semaphore_info,
-        .commandBufferInfoCount = 1,
-        .pCommandBufferInfos = &command_buffer_info,
-        .signalSemaphoreInfoCount = static_cast<u32>(signal_semaphore_info.size()),
-        .pSignalSemaphoreInfos = signal_semaphore_info.data(),
+        .semaphore = mesh_uploads.timeline_semaphore,
+        .value = mesh_uploads.submitted_batch_count,
+        .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+        .deviceIndex = 0, // NOTE: Set to zero when not using device groups
+    };
+
+    // Frames still run one after the other on the GPU, only the CPU gets ahead.
+    // That keeps the frame graph resources and the persistent pass buffers safe to share between frames.
+    const VkSemaphoreSubmitInfo previous_frame_wait_info = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+        .pNext = nullptr,
+        .semaphore = resources.frame_sync_resources.timeline_semaphore,
+        .value = backend.frame_index - 1,
+        .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+        .deviceIndex = 0, // NOTE: Set to zero when not using device groups
     };
 
     log_debug(root, "vulkan: submit drawing commands");
-    AssertVk(vkQueueSubmit2(backend.graphics_queue, 1, &submit_info_2, VK_NULL_HANDLE));
+
+    for (u32 batch_index = 0; batch_index < schedule.submit_batches.size(); batch_index++)
+    {
+        using namespace FrameGraph;
+
+        const SubmitBatch& batch = schedule.submit_batches[batch_index];
+        const bool         is_graphics = batch.queue_type == QueueType::Graphics;
+
+        std::vector<VkSemaphoreSubmitInfo> wait_semaphore_infos;
+        std::vector<VkSemaphoreSubmitInfo> signal_semaphore_infos;
+
+        if (is_graphics && batch.signal_value == 1)
+        {
+            wait_semaphore_infos.push_back(wait_semaphore_info);
+        }
+
+        if (batch.signal_value == 1 && resources.frames_in_flight > 1)
+        {
+            wait_semaphore_infos.push_back(previous_frame_wait_info);
+        }
+
+        if (batch.signal_value == 1 && mesh_uploads.submitted_batch_count > 0)
+        {
+            wait_semaphore_infos.push_back(mesh_upload_wait_info);
+        }
+
+        for (u32 queue_type = 0; queue_type < QueueType::Count; queue_type++)
+        {
+            if (batch.wait_values[queue_type] > 0)
+                wait_semaphore_infos.push_back(get_queue_timeline_info(queue_type, batch.wait_values[queue_type]));
+        }
+
+        signal_semaphore_infos.push_back(get_queue_timeline_info(batch.queue_type, batch.signal_value));
+
+        // Without async compute the last graphics batch ends the frame
+        if (is_graphics && batch.signal_value == queue_batch_counts[QueueType::Graphics] && !has_async_compute_batches)
+        {
+            signal_semaphore_infos.insert(signal_semaphore_infos.end(), frame_end_signal_semaphore_info.begin(),
+                                          frame_end_signal_semaphore_info.end());
+        }
+
+        const VkCommandBufferSubmitInfo command_buffer_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+            .pNext = nullptr,
+            .commandBuffer = batch_cmd_buffers[batch_index].handle,
+            .deviceMask = 0, // NOTE: Set to zero when not using device groups
+        };
+
+        const VkSubmitInfo2 submit_info_2 = {
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+            .pNext = nullptr,
+            .flags = VK_FLAGS_NONE,
+            .waitSemaphoreInfoCount = static_cast<u32>(wait_semaphore_infos.size()),
+            .pWaitSemaphoreInfos = wait_semaphore_infos.data(),
+            .commandBufferInfoCount = 1,
+            .pCommandBufferInfos = &command_buffer_info,
+            .signalSemaphoreInfoCount = static_cast<u32>(signal_semaphore_infos.size()),
+            .pSignalSemaphoreInfos = signal_semaphore_infos.data(),
+        };
+
+        // NOTE: Timeline semaphores allow waiting on values that will be signaled by a later submit
+        const VkQueue queue = is_graphics ? backend.graphics_queue : backend.compute_queue;
+
+        AssertVk(vkQueueSubmit2(queue, 1, &submit_info_2, VK_NULL_HANDLE));
+    }
+
+    // The last graphics batch might be waited on by compute work, so we can't make it wait for the end of the compute
+    // queue. Join both queues with an empty submit instead.
+    if (has_async_compute_batches)
+    {
+        const VkSemaphoreSubmitInfo compute_end_wait_info = get_queue_timeline_info(
+            FrameGraph::QueueType::AsyncCompute, queue_batch_counts[FrameGraph::QueueType::AsyncCompute]);
+
+        const VkSubmitInfo2 submit_info_2 = {
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+            .pNext = nullptr,
+            .flags = VK_FLAGS_NONE,
+            .waitSemaphoreInfoCount = 1,
+            .pWaitSemaphoreInfos = &compute_end_wait_info,
+            .commandBufferInfoCount = 0,
+            .pCommandBufferInfos = nullptr,
+            .signalSemaphoreInfoCount = static_cast<u32>(frame_end_signal_semaphore_info.size()),
+            .pSignalSemaphoreInfos = frame_end_signal_semaphore_info.data(),
+        };
+
+        AssertVk(vkQueueSubmit2(backend.graphics_queue, 1, &submit_info_2, VK_NULL_HANDLE));
+    }
+
+    for (u32 queue_type = 0; queue_type < FrameGraph::QueueType::Count; queue_type++)
+    {
+        frame_sync.queue_timeline_values[queue_type] += queue_batch_counts[queue_type];
+    }
 
     log_debug(root, "vulkan: present");
 
@@ -634,7 +1033,7 @@ void backend_execute_frame(ReaperRoot& root, VulkanBackend& backend, CommandBuff
 
         MeshletCullingStats                    total = {};
         const std::vector<MeshletCullingStats> culling_stats =
-            get_meshlet_culling_gpu_stats(backend, prepared, resources.meshlet_culling_resources);
+            get_meshlet_culling_gpu_stats(backend, completed_frame_index, resources.meshlet_culling_resources);
 
         log_debug(root, "{}GPU mesh culling stats:", event_status == VK_EVENT_SET ? "" : "[OUT OF DATE] ");
         for (auto stats : culling_stats)
@@ -650,6 +1049,6 @@ void backend_execute_frame(ReaperRoot& root, VulkanBackend& backend, CommandBuff
                   total.surviving_meshlet_count, total.surviving_triangle_count, total.indirect_draw_command_count);
     }
 
-    read_gpu_audio_data(backend, resources.audio_resources);
+    read_gpu_audio_data(backend, resources.audio_resources, completed_frame_index);
 }
 } // namespace Reaper
@@ -70,7 +70,7 @@ void prepare_tile_lighting_frame(const SceneGraph& scene, const RendererPerspect
     for (u32 scene_light_index = 0; scene_light_index < scene.scene_lights.size(); scene_light_index++)
     {
         const SceneLight&  light = scene.scene_lights[scene_light_index];
-        const glm::fmat4x3 light_ms_to_ws = get_scene_node_transform_slow(light.scene_node);
+        const glm::fmat4x3 light_ms_to_ws = get_scene_node_transform(scene, light.scene_node);
         const glm::fmat4x3 light_ws_to_ms = glm::inverse(glm::fmat4(light_ms_to_ws));
 
         const glm::vec3 light_position_ws = light_ms_to_ws * glm::vec4(0.f, 0.f, 0.f, 1.0f);
@@ -40,8 +40,8 @@ namespace Reaper
 {
 namespace
 {
-    VkPipeline create_lighting_pipeline(VkDevice device, const ShaderModules& shader_modules,
-                                        VkPipelineLayout pipeline_layout)
+    VkPipeline create_lighting_pipeline(VkDevice device, VkPipelineCache pipeline_cache,
+                                        const ShaderModules& shader_modules, VkPipelineLayout pipeline_layout)
     {
         const VkShaderModuleCreateInfo module_create_info = shader_module_create_info(
             get_spirv_shader_module(shader_modules, "tiled_lighting/tiled_lighting.comp.spv"));
@@ -49,11 +49,11 @@ namespace
         const VkPipelineShaderStageCreateInfo shader_stage =
             default_pipeline_shader_stage_create_info(VK_SHADER_STAGE_COMPUTE_BIT, &module_create_info);
 
-        return create_compute_pipeline(device, pipeline_layout, shader_stage);
+        return create_compute_pipeline(device, pipeline_cache, pipeline_layout, shader_stage);
     }
 
-    VkPipeline create_lighting_debug_pipeline(VkDevice device, const ShaderModules& shader_modules,
-                                              VkPipelineLayout pipeline_layout)
+    VkPipeline create_lighting_debug_pipeline(VkDevice device, VkPipelineCache pipeline_cache,
+                                              const ShaderModules& shader_modules, VkPipelineLayout pipeline_layout)
     {
         const VkShaderModuleCreateInfo module_create_info = shader_module_create_info(
             get_spirv_shader_module(shader_modules, "tiled_lighting/tiled_lighting_debug.comp.spv"));
@@ -61,7 +61,7 @@ namespace
         const VkPipelineShaderStageCreateInfo shader_stage =
             default_pipeline_shader_stage_create_info(VK_SHADER_STAGE_COMPUTE_BIT, &module_create_info);
 
-        return create_compute_pipeline(device, pipeline_layout, shader_stage);
+        return create_compute_pipeline(device, pipeline_cache, pipeline_layout, shader_stage);
     }
 } // namespace
 
@@ -110,20 +110,6 @@ TiledLightingPassResources create_tiled_lighting_pass_resources(VulkanBackend&
                                       });
     }
 
-    {
-        std::vector<VkDescriptorSetLayout> dset_layouts = {resources.lighting.descriptor_set_layout};
-        std::vector<VkDescriptorSet>       dsets(dset_layouts.size());
-
-        allocate_descriptor_sets(backend.device, backend.global_descriptor_pool, dset_layouts, dsets);
-
-        resources.tiled_lighting_descriptor_set = dsets[0];
-    }
-
-    resources.tiled_lighting_constant_buffer =
-        create_buffer(backend.device, "Tiled lighting constants",
-                      DefaultGPUBufferProperties(1, sizeof(TiledLightingConstants), GPUBufferUsage::UniformBuffer),
-                      backend.vma_instance, MemUsage::CPU_To_GPU);
-
     // Debug
     {
         std::vector<VkDescriptorSetLayoutBinding> bindings = {
@@ -149,10 +135,6 @@ TiledLightingPassResources create_tiled_lighting_pass_resources(VulkanBackend&
                                       });
     }
 
-    allocate_descriptor_sets(backend.device, backend.global_descriptor_pool,
-                             std::span(&resources.debug.descriptor_set_layout, 1),
-                             std::span(&resources.debug_descriptor_set, 1));
-
     return resources;
 }
 
@@ -161,8 +143,6 @@ void destroy_tiled_lighting_pass_resources(VulkanBackend& backend, TiledLighting
     vkDestroyPipelineLayout(backend.device, resources.debug.pipeline_layout, nullptr);
     vkDestroyDescriptorSetLayout(backend.device, resources.debug.descriptor_set_layout, nullptr);
 
-    vmaDestroyBuffer(backend.vma_instance, resources.tiled_lighting_constant_buffer.handle,
-                     resources.tiled_lighting_constant_buffer.allocation);
 
     vkDestroyPipelineLayout(backend.device, resources.lighting.pipeline_layout, nullptr);
     vkDestroyDescriptorSetLayout(backend.device, resources.lighting.descriptor_set_layout, nullptr);
@@ -244,21 +224,28 @@ TiledLightingDebugFrameGraphRecord create_tiled_lighting_debug_pass_record(
     return tiled_lighting_debug;
 }
 
-void update_tiled_lighting_pass_resources(VulkanBackend& backend, const FrameGraph::FrameGraph& frame_graph,
+void update_tiled_lighting_pass_resources(const FrameGraph::FrameGraph&        frame_graph,
                                           const FrameGraphResources&           frame_graph_resources,
                                           const TiledLightingFrameGraphRecord& record,
-                                          DescriptorWriteHelper& write_helper, const PreparedData& prepared,
-                                          const LightingPassResources&      lighting_resources,
-                                          const TiledLightingPassResources& resources,
-                                          const SamplerResources&           sampler_resources)
+                                          DescriptorWriteHelper&               write_helper,
+                                          StorageBufferAllocator&              frame_storage_allocator,
+                                          const PreparedData&                  prepared,
+                                          const LightingPassResources&         lighting_resources,
+                                          TiledLightingPassResources&          resources,
+                                          const SamplerResources&              sampler_resources)
 {
     REAPER_PROFILE_SCOPE_FUNC();
 
+    resources.tiled_lighting_descriptor_set =
+        write_helper.allocate_descriptor_set(resources.lighting.descriptor_set_layout);
+
     if (prepared.point_lights.empty())
         return;
 
-    upload_buffer_data_deprecated(backend.device, backend.vma_instance, resources.tiled_lighting_constant_buffer,
-                                  &prepared.tiled_light_constants, sizeof(TiledLightingConstants));
+    const StorageBufferAlloc constants_alloc =
+        allocate_storage(frame_storage_allocator, sizeof(TiledLightingConstants));
+
+    upload_storage_buffer(frame_storage_allocator, constants_alloc, &prepared.tiled_light_constants);
 
     const FrameGraphBuffer light_list_buffer =
         get_frame_graph_buffer(frame_graph_resources, frame_graph, record.light_list);
@@ -273,7 +260,8 @@ void update_tiled_lighting_pass_resources(VulkanBackend& backend, const FrameGra
         get_frame_graph_buffer(frame_graph_resources, frame_graph, record.tile_debug_texture);
 
     VkDescriptorSet dset = resources.tiled_lighting_descriptor_set;
-    write_helper.append(dset, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, resources.tiled_lighting_constant_buffer.handle);
+    write_helper.append(dset, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, constants_alloc.buffer,
+                        constants_alloc.offset_bytes, constants_alloc.size_bytes);
     write_helper.append(dset, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, light_list_buffer.handle);
     write_helper.append(dset, 2, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, gbuffer_rt0.default_view_handle,
                         gbuffer_rt0.image_layout);
@@ -343,8 +331,10 @@ void update_tiled_lighting_debug_pass_resources(const FrameGraph::FrameGraph&
                                                 const FrameGraphResources&                frame_graph_resources,
                                                 const TiledLightingDebugFrameGraphRecord& record,
                                                 DescriptorWriteHelper&                    write_helper,
-                                                const TiledLightingPassResources&         resources)
+                                                TiledLightingPassResources&               resources)
 {
+    resources.debug_descriptor_set = write_helper.allocate_descriptor_set(resources.debug.descriptor_set_layout);
+
     const FrameGraphBuffer tile_debug_buffer =
         get_frame_graph_buffer(frame_graph_resources, frame_graph, record.tile_debug);
     const FrameGraphTexture tile_debug_texture =
@@ -26,8 +26,6 @@ struct TiledLightingPassResources
 
     VkDescriptorSet tiled_lighting_descriptor_set;
 
-    GPUBuffer tiled_lighting_constant_buffer;
-
     // Debug
     struct LightingDebug
     {
@@ -88,14 +86,17 @@ class DescriptorWriteHelper;
 struct LightingPassResources;
 struct PreparedData;
 struct SamplerResources;
+struct StorageBufferAllocator;
 
-void update_tiled_lighting_pass_resources(VulkanBackend& backend, const FrameGraph::FrameGraph& frame_graph,
+void update_tiled_lighting_pass_resources(const FrameGraph::FrameGraph&        frame_graph,
                                           const FrameGraphResources&           frame_graph_resources,
                                           const TiledLightingFrameGraphRecord& record,
-                                          DescriptorWriteHelper& write_helper, const PreparedData& prepared,
-                                          const LightingPassResources&      lighting_resources,
-                                          const TiledLightingPassResources& resources,
-                                          const SamplerResources&           sampler_resources);
+                                          DescriptorWriteHelper&               write_helper,
+                                          StorageBufferAllocator&              frame_storage_allocator,
+                                          const PreparedData&                  prepared,
+                                          const LightingPassResources&         lighting_resources,
+                                          TiledLightingPassResources&          resources,
+                                          const SamplerResources&              sampler_resources);
 
 struct CommandBuffer;
 struct FrameGraphHelper;
@@ -110,7 +111,7 @@ void update_tiled_lighting_debug_pass_resources(const FrameGraph::FrameGraph&
                                                 const FrameGraphResources&                frame_graph_resources,
                                                 const TiledLightingDebugFrameGraphRecord& record,
                                                 DescriptorWriteHelper&                    write_helper,
-                                                const TiledLightingPassResources&         resources);
+                                                TiledLightingPassResources&               resources);
 
 void record_tiled_lighting_debug_command_buffer(const FrameGraphHelper&                   frame_graph_helper,
                                                 const TiledLightingDebugFrameGraphRecord& pass_record,
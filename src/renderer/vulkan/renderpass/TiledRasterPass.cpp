@@ -127,6 +127,7 @@ namespace Raster
 namespace
 {
     VkPipeline create_tiled_raster_depth_copy_pipeline(VkDevice             device,
+                                                       VkPipelineCache      pipeline_cache,
                                                        const ShaderModules& shader_modules,
                                                        VkPipelineLayout     pipeline_layout)
     {
@@ -149,11 +150,13 @@ namespace
 
         const std::vector<VkDynamicState> dynamic_states = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
 
-        VkPipeline pipeline = create_graphics_pipeline(device, shader_stages, pipeline_properties, dynamic_states);
+        VkPipeline pipeline =
+            create_graphics_pipeline(device, pipeline_cache, shader_stages, pipeline_properties, dynamic_states);
         return pipeline;
     }
 
-    VkPipeline create_tiled_raster_classify_pipeline(VkDevice device, const ShaderModules& shader_modules,
+    VkPipeline create_tiled_raster_classify_pipeline(VkDevice device, VkPipelineCache pipeline_cache,
+                                                     const ShaderModules& shader_modules,
                                                      VkPipelineLayout pipeline_layout)
     {
         const VkShaderModuleCreateInfo module_create_info = shader_module_create_info(
@@ -162,11 +165,11 @@ namespace
         const VkPipelineShaderStageCreateInfo shader_stage =
             default_pipeline_shader_stage_create_info(VK_SHADER_STAGE_COMPUTE_BIT, &module_create_info);
 
-        return create_compute_pipeline(device, pipeline_layout, shader_stage);
+        return create_compute_pipeline(device, pipeline_cache, pipeline_layout, shader_stage);
     }
 
-    VkPipeline create_tiled_raster_pipeline(VkDevice device, const ShaderModules& shader_modules,
-                                            VkPipelineLayout pipeline_layout)
+    VkPipeline create_tiled_raster_pipeline(VkDevice device, VkPipelineCache pipeline_cache,
+                                            const ShaderModules& shader_modules, VkPipelineLayout pipeline_layout)
     {
         const VkShaderModuleCreateInfo module_create_info_vert = shader_module_create_info(
             get_spirv_shader_module(shader_modules, "tiled_lighting/rasterize_light_volume.vert.spv"));
@@ -190,7 +193,7 @@ namespace
                                                             VK_DYNAMIC_STATE_DEPTH_COMPARE_OP,
                                                             VK_DYNAMIC_STATE_CULL_MODE};
 
-        return create_graphics_pipeline(device, shader_stages, pipeline_properties, dynamic_states);
+        return create_graphics_pipeline(device, pipeline_cache, shader_stages, pipeline_properties, dynamic_states);
     }
 } // namespace
 
@@ -272,18 +275,6 @@ TiledRasterResources create_tiled_raster_pass_resources(VulkanBackend& backend,
                                       });
     }
 
-    std::vector<VkDescriptorSetLayout> dset_layouts = {
-        resources.depth_copy.descriptor_set_layout, resources.classify.descriptor_set_layout,
-        resources.light_raster.descriptor_set_layout, resources.light_raster.descriptor_set_layout};
-    std::vector<VkDescriptorSet> dsets(dset_layouts.size());
-
-    allocate_descriptor_sets(backend.device, backend.global_descriptor_pool, dset_layouts, dsets);
-
-    resources.depth_copy.descriptor_set = dsets[0];
-    resources.classify.descriptor_set = dsets[1];
-    resources.light_raster.descriptor_sets[0] = dsets[2];
-    resources.light_raster.descriptor_sets[1] = dsets[3];
-
     {
         const GPUBufferProperties properties = DefaultGPUBufferProperties(
             MaxVertexCount, sizeof(hlsl_float3), GPUBufferUsage::StorageBuffer | GPUBufferUsage::VertexBuffer);
@@ -302,7 +293,7 @@ TiledRasterResources create_tiled_raster_pass_resources(VulkanBackend& backend,
         resources.vertex_buffer_offset += icosahedron_alloc.vertex_count;
 
         // FIXME It's assumed here that the mesh indices are flat
-        upload_buffer_data(backend.device, backend.vma_instance, resources.vertex_buffer_position, properties,
+        upload_buffer_data(backend.vma_instance, resources.vertex_buffer_position, properties,
                            icosahedron.positions.data(),
                            icosahedron.positions.size() * sizeof(icosahedron.positions[0]),
                            icosahedron_alloc.vertex_offset);
@@ -507,11 +498,17 @@ void update_tiled_lighting_raster_pass_resources(const FrameGraph::FrameGraph&
                                                  const LightRasterFrameGraphRecord& record,
                                                  DescriptorWriteHelper&             write_helper,
                                                  StorageBufferAllocator&            frame_storage_allocator,
-                                                 const TiledRasterResources&        resources,
+                                                 TiledRasterResources&              resources,
                                                  const TiledLightingFrame&          tiled_lighting_frame)
 {
     REAPER_PROFILE_SCOPE_FUNC();
 
+    resources.depth_copy.descriptor_set =
+        write_helper.allocate_descriptor_set(resources.depth_copy.descriptor_set_layout);
+    resources.classify.descriptor_set = write_helper.allocate_descriptor_set(resources.classify.descriptor_set_layout);
+    write_helper.allocate_descriptor_sets(resources.light_raster.descriptor_set_layout,
+                                          resources.light_raster.descriptor_sets);
+
     if (tiled_lighting_frame.light_volumes.empty())
         return;
 
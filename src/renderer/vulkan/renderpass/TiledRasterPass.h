@@ -122,7 +122,7 @@ void update_tiled_lighting_raster_pass_resources(const FrameGraph::FrameGraph&
                                                  const LightRasterFrameGraphRecord& record,
                                                  DescriptorWriteHelper&             write_helper,
                                                  StorageBufferAllocator&            frame_storage_allocator,
-                                                 const TiledRasterResources&        resources,
+                                                 TiledRasterResources&              resources,
                                                  const TiledLightingFrame&          tiled_lighting_frame);
 
 struct CommandBuffer;
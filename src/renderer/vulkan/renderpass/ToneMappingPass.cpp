@@ -30,8 +30,8 @@ namespace Reaper
 {
 namespace
 {
-    VkPipeline create_tone_map_bake_pipeline(VkDevice device, const ShaderModules& shader_modules,
-                                             VkPipelineLayout pipeline_layout)
+    VkPipeline create_tone_map_bake_pipeline(VkDevice device, VkPipelineCache pipeline_cache,
+                                             const ShaderModules& shader_modules, VkPipelineLayout pipeline_layout)
     {
         const VkShaderModuleCreateInfo module_create_info =
             shader_module_create_info(get_spirv_shader_module(shader_modules, "tone_mapping_bake_lut.comp.spv"));
@@ -39,7 +39,7 @@ namespace
         const VkPipelineShaderStageCreateInfo shader_stage =
             default_pipeline_shader_stage_create_info(VK_SHADER_STAGE_COMPUTE_BIT, &module_create_info);
 
-        return create_compute_pipeline(device, pipeline_layout, shader_stage);
+        return create_compute_pipeline(device, pipeline_cache, pipeline_layout, shader_stage);
     }
 } // namespace
 
@@ -69,9 +69,6 @@ ToneMapPassResources create_tone_map_pass_resources(VulkanBackend& backend, Pipe
                                       });
     }
 
-    allocate_descriptor_sets(backend.device, backend.global_descriptor_pool,
-                             std::span(&resources.descriptor_set_layout, 1), std::span(&resources.descriptor_set, 1));
-
     return resources;
 }
 
@@ -102,8 +99,10 @@ void update_tone_map_pass_descriptor_set(const FrameGraph::FrameGraph& frame_gra
                                          const FrameGraphResources&    frame_graph_resources,
                                          const ToneMapPassRecord&      record,
                                          DescriptorWriteHelper&        write_helper,
-                                         const ToneMapPassResources&   resources)
+                                         ToneMapPassResources&         resources)
 {
+    resources.descriptor_set = write_helper.allocate_descriptor_set(resources.descriptor_set_layout);
+
     const FrameGraphTexture tone_map_lut =
         get_frame_graph_texture(frame_graph_resources, frame_graph, record.tone_map_lut);
 
@@ -50,7 +50,7 @@ void update_tone_map_pass_descriptor_set(const FrameGraph::FrameGraph& frame_gra
                                          const FrameGraphResources&    frame_graph_resources,
                                          const ToneMapPassRecord&      record,
                                          DescriptorWriteHelper&        write_helper,
-                                         const ToneMapPassResources&   resources);
+                                         ToneMapPassResources&         resources);
 
 struct CommandBuffer;
 struct FrameGraphHelper;
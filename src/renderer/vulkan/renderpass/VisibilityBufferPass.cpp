@@ -87,6 +87,8 @@ namespace FillGBuffer
         mesh_materials,
         diffuse_map_sampler,
         material_maps,
+        texture_view_mip_offsets,
+        texture_feedback,
         _count,
     };
 
@@ -143,16 +145,28 @@ namespace FillGBuffer
          .count = MaterialTextureMaxCount,
          .type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
          .stage_mask = VK_SHADER_STAGE_COMPUTE_BIT},
+        {.slot = Slot_texture_view_mip_offsets,
+         .count = 1,
+         .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+         .stage_mask = VK_SHADER_STAGE_COMPUTE_BIT},
+        {.slot = Slot_texture_feedback,
+         .count = 1,
+         .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+         .stage_mask = VK_SHADER_STAGE_COMPUTE_BIT},
     };
 } // namespace FillGBuffer
 
 namespace
 {
-    VkPipeline create_vis_buffer_pipeline(VkDevice device, const ShaderModules& shader_modules,
-                                          VkPipelineLayout pipeline_layout, bool enable_msaa)
+    VkPipeline create_vis_buffer_pipeline(VkDevice device, VkPipelineCache pipeline_cache,
+                                          const ShaderModules& shader_modules, VkPipelineLayout pipeline_layout,
+                                          bool enable_msaa, bool enable_quantized_vertices)
     {
+        const char* vertex_shader_name = enable_quantized_vertices ? "vis_buffer/vis_buffer_raster_quantized.vert.spv"
+                                                                   : "vis_buffer/vis_buffer_raster.vert.spv";
+
         const VkShaderModuleCreateInfo module_create_info_vert =
-            shader_module_create_info(get_spirv_shader_module(shader_modules, "vis_buffer/vis_buffer_raster.vert.spv"));
+            shader_module_create_info(get_spirv_shader_module(shader_modules, vertex_shader_name));
         const VkShaderModuleCreateInfo module_create_info_frag =
             shader_module_create_info(get_spirv_shader_module(shader_modules, "vis_buffer/vis_buffer_raster.frag.spv"));
 
@@ -212,7 +226,8 @@ namespace
 
         std::vector<VkDynamicState> dynamic_states = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
 
-        VkPipeline pipeline = create_graphics_pipeline(device, shader_stages, pipeline_properties, dynamic_states);
+        VkPipeline pipeline =
+            create_graphics_pipeline(device, pipeline_cache, shader_stages, pipeline_properties, dynamic_states);
 
         // log_debug(root, "- total time = {}ms, vs = {}ms, fs = {}ms", feedback.duration / 1000,
         //           feedback_stages[0].duration / 1000, feedback_stages[1].duration / 1000);
@@ -220,55 +235,97 @@ namespace
         return pipeline;
     }
 
-    VkPipeline create_vis_buffer_pipeline_non_msaa(VkDevice device, const ShaderModules& shader_modules,
+    VkPipeline create_vis_buffer_pipeline_non_msaa(VkDevice device, VkPipelineCache pipeline_cache,
+                                                   const ShaderModules& shader_modules,
                                                    VkPipelineLayout pipeline_layout)
     {
-        return create_vis_buffer_pipeline(device, shader_modules, pipeline_layout, false);
+        return create_vis_buffer_pipeline(device, pipeline_cache, shader_modules, pipeline_layout, false, false);
     }
 
-    VkPipeline create_vis_buffer_pipeline_msaa(VkDevice device, const ShaderModules& shader_modules,
-                                               VkPipelineLayout pipeline_layout)
+    VkPipeline create_vis_buffer_pipeline_msaa(VkDevice device, VkPipelineCache pipeline_cache,
+                                               const ShaderModules& shader_modules, VkPipelineLayout pipeline_layout)
     {
-        return create_vis_buffer_pipeline(device, shader_modules, pipeline_layout, true);
+        return create_vis_buffer_pipeline(device, pipeline_cache, shader_modules, pipeline_layout, true, false);
     }
 
-    VkPipeline create_vis_buffer_fill_pipeline(VkDevice device, const ShaderModules& shader_modules,
-                                               VkPipelineLayout pipeline_layout)
+    VkPipeline create_vis_buffer_pipeline_non_msaa_quantized(VkDevice device, VkPipelineCache pipeline_cache,
+                                                             const ShaderModules& shader_modules,
+                                                             VkPipelineLayout pipeline_layout)
     {
-        const VkShaderModuleCreateInfo module_create_info =
-            shader_module_create_info(get_spirv_shader_module(shader_modules, "vis_buffer/fill_gbuffer.comp.spv"));
-
-        const VkPipelineShaderStageCreateInfo shader_stage =
-            default_pipeline_shader_stage_create_info(VK_SHADER_STAGE_COMPUTE_BIT, &module_create_info);
+        return create_vis_buffer_pipeline(device, pipeline_cache, shader_modules, pipeline_layout, false, true);
+    }
 
-        return create_compute_pipeline(device, pipeline_layout, shader_stage);
+    VkPipeline create_vis_buffer_pipeline_msaa_quantized(VkDevice device, VkPipelineCache pipeline_cache,
+                                                         const ShaderModules& shader_modules,
+                                                         VkPipelineLayout pipeline_layout)
+    {
+        return create_vis_buffer_pipeline(device, pipeline_cache, shader_modules, pipeline_layout, true, true);
     }
 
-    VkPipeline create_vis_buffer_fill_msaa_pipeline(VkDevice device, const ShaderModules& shader_modules,
-                                                    VkPipelineLayout pipeline_layout)
+    VkPipeline create_vis_buffer_fill_pipeline_generic(VkDevice device, VkPipelineCache pipeline_cache,
+                                                       const ShaderModules& shader_modules,
+                                                       VkPipelineLayout pipeline_layout, const char* shader_name)
     {
         const VkShaderModuleCreateInfo module_create_info =
-            shader_module_create_info(get_spirv_shader_module(shader_modules, "vis_buffer/fill_gbuffer_msaa.comp.spv"));
+            shader_module_create_info(get_spirv_shader_module(shader_modules, shader_name));
 
         const VkPipelineShaderStageCreateInfo shader_stage =
             default_pipeline_shader_stage_create_info(VK_SHADER_STAGE_COMPUTE_BIT, &module_create_info);
 
-        return create_compute_pipeline(device, pipeline_layout, shader_stage);
+        return create_compute_pipeline(device, pipeline_cache, pipeline_layout, shader_stage);
+    }
+
+    VkPipeline create_vis_buffer_fill_pipeline(VkDevice device, VkPipelineCache pipeline_cache,
+                                               const ShaderModules& shader_modules, VkPipelineLayout pipeline_layout)
+    {
+        return create_vis_buffer_fill_pipeline_generic(device, pipeline_cache, shader_modules, pipeline_layout,
+                                                       "vis_buffer/fill_gbuffer.comp.spv");
     }
 
-    VkPipeline create_vis_buffer_fill_msaa_with_resolve_pipeline(VkDevice device, const ShaderModules& shader_modules,
+    VkPipeline create_vis_buffer_fill_msaa_pipeline(VkDevice device, VkPipelineCache pipeline_cache,
+                                                    const ShaderModules& shader_modules,
+                                                    VkPipelineLayout pipeline_layout)
+    {
+        return create_vis_buffer_fill_pipeline_generic(device, pipeline_cache, shader_modules, pipeline_layout,
+                                                       "vis_buffer/fill_gbuffer_msaa.comp.spv");
+    }
+
+    VkPipeline create_vis_buffer_fill_msaa_with_resolve_pipeline(VkDevice device, VkPipelineCache pipeline_cache,
+                                                                 const ShaderModules& shader_modules,
                                                                  VkPipelineLayout pipeline_layout)
     {
-        const VkShaderModuleCreateInfo module_create_info = shader_module_create_info(
-            get_spirv_shader_module(shader_modules, "vis_buffer/fill_gbuffer_msaa_with_depth_resolve.comp.spv"));
+        return create_vis_buffer_fill_pipeline_generic(device, pipeline_cache, shader_modules, pipeline_layout,
+                                                       "vis_buffer/fill_gbuffer_msaa_with_depth_resolve.comp.spv");
+    }
 
-        const VkPipelineShaderStageCreateInfo shader_stage =
-            default_pipeline_shader_stage_create_info(VK_SHADER_STAGE_COMPUTE_BIT, &module_create_info);
+    VkPipeline create_vis_buffer_fill_quantized_pipeline(VkDevice device, VkPipelineCache pipeline_cache,
+                                                         const ShaderModules& shader_modules,
+                                                         VkPipelineLayout pipeline_layout)
+    {
+        return create_vis_buffer_fill_pipeline_generic(device, pipeline_cache, shader_modules, pipeline_layout,
+                                                       "vis_buffer/fill_gbuffer_quantized.comp.spv");
+    }
 
-        return create_compute_pipeline(device, pipeline_layout, shader_stage);
+    VkPipeline create_vis_buffer_fill_msaa_quantized_pipeline(VkDevice device, VkPipelineCache pipeline_cache,
+                                                              const ShaderModules& shader_modules,
+                                                              VkPipelineLayout pipeline_layout)
+    {
+        return create_vis_buffer_fill_pipeline_generic(device, pipeline_cache, shader_modules, pipeline_layout,
+                                                       "vis_buffer/fill_gbuffer_msaa_quantized.comp.spv");
+    }
+
+    VkPipeline create_vis_buffer_fill_msaa_with_resolve_quantized_pipeline(VkDevice             device,
+                                                                           VkPipelineCache      pipeline_cache,
+                                                                           const ShaderModules& shader_modules,
+                                                                           VkPipelineLayout     pipeline_layout)
+    {
+        return create_vis_buffer_fill_pipeline_generic(
+            device, pipeline_cache, shader_modules, pipeline_layout,
+            "vis_buffer/fill_gbuffer_msaa_with_depth_resolve_quantized.comp.spv");
     }
 
-    VkPipeline create_legacy_depth_resolve_pipeline(VkDevice device, const ShaderModules& shader_modules,
+    VkPipeline create_legacy_depth_resolve_pipeline(VkDevice device, VkPipelineCache pipeline_cache,
+                                                    const ShaderModules& shader_modules,
                                                     VkPipelineLayout pipeline_layout)
     {
         const VkShaderModuleCreateInfo module_create_info_vert =
@@ -289,7 +346,8 @@ namespace
 
         const std::vector<VkDynamicState> dynamic_states = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
 
-        VkPipeline pipeline = create_graphics_pipeline(device, shader_stages, pipeline_properties, dynamic_states);
+        VkPipeline pipeline =
+            create_graphics_pipeline(device, pipeline_cache, shader_stages, pipeline_properties, dynamic_states);
         return pipeline;
     }
 } // namespace
@@ -299,6 +357,9 @@ VisibilityBufferPassResources create_vis_buffer_pass_resources(VulkanBackend&
 {
     VisibilityBufferPassResources resources = {};
 
+    // Has to match the vertex streams of the mesh cache, see get_vertex_position_buffer()
+    const bool enable_quantized_vertices = backend.options.enable_quantized_vertices;
+
     {
         using namespace Render;
 
@@ -319,7 +380,9 @@ VisibilityBufferPassResources create_vis_buffer_pass_resources(VulkanBackend&
             register_pipeline_creator(pipeline_factory,
                                       PipelineCreator{
                                           .pipeline_layout = resources.pipe.pipelineLayout,
-                                          .pipeline_creation_function = &create_vis_buffer_pipeline_non_msaa,
+                                          .pipeline_creation_function =
+                                              enable_quantized_vertices ? &create_vis_buffer_pipeline_non_msaa_quantized
+                                                                        : &create_vis_buffer_pipeline_non_msaa,
                                       });
     }
 
@@ -344,7 +407,9 @@ VisibilityBufferPassResources create_vis_buffer_pass_resources(VulkanBackend&
             register_pipeline_creator(pipeline_factory,
                                       PipelineCreator{
                                           .pipeline_layout = resources.pipe_msaa.pipelineLayout,
-                                          .pipeline_creation_function = &create_vis_buffer_pipeline_msaa,
+                                          .pipeline_creation_function =
+                                              enable_quantized_vertices ? &create_vis_buffer_pipeline_msaa_quantized
+                                                                        : &create_vis_buffer_pipeline_msaa,
                                       });
     }
 
@@ -372,7 +437,9 @@ VisibilityBufferPassResources create_vis_buffer_pass_resources(VulkanBackend&
             register_pipeline_creator(pipeline_factory,
                                       PipelineCreator{
                                           .pipeline_layout = pipelineLayout,
-                                          .pipeline_creation_function = &create_vis_buffer_fill_pipeline,
+                                          .pipeline_creation_function =
+                                              enable_quantized_vertices ? &create_vis_buffer_fill_quantized_pipeline
+                                                                        : &create_vis_buffer_fill_pipeline,
                                       });
     }
 
@@ -400,7 +467,10 @@ VisibilityBufferPassResources create_vis_buffer_pass_resources(VulkanBackend&
             register_pipeline_creator(pipeline_factory,
                                       PipelineCreator{
                                           .pipeline_layout = pipelineLayout,
-                                          .pipeline_creation_function = &create_vis_buffer_fill_msaa_pipeline,
+                                          .pipeline_creation_function =
+                                              enable_quantized_vertices
+                                                  ? &create_vis_buffer_fill_msaa_quantized_pipeline
+                                                  : &create_vis_buffer_fill_msaa_pipeline,
                                       });
     }
 
@@ -428,7 +498,9 @@ VisibilityBufferPassResources create_vis_buffer_pass_resources(VulkanBackend&
             pipeline_factory,
             PipelineCreator{
                 .pipeline_layout = pipelineLayout,
-                .pipeline_creation_function = &create_vis_buffer_fill_msaa_with_resolve_pipeline,
+                .pipeline_creation_function = enable_quantized_vertices
+                                                  ? &create_vis_buffer_fill_msaa_with_resolve_quantized_pipeline
+                                                  : &create_vis_buffer_fill_msaa_with_resolve_pipeline,
             });
     }
 
@@ -453,17 +525,6 @@ VisibilityBufferPassResources create_vis_buffer_pass_resources(VulkanBackend&
                                       });
     }
 
-    allocate_descriptor_sets(backend.device, backend.global_descriptor_pool,
-                             std::span(&resources.pipe.desc_set_layout, 1), std::span(&resources.descriptor_set, 1));
-
-    allocate_descriptor_sets(backend.device, backend.global_descriptor_pool,
-                             std::span(&resources.fill_pipe.desc_set_layout, 1),
-                             std::span(&resources.descriptor_set_fill, 1));
-
-    allocate_descriptor_sets(backend.device, backend.global_descriptor_pool,
-                             std::span(&resources.legacy_resolve_pipe.desc_set_layout, 1),
-                             std::span(&resources.descriptor_set_legacy_resolve, 1));
-
     return resources;
 }
 
@@ -654,14 +715,19 @@ VisBufferFrameGraphRecord create_vis_buffer_pass_record(FrameGraph::Builder&
 void update_vis_buffer_pass_resources(const FrameGraph::FrameGraph&    frame_graph,
                                       const FrameGraphResources&       frame_graph_resources,
                                       const VisBufferFrameGraphRecord& record, DescriptorWriteHelper& write_helper,
-                                      StorageBufferAllocator&              frame_storage_allocator,
-                                      const VisibilityBufferPassResources& resources, const PreparedData& prepared,
+                                      StorageBufferAllocator&        frame_storage_allocator,
+                                      VisibilityBufferPassResources& resources, const PreparedData& prepared,
                                       const SamplerResources&  sampler_resources,
                                       const MaterialResources& material_resources, const MeshCache& mesh_cache,
                                       bool enable_msaa, bool support_shader_stores_to_depth)
 {
     REAPER_PROFILE_SCOPE_FUNC();
 
+    resources.descriptor_set = write_helper.allocate_descriptor_set(resources.pipe.desc_set_layout);
+    resources.descriptor_set_fill = write_helper.allocate_descriptor_set(resources.fill_pipe.desc_set_layout);
+    resources.descriptor_set_legacy_resolve =
+        write_helper.allocate_descriptor_set(resources.legacy_resolve_pipe.desc_set_layout);
+
     if (prepared.mesh_instances.empty())
         return;
 
@@ -677,6 +743,15 @@ void update_vis_buffer_pass_resources(const FrameGraph::FrameGraph&    frame_gra
 
     upload_storage_buffer(frame_storage_allocator, mesh_material_alloc, prepared.mesh_materials.data());
 
+    std::array<u32, MaterialTextureMaxCount> view_mip_offsets = {};
+
+    for (u32 index = 0; index < material_resources.textures.size(); index += 1)
+        view_mip_offsets[index] = get_texture_view_mip_offset(material_resources.textures[index]);
+
+    StorageBufferAlloc view_mip_offsets_alloc = allocate_storage(frame_storage_allocator, sizeof(view_mip_offsets));
+
+    upload_storage_buffer(frame_storage_allocator, view_mip_offsets_alloc, view_mip_offsets.data());
+
     {
         const FrameGraphBuffer visible_meshlet_buffer =
             get_frame_graph_buffer(frame_graph_resources, frame_graph, record.render.visible_meshlet_buffer);
@@ -687,7 +762,7 @@ void update_vis_buffer_pass_resources(const FrameGraph::FrameGraph&    frame_gra
                             mesh_instance_alloc.offset_bytes, mesh_instance_alloc.size_bytes);
         write_helper.append(resources.descriptor_set, g_bindings[visible_meshlets], visible_meshlet_buffer.handle);
         write_helper.append(resources.descriptor_set, g_bindings[buffer_position_ms],
-                            mesh_cache.vertexBufferPosition.handle);
+                            get_vertex_position_buffer(mesh_cache).handle);
     }
 
     {
@@ -734,14 +809,19 @@ void update_vis_buffer_pass_resources(const FrameGraph::FrameGraph&    frame_gra
                             meshlet_visible_index_buffer.handle, visible_index_buffer_view.offset_bytes,
                             visible_index_buffer_view.size_bytes);
         write_helper.append(resources.descriptor_set_fill, g_bindings[buffer_position_ms],
-                            mesh_cache.vertexBufferPosition.handle);
+                            get_vertex_position_buffer(mesh_cache).handle);
         write_helper.append(resources.descriptor_set_fill, g_bindings[buffer_attributes],
-                            mesh_cache.vertexAttributesBuffer.handle);
+                            get_vertex_attributes_buffer(mesh_cache).handle);
         write_helper.append(resources.descriptor_set_fill, g_bindings[visible_meshlets], visible_meshlet_buffer.handle);
         write_helper.append(resources.descriptor_set_fill, g_bindings[mesh_materials], mesh_material_alloc.buffer,
                             mesh_material_alloc.offset_bytes, mesh_material_alloc.size_bytes);
         write_helper.append(resources.descriptor_set_fill, g_bindings[diffuse_map_sampler],
                             sampler_resources.diffuse_map_sampler);
+        write_helper.append(resources.descriptor_set_fill, g_bindings[texture_view_mip_offsets],
+                            view_mip_offsets_alloc.buffer, view_mip_offsets_alloc.offset_bytes,
+                            view_mip_offsets_alloc.size_bytes);
+        write_helper.append(resources.descriptor_set_fill, g_bindings[texture_feedback],
+                            material_resources.feedback.buffer.handle);
 
         if (!material_resources.textures.empty())
         {
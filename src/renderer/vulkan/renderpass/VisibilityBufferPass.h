@@ -114,8 +114,8 @@ struct StorageBufferAllocator;
 void update_vis_buffer_pass_resources(const FrameGraph::FrameGraph&    frame_graph,
                                       const FrameGraphResources&       frame_graph_resources,
                                       const VisBufferFrameGraphRecord& record, DescriptorWriteHelper& write_helper,
-                                      StorageBufferAllocator&              frame_storage_allocator,
-                                      const VisibilityBufferPassResources& resources, const PreparedData& prepared,
+                                      StorageBufferAllocator&        frame_storage_allocator,
+                                      VisibilityBufferPassResources& resources, const PreparedData& prepared,
                                       const SamplerResources&  sampler_resources,
                                       const MaterialResources& material_resources, const MeshCache& mesh_cache,
                                       bool enable_msaa, bool support_shader_stores_to_depth);
@@ -0,0 +1,118 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include "core/fs/MappedFile.h"
+#include "core/jobs/JobSystem.h"
+#include "mesh/ModelLoader.h"
+#include "renderer/CookedMesh.h"
+#include "renderer/MeshletBuilder.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Reaper;
+
+namespace
+{
+bool is_cooked_mesh_up_to_date(const std::string& cooked_path, u64 source_hash)
+{
+    MappedFile cooked_file;
+
+    if (!map_file(cooked_path, cooked_file))
+        return false;
+
+    std::vector<MeshletMeshView> views;
+
+    const bool is_up_to_date =
+        get_cooked_mesh_views(std::span(cooked_file.data, cooked_file.size_bytes), source_hash, views);
+
+    unmap_file(cooked_file);
+
+    return is_up_to_date;
+}
+} // namespace
+
+// Usage: reaper_mesh_cooker [--force] <source.obj>...
+// Writes <source.obj>.rmesh next to every source that changed since it was last cooked.
+int main(int argc, char** argv)
+{
+    std::vector<std::string> source_paths;
+    bool                     force = false;
+
+    for (const char* arg : std::span(argv + 1, argv + argc))
+    {
+        if (std::string(arg) == "--force")
+            force = true;
+        else
+            source_paths.emplace_back(arg);
+    }
+
+    if (source_paths.empty())
+    {
+        fmt::print(stderr, "usage: {} [--force] <source.obj>...\n", argv[0]);
+        return 1;
+    }
+
+    const u32  worker_thread_count = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    JobSystem* job_system = create_job_system(worker_thread_count);
+
+    std::vector<u64>  source_hashes;
+    std::vector<Mesh> meshes;
+    std::vector<u32>  stale_source_indices;
+
+    for (u32 source_index = 0; source_index < source_paths.size(); source_index++)
+    {
+        const std::string& source_path = source_paths[source_index];
+        const u64          source_hash = hash_cooked_mesh_source(source_path);
+
+        source_hashes.push_back(source_hash);
+
+        if (!force && is_cooked_mesh_up_to_date(get_cooked_mesh_path(source_path), source_hash))
+        {
+            fmt::print("{}: up to date\n", source_path);
+            continue;
+        }
+
+        // Same options as the runtime, so cooked data matches what load_meshes() would upload
+        ObjLoadOptions options;
+        options.job_system = job_system;
+
+        meshes.push_back(load_obj(source_path, options));
+        stale_source_indices.push_back(source_index);
+    }
+
+    std::vector<MeshletMesh> meshlet_meshes(meshes.size());
+    build_meshlet_meshes(meshes, meshlet_meshes, job_system);
+
+    destroy_job_system(job_system);
+
+    int result = 0;
+
+    for (u32 mesh_index = 0; mesh_index < meshlet_meshes.size(); mesh_index++)
+    {
+        const u32          source_index = stale_source_indices[mesh_index];
+        const std::string& source_path = source_paths[source_index];
+        const std::string  cooked_path = get_cooked_mesh_path(source_path);
+
+        if (write_cooked_mesh_file(cooked_path, std::span(&meshlet_meshes[mesh_index], 1), source_hashes[source_index]))
+        {
+            fmt::print("{}: cooked to {}\n", source_path, cooked_path);
+        }
+        else
+        {
+            fmt::print(stderr, "{}: could not write {}\n", source_path, cooked_path);
+            result = 1;
+        }
+    }
+
+    return result;
+}
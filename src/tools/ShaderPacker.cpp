@@ -0,0 +1,59 @@
+////////////////////////////////////////////////////////////////////////////////
+/// Reaper
+///
+/// Copyright (c) 2015-2022 Thibault Schueller
+/// This file is distributed under the MIT License
+////////////////////////////////////////////////////////////////////////////////
+
+#include "core/fs/FileLoading.h"
+#include "renderer/ShaderPack.h"
+
+#include <fmt/format.h>
+
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+using namespace Reaper;
+
+// Usage: reaper_shader_packer <output.rspv> <shader folder> <module.spv>...
+// Modules are named after their path relative to the shader folder, which is what get_spirv_shader_module() expects.
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        fmt::print(stderr, "usage: {} <output.rspv> <shader folder> <module.spv>...\n", argv[0]);
+        return 1;
+    }
+
+    const std::string           output_path = argv[1];
+    const std::filesystem::path shader_folder = argv[2];
+
+    std::vector<ShaderPackSource> sources;
+
+    for (const char* arg : std::span(argv + 3, argv + argc))
+    {
+        const std::filesystem::path module_path = arg;
+
+        ShaderPackSource& source = sources.emplace_back();
+        source.name = std::filesystem::relative(module_path, shader_folder).generic_string();
+        source.code = readWholeFile(module_path.string());
+
+        if (source.code.size() % sizeof(u32) != 0)
+        {
+            fmt::print(stderr, "{}: not a SPIR-V module\n", module_path.string());
+            return 1;
+        }
+    }
+
+    if (!write_shader_pack_file(output_path, sources))
+    {
+        fmt::print(stderr, "could not write {}\n", output_path);
+        return 1;
+    }
+
+    fmt::print("packed {} SPIR-V modules to {}\n", sources.size(), output_path);
+
+    return 0;
+}